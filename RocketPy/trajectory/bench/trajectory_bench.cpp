@@ -0,0 +1,559 @@
+// Trajectory engine: flights per second for each model and integrator, and checks that the
+// integration is right. Vacuum flights have closed-form apogees, and flights of the RocketPyTest
+// rocket should agree between the two integrators and with a much finer reference. Also the air
+// brake computer's apogee controller and predictor flying in the engine.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "engine/apogee_controller.h"
+#include "engine/flight.h"
+#include "engine/monte_carlo.h"
+
+namespace seds::trajectory {
+    namespace {
+        /// The RocketPyTest rocket, loaded once.
+        Expected<Scenario> const& calisto() {
+            static auto const scenario = load_calisto(TRAJECTORY_DATA_DIR);
+            return scenario;
+        }
+
+        /// The spread of dispersions.txt.
+        Dispersions dispersed() {
+            Dispersions dispersions;
+            dispersions.impulse = Distribution { Distribution::Kind::Normal, 1, 0.03 };
+            dispersions.drag = Distribution { Distribution::Kind::Normal, 1, 0.05 };
+            dispersions.mass = Distribution { Distribution::Kind::Normal, 14.426, 0.15 };
+            dispersions.inclination = Distribution { Distribution::Kind::Normal, 85, 1 };
+            dispersions.heading = Distribution { Distribution::Kind::Normal, 0, 2 };
+            dispersions.wind_speed = Distribution { Distribution::Kind::Uniform, 0, 8 };
+            dispersions.wind_from = Distribution { Distribution::Kind::Uniform, 0, 360 };
+            return dispersions;
+        }
+
+        /// A motor with a flat thrust curve, burning its propellant off at a constant rate.
+        Scenario vacuum_flight(double propellant_mass) {
+            std::vector<std::pair<double, double>> const thrust = { { 0.0, 3000.0 },
+                { 4.0, 3000.0 } };
+            return Scenario {
+                .rocket = Rocket {
+                    .mass = 20,
+                    .radius = 0.0635,
+                    .power_on_drag = {},
+                    .power_off_drag = {},
+                    .drag_scale = 1,
+                    .motor = Motor(thrust, MotorConfig {
+                        .dry_mass = 0,
+                        .propellant_mass = propellant_mass,
+                        .burn_time = std::nullopt,
+                    }),
+                    .air_brakes = std::nullopt,
+                },
+                .atmosphere = Atmosphere { .constant_gravity = 9.81, .vacuum = true },
+                .rail = LaunchRail { .length = 1, .inclination = 90, .heading = 0 },
+                .sampling_rate = 10,
+            };
+        }
+
+        /// Apogee of `vacuum_flight` from the rocket equation.
+        double vacuum_apogee(double propellant_mass) {
+            constexpr double thrust = 3000;
+            constexpr double burn_time = 4;
+            constexpr double gravity = 9.81;
+            auto const start = 20 + propellant_mass;
+            auto const end = 20.0;
+
+            double altitude;
+            double velocity;
+            if (propellant_mass == 0) {
+                auto const accel = thrust / start - gravity;
+                altitude = 0.5 * accel * burn_time * burn_time;
+                velocity = accel * burn_time;
+            } else {
+                auto const exhaust_velocity = thrust * burn_time / propellant_mass;
+                auto const flow = propellant_mass / burn_time;
+                auto const ratio = std::log(start / end);
+                velocity = exhaust_velocity * ratio - gravity * burn_time;
+                altitude = exhaust_velocity * (burn_time - end / flow * ratio)
+                    - 0.5 * gravity * burn_time * burn_time;
+            }
+            return altitude + velocity * velocity / (2 * gravity);
+        }
+    }
+
+    /// The RocketPyTest rocket to apogee with the air brakes stowed, by model and method. The
+    /// counters show where it got to and the work it took.
+    static void BM_Flight(benchmark::State& state) {
+        auto const& scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        SolverConfig const config {
+            .model = static_cast<Model>(state.range(0)),
+            .method = static_cast<Method>(state.range(1)),
+        };
+
+        FlightResult result;
+        for (auto _ : state) {
+            result = simulate(*scenario, config);
+            benchmark::DoNotOptimize(result);
+        }
+
+        state.SetLabel(std::string(config.model == Model::Vertical ? "vertical" : "point-mass")
+            + (config.method == Method::Rk4 ? "/rk4" : "/rk45"));
+        state.SetItemsProcessed(state.iterations());
+        state.counters["apogee_m"] = result.apogee;
+        state.counters["steps"] = result.steps;
+        state.counters["evaluations"] = result.evaluations;
+        if (!result.reached_apogee) {
+            state.SkipWithError("the flight never reached apogee");
+        }
+    }
+    BENCHMARK(BM_Flight)->ArgsProduct({ { 0, 1 }, { 0, 1 } })->Unit(benchmark::kMicrosecond);
+
+    /// The same with the air brake controller from AirbreaksDataTest.py, which also runs it at
+    /// 10 Hz and so cuts every step at a sampling time.
+    static void BM_Flight_AirBrakes(benchmark::State& state) {
+        auto const& scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+
+        FlightResult stowed = simulate(*scenario, SolverConfig {});
+        FlightResult result;
+        for (auto _ : state) {
+            result = simulate(*scenario, SolverConfig {},
+                RocketPyExampleController(scenario->sampling_rate));
+            benchmark::DoNotOptimize(result);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["apogee_m"] = result.apogee;
+        state.counters["deployment"] = result.deployment;
+        if (result.apogee >= stowed.apogee || result.deployment <= 0) {
+            state.SkipWithError("the air brakes didn't lower the apogee");
+        }
+    }
+    BENCHMARK(BM_Flight_AirBrakes)->Unit(benchmark::kMicrosecond);
+
+    /// The air brake computer's apogee controller at 100 Hz, predicting with its closed form (0)
+    /// or with the apogee predictor (1), aiming for the target in metres. Fails unless the apogee
+    /// lands within 10 m of the target. The closed form reads low through the transonic drag
+    /// rise, so only the predictor is flown at 5000 m.
+    static void BM_Flight_ApogeeTarget(benchmark::State& state) {
+        auto scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        scenario->sampling_rate = 100;
+        airbrake::ControllerConfig const config {
+            .target_apogee = static_cast<float>(state.range(1)),
+        };
+        auto const predictor = state.range(0) != 0
+            ? std::make_shared<airbrake::ApogeePredictor const>(predictor_config(*scenario))
+            : nullptr;
+
+        FlightResult result;
+        for (auto _ : state) {
+            auto controller = predictor != nullptr ? ApogeeTargetController(config, predictor)
+                                                   : ApogeeTargetController(config);
+            result = simulate(*scenario, SolverConfig {}, std::move(controller));
+            benchmark::DoNotOptimize(result);
+        }
+
+        state.SetItemsProcessed(state.iterations());
+        state.counters["apogee_m"] = result.apogee;
+        state.counters["deployment"] = result.deployment;
+        if (!result.reached_apogee || std::abs(result.apogee - config.target_apogee) > 10) {
+            state.SkipWithError("the apogee controller missed its target");
+        }
+    }
+    BENCHMARK(BM_Flight_ApogeeTarget)
+        ->Args({ 0, 5200 })
+        ->Args({ 1, 5200 })
+        ->Args({ 1, 5000 })
+        ->Unit(benchmark::kMicrosecond);
+
+    /// The apogee predictor against flights with the brakes held at 0, 0.5 and 1 after burnout,
+    /// from every accepted step of the coast above 10 m/s. Straight up in the vertical model,
+    /// which is the predictor's own model, it has to land within 3 m of the engine's apogee. Off
+    /// the 85° rail in the point-mass model it only sees the vertical speed, so it
+    /// underestimates the drag and reads high, by up to 30 m. The counters are the worst
+    /// errors, m.
+    static void BM_ApogeePredictor_Accuracy(benchmark::State& state) {
+        auto scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        auto const burn_out = scenario->rocket.motor.burn_out_time();
+
+        double vertical_error = 0;
+        double point_mass_error = 0;
+        for (auto _ : state) {
+            vertical_error = 0;
+            point_mass_error = 0;
+            for (auto model : { Model::Vertical, Model::PointMass }) {
+                auto flown = *scenario;
+                flown.rail.inclination = model == Model::Vertical ? 90 : scenario->rail.inclination;
+                airbrake::ApogeePredictor const predictor(predictor_config(flown));
+                auto& worst = model == Model::Vertical ? vertical_error : point_mass_error;
+
+                for (double level : { 0.0, 0.5, 1.0 }) {
+                    std::vector<TrajectoryPoint> coast;
+                    auto const result = simulate(flown, SolverConfig { .model = model },
+                        [level](ControllerInput const& input) {
+                            return input.burning ? 0.0 : level;
+                        },
+                        [&](TrajectoryPoint const& point) {
+                            if (point.time >= burn_out && point.velocity[2] > 10) {
+                                coast.push_back(point);
+                            }
+                        });
+                    for (auto const& point : coast) {
+                        auto const predicted = predictor.predict(
+                            static_cast<float>(point.position[2]),
+                            static_cast<float>(point.velocity[2]), static_cast<float>(level));
+                        worst = std::max(worst, std::abs(predicted - result.apogee));
+                    }
+                }
+            }
+        }
+
+        state.counters["vertical_error_m"] = vertical_error;
+        state.counters["point_mass_error_m"] = point_mass_error;
+        if (vertical_error > 3 || point_mass_error > 30) {
+            state.SkipWithError("the apogee predictor is off the engine's flights");
+        }
+    }
+    BENCHMARK(BM_ApogeePredictor_Accuracy)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+    /// The drag identifier on a rocket 15% draggier than the predictor's tables, fed the true
+    /// specific force at 100 Hz. The brakes stay stowed for 3 s after burnout and then hold at
+    /// 0.5, so both scales are seen. 6 s after burnout, the predictor with the fitted scales is
+    /// held against the tables alone. Straight up the fit has to land within 2% on the airframe
+    /// and 10% on the brakes, and its prediction within 5 m. Off the rail the fit also takes up
+    /// the predictor's blindness to horizontal speed (see BM_ApogeePredictor_Accuracy), so only
+    /// the prediction is checked, within 10 m. The counters are the fitted scales and the
+    /// prediction errors, m.
+    static void BM_DragIdentifier_Accuracy(benchmark::State& state) {
+        auto scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        constexpr double drag_error = 1.15;
+        auto const burn_out = scenario->rocket.motor.burn_out_time();
+        auto const model = static_cast<Model>(state.range(0));
+
+        auto flown = *scenario;
+        flown.sampling_rate = 100;
+        flown.rail.inclination = model == Model::Vertical ? 90 : scenario->rail.inclination;
+        airbrake::ApogeePredictor const predictor(predictor_config(flown));
+        flown.rocket.drag_scale *= drag_error;
+
+        airbrake::DragScales fitted;
+        double tables_error = 0;
+        double fitted_error = 0;
+        for (auto _ : state) {
+            airbrake::DragIdentifier identifier;
+            float tables_prediction = 0;
+            float fitted_prediction = 0;
+            auto const result = simulate(flown, SolverConfig { .model = model },
+                [&](ControllerInput const& input) {
+                    auto const level = input.burning || input.time < burn_out + 3 ? 0.0f : 0.5f;
+                    auto const altitude = static_cast<float>(input.altitude);
+                    auto const velocity = static_cast<float>(input.vertical_velocity);
+                    if (!input.burning) {
+                        identifier.update(std::llround(input.time * 1000), velocity,
+                            static_cast<float>(-input.specific_force),
+                            predictor.regressors(altitude, velocity, level));
+                    }
+                    if (tables_prediction == 0 && input.time >= burn_out + 6) {
+                        tables_prediction = predictor.predict(altitude, velocity, level);
+                        fitted_prediction =
+                            predictor.predict(altitude, velocity, level, identifier.scales());
+                    }
+                    return level;
+                });
+            fitted = identifier.scales();
+            tables_error = tables_prediction - result.apogee;
+            fitted_error = fitted_prediction - result.apogee;
+        }
+
+        state.counters["body_scale"] = fitted.body;
+        state.counters["brake_scale"] = fitted.brakes;
+        state.counters["tables_error_m"] = tables_error;
+        state.counters["fitted_error_m"] = fitted_error;
+        auto const fit_off = std::abs(fitted.body - drag_error) > 0.02 * drag_error
+            || std::abs(fitted.brakes - 1) > 0.1;
+        if (model == Model::Vertical ? fit_off || std::abs(fitted_error) > 5
+                                     : std::abs(fitted_error) > 10) {
+            state.SkipWithError("the drag fit is off the engine's rocket");
+        }
+    }
+    BENCHMARK(BM_DragIdentifier_Accuracy)
+        ->Arg(static_cast<int>(Model::Vertical))
+        ->Arg(static_cast<int>(Model::PointMass))
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
+
+    /// The drag identifier fitting through the whole coast of a rocket whose airframe and air
+    /// brakes are off the predictor's tables by the arguments' percentages, straight up with
+    /// the true specific force at 100 Hz. The brakes stay stowed for 3 s after burnout and then
+    /// hold at 0.5. Fails unless, from 6 s after burnout until the fit stops near apogee, the
+    /// airframe scale stays within 1% of the flown rocket's and the brake scale within 2%, and
+    /// the prediction with the fit at 6 s is within 5 m. The counters are the worst relative
+    /// errors in that stretch, when after burnout the scales last strayed outside those bounds
+    /// (s), and the prediction errors at 6 s with the tables and with the fit (m).
+    static void BM_DragIdentifier_Convergence(benchmark::State& state) {
+        auto scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        constexpr double settle_s = 6;
+        constexpr double body_tolerance = 0.01;
+        constexpr double brake_tolerance = 0.02;
+        auto const body_error = static_cast<double>(state.range(0)) / 100;
+        auto const brake_error = static_cast<double>(state.range(1)) / 100;
+        auto const burn_out = scenario->rocket.motor.burn_out_time();
+
+        auto flown = *scenario;
+        flown.sampling_rate = 100;
+        flown.rail.inclination = 90;
+        airbrake::ApogeePredictor const predictor(predictor_config(flown));
+        flown.rocket.drag_scale *= body_error;
+        flown.rocket.air_brakes->reference_area *= brake_error;
+
+        double worst_body = 0;
+        double worst_brakes = 0;
+        double strayed_s = 0;
+        uint32_t settled_samples = 0;
+        double tables_error = 0;
+        double fitted_error = 0;
+        for (auto _ : state) {
+            airbrake::DragIdentifier identifier;
+            worst_body = 0;
+            worst_brakes = 0;
+            strayed_s = 0;
+            settled_samples = 0;
+            float tables_prediction = 0;
+            float fitted_prediction = 0;
+            auto const result = simulate(flown, SolverConfig { .model = Model::Vertical },
+                [&](ControllerInput const& input) {
+                    auto const level = input.burning || input.time < burn_out + 3 ? 0.0f : 0.5f;
+                    auto const altitude = static_cast<float>(input.altitude);
+                    auto const velocity = static_cast<float>(input.vertical_velocity);
+                    auto const since_s = input.time - burn_out;
+                    if (!input.burning
+                        && identifier.update(std::llround(input.time * 1000), velocity,
+                            static_cast<float>(-input.specific_force),
+                            predictor.regressors(altitude, velocity, level))) {
+                        auto const scales = identifier.scales();
+                        auto const body_off = std::abs(scales.body / body_error - 1);
+                        auto const brakes_off = std::abs(scales.brakes / brake_error - 1);
+                        if (body_off > body_tolerance || brakes_off > brake_tolerance) {
+                            strayed_s = since_s;
+                        }
+                        if (since_s >= settle_s) {
+                            worst_body = std::max(worst_body, body_off);
+                            worst_brakes = std::max(worst_brakes, brakes_off);
+                            settled_samples++;
+                        }
+                    }
+                    if (tables_prediction == 0 && since_s >= settle_s) {
+                        tables_prediction = predictor.predict(altitude, velocity, level);
+                        fitted_prediction =
+                            predictor.predict(altitude, velocity, level, identifier.scales());
+                    }
+                    return level;
+                });
+            tables_error = tables_prediction - result.apogee;
+            fitted_error = fitted_prediction - result.apogee;
+        }
+
+        state.counters["worst_body_error_pct"] = worst_body * 100;
+        state.counters["worst_brake_error_pct"] = worst_brakes * 100;
+        state.counters["last_strayed_s"] = strayed_s;
+        state.counters["tables_error_m"] = tables_error;
+        state.counters["fitted_error_m"] = fitted_error;
+        if (settled_samples == 0) {
+            state.SkipWithError("the drag fit stopped before it was checked");
+        } else if (worst_body > body_tolerance || worst_brakes > brake_tolerance) {
+            state.SkipWithError("the drag fit didn't converge on the flown rocket");
+        } else if (std::abs(fitted_error) > 5) {
+            state.SkipWithError("the fitted prediction is off the flown rocket's apogee");
+        }
+    }
+    BENCHMARK(BM_DragIdentifier_Convergence)
+        ->ArgNames({ "body_pct", "brakes_pct" })
+        ->Args({ 85, 100 })
+        ->Args({ 115, 100 })
+        ->Args({ 115, 130 })
+        ->Args({ 130, 75 })
+        ->Args({ 100, 140 })
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
+
+    /// Vacuum flights straight up, with a fixed mass and with propellant burning off, against the
+    /// rocket equation. Fails if any model and method misses by more than a millimetre.
+    static void BM_Vacuum_Accuracy(benchmark::State& state) {
+        double worst = 0;
+        for (auto _ : state) {
+            worst = 0;
+            for (double propellant : { 0.0, 8.0 }) {
+                auto const scenario = vacuum_flight(propellant);
+                auto const expected = vacuum_apogee(propellant);
+                for (auto model : { Model::Vertical, Model::PointMass }) {
+                    for (auto method : { Method::Rk4, Method::Rk45 }) {
+                        auto const result = simulate(scenario, SolverConfig {
+                            .model = model,
+                            .method = method,
+                            .tolerance = 1e-9,
+                        });
+                        worst = std::max(worst, std::abs(result.apogee - expected));
+                    }
+                }
+            }
+        }
+
+        state.counters["max_error_m"] = worst;
+        if (worst > 1e-3) {
+            state.SkipWithError("a vacuum flight missed the closed-form apogee");
+        }
+    }
+    BENCHMARK(BM_Vacuum_Accuracy)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+    /// The RocketPyTest rocket at the default settings against a reference with a hundred times
+    /// tighter tolerance, with and without air brakes. Fails if either integrator is off by more
+    /// than 10 cm.
+    static void BM_Convergence(benchmark::State& state) {
+        auto const& scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+
+        double rk4_error = 0;
+        double rk45_error = 0;
+        for (auto _ : state) {
+            for (bool brakes : { false, true }) {
+                auto const fly = [&](SolverConfig const& config) {
+                    return brakes
+                        ? simulate(*scenario, config, RocketPyExampleController(scenario->sampling_rate))
+                        : simulate(*scenario, config);
+                };
+                auto const reference = fly(SolverConfig { .tolerance = 1e-9 });
+                rk4_error = std::max(rk4_error,
+                    std::abs(fly(SolverConfig { .method = Method::Rk4 }).apogee - reference.apogee));
+                rk45_error = std::max(rk45_error,
+                    std::abs(fly(SolverConfig {}).apogee - reference.apogee));
+            }
+        }
+
+        state.counters["rk4_error_m"] = rk4_error;
+        state.counters["rk45_error_m"] = rk45_error;
+        if (rk4_error > 0.1 || rk45_error > 0.1) {
+            state.SkipWithError("an integrator hasn't converged on the reference apogee");
+        }
+    }
+    BENCHMARK(BM_Convergence)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+    /// A dispersion study of the RocketPyTest rocket on `state.range(0)` threads, the same as
+    /// dispersions.txt. Fails unless every run matches the same run flown on its own, so the
+    /// results can't depend on how the pool shared out the work.
+    static void BM_MonteCarlo(benchmark::State& state) {
+        auto const& scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        auto const dispersions = dispersed();
+        StudyConfig const config { .runs = 256, .seed = 7 };
+
+        ThreadPool pool(static_cast<size_t>(state.range(0)));
+        std::vector<RunResult> results;
+        for (auto _ : state) {
+            results = run_study(*scenario, dispersions, config, {}, pool);
+            benchmark::DoNotOptimize(results.data());
+        }
+
+        double sum = 0;
+        double squares = 0;
+        for (size_t run = 0; run < results.size(); run++) {
+            auto const alone = simulate(apply(*scenario, draw(dispersions, *scenario, 7, run)),
+                SolverConfig {});
+            if (!results[run].flight.reached_apogee || results[run].flight.apogee != alone.apogee) {
+                state.SkipWithError("a run's result depended on the thread pool");
+                return;
+            }
+            sum += alone.apogee;
+            squares += alone.apogee * alone.apogee;
+        }
+        auto const mean = sum / config.runs;
+        state.SetItemsProcessed(state.iterations() * config.runs);
+        state.counters["apogee_mean_m"] = mean;
+        state.counters["apogee_sd_m"] = std::sqrt(squares / config.runs - mean * mean);
+        state.counters["steals"] = static_cast<double>(pool.steals());
+    }
+    BENCHMARK(BM_MonteCarlo)->Arg(1)->Arg(2)->Arg(4)
+        ->Arg(std::max(1u, std::thread::hardware_concurrency()))->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+
+    /// The same study on one thread, `state.range(0)` flights at a time with BatchSimulator.
+    /// Fails if any apogee is more than 25 cm from the same run flown on its own, which is about
+    /// what two step sequences at the default tolerance differ by. Reports how many times faster
+    /// than flying each run on its own it is.
+    static void BM_Batch(benchmark::State& state) {
+        auto const& scenario = calisto();
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        auto const dispersions = dispersed();
+        StudyConfig config { .runs = 256, .seed = 7 };
+        ThreadPool pool(1);
+
+        auto const alone_start = std::chrono::steady_clock::now();
+        auto const alone = run_study(*scenario, dispersions, config, {}, pool);
+        auto const alone_time = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - alone_start).count();
+
+        config.batch = static_cast<size_t>(state.range(0));
+        std::vector<RunResult> results;
+        auto const start = std::chrono::steady_clock::now();
+        for (auto _ : state) {
+            results = run_study(*scenario, dispersions, config, {}, pool);
+            benchmark::DoNotOptimize(results.data());
+        }
+        auto const time = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        double worst = 0;
+        for (size_t run = 0; run < results.size(); run++) {
+            if (!results[run].flight.reached_apogee) {
+                state.SkipWithError("a batched run never reached apogee");
+                return;
+            }
+            worst = std::max(worst, std::abs(results[run].flight.apogee - alone[run].flight.apogee));
+        }
+        if (worst > 0.25) {
+            state.SkipWithError("batched apogees disagree with flying each run on its own");
+            return;
+        }
+        state.SetItemsProcessed(state.iterations() * config.runs);
+        state.counters["apogee_error_m"] = worst;
+        state.counters["speedup"] = alone_time * static_cast<double>(state.iterations()) / time;
+    }
+    BENCHMARK(BM_Batch)->Arg(8)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
@@ -0,0 +1,138 @@
+"""
+Flies the rocket from AirbreaksDataTest.py in RocketPy and in the C++ engine
+(simulate), with the air brakes stowed and with the example controller, and
+prints the two apogees side by side.
+
+The C++ engine is a point mass, so expect it within a few metres of RocketPy
+rather than exactly on it.
+
+Needs RocketPy installed and simulate built:
+
+    cmake -S . -B build && cmake --build build
+    python compare_rocketpy.py [path/to/simulate]
+"""
+import os
+import re
+import subprocess
+import sys
+
+from rocketpy import Environment, SolidMotor, Rocket, Flight
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DATA = os.path.join(HERE, "..", "RocketPyTest")
+SIMULATE = sys.argv[1] if len(sys.argv) > 1 else os.path.join(HERE, "build", "simulate")
+
+
+def data(name):
+    return os.path.join(DATA, name)
+
+
+def rocketpy_apogee(with_brakes):
+    """The same setup as AirbreaksDataTest.py, with the files found from here."""
+    env = Environment(latitude=32.990254, longitude=-106.974998, elevation=1400)
+    motor = SolidMotor(
+        thrust_source=data("Cesaroni_12066N2200-P.eng"),
+        dry_mass=1.815,
+        dry_inertia=(0.125, 0.125, 0.002),
+        nozzle_radius=33 / 1000,
+        grain_number=5,
+        grain_density=1815,
+        grain_outer_radius=33 / 1000,
+        grain_initial_inner_radius=15 / 1000,
+        grain_initial_height=120 / 1000,
+        grain_separation=5 / 1000,
+        grains_center_of_mass_position=0.397,
+        center_of_dry_mass_position=0.317,
+        nozzle_position=0,
+        burn_time=3.9,
+        throat_radius=11 / 1000,
+        coordinate_system_orientation="nozzle_to_combustion_chamber",
+    )
+    calisto = Rocket(
+        radius=127 / 2000,
+        mass=14.426,
+        inertia=(6.321, 6.321, 0.034),
+        power_off_drag=data("powerOffDragCurve.csv"),
+        power_on_drag=data("powerOnDragCurve.csv"),
+        center_of_mass_without_motor=0,
+        coordinate_system_orientation="tail_to_nose",
+    )
+    calisto.set_rail_buttons(
+        upper_button_position=0.0818, lower_button_position=-0.618, angular_position=45
+    )
+    calisto.add_motor(motor, position=-1.255)
+    calisto.add_nose(length=0.55829, kind="vonKarman", position=1.278)
+    calisto.add_trapezoidal_fins(
+        n=4,
+        root_chord=0.120,
+        tip_chord=0.060,
+        span=0.110,
+        position=-1.04956,
+        cant_angle=0.5,
+        airfoil=(data("NACA0012-radians.txt.txt"), "radians"),
+    )
+    calisto.add_tail(top_radius=0.0635, bottom_radius=0.0435, length=0.060, position=-1.194656)
+
+    def controller_function(
+        time, sampling_rate, state, state_history, observed_variables, air_brakes
+    ):
+        # The controller from AirbreaksDataTest.py, without the values it only records
+        altitude_agl = state[2] - env.elevation
+        vz = state[5]
+        previous_vz = state_history[-1][5]
+        if time < motor.burn_out_time:
+            return None
+        if altitude_agl < 1500:
+            air_brakes.deployment_level = 0
+        else:
+            new_deployment_level = (
+                air_brakes.deployment_level + 0.1 * vz + 0.01 * previous_vz**2
+            )
+            max_change = 0.2 / sampling_rate
+            new_deployment_level = min(
+                max(new_deployment_level, air_brakes.deployment_level - max_change),
+                air_brakes.deployment_level + max_change,
+            )
+            air_brakes.deployment_level = new_deployment_level
+        return None
+
+    if with_brakes:
+        calisto.add_air_brakes(
+            drag_coefficient_curve=data("air_brakes_cd.csv"),
+            controller_function=controller_function,
+            sampling_rate=10,
+            reference_area=None,
+            clamp=True,
+            override_rocket_drag=False,
+            name="Air Brakes",
+        )
+
+    flight = Flight(
+        rocket=calisto,
+        environment=env,
+        rail_length=5.2,
+        inclination=85,
+        heading=0,
+        time_overshoot=False,
+        terminate_on_apogee=True,
+    )
+    return flight.apogee - env.elevation
+
+
+def engine_apogee(with_brakes, model):
+    output = subprocess.run(
+        [SIMULATE, "--data", DATA, "--model", model, "--tolerance", "1e-9",
+         "--brakes", "example" if with_brakes else "off"],
+        check=True, capture_output=True, text=True,
+    ).stdout
+    return float(re.search(r"apogee\s+([0-9.]+) m", output).group(1))
+
+
+for with_brakes in (False, True):
+    expected = rocketpy_apogee(with_brakes)
+    print("air brakes " + ("example" if with_brakes else "stowed"))
+    print("  rocketpy       %.2f m" % expected)
+    for model in ("point-mass", "vertical"):
+        apogee = engine_apogee(with_brakes, model)
+        print("  %-14s %.2f m (%+.2f m, %+.2f%%)"
+              % (model, apogee, apogee - expected, 100 * (apogee - expected) / expected))
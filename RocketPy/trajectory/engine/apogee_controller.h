@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+#include <memory>
+
+#include "airbrake/apogee_controller.h"
+#include "airbrake/apogee_predictor.h"
+#include "engine/flight.h"
+
+namespace seds::trajectory {
+    /// The apogee predictor the air brake computer would carry for `scenario`'s rocket: its mass
+    /// after burnout, its reference areas and drag scale, and the gravity and pad elevation of
+    /// the launch site.
+    [[nodiscard]]
+    inline airbrake::PredictorConfig predictor_config(Scenario const& scenario) {
+        auto const& rocket = scenario.rocket;
+        auto const area = rocket.area();
+        auto const brake_area =
+            rocket.air_brakes.has_value() ? rocket.air_brakes->reference_area : area;
+        // Gravity at about the middle of the coast
+        constexpr double coast_altitude = 2500;
+        return {
+            .mass = static_cast<float>(rocket.mass_at(rocket.motor.burn_out_time())),
+            .area = static_cast<float>(area),
+            .brake_area = static_cast<float>(brake_area),
+            .drag_scale = static_cast<float>(rocket.drag_scale),
+            .pad_elevation = static_cast<float>(scenario.atmosphere.elevation),
+            .gravity = static_cast<float>(scenario.atmosphere.gravity(coast_altitude)),
+        };
+    }
+
+    /// The air brake computer's airbrake::ApogeeController, flying in the engine. It sees the
+    /// true state instead of the flight computer's estimate, with the vertical acceleration
+    /// taken from the change in velocity since the last sample, much as the estimator's would
+    /// lag the accelerometers. Run it at the air brake computer's rate by setting the scenario's
+    /// `sampling_rate`.
+    ///
+    /// Given a predictor it steers by airbrake::ApogeePredictor, and by the controller's closed
+    /// form otherwise. Copies share the predictor, which never changes, so one built per study
+    /// serves every flight.
+    class ApogeeTargetController {
+    public:
+        explicit ApogeeTargetController(airbrake::ControllerConfig const& config)
+            : controller(config) {}
+
+        ApogeeTargetController(airbrake::ControllerConfig const& config,
+            std::shared_ptr<airbrake::ApogeePredictor const> predictor)
+            : predictor(std::move(predictor)), controller(config, *this->predictor) {}
+
+        double operator()(ControllerInput const& input) {
+            estimation::Estimate estimate;
+            estimate.time_ms = std::llround(input.time * 1000);
+            estimate.altitude = static_cast<float>(input.altitude);
+            estimate.velocity = static_cast<float>(input.vertical_velocity);
+            estimate.acceleration = this->previous_time >= 0 && input.time > this->previous_time
+                ? static_cast<float>((input.vertical_velocity - this->previous_velocity)
+                    / (input.time - this->previous_time))
+                : -estimation::GRAVITY;
+            this->previous_time = input.time;
+            this->previous_velocity = input.vertical_velocity;
+            return this->controller.update(estimate, !input.burning);
+        }
+
+    private:
+        std::shared_ptr<airbrake::ApogeePredictor const> predictor;
+        airbrake::ApogeeController controller;
+        double previous_time = -1;
+        double previous_velocity = 0;
+    };
+}
@@ -0,0 +1,119 @@
+#include "engine/atmosphere.h"
+
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace seds::trajectory {
+
+namespace {
+    constexpr double GAS_CONSTANT = 287.05287;
+    constexpr double HEAT_RATIO = 1.4;
+    constexpr double STANDARD_GRAVITY = 9.80665;
+
+    /// A layer of the standard atmosphere, from its base up to the next one's.
+    struct Layer {
+        /// m above sea level
+        double base;
+        /// K/m
+        double lapse_rate;
+        /// At the base, K
+        double temperature;
+    };
+
+    /// The layers up to 47 km.
+    constexpr std::array<Layer, 4> LAYERS = [] {
+        std::array<Layer, 4> layers {{
+            { 0, -0.0065, 288.15 },
+            { 11000, 0, 0 },
+            { 20000, 0.001, 0 },
+            { 32000, 0.0028, 0 },
+        }};
+        for (size_t i = 1; i < layers.size(); i++) {
+            auto const& below = layers[i - 1];
+            layers[i].temperature =
+                below.temperature + below.lapse_rate * (layers[i].base - below.base);
+        }
+        return layers;
+    }();
+
+    constexpr double SEA_LEVEL_PRESSURE = 101325;
+
+    double pressure_in(Layer const& layer, double base_pressure, double height) {
+        constexpr double exponent_scale = STANDARD_GRAVITY / GAS_CONSTANT;
+        if (layer.lapse_rate == 0) {
+            return base_pressure * std::exp(-exponent_scale * height / layer.temperature);
+        }
+        auto const temperature = layer.temperature + layer.lapse_rate * height;
+        return base_pressure
+            * std::pow(temperature / layer.temperature, -exponent_scale / layer.lapse_rate);
+    }
+
+    /// Pressure at each layer's base.
+    std::array<double, LAYERS.size()> const& base_pressures() {
+        static auto const pressures = [] {
+            std::array<double, LAYERS.size()> pressures { SEA_LEVEL_PRESSURE };
+            for (size_t i = 1; i < LAYERS.size(); i++) {
+                pressures[i] = pressure_in(LAYERS[i - 1], pressures[i - 1],
+                    LAYERS[i].base - LAYERS[i - 1].base);
+            }
+            return pressures;
+        }();
+        return pressures;
+    }
+}
+
+Air Atmosphere::air(double altitude) const {
+    if (this->vacuum) {
+        return Air {
+            .density = 0,
+            .speed_of_sound = 340.294,
+            .pressure = 0,
+            .temperature = 288.15,
+        };
+    }
+
+    // Geometric height is used as geopotential height, which is within 0.2% below 10 km
+    auto const height = this->elevation + altitude;
+    size_t i = 0;
+    while (i + 1 < LAYERS.size() && height >= LAYERS[i + 1].base) {
+        i++;
+    }
+    auto const& layer = LAYERS[i];
+    auto const above_base = height - layer.base;
+    auto const temperature = layer.temperature + layer.lapse_rate * above_base;
+    auto const pressure = pressure_in(layer, base_pressures()[i], above_base);
+    return Air {
+        .density = pressure / (GAS_CONSTANT * temperature),
+        .speed_of_sound = std::sqrt(HEAT_RATIO * GAS_CONSTANT * temperature),
+        .pressure = pressure,
+        .temperature = temperature,
+    };
+}
+
+double Atmosphere::gravity(double altitude) const {
+    if (this->constant_gravity.has_value()) {
+        return *this->constant_gravity;
+    }
+
+    // Somigliana's formula for the WGS 84 ellipsoid with its free-air height correction, as in
+    // RocketPy's Environment
+    constexpr double semi_major_axis = 6378137.0;
+    constexpr double flattening = 1 / 298.257223563;
+    constexpr double rotation_ratio = 3.449786506841e-3;
+    constexpr double equatorial_gravity = 9.7803253359;
+    constexpr double somigliana_k = 1.931852652458e-3;
+    constexpr double eccentricity_squared = 6.694379990141e-3;
+
+    auto const sin_squared = std::pow(std::sin(this->latitude * std::numbers::pi / 180), 2);
+    auto const sea_level = equatorial_gravity * (1 + somigliana_k * sin_squared)
+        / std::sqrt(1 - eccentricity_squared * sin_squared);
+    auto const height = this->elevation + altitude;
+    auto const correction = 1
+        - 2 / semi_major_axis * (1 + flattening + rotation_ratio - 2 * flattening * sin_squared)
+            * height
+        + 3 * height * height / (semi_major_axis * semi_major_axis);
+    return sea_level * correction;
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+#include <optional>
+
+namespace seds::trajectory {
+    /// The air at some altitude.
+    struct Air {
+        /// kg/m³
+        double density;
+        /// m/s
+        double speed_of_sound;
+        /// Pa
+        double pressure;
+        /// K
+        double temperature;
+    };
+
+    /// The launch site: the International Standard Atmosphere and the gravity there, the way
+    /// RocketPy's `Environment` models them when it's given no weather, and a steady wind.
+    struct Atmosphere {
+        /// Height of the pad above sea level, m.
+        double elevation = 0;
+        /// Latitude of the pad, degrees, which sets gravity.
+        double latitude = 0;
+        /// Use this gravity (m/s²) at every altitude instead of the WGS 84 model.
+        std::optional<double> constant_gravity = {};
+        /// No air at all, for checking trajectories against closed-form ones.
+        bool vacuum = false;
+        /// Velocity of the air east and north, m/s, the same at every altitude.
+        std::array<double, 2> wind = {};
+
+        /// The air at `altitude` above the pad, m.
+        [[nodiscard]]
+        Air air(double altitude) const;
+
+        /// Gravitational acceleration at `altitude` above the pad, m/s².
+        [[nodiscard]]
+        double gravity(double altitude) const;
+    };
+}
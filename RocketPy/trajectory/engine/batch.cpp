@@ -0,0 +1,553 @@
+#include "engine/batch.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+#include "engine/integrator.h"
+
+namespace seds::trajectory {
+
+namespace {
+    /// Breakpoints closer than this to the end of a step are taken as reached, s.
+    constexpr double TIME_EPSILON = 1e-9;
+    constexpr double DEGREES = std::numbers::pi / 180;
+
+    /// How high above the pad the atmosphere tables go, and how finely, m.
+    constexpr double ATMOSPHERE_HEIGHT = 40000;
+    constexpr double ATMOSPHERE_SPACING = 25;
+    /// Drag curves are resampled this finely in Mach number, which keeps RocketPy's 0.1 steps
+    /// exact.
+    constexpr double MACH_SPACING = 0.01;
+    /// The thrust curve and motor mass are resampled this finely, s, which keeps the times of a
+    /// RASP file exact.
+    constexpr double MOTOR_SPACING = 0.001;
+
+    /// Dormand-Prince fifth- minus fourth-order weights, for the error estimate.
+    constexpr std::array<double, 7> ERROR_WEIGHTS = { 71.0 / 57600, 0, -71.0 / 16695,
+        71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40 };
+
+    /// Position east, north and up from the pad, then velocity.
+    enum Component { X, Y, Z, VX, VY, VZ, COMPONENTS };
+
+    /// One column per component, one row per flight.
+    using Columns = std::array<std::vector<double>, COMPONENTS>;
+
+    Columns columns(size_t flights) {
+        Columns result;
+        for (auto& column : result) {
+            column.assign(flights, 0);
+        }
+        return result;
+    }
+
+    /// out = y + step (sum of weights[j] k[j]), where each flight has its own step.
+    template<size_t K>
+    void combine(Columns& out, Columns const& y, std::vector<double> const& step,
+        std::array<double, K> const& weights, std::array<Columns const*, K> const& k)
+    {
+        auto const flights = step.size();
+        auto const* __restrict__ h = step.data();
+        for (size_t c = 0; c < COMPONENTS; c++) {
+            std::array<double const*, K> slopes;
+            for (size_t j = 0; j < K; j++) {
+                slopes[j] = (*k[j])[c].data();
+            }
+            auto* __restrict__ result = out[c].data();
+            auto const* __restrict__ start = y[c].data();
+            for (size_t i = 0; i < flights; i++) {
+                double sum = 0;
+                for (size_t j = 0; j < K; j++) {
+                    sum += weights[j] * slopes[j][i];
+                }
+                result[i] = start[i] + h[i] * sum;
+            }
+        }
+    }
+
+    /// out = condition ? a : b, flight by flight, in every column.
+    void select(Columns& out, std::vector<double> const& condition, Columns const& a,
+        Columns const& b)
+    {
+        auto const* __restrict__ mask = condition.data();
+        for (size_t c = 0; c < COMPONENTS; c++) {
+            auto* __restrict__ result = out[c].data();
+            auto const* __restrict__ first = a[c].data();
+            auto const* __restrict__ second = b[c].data();
+            for (size_t i = 0; i < condition.size(); i++) {
+                result[i] = mask[i] != 0 ? first[i] : second[i];
+            }
+        }
+    }
+}
+
+namespace batch_detail {
+    /// The flights of one BatchSimulator::fly call, and the equations of motion for all of
+    /// them at once.
+    struct Batch {
+        BatchSimulator const& model;
+        size_t flights;
+
+        // From the draws
+        std::vector<double> thrust_scale;
+        std::vector<double> mass;
+        /// Drag scale times the rocket's area, m².
+        std::vector<double> drag_area;
+        std::vector<double> wind_east;
+        std::vector<double> wind_north;
+        /// Unit vector along the rail.
+        std::array<std::vector<double>, 3> rail;
+
+        // What holds for the whole of each flight's current step, as in `simulate`. The flags
+        // are 0 or 1, to multiply by.
+        std::vector<double> deployment;
+        std::vector<double> burning;
+        std::vector<double> on_rail;
+        std::vector<double> active;
+        /// Whether any flight has its air brakes out.
+        bool deployed = false;
+
+        // Found by the last evaluation, for the states it was given
+        std::vector<double> airspeed;
+        std::vector<double> mach;
+        std::vector<double> density;
+        std::vector<double> gravity;
+        std::vector<double> brake_cd;
+        std::vector<double> weight_sum;
+        /// What an accelerometer along each rocket reads, as ControllerInput has it.
+        std::vector<double> specific_force;
+        uint32_t evaluations = 0;
+
+        Batch(BatchSimulator const& model, std::span<Draw const> draws)
+            : model(model), flights(draws.size())
+        {
+            auto const& rocket = model.nominal.rocket;
+            for (auto* column : { &this->thrust_scale, &this->mass, &this->drag_area,
+                     &this->wind_east, &this->wind_north, &this->rail[0], &this->rail[1],
+                     &this->rail[2], &this->deployment, &this->burning, &this->on_rail,
+                     &this->active, &this->airspeed, &this->mach, &this->density,
+                     &this->gravity, &this->brake_cd, &this->weight_sum,
+                     &this->specific_force }) {
+                column->assign(this->flights, 0);
+            }
+            for (size_t i = 0; i < this->flights; i++) {
+                // The same as `apply`, but into columns
+                auto const& draw = draws[i];
+                this->thrust_scale[i] = draw.impulse;
+                this->mass[i] = draw.mass;
+                this->drag_area[i] = rocket.drag_scale * draw.drag * rocket.area();
+                this->wind_east[i] = -draw.wind_speed * std::sin(draw.wind_from * DEGREES);
+                this->wind_north[i] = -draw.wind_speed * std::cos(draw.wind_from * DEGREES);
+                auto const elevation = draw.inclination * DEGREES;
+                auto const heading = draw.heading * DEGREES;
+                this->rail[0][i] = std::cos(elevation) * std::sin(heading);
+                this->rail[1][i] = std::cos(elevation) * std::cos(heading);
+                this->rail[2][i] = std::sin(elevation);
+                this->burning[i] = 1;
+                this->on_rail[i] = 1;
+                this->active[i] = 1;
+            }
+        }
+
+        /// The air, at every flight's altitude.
+        void find_air(Columns const& y) {
+            auto const* __restrict__ vx = y[VX].data();
+            auto const* __restrict__ vy = y[VY].data();
+            auto const* __restrict__ vz = y[VZ].data();
+            auto const* __restrict__ z = y[Z].data();
+            auto const* __restrict__ wind_east = this->wind_east.data();
+            auto const* __restrict__ wind_north = this->wind_north.data();
+            auto* __restrict__ airspeed = this->airspeed.data();
+            auto* __restrict__ mach = this->mach.data();
+            auto* __restrict__ density = this->density.data();
+            auto* __restrict__ gravity = this->gravity.data();
+            auto const density_table = this->model.density.view();
+            auto const sound_table = this->model.speed_of_sound.view();
+            auto const gravity_table = this->model.gravity.view();
+
+            // The tables' gathers keep GCC from proving the columns apart on its own, here and in
+            // `derivative`
+            #pragma GCC ivdep
+            for (size_t i = 0; i < this->flights; i++) {
+                auto const ax = vx[i] - wind_east[i];
+                auto const ay = vy[i] - wind_north[i];
+                auto const speed = std::sqrt(ax * ax + ay * ay + vz[i] * vz[i]);
+                airspeed[i] = speed;
+                mach[i] = speed / sound_table(z[i]);
+                density[i] = density_table(z[i]);
+                gravity[i] = gravity_table(z[i]);
+            }
+        }
+
+        /// The air brakes' drag coefficients, by Shepard interpolation like ScatteredTable but
+        /// with the flights as the inner loop. An exact hit on a point gets a weight so large
+        /// the rest don't count, rather than a branch.
+        void find_brake_drag() {
+            auto* __restrict__ brake_cd = this->brake_cd.data();
+            if (!this->deployed) {
+                std::fill(this->brake_cd.begin(), this->brake_cd.end(), 0);
+                return;
+            }
+
+            auto const* __restrict__ deployment = this->deployment.data();
+            auto const* __restrict__ mach = this->mach.data();
+            auto* __restrict__ weight_sum = this->weight_sum.data();
+            for (size_t i = 0; i < this->flights; i++) {
+                brake_cd[i] = 0;
+                weight_sum[i] = 0;
+            }
+            for (auto const& [px, py, pz] :
+                this->model.nominal.rocket.air_brakes->drag_coefficient.points()) {
+                for (size_t i = 0; i < this->flights; i++) {
+                    auto const dx = px - deployment[i];
+                    auto const dy = py - mach[i];
+                    auto const distance_squared = std::max(dx * dx + dy * dy, 1e-100);
+                    auto const weight = 1 / (distance_squared * std::sqrt(distance_squared));
+                    brake_cd[i] += weight * pz;
+                    weight_sum[i] += weight;
+                }
+            }
+            for (size_t i = 0; i < this->flights; i++) {
+                brake_cd[i] = deployment[i] > 0 ? brake_cd[i] / weight_sum[i] : 0;
+            }
+        }
+
+        /// The derivative of every flight's state at its own time. Flights that have stopped
+        /// get zero.
+        void derivative(std::vector<double> const& times, Columns const& y, Columns& slope) {
+            this->evaluations++;
+            this->find_air(y);
+            this->find_brake_drag();
+
+            auto const& air_brakes = this->model.nominal.rocket.air_brakes;
+            auto const brake_area = air_brakes.has_value() ? air_brakes->reference_area : 0;
+            auto const thrust_table = this->model.thrust.view();
+            auto const motor_mass_table = this->model.motor_mass.view();
+            auto const power_on_drag = this->model.power_on_drag.view();
+            auto const power_off_drag = this->model.power_off_drag.view();
+
+            auto const* __restrict__ time = times.data();
+            auto const* __restrict__ vx = y[VX].data();
+            auto const* __restrict__ vy = y[VY].data();
+            auto const* __restrict__ vz = y[VZ].data();
+            auto const* __restrict__ wind_east = this->wind_east.data();
+            auto const* __restrict__ wind_north = this->wind_north.data();
+            auto const* __restrict__ rail_x = this->rail[0].data();
+            auto const* __restrict__ rail_y = this->rail[1].data();
+            auto const* __restrict__ rail_z = this->rail[2].data();
+            auto const* __restrict__ thrust_scale = this->thrust_scale.data();
+            auto const* __restrict__ mass = this->mass.data();
+            auto const* __restrict__ drag_area = this->drag_area.data();
+            auto const* __restrict__ burning = this->burning.data();
+            auto const* __restrict__ on_rail = this->on_rail.data();
+            auto const* __restrict__ active = this->active.data();
+            auto const* __restrict__ airspeed = this->airspeed.data();
+            auto const* __restrict__ mach = this->mach.data();
+            auto const* __restrict__ density = this->density.data();
+            auto const* __restrict__ gravity = this->gravity.data();
+            auto const* __restrict__ brake_cd = this->brake_cd.data();
+            auto* __restrict__ dx = slope[X].data();
+            auto* __restrict__ dy = slope[Y].data();
+            auto* __restrict__ dz = slope[Z].data();
+            auto* __restrict__ dvx = slope[VX].data();
+            auto* __restrict__ dvy = slope[VY].data();
+            auto* __restrict__ dvz = slope[VZ].data();
+            auto* __restrict__ specific_force = this->specific_force.data();
+
+            #pragma GCC ivdep
+            for (size_t i = 0; i < this->flights; i++) {
+                auto const speed = airspeed[i];
+                auto const body_cd = burning[i] * power_on_drag(mach[i])
+                    + (1 - burning[i]) * power_off_drag(mach[i]);
+                auto const drag = (body_cd * drag_area[i] + brake_cd[i] * brake_area)
+                    * 0.5 * density[i] * speed * speed;
+                auto const thrust = burning[i] * thrust_scale[i] * thrust_table(time[i]);
+                auto const axial = (thrust - drag) / (mass[i] + motor_mass_table(time[i]));
+                auto const g = gravity[i];
+
+                // On the rail, along it and never back down it. Off it, into the relative wind.
+                auto const along = std::max(0.0, axial - g * rail_z[i]);
+                auto const moving_air = speed > 0;
+                auto const per_speed = moving_air ? axial / speed : 0;
+                auto const free_x =
+                    moving_air ? per_speed * (vx[i] - wind_east[i]) : axial * rail_x[i];
+                auto const free_y =
+                    moving_air ? per_speed * (vy[i] - wind_north[i]) : axial * rail_y[i];
+                auto const free_z = (moving_air ? per_speed * vz[i] : axial * rail_z[i]) - g;
+
+                auto const rail = on_rail[i];
+                auto const moving = active[i];
+                dx[i] = moving * vx[i];
+                dy[i] = moving * vy[i];
+                dz[i] = moving * vz[i];
+                dvx[i] = moving * (rail * along * rail_x[i] + (1 - rail) * free_x);
+                dvy[i] = moving * (rail * along * rail_y[i] + (1 - rail) * free_y);
+                dvz[i] = moving * (rail * along * rail_z[i] + (1 - rail) * free_z);
+                specific_force[i] = rail * std::max(axial, g * rail_z[i]) + (1 - rail) * axial;
+            }
+        }
+
+        double along_rail(Columns const& y, size_t offset, size_t i) const {
+            return y[offset][i] * this->rail[0][i] + y[offset + 1][i] * this->rail[1][i]
+                + y[offset + 2][i] * this->rail[2][i];
+        }
+
+        static double ground_speed(Columns const& y, size_t i) {
+            return std::sqrt(y[VX][i] * y[VX][i] + y[VY][i] * y[VY][i] + y[VZ][i] * y[VZ][i]);
+        }
+    };
+}
+
+using batch_detail::Batch;
+
+BatchSimulator::BatchSimulator(Scenario const& nominal) : nominal(nominal) {
+    auto const& atmosphere = this->nominal.atmosphere;
+    this->density = UniformTable([&](double h) { return atmosphere.air(h).density; }, 0,
+        ATMOSPHERE_HEIGHT, ATMOSPHERE_SPACING);
+    this->speed_of_sound = UniformTable([&](double h) {
+        return atmosphere.air(h).speed_of_sound;
+    }, 0, ATMOSPHERE_HEIGHT, ATMOSPHERE_SPACING);
+    this->gravity = UniformTable([&](double h) { return atmosphere.gravity(h); }, 0,
+        ATMOSPHERE_HEIGHT, ATMOSPHERE_SPACING);
+
+    auto const& rocket = this->nominal.rocket;
+    auto const resample = [](LinearTable const& curve) {
+        auto const xs = curve.xs();
+        return UniformTable(curve, 0, xs.empty() ? 0 : xs.back(), MACH_SPACING);
+    };
+    this->power_on_drag = resample(rocket.power_on_drag);
+    this->power_off_drag = resample(rocket.power_off_drag);
+
+    // Thrust only counts while burning, and the mass stays put after, so both end at burnout
+    auto const& motor = rocket.motor;
+    this->thrust = UniformTable([&](double t) { return motor.thrust(t); }, 0,
+        motor.burn_out_time(), MOTOR_SPACING);
+    this->motor_mass = UniformTable([&](double t) { return motor.mass(t); }, 0,
+        motor.burn_out_time(), MOTOR_SPACING);
+}
+
+std::vector<FlightResult> BatchSimulator::fly(std::span<Draw const> draws,
+    SolverConfig const& config, ControllerFactory const& make_controller) const
+{
+    auto const flights = draws.size();
+    Batch batch(*this, draws);
+    std::vector<FlightResult> results(flights);
+
+    // A factory that makes empty controllers means stowed air brakes, as for `simulate`
+    std::vector<Controller> controllers;
+    for (size_t i = 0; make_controller && i < flights; i++) {
+        controllers.push_back(make_controller());
+        if (!controllers.back()) {
+            controllers.clear();
+            break;
+        }
+    }
+
+    auto const burn_out = this->nominal.rocket.motor.burn_out_time();
+    auto const sample_period = 1 / this->nominal.sampling_rate;
+    auto const rail_length = this->nominal.rail.length;
+    auto const has_brakes = this->nominal.rocket.air_brakes.has_value();
+    auto const clamp = has_brakes && this->nominal.rocket.air_brakes->clamp;
+
+    // Each flight's own time and steps, as `simulate` keeps them
+    std::vector<double> t(flights, 0);
+    std::vector<double> h(flights, config.step);
+    std::vector<double> step(flights, 0);
+    std::vector<double> stage_time(flights, 0);
+    // The shortened step that ends at the top of the rail, to take next, or zero
+    std::vector<double> retake(flights, 0);
+    std::vector<char> truncated(flights, 0);
+    std::vector<double> next_sample(flights, 0);
+    std::vector<uint32_t> samples(flights, 0);
+    // 1 for the flights whose step was accepted
+    std::vector<double> accepted(flights, 0);
+
+    auto y = columns(flights);
+    auto next = columns(flights);
+    auto stage = columns(flights);
+    std::array<Columns, 7> k;
+    for (auto& slope : k) {
+        slope = columns(flights);
+    }
+    auto remaining = flights;
+
+    auto const run_controller = [&](size_t i, Columns const& state) {
+        if (!controllers.empty()) {
+            auto const deployment = controllers[i](ControllerInput {
+                .time = t[i],
+                .altitude = state[Z][i],
+                .vertical_velocity = state[VZ][i],
+                .speed = Batch::ground_speed(state, i),
+                .mach = batch.mach[i],
+                .specific_force = batch.specific_force[i],
+                .deployment = batch.deployment[i],
+                .burning = batch.burning[i] != 0,
+            });
+            batch.deployment[i] = clamp ? std::clamp(deployment, 0.0, 1.0) : deployment;
+            batch.deployed = batch.deployed || (has_brakes && batch.deployment[i] > 0);
+        }
+        next_sample[i] = ++samples[i] * sample_period;
+    };
+
+    // The first evaluation finds the Mach numbers the controllers start from
+    batch.derivative(t, y, k[0]);
+    for (size_t i = 0; i < flights; i++) {
+        run_controller(i, y);
+    }
+    if (!controllers.empty()) {
+        batch.derivative(t, y, k[0]);
+    }
+
+    while (remaining > 0) {
+        // Each flight's step, landing exactly on its next discontinuity
+        for (size_t i = 0; i < flights; i++) {
+            if (batch.active[i] == 0) {
+                step[i] = 0;
+                continue;
+            }
+            if (retake[i] > 0) {
+                step[i] = retake[i];
+                continue;
+            }
+            auto next_break = !controllers.empty() ? next_sample[i] : config.max_time;
+            if (batch.burning[i] != 0) {
+                next_break = std::min(next_break, burn_out);
+            }
+            step[i] = h[i];
+            truncated[i] = false;
+            if (next_break - t[i] <= h[i] + TIME_EPSILON) {
+                truncated[i] = next_break - t[i] < h[i];
+                step[i] = next_break - t[i];
+            }
+        }
+
+        // Dormand-Prince 5(4), as `dormand_prince`, with every flight in each stage
+        auto const at = [&](double fraction) -> std::vector<double> const& {
+            for (size_t i = 0; i < flights; i++) {
+                stage_time[i] = t[i] + fraction * step[i];
+            }
+            return stage_time;
+        };
+        combine<1>(stage, y, step, { 1.0 / 5 }, { &k[0] });
+        batch.derivative(at(1.0 / 5), stage, k[1]);
+        combine<2>(stage, y, step, { 3.0 / 40, 9.0 / 40 }, { &k[0], &k[1] });
+        batch.derivative(at(3.0 / 10), stage, k[2]);
+        combine<3>(stage, y, step, { 44.0 / 45, -56.0 / 15, 32.0 / 9 }, { &k[0], &k[1], &k[2] });
+        batch.derivative(at(4.0 / 5), stage, k[3]);
+        combine<4>(stage, y, step,
+            { 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729 },
+            { &k[0], &k[1], &k[2], &k[3] });
+        batch.derivative(at(8.0 / 9), stage, k[4]);
+        combine<5>(stage, y, step,
+            { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656 },
+            { &k[0], &k[1], &k[2], &k[3], &k[4] });
+        batch.derivative(at(1), stage, k[5]);
+        combine<6>(next, y, step,
+            { 35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 },
+            { &k[0], &k[1], &k[2], &k[3], &k[4], &k[5] });
+        batch.derivative(at(1), next, k[6]);
+
+        // Then each flight decides on its own step the way `simulate` does
+        auto stale = false;
+        for (size_t i = 0; i < flights; i++) {
+            accepted[i] = 0;
+            if (batch.active[i] == 0) {
+                continue;
+            }
+            auto& result = results[i];
+            auto const length = step[i];
+
+            double error = 0;
+            for (size_t c = 0; c < COMPONENTS; c++) {
+                double difference = 0;
+                for (size_t j = 0; j < k.size(); j++) {
+                    difference += ERROR_WEIGHTS[j] * k[j][c][i];
+                }
+                auto const scale = config.tolerance
+                    * (1 + std::max(std::abs(y[c][i]), std::abs(next[c][i])));
+                error = std::max(error, std::abs(length * difference) / scale);
+            }
+
+            // The step that ends at the top of the rail is taken whatever its error
+            auto const leaves_rail = retake[i] > 0;
+            retake[i] = 0;
+            if (!leaves_rail) {
+                if (error > 1) {
+                    h[i] = length * std::max(0.2, 0.9 * std::pow(error, -0.2));
+                    result.rejected_steps++;
+                    continue;
+                }
+                if (batch.on_rail[i] != 0 && batch.along_rail(next, X, i) >= rail_length) {
+                    auto const fraction = hermite_crossing(batch.along_rail(y, X, i),
+                        batch.along_rail(y, VX, i) * length, batch.along_rail(next, X, i),
+                        batch.along_rail(k[6], X, i) * length, rail_length);
+                    retake[i] = length * fraction;
+                    continue;
+                }
+            }
+
+            // Apogee: where the vertical velocity crosses zero within the step
+            if (batch.on_rail[i] == 0 && next[VZ][i] <= 0) {
+                auto const fraction = hermite_crossing(y[VZ][i], k[0][VZ][i] * length,
+                    next[VZ][i], k[6][VZ][i] * length, 0);
+                result.reached_apogee = true;
+                result.apogee = hermite(y[Z][i], y[VZ][i] * length, next[Z][i],
+                    next[VZ][i] * length, fraction);
+                result.apogee_time = t[i] + fraction * length;
+                result.deployment = batch.deployment[i];
+                result.steps++;
+                result.evaluations = batch.evaluations;
+                batch.active[i] = 0;
+                remaining--;
+                continue;
+            }
+
+            accepted[i] = 1;
+            t[i] += length;
+            result.steps++;
+            result.max_speed = std::max(result.max_speed, Batch::ground_speed(next, i));
+            result.max_mach = std::max(result.max_mach, batch.mach[i]);
+
+            if (leaves_rail) {
+                batch.on_rail[i] = 0;
+                stale = true;
+                result.rail_exit_time = t[i];
+                result.rail_exit_speed = Batch::ground_speed(next, i);
+            }
+            if (batch.burning[i] != 0 && t[i] >= burn_out - TIME_EPSILON) {
+                batch.burning[i] = 0;
+                stale = true;
+                result.burn_out_time = t[i];
+                result.burn_out_altitude = next[Z][i];
+                result.burn_out_speed = Batch::ground_speed(next, i);
+            }
+            if (std::abs(t[i] - next_sample[i]) < TIME_EPSILON) {
+                stale = true;
+                run_controller(i, next);
+            }
+
+            // Steps cut short by a breakpoint say little about how long the next can be
+            auto const factor = 0.9 * std::pow(std::max(error, 1e-10), -0.2);
+            auto const grown = length * std::clamp(factor, 0.2, 5.0);
+            h[i] = truncated[i] || leaves_rail ? std::max(h[i], grown) : grown;
+
+            if (t[i] >= config.max_time) {
+                batch.active[i] = 0;
+                result.evaluations = batch.evaluations;
+                remaining--;
+            }
+        }
+
+        // Accepted steps move on, with the slope at their end to start the next
+        select(y, accepted, next, y);
+        select(k[0], accepted, k[6], k[0]);
+        if (stale) {
+            // The same again for every flight whose flags didn't change
+            batch.derivative(t, y, k[0]);
+        }
+    }
+    return results;
+}
+
+}
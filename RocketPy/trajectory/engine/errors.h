@@ -0,0 +1,23 @@
+#pragma once
+
+#include <expected>
+#include <string>
+
+// Exceptionless error handling for the trajectory tools, in the same shape as the flight
+// computer's errors.h. These only ever run on a desktop, so an error owns its message and can
+// say which file and line was wrong.
+
+/// Returns std::unexpected if the given std::expected value is an error.
+#define TRY(x) ({                                                                                   \
+    auto result = (x);                                                                              \
+    if (!result.has_value()) {                                                                      \
+        return std::unexpected(std::move(result).error());                                          \
+    }                                                                                               \
+    std::move(result).value();                                                                      \
+})
+
+namespace seds::trajectory {
+    /// Contains either a value or a message saying what went wrong.
+    template<typename T>
+    using Expected = std::expected<T, std::string>;
+}
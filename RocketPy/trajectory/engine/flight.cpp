@@ -0,0 +1,341 @@
+#include "engine/flight.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "engine/integrator.h"
+
+namespace seds::trajectory {
+
+namespace {
+    /// Breakpoints closer than this to the end of a step are taken as reached, s.
+    constexpr double TIME_EPSILON = 1e-9;
+
+    /// The equations of motion for `Dimensions` dimensions (1 for Model::Vertical, 3 for
+    /// Model::PointMass). The state is the position from the pad then the velocity; up is always
+    /// the last of each.
+    template<size_t Dimensions>
+    struct Dynamics {
+        static constexpr size_t N = 2 * Dimensions;
+        static constexpr size_t UP = Dimensions - 1;
+
+        Scenario const& scenario;
+        /// Unit vector along the rail.
+        std::array<double, Dimensions> rail;
+        // What holds for the whole of the current step, since no step straddles a change in
+        // these. A step that starts at burnout sees no thrust even at its first point.
+        double deployment = 0;
+        bool on_rail = true;
+        bool burning = true;
+        mutable uint32_t evaluations = 0;
+
+        explicit Dynamics(Scenario const& scenario) : scenario(scenario) {
+            if constexpr (Dimensions == 1) {
+                this->rail = { 1 };
+            } else {
+                constexpr double degrees = std::numbers::pi / 180;
+                auto const elevation = scenario.rail.inclination * degrees;
+                auto const heading = scenario.rail.heading * degrees;
+                this->rail = {
+                    std::cos(elevation) * std::sin(heading),
+                    std::cos(elevation) * std::cos(heading),
+                    std::sin(elevation),
+                };
+            }
+        }
+
+        static double speed(State<N> const& y) {
+            double squared = 0;
+            for (size_t i = 0; i < Dimensions; i++) {
+                squared += y[Dimensions + i] * y[Dimensions + i];
+            }
+            return std::sqrt(squared);
+        }
+
+        /// Velocity through the air. The vertical model has no horizontal axes for the wind to
+        /// blow along.
+        std::array<double, Dimensions> airspeed(State<N> const& y) const {
+            std::array<double, Dimensions> velocity;
+            for (size_t i = 0; i < Dimensions; i++) {
+                velocity[i] = y[Dimensions + i];
+            }
+            if constexpr (Dimensions == 3) {
+                velocity[0] -= this->scenario.atmosphere.wind[0];
+                velocity[1] -= this->scenario.atmosphere.wind[1];
+            }
+            return velocity;
+        }
+
+        static double norm(std::array<double, Dimensions> const& v) {
+            double squared = 0;
+            for (auto component : v) {
+                squared += component * component;
+            }
+            return std::sqrt(squared);
+        }
+
+        double along_rail(State<N> const& y, size_t offset = 0) const {
+            double distance = 0;
+            for (size_t i = 0; i < Dimensions; i++) {
+                distance += y[offset + i] * this->rail[i];
+            }
+            return distance;
+        }
+
+        double mach(State<N> const& y) const {
+            return norm(this->airspeed(y)) / this->scenario.atmosphere.air(y[UP]).speed_of_sound;
+        }
+
+        /// Thrust less drag over the mass, m/s², along the rocket.
+        double axial(double time, Air const& air, double speed) const {
+            auto const& rocket = this->scenario.rocket;
+            auto const mach = speed / air.speed_of_sound;
+
+            // Drag from the airframe, then from the air brakes against their own area
+            auto const body_cd =
+                this->burning ? rocket.power_on_drag(mach) : rocket.power_off_drag(mach);
+            auto drag = rocket.drag_scale * body_cd * rocket.area();
+            if (rocket.air_brakes.has_value()) {
+                drag += rocket.air_brake_drag_coefficient(this->deployment, mach)
+                    * rocket.air_brakes->reference_area;
+            }
+            drag *= 0.5 * air.density * speed * speed;
+
+            auto const thrust = this->burning ? rocket.motor.thrust(time) : 0;
+            return (thrust - drag) / rocket.mass_at(time);
+        }
+
+        /// What an accelerometer along the rocket reads, m/s²: thrust less drag over the mass,
+        /// or while the rail still holds the rocket up, its share of gravity.
+        double specific_force(double time, State<N> const& y) const {
+            auto const air = this->scenario.atmosphere.air(y[UP]);
+            auto const axial = this->axial(time, air, norm(this->airspeed(y)));
+            if (this->on_rail) {
+                auto const gravity = this->scenario.atmosphere.gravity(y[UP]);
+                return std::max(axial, gravity * this->rail[UP]);
+            }
+            return axial;
+        }
+
+        State<N> operator()(double time, State<N> const& y) const {
+            this->evaluations++;
+            auto const air = this->scenario.atmosphere.air(y[UP]);
+            auto const airspeed = this->airspeed(y);
+            auto const speed = norm(airspeed);
+            auto const axial = this->axial(time, air, speed);
+            auto const gravity = this->scenario.atmosphere.gravity(y[UP]);
+
+            State<N> slope;
+            for (size_t i = 0; i < Dimensions; i++) {
+                slope[i] = y[Dimensions + i];
+            }
+            if (this->on_rail) {
+                // The rail takes everything across it, and holds the rocket until thrust beats
+                // weight
+                auto const along = std::max(0.0, axial - gravity * this->rail[UP]);
+                for (size_t i = 0; i < Dimensions; i++) {
+                    slope[Dimensions + i] = along * this->rail[i];
+                }
+            } else {
+                // Pointing into the relative wind, so thrust and drag both act along it
+                for (size_t i = 0; i < Dimensions; i++) {
+                    auto const direction = speed > 0 ? airspeed[i] / speed : this->rail[i];
+                    slope[Dimensions + i] = axial * direction;
+                }
+                slope[N - 1] -= gravity;
+            }
+            return slope;
+        }
+    };
+
+    template<size_t Dimensions>
+    TrajectoryPoint point(Dynamics<Dimensions> const& f, double time,
+        State<2 * Dimensions> const& y)
+    {
+        TrajectoryPoint point {
+            .time = time,
+            .position = {},
+            .velocity = {},
+            .mach = f.mach(y),
+            .deployment = f.deployment,
+        };
+        // Fill up from the last axis, so the vertical model's one axis is up
+        for (size_t i = 0; i < Dimensions; i++) {
+            point.position[3 - Dimensions + i] = y[i];
+            point.velocity[3 - Dimensions + i] = y[Dimensions + i];
+        }
+        return point;
+    }
+
+    template<size_t Dimensions>
+    FlightResult fly(Scenario const& scenario, SolverConfig const& config,
+        Controller const& controller, Observer const& observer)
+    {
+        using Dyn = Dynamics<Dimensions>;
+        constexpr size_t N = Dyn::N;
+        constexpr size_t UP = Dyn::UP;
+
+        Dyn f(scenario);
+        FlightResult result;
+        auto const burn_out = scenario.rocket.motor.burn_out_time();
+        auto const sample_period = 1 / scenario.sampling_rate;
+        auto const clamp = scenario.rocket.air_brakes.has_value()
+            && scenario.rocket.air_brakes->clamp;
+
+        double t = 0;
+        State<N> y {};
+        std::optional<State<N>> slope;
+        uint32_t samples = 0;
+        double next_sample = 0;
+        double h = config.step;
+
+        auto const run_controller = [&] {
+            if (controller) {
+                auto deployment = controller(ControllerInput {
+                    .time = t,
+                    .altitude = y[UP],
+                    .vertical_velocity = y[N - 1],
+                    .speed = Dyn::speed(y),
+                    .mach = f.mach(y),
+                    .specific_force = f.specific_force(t, y),
+                    .deployment = f.deployment,
+                    .burning = f.burning,
+                });
+                f.deployment = clamp ? std::clamp(deployment, 0.0, 1.0) : deployment;
+            }
+            next_sample = ++samples * sample_period;
+        };
+
+        run_controller();
+        if (observer) {
+            observer(point(f, t, y));
+        }
+
+        while (t < config.max_time) {
+            if (!slope.has_value()) {
+                slope = f(t, y);
+            }
+
+            // Land exactly on the next discontinuity, so no step straddles one. Without a
+            // controller, the sampling times change nothing.
+            auto next_break = controller ? next_sample : config.max_time;
+            if (f.burning) {
+                next_break = std::min(next_break, burn_out);
+            }
+            auto step = h;
+            auto truncated = false;
+            if (next_break - t <= h + TIME_EPSILON) {
+                truncated = next_break - t < h;
+                step = next_break - t;
+            }
+
+            auto const take = [&](double length) {
+                return config.method == Method::Rk4
+                    ? rk4<N>(f, t, y, length, *slope)
+                    : dormand_prince<N>(f, t, y, length, *slope, config.tolerance);
+            };
+            auto next = take(step);
+            if (next.error > 1) {
+                h = step * std::max(0.2, 0.9 * std::pow(next.error, -0.2));
+                result.rejected_steps++;
+                continue;
+            }
+
+            // Leaving the rail: shorten the step to end at the top of it
+            auto leaves_rail = false;
+            if (f.on_rail && f.along_rail(next.y) >= scenario.rail.length) {
+                auto const end_slope = next.end_slope.value_or(f(t + step, next.y));
+                auto const fraction = hermite_crossing(f.along_rail(y),
+                    f.along_rail(y, Dimensions) * step, f.along_rail(next.y),
+                    f.along_rail(end_slope, 0) * step, scenario.rail.length);
+                step *= fraction;
+                next = take(step);
+                leaves_rail = true;
+            }
+
+            // Apogee: where the vertical velocity crosses zero within the step
+            if (!f.on_rail && next.y[N - 1] <= 0) {
+                auto const end_slope = next.end_slope.value_or(f(t + step, next.y));
+                auto const fraction = hermite_crossing(y[N - 1], (*slope)[N - 1] * step,
+                    next.y[N - 1], end_slope[N - 1] * step, 0);
+                result.reached_apogee = true;
+                result.apogee = hermite(y[UP], y[N - 1] * step, next.y[UP],
+                    next.y[N - 1] * step, fraction);
+                result.apogee_time = t + fraction * step;
+                result.deployment = f.deployment;
+                result.steps++;
+                break;
+            }
+
+            t += step;
+            y = next.y;
+            slope = next.end_slope;
+            result.steps++;
+            result.max_speed = std::max(result.max_speed, Dyn::speed(y));
+            result.max_mach = std::max(result.max_mach, f.mach(y));
+            if (observer) {
+                observer(point(f, t, y));
+            }
+
+            if (leaves_rail) {
+                f.on_rail = false;
+                slope.reset();
+                result.rail_exit_time = t;
+                result.rail_exit_speed = Dyn::speed(y);
+            }
+            if (f.burning && t >= burn_out - TIME_EPSILON) {
+                f.burning = false;
+                slope.reset();
+                result.burn_out_time = t;
+                result.burn_out_altitude = y[UP];
+                result.burn_out_speed = Dyn::speed(y);
+            }
+            if (std::abs(t - next_sample) < TIME_EPSILON) {
+                slope.reset();
+                run_controller();
+            }
+
+            if (config.method == Method::Rk4) {
+                h = config.step;
+            } else {
+                // Steps cut short by a breakpoint say little about how long the next can be
+                auto const factor = 0.9 * std::pow(std::max(next.error, 1e-10), -0.2);
+                auto const grown = step * std::clamp(factor, 0.2, 5.0);
+                h = truncated || leaves_rail ? std::max(h, grown) : grown;
+            }
+        }
+
+        result.evaluations = f.evaluations;
+        return result;
+    }
+}
+
+FlightResult simulate(Scenario const& scenario, SolverConfig const& config,
+    Controller const& controller, Observer const& observer)
+{
+    if (config.model == Model::Vertical) {
+        return fly<1>(scenario, config, controller, observer);
+    }
+    return fly<3>(scenario, config, controller, observer);
+}
+
+double RocketPyExampleController::operator()(ControllerInput const& input) {
+    auto const previous = this->previous_vertical_velocity;
+    this->previous_vertical_velocity = input.vertical_velocity;
+
+    if (input.burning) {
+        return input.deployment;
+    }
+    if (input.altitude < 1500) {
+        return 0;
+    }
+
+    // Far more than the rate limit at any speed the rocket reaches above 1500 m
+    auto const wanted =
+        input.deployment + 0.1 * input.vertical_velocity + 0.01 * previous * previous;
+    auto const max_change = 0.2 / this->sampling_rate;
+    return std::clamp(wanted, input.deployment - max_change, input.deployment + max_change);
+}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "engine/rocket.h"
+
+namespace seds::trajectory {
+    /// How much of the motion to simulate.
+    enum class Model {
+        /// Straight up: altitude and vertical velocity only. The rail's tilt and the wind are
+        /// ignored.
+        Vertical,
+        /// A point mass in three dimensions that leaves the rail along it and then always points
+        /// into the relative wind: a gravity turn, weathercocking in a wind. RocketPy's
+        /// six-degree-of-freedom flights of a stable rocket stay close to this.
+        PointMass,
+    };
+
+    /// How to integrate the equations of motion.
+    enum class Method {
+        /// Classic fourth-order Runge-Kutta with a fixed step.
+        Rk4,
+        /// Dormand-Prince 5(4) with an adaptive step.
+        Rk45,
+    };
+
+    struct SolverConfig {
+        Model model = Model::PointMass;
+        Method method = Method::Rk45;
+        /// The step for Rk4, or the first step for Rk45, s.
+        double step = 0.01;
+        /// Error allowed per step for Rk45, relative to each state variable and absolute.
+        double tolerance = 1e-7;
+        /// Give up if there's no apogee by this time, s.
+        double max_time = 300;
+    };
+
+    /// What the air brake controller sees each time it runs.
+    struct ControllerInput {
+        /// Since ignition, s.
+        double time;
+        /// Above the pad, m.
+        double altitude;
+        /// m/s
+        double vertical_velocity;
+        /// m/s
+        double speed;
+        double mach;
+        /// What an accelerometer along the rocket reads, m/s²: thrust less drag over the mass,
+        /// or 1 g's worth on the pad.
+        double specific_force;
+        /// The current deployment level.
+        double deployment;
+        /// Whether the motor is still burning.
+        bool burning;
+    };
+
+    /// Decides the air brake deployment level, 0 to 1. Runs at t = 0 and then at the scenario's
+    /// sampling rate, and the level holds until it runs again.
+    using Controller = std::function<double(ControllerInput const&)>;
+
+    /// One accepted integrator step, for tools that want the whole trajectory.
+    struct TrajectoryPoint {
+        /// Since ignition, s.
+        double time;
+        /// East, north and up from the pad, m.
+        std::array<double, 3> position;
+        /// m/s
+        std::array<double, 3> velocity;
+        double mach;
+        double deployment;
+    };
+
+    using Observer = std::function<void(TrajectoryPoint const&)>;
+
+    /// The events of a flight from ignition to apogee.
+    struct FlightResult {
+        /// Whether it reached apogee within SolverConfig::max_time.
+        bool reached_apogee = false;
+        /// Above the pad, m.
+        double apogee = 0;
+        double apogee_time = 0;
+        double rail_exit_time = 0;
+        double rail_exit_speed = 0;
+        double burn_out_time = 0;
+        /// Above the pad, m.
+        double burn_out_altitude = 0;
+        double burn_out_speed = 0;
+        double max_speed = 0;
+        double max_mach = 0;
+        /// The air brakes' deployment level at apogee.
+        double deployment = 0;
+        uint32_t steps = 0;
+        uint32_t rejected_steps = 0;
+        /// Times the equations of motion were evaluated.
+        uint32_t evaluations = 0;
+    };
+
+    /// Flies `scenario` from ignition to apogee. Without a controller, the air brakes stay
+    /// stowed.
+    [[nodiscard]]
+    FlightResult simulate(Scenario const& scenario, SolverConfig const& config,
+        Controller const& controller = {}, Observer const& observer = {});
+
+    /// The air brake controller from RocketPyTest/AirbreaksDataTest.py, for comparing flights
+    /// with RocketPy's. Above 1500 m after burnout it deploys as fast as its 0.2/s rate limit
+    /// allows.
+    class RocketPyExampleController {
+    public:
+        explicit RocketPyExampleController(double sampling_rate) : sampling_rate(sampling_rate) {}
+
+        double operator()(ControllerInput const& input);
+
+    private:
+        double sampling_rate;
+        double previous_vertical_velocity = 0;
+    };
+}
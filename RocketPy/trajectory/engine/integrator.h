@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+
+namespace seds::trajectory {
+    template<size_t N>
+    using State = std::array<double, N>;
+
+    /// The result of one step of an integrator.
+    template<size_t N>
+    struct Step {
+        State<N> y;
+        /// The derivative at the end of the step, if the method got it for free, to start the
+        /// next step with.
+        std::optional<State<N>> end_slope;
+        /// Estimated error relative to the tolerance: the step is good enough at or below 1.
+        /// Always 0 for fixed-step methods.
+        double error = 0;
+    };
+
+    namespace integrator_detail {
+        /// y + h (sum of weights[i] k[i])
+        template<size_t N, size_t K>
+        State<N> combine(State<N> const& y, double h, std::array<double, K> const& weights,
+            std::array<State<N> const*, K> const& k)
+        {
+            State<N> result = y;
+            for (size_t j = 0; j < K; j++) {
+                if (weights[j] == 0) {
+                    continue;
+                }
+                for (size_t i = 0; i < N; i++) {
+                    result[i] += h * weights[j] * (*k[j])[i];
+                }
+            }
+            return result;
+        }
+    }
+
+    /// One classic fourth-order Runge-Kutta step of `h` from (t, y), where `slope` is f(t, y).
+    template<size_t N, typename F>
+    Step<N> rk4(F const& f, double t, State<N> const& y, double h, State<N> const& slope) {
+        using integrator_detail::combine;
+        auto const& k1 = slope;
+        auto const k2 = f(t + h / 2, combine<N, 1>(y, h, { 0.5 }, { &k1 }));
+        auto const k3 = f(t + h / 2, combine<N, 1>(y, h, { 0.5 }, { &k2 }));
+        auto const k4 = f(t + h, combine<N, 1>(y, h, { 1.0 }, { &k3 }));
+        return Step<N> {
+            .y = combine<N, 4>(y, h, { 1.0 / 6, 1.0 / 3, 1.0 / 3, 1.0 / 6 },
+                { &k1, &k2, &k3, &k4 }),
+            .end_slope = std::nullopt,
+            .error = 0,
+        };
+    }
+
+    /// One Dormand-Prince 5(4) step of `h` from (t, y), where `slope` is f(t, y). The error is
+    /// the difference from the embedded fourth-order solution, relative to `tolerance` (both
+    /// absolute and relative to each component).
+    template<size_t N, typename F>
+    Step<N> dormand_prince(F const& f, double t, State<N> const& y, double h,
+        State<N> const& slope, double tolerance)
+    {
+        using integrator_detail::combine;
+        auto const& k1 = slope;
+        auto const k2 = f(t + h / 5, combine<N, 1>(y, h, { 1.0 / 5 }, { &k1 }));
+        auto const k3 = f(t + 3 * h / 10,
+            combine<N, 2>(y, h, { 3.0 / 40, 9.0 / 40 }, { &k1, &k2 }));
+        auto const k4 = f(t + 4 * h / 5,
+            combine<N, 3>(y, h, { 44.0 / 45, -56.0 / 15, 32.0 / 9 }, { &k1, &k2, &k3 }));
+        auto const k5 = f(t + 8 * h / 9, combine<N, 4>(y, h,
+            { 19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729 },
+            { &k1, &k2, &k3, &k4 }));
+        auto const k6 = f(t + h, combine<N, 5>(y, h,
+            { 9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656 },
+            { &k1, &k2, &k3, &k4, &k5 }));
+        auto const next = combine<N, 6>(y, h,
+            { 35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84 },
+            { &k1, &k2, &k3, &k4, &k5, &k6 });
+        auto const k7 = f(t + h, next);
+
+        // Fifth- minus fourth-order weights
+        auto const difference = combine<N, 7>(State<N> {}, h,
+            { 71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525,
+                -1.0 / 40 },
+            { &k1, &k2, &k3, &k4, &k5, &k6, &k7 });
+        double error = 0;
+        for (size_t i = 0; i < N; i++) {
+            auto const scale = tolerance * (1 + std::max(std::abs(y[i]), std::abs(next[i])));
+            error = std::max(error, std::abs(difference[i]) / scale);
+        }
+
+        return Step<N> { .y = next, .end_slope = k7, .error = error };
+    }
+
+    /// The cubic Hermite polynomial through p0 with slope d0 at s = 0 and p1 with slope d1 at
+    /// s = 1, at `s`. Slopes are per unit of `s`, so a step's derivatives times its length.
+    inline double hermite(double p0, double d0, double p1, double d1, double s) {
+        auto const s2 = s * s;
+        auto const s3 = s2 * s;
+        return (2 * s3 - 3 * s2 + 1) * p0 + (s3 - 2 * s2 + s) * d0 + (-2 * s3 + 3 * s2) * p1
+            + (s3 - s2) * d1;
+    }
+
+    /// Where between 0 and 1 the Hermite polynomial (see `hermite`) crosses `target`, given that
+    /// p0 and p1 are on either side of it.
+    inline double hermite_crossing(double p0, double d0, double p1, double d1, double target) {
+        double low = 0;
+        double high = 1;
+        bool const rising = p1 > p0;
+        for (int i = 0; i < 60 && high - low > 1e-12; i++) {
+            auto const mid = (low + high) / 2;
+            if ((hermite(p0, d0, p1, d1, mid) < target) == rising) {
+                low = mid;
+            } else {
+                high = mid;
+            }
+        }
+        return (low + high) / 2;
+    }
+}
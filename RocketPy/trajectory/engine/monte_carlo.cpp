@@ -0,0 +1,235 @@
+#include "engine/monte_carlo.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numbers>
+#include <string>
+#include <string_view>
+
+#include "engine/batch.h"
+
+namespace seds::trajectory {
+
+namespace {
+    constexpr double DEGREES = std::numbers::pi / 180;
+
+    /// Splits a line into its whitespace-separated words.
+    std::vector<std::string_view> words(std::string_view line) {
+        std::vector<std::string_view> result;
+        while (true) {
+            auto const start = line.find_first_not_of(" \t\r");
+            if (start == std::string_view::npos) {
+                return result;
+            }
+            line.remove_prefix(start);
+            auto const end = std::min(line.find_first_of(" \t\r"), line.size());
+            result.push_back(line.substr(0, end));
+            line.remove_prefix(end);
+        }
+    }
+
+    std::optional<double> number(std::string_view word) {
+        double value;
+        auto [end, error] = std::from_chars(word.data(), word.data() + word.size(), value);
+        if (error != std::errc {} || end != word.data() + word.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /// Where each parameter's name in a dispersions file goes.
+    constexpr std::pair<std::string_view, std::optional<Distribution> Dispersions::*>
+        PARAMETERS[] = {
+            { "impulse", &Dispersions::impulse },
+            { "drag", &Dispersions::drag },
+            { "mass", &Dispersions::mass },
+            { "inclination", &Dispersions::inclination },
+            { "heading", &Dispersions::heading },
+            { "wind_speed", &Dispersions::wind_speed },
+            { "wind_from", &Dispersions::wind_from },
+        };
+}
+
+double Distribution::draw(Random& random) const {
+    switch (this->kind) {
+    case Kind::Constant:
+        return this->a;
+    case Kind::Normal:
+        return this->a + this->b * random.normal();
+    case Kind::Uniform:
+        return this->a + (this->b - this->a) * random.uniform();
+    }
+    return this->a;
+}
+
+Expected<Dispersions> Dispersions::load(std::filesystem::path const& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected(path.string() + ": can't open");
+    }
+
+    Dispersions dispersions;
+    std::string line;
+    for (size_t line_number = 1; std::getline(file, line); line_number++) {
+        auto text = std::string_view(line);
+        text = text.substr(0, text.find('#'));
+        auto const fields = words(text);
+        if (fields.empty()) {
+            continue;
+        }
+        auto const where = path.string() + ":" + std::to_string(line_number) + ": ";
+
+        auto const parameter = std::ranges::find(PARAMETERS, fields[0],
+            &std::pair<std::string_view, std::optional<Distribution> Dispersions::*>::first);
+        if (parameter == std::end(PARAMETERS)) {
+            return std::unexpected(where + "unknown parameter '" + std::string(fields[0]) + "'");
+        }
+
+        Distribution distribution;
+        size_t expected_fields;
+        if (fields.size() > 1 && fields[1] == "constant") {
+            distribution.kind = Distribution::Kind::Constant;
+            expected_fields = 3;
+        } else if (fields.size() > 1 && fields[1] == "normal") {
+            distribution.kind = Distribution::Kind::Normal;
+            expected_fields = 4;
+        } else if (fields.size() > 1 && fields[1] == "uniform") {
+            distribution.kind = Distribution::Kind::Uniform;
+            expected_fields = 4;
+        } else {
+            return std::unexpected(where + "expected constant, normal or uniform");
+        }
+        if (fields.size() != expected_fields) {
+            return std::unexpected(where + "wrong number of values for " + std::string(fields[1]));
+        }
+
+        auto const a = number(fields[2]);
+        auto const b = expected_fields == 4 ? number(fields[3]) : std::optional<double>(0);
+        if (!a.has_value() || !b.has_value()) {
+            return std::unexpected(where + "expected numbers");
+        }
+        distribution.a = *a;
+        distribution.b = *b;
+        dispersions.*(parameter->second) = distribution;
+    }
+    return dispersions;
+}
+
+Draw draw(Dispersions const& dispersions, Scenario const& nominal, uint64_t seed, uint64_t run) {
+    auto const& wind = nominal.atmosphere.wind;
+    Draw result {
+        .impulse = 1,
+        .drag = 1,
+        .mass = nominal.rocket.mass,
+        .inclination = nominal.rail.inclination,
+        .heading = nominal.rail.heading,
+        .wind_speed = std::hypot(wind[0], wind[1]),
+        .wind_from = std::fmod(std::atan2(-wind[0], -wind[1]) / DEGREES + 360, 360),
+    };
+
+    Random random(seed, run);
+    auto const take = [&](std::optional<Distribution> const& distribution, double& value) {
+        if (distribution.has_value()) {
+            value = distribution->draw(random);
+        }
+    };
+    take(dispersions.impulse, result.impulse);
+    take(dispersions.drag, result.drag);
+    take(dispersions.mass, result.mass);
+    take(dispersions.inclination, result.inclination);
+    take(dispersions.heading, result.heading);
+    take(dispersions.wind_speed, result.wind_speed);
+    take(dispersions.wind_from, result.wind_from);
+    return result;
+}
+
+Scenario apply(Scenario nominal, Draw const& draw) {
+    nominal.rocket.motor.scale_impulse(draw.impulse);
+    nominal.rocket.drag_scale *= draw.drag;
+    nominal.rocket.mass = draw.mass;
+    nominal.rail.inclination = draw.inclination;
+    nominal.rail.heading = draw.heading;
+    // Blowing from wind_from, so towards the opposite heading
+    nominal.atmosphere.wind = {
+        -draw.wind_speed * std::sin(draw.wind_from * DEGREES),
+        -draw.wind_speed * std::cos(draw.wind_from * DEGREES),
+    };
+    return nominal;
+}
+
+std::vector<RunResult> run_study(Scenario const& nominal, Dispersions const& dispersions,
+    StudyConfig const& config, ControllerFactory const& make_controller, ThreadPool& pool)
+{
+    std::vector<RunResult> results(config.runs);
+    auto const batched = config.batch > 0 && config.solver.model == Model::PointMass
+        && config.solver.method == Method::Rk45;
+    if (batched) {
+        // Each chunk is one batch, so which runs share a batch depends only on the batch size
+        BatchSimulator const simulator(nominal);
+        pool.for_each(config.runs, config.batch, [&](size_t begin, size_t end) {
+            std::vector<Draw> draws;
+            for (auto run = begin; run < end; run++) {
+                draws.push_back(draw(dispersions, nominal, config.seed, run));
+            }
+            auto const flights = simulator.fly(draws, config.solver, make_controller);
+            for (auto run = begin; run < end; run++) {
+                results[run] = RunResult { draws[run - begin], flights[run - begin] };
+            }
+        });
+        return results;
+    }
+
+    pool.for_each(config.runs, config.grain, [&](size_t begin, size_t end) {
+        for (auto run = begin; run < end; run++) {
+            auto& result = results[run];
+            result.draw = draw(dispersions, nominal, config.seed, run);
+            auto const controller = make_controller ? make_controller() : Controller {};
+            result.flight = simulate(apply(nominal, result.draw), config.solver, controller);
+        }
+    });
+    return results;
+}
+
+Histogram Histogram::of(std::span<double const> values, size_t bins, double low, double high) {
+    Histogram histogram;
+    histogram.low = low;
+    histogram.width = high > low ? (high - low) / static_cast<double>(bins) : 1;
+    histogram.counts.assign(std::max<size_t>(bins, 1), 0);
+    for (auto value : values) {
+        auto const bin = std::floor((value - low) / histogram.width);
+        auto const last = static_cast<double>(histogram.counts.size() - 1);
+        histogram.counts[static_cast<size_t>(std::clamp(bin, 0.0, last))]++;
+    }
+    return histogram;
+}
+
+Histogram Histogram::of(std::span<double const> values, size_t bins) {
+    if (values.empty()) {
+        return of(values, bins, 0, 1);
+    }
+    auto const [low, high] = std::ranges::minmax(values);
+    return of(values, bins, low, high);
+}
+
+Expected<void> Histogram::write_csv(std::filesystem::path const& path,
+    char const* quantity) const
+{
+    auto* file = std::fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return std::unexpected(path.string() + ": can't create");
+    }
+    std::fprintf(file, "%s low,%s high,count\n", quantity, quantity);
+    for (size_t i = 0; i < this->counts.size(); i++) {
+        auto const bin_low = this->low + static_cast<double>(i) * this->width;
+        std::fprintf(file, "%.6g,%.6g,%u\n", bin_low, bin_low + this->width, this->counts[i]);
+    }
+    if (std::fclose(file) != 0) {
+        return std::unexpected(path.string() + ": write failed");
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "engine/errors.h"
+#include "engine/flight.h"
+#include "engine/random.h"
+#include "engine/thread_pool.h"
+
+namespace seds::trajectory {
+    /// How one dispersed parameter is drawn. Normal draws aren't truncated.
+    struct Distribution {
+        enum class Kind {
+            Constant,
+            Normal,
+            Uniform,
+        };
+
+        Kind kind = Kind::Constant;
+        /// The value, the mean, or the lower bound.
+        double a = 0;
+        /// Unused, the standard deviation, or the upper bound.
+        double b = 0;
+
+        [[nodiscard]]
+        double draw(Random& random) const;
+    };
+
+    /// What varies from flight to flight. Parameters left empty keep the scenario's value.
+    struct Dispersions {
+        /// Multiplies the motor's thrust, and so its total impulse.
+        std::optional<Distribution> impulse;
+        /// Multiplies both drag curves.
+        std::optional<Distribution> drag;
+        /// The rocket without its motor, kg.
+        std::optional<Distribution> mass;
+        /// The rail's elevation above the horizon, degrees.
+        std::optional<Distribution> inclination;
+        /// The rail's compass heading, degrees.
+        std::optional<Distribution> heading;
+        /// m/s
+        std::optional<Distribution> wind_speed;
+        /// The compass direction the wind blows from, degrees, as a weather report gives it.
+        std::optional<Distribution> wind_from;
+
+        /// Reads a file of "<parameter> <distribution> <a> [<b>]" lines, where the distribution
+        /// is constant, normal or uniform. '#' starts a comment.
+        [[nodiscard]]
+        static Expected<Dispersions> load(std::filesystem::path const& path);
+    };
+
+    /// The parameters one run flew with.
+    struct Draw {
+        double impulse;
+        double drag;
+        double mass;
+        double inclination;
+        double heading;
+        double wind_speed;
+        double wind_from;
+    };
+
+    /// Draws run `run` of the study seeded with `seed`. The run gets its own random stream, so
+    /// its draw depends on nothing else, and the parameters draw from it in the order above.
+    [[nodiscard]]
+    Draw draw(Dispersions const& dispersions, Scenario const& nominal, uint64_t seed, uint64_t run);
+
+    /// `nominal` with the parameters of `draw`.
+    [[nodiscard]]
+    Scenario apply(Scenario nominal, Draw const& draw);
+
+    struct StudyConfig {
+        size_t runs = 1000;
+        uint64_t seed = 1;
+        SolverConfig solver = {};
+        /// Runs handed out to a thread at a time.
+        size_t grain = 8;
+        /// Fly this many runs at a time with BatchSimulator, or each run on its own if zero.
+        /// Batches are only for Model::PointMass with Method::Rk45.
+        size_t batch = 0;
+    };
+
+    /// Makes the air brake controller for each run, since a controller may remember earlier
+    /// samples. Empty for stowed air brakes.
+    using ControllerFactory = std::function<Controller()>;
+
+    struct RunResult {
+        Draw draw;
+        FlightResult flight;
+    };
+
+    /// Flies `config.runs` dispersed flights of `nominal` across `pool`. The results are in run
+    /// order and the same for any number of threads.
+    [[nodiscard]]
+    std::vector<RunResult> run_study(Scenario const& nominal, Dispersions const& dispersions,
+        StudyConfig const& config, ControllerFactory const& make_controller, ThreadPool& pool);
+
+    /// Counts of values in equal bins.
+    struct Histogram {
+        /// The lower edge of the first bin.
+        double low = 0;
+        double width = 1;
+        std::vector<uint32_t> counts;
+
+        /// `bins` bins from `low` to `high`. Values outside go in the first or last bin.
+        [[nodiscard]]
+        static Histogram of(std::span<double const> values, size_t bins, double low, double high);
+
+        /// `bins` bins from the smallest value to the largest.
+        [[nodiscard]]
+        static Histogram of(std::span<double const> values, size_t bins);
+
+        /// Writes "<quantity> low,<quantity> high,count" and a line per bin.
+        [[nodiscard]]
+        Expected<void> write_csv(std::filesystem::path const& path, char const* quantity) const;
+    };
+}
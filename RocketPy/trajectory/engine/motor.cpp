@@ -0,0 +1,118 @@
+#include "engine/motor.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace seds::trajectory {
+
+namespace {
+    /// Reads the numbers out of a line of whitespace-separated numbers.
+    std::vector<double> numbers(std::string_view line) {
+        std::vector<double> values;
+        while (true) {
+            auto const start = line.find_first_not_of(" \t\r");
+            if (start == std::string_view::npos) {
+                return values;
+            }
+            line.remove_prefix(start);
+            double value;
+            auto [end, error] = std::from_chars(line.data(), line.data() + line.size(), value);
+            if (error != std::errc {}) {
+                return {};
+            }
+            values.push_back(value);
+            line.remove_prefix(end - line.data());
+        }
+    }
+}
+
+Motor::Motor(std::span<std::pair<double, double> const> points, MotorConfig const& config)
+    : dry_mass(config.dry_mass), initial_propellant(config.propellant_mass)
+{
+    std::vector<std::pair<double, double>> curve;
+    for (auto const& point : points) {
+        if (config.burn_time.has_value() && point.first > *config.burn_time) {
+            // End exactly at the burn time, at whatever the curve reaches by then
+            auto const end = *config.burn_time;
+            if (!curve.empty() && curve.back().first < end) {
+                auto const& last = curve.back();
+                auto const fraction = (end - last.first) / (point.first - last.first);
+                curve.emplace_back(end, last.second + fraction * (point.second - last.second));
+            }
+            break;
+        }
+        curve.push_back(point);
+    }
+    this->thrust_curve = LinearTable(curve, LinearTable::Extrapolation::Zero);
+
+    double total = 0;
+    for (size_t i = 0; i < curve.size(); i++) {
+        if (i > 0) {
+            total += 0.5 * (curve[i].second + curve[i - 1].second)
+                * (curve[i].first - curve[i - 1].first);
+        }
+        this->impulse.push_back(total);
+    }
+}
+
+Expected<Motor> Motor::load_eng(std::filesystem::path const& path, MotorConfig const& config) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected(path.string() + ": can't open");
+    }
+
+    // Comments start with ';', then a header line (name, diameter, length, delays, masses,
+    // maker), then "time thrust" pairs
+    std::vector<std::pair<double, double>> points;
+    bool header = true;
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); number++) {
+        auto const text = std::string_view(line);
+        if (text.find_first_not_of(" \t\r") == std::string_view::npos || text.starts_with(';')) {
+            continue;
+        }
+        if (header) {
+            header = false;
+            continue;
+        }
+
+        auto const values = numbers(text);
+        if (values.size() != 2 || (!points.empty() && values[0] <= points.back().first)) {
+            return std::unexpected(path.string() + ":" + std::to_string(number)
+                + ": expected a time after the last one and a thrust");
+        }
+        points.emplace_back(values[0], values[1]);
+    }
+    if (points.empty()) {
+        return std::unexpected(path.string() + ": no thrust curve");
+    }
+
+    // RASP curves leave out ignition, which RocketPy puts back
+    if (points.front().first > 0) {
+        points.insert(points.begin(), { 0.0, 0.0 });
+    }
+    return Motor(points, config);
+}
+
+double Motor::propellant_mass(double time) const {
+    // As a fraction of the impulse, which thrust_scale doesn't change
+    auto const total = this->impulse.empty() ? 0 : this->impulse.back();
+    if (total <= 0 || time <= 0) {
+        return this->initial_propellant;
+    }
+    if (time >= this->burn_out_time()) {
+        return 0;
+    }
+
+    // Impulse so far: the points before `time`, then the trapezoid up to it
+    auto const xs = this->thrust_curve.xs();
+    auto const i = static_cast<size_t>(std::upper_bound(xs.begin(), xs.end(), time) - xs.begin());
+    auto const delivered = this->impulse[i - 1]
+        + 0.5 * (this->thrust_curve.ys()[i - 1] + this->thrust_curve(time)) * (time - xs[i - 1]);
+    return this->initial_propellant * (1 - delivered / total);
+}
+
+}
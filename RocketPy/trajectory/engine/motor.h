@@ -0,0 +1,83 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "engine/errors.h"
+#include "engine/table.h"
+
+namespace seds::trajectory {
+    /// What a motor file doesn't say, or what to use instead of what it says. These match the
+    /// arguments of RocketPy's `SolidMotor` that matter to a point-mass trajectory.
+    struct MotorConfig {
+        /// Mass of the empty motor casing, kg.
+        double dry_mass = 0;
+        /// Propellant at ignition, kg. RocketPy works this out from the grain geometry, ignoring
+        /// the mass in the motor file.
+        double propellant_mass = 0;
+        /// Cuts the thrust curve off here, s, the way RocketPy's `burn_time` does. Empty to use
+        /// the whole curve.
+        std::optional<double> burn_time;
+    };
+
+    /// A solid motor: its thrust curve, and its propellant burning off in proportion to the
+    /// impulse delivered so far (RocketPy's constant exhaust velocity model).
+    class Motor {
+    public:
+        Motor() = default;
+
+        /// A motor with the thrust curve `points` (s, N), which must start at t = 0.
+        Motor(std::span<std::pair<double, double> const> points, MotorConfig const& config);
+
+        /// Loads a RASP .eng thrust curve.
+        [[nodiscard]]
+        static Expected<Motor> load_eng(std::filesystem::path const& path,
+            MotorConfig const& config);
+
+        /// Thrust at `time` after ignition, N. Zero after burnout.
+        [[nodiscard]]
+        double thrust(double time) const {
+            return this->thrust_scale * this->thrust_curve(time);
+        }
+
+        /// Scales the thrust, and so the total impulse, by `factor` over the same burn, the way a
+        /// motor from another batch of propellant performs. The propellant still burns off over
+        /// the same curve.
+        void scale_impulse(double factor) {
+            this->thrust_scale *= factor;
+        }
+
+        /// Propellant left at `time` after ignition, kg.
+        [[nodiscard]]
+        double propellant_mass(double time) const;
+
+        /// Mass of the motor at `time` after ignition, kg.
+        [[nodiscard]]
+        double mass(double time) const {
+            return this->dry_mass + this->propellant_mass(time);
+        }
+
+        /// When the thrust curve ends, s.
+        [[nodiscard]]
+        double burn_out_time() const {
+            return this->thrust_curve.xs().empty() ? 0 : this->thrust_curve.xs().back();
+        }
+
+        /// Impulse over the whole burn, N s.
+        [[nodiscard]]
+        double total_impulse() const {
+            return this->impulse.empty() ? 0 : this->thrust_scale * this->impulse.back();
+        }
+
+    private:
+        LinearTable thrust_curve;
+        /// Impulse delivered by each point of the thrust curve, N s, before `thrust_scale`.
+        std::vector<double> impulse;
+        double thrust_scale = 1;
+        double dry_mass = 0;
+        double initial_propellant = 0;
+    };
+}
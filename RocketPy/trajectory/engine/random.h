@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+namespace seds::trajectory {
+    /// xoshiro256** (Blackman and Vigna), seeded through SplitMix64. Each Monte Carlo run gets its
+    /// own generator from the study's seed and the run's number, so a run draws the same numbers
+    /// whichever thread flies it and however many runs there are.
+    class Random {
+    public:
+        Random(uint64_t seed, uint64_t stream) {
+            // SplitMix64 spreads even neighbouring seeds and streams over the whole state
+            auto mix = seed ^ (stream * 0xd1342543de82ef95);
+            for (auto& word : this->state) {
+                mix += 0x9e3779b97f4a7c15;
+                auto z = mix;
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+                word = z ^ (z >> 31);
+            }
+        }
+
+        uint64_t next() {
+            auto& s = this->state;
+            auto const result = std::rotl(s[1] * 5, 7) * 9;
+            auto const t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = std::rotl(s[3], 45);
+            return result;
+        }
+
+        /// Uniform in [0, 1), from the top 53 bits.
+        double uniform() {
+            return static_cast<double>(this->next() >> 11) * 0x1.0p-53;
+        }
+
+        /// Standard normal, by Box-Muller. Written out rather than std::normal_distribution,
+        /// whose draws differ between standard libraries.
+        double normal() {
+            auto const u = 1 - this->uniform();
+            auto const v = this->uniform();
+            return std::sqrt(-2 * std::log(u)) * std::cos(2 * std::numbers::pi * v);
+        }
+
+    private:
+        std::array<uint64_t, 4> state;
+    };
+}
@@ -0,0 +1,48 @@
+#include "engine/rocket.h"
+
+namespace seds::trajectory {
+
+Expected<Scenario> load_calisto(std::filesystem::path const& data_dir) {
+    // Five BATES grains, as RocketPy's SolidMotor works out the propellant from them
+    constexpr double grain_number = 5;
+    constexpr double grain_density = 1815;
+    constexpr double grain_outer_radius = 33 / 1000.0;
+    constexpr double grain_inner_radius = 15 / 1000.0;
+    constexpr double grain_height = 120 / 1000.0;
+    constexpr double propellant_mass = grain_number * grain_density * std::numbers::pi
+        * (grain_outer_radius * grain_outer_radius - grain_inner_radius * grain_inner_radius)
+        * grain_height;
+
+    auto const motor = TRY(Motor::load_eng(data_dir / "Cesaroni_12066N2200-P.eng", MotorConfig {
+        .dry_mass = 1.815,
+        .propellant_mass = propellant_mass,
+        .burn_time = 3.9,
+    }));
+
+    Rocket rocket {
+        .mass = 14.426,
+        .radius = 127 / 2000.0,
+        .power_on_drag = TRY(LinearTable::load_csv(data_dir / "powerOnDragCurve.csv",
+            LinearTable::Extrapolation::Constant)),
+        .power_off_drag = TRY(LinearTable::load_csv(data_dir / "powerOffDragCurve.csv",
+            LinearTable::Extrapolation::Constant)),
+        .drag_scale = 1,
+        .motor = motor,
+        .air_brakes = std::nullopt,
+    };
+    // RocketPy uses the rocket's own area when the air brakes don't give one
+    rocket.air_brakes = AirBrakes {
+        .drag_coefficient = TRY(ScatteredTable::load_csv(data_dir / "air_brakes_cd.csv")),
+        .reference_area = rocket.area(),
+        .clamp = true,
+    };
+
+    return Scenario {
+        .rocket = std::move(rocket),
+        .atmosphere = Atmosphere { .elevation = 1400, .latitude = 32.990254 },
+        .rail = LaunchRail { .length = 5.2, .inclination = 85, .heading = 0 },
+        .sampling_rate = 10,
+    };
+}
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <numbers>
+#include <optional>
+
+#include "engine/atmosphere.h"
+#include "engine/errors.h"
+#include "engine/motor.h"
+#include "engine/table.h"
+
+namespace seds::trajectory {
+    /// Air brakes, as RocketPy's `AirBrakes` describes them.
+    struct AirBrakes {
+        /// Drag coefficient by deployment level (0 to 1) and Mach number.
+        ScatteredTable drag_coefficient;
+        /// Area the drag coefficient is relative to, m².
+        double reference_area = 0;
+        /// Keep the deployment level between 0 and 1.
+        bool clamp = true;
+    };
+
+    /// A rocket as a point mass with drag.
+    struct Rocket {
+        /// Without the motor, kg.
+        double mass = 0;
+        /// m
+        double radius = 0;
+        /// Drag coefficient by Mach number while the motor burns and after.
+        LinearTable power_on_drag;
+        LinearTable power_off_drag;
+        /// Multiplies both drag curves, for a rocket draggier or sleeker than its model.
+        double drag_scale = 1;
+        Motor motor;
+        std::optional<AirBrakes> air_brakes;
+
+        /// Cross-section the drag coefficients are relative to, m².
+        [[nodiscard]]
+        double area() const {
+            return std::numbers::pi * this->radius * this->radius;
+        }
+
+        /// Mass at `time` after ignition, kg.
+        [[nodiscard]]
+        double mass_at(double time) const {
+            return this->mass + this->motor.mass(time);
+        }
+
+        /// The air brakes' drag coefficient relative to their own reference area, with zero for
+        /// stowed ones the way RocketPy skips them.
+        [[nodiscard]]
+        double air_brake_drag_coefficient(double deployment, double mach) const {
+            if (!this->air_brakes.has_value() || deployment <= 0) {
+                return 0;
+            }
+            if (this->air_brakes->clamp) {
+                deployment = std::min(deployment, 1.0);
+            }
+            return this->air_brakes->drag_coefficient(deployment, mach);
+        }
+    };
+
+    /// The launch rail.
+    struct LaunchRail {
+        /// m
+        double length = 0;
+        /// Elevation above the horizon, degrees.
+        double inclination = 90;
+        /// Compass heading it points along, degrees.
+        double heading = 0;
+    };
+
+    /// Everything about a flight but the air brake controller.
+    struct Scenario {
+        Rocket rocket;
+        Atmosphere atmosphere;
+        LaunchRail rail;
+        /// How often the air brake controller runs, Hz.
+        double sampling_rate = 10;
+    };
+
+    /// The rocket, motor and launch from RocketPyTest/AirbreaksDataTest.py (the Calisto example
+    /// with the Cesaroni N2200 from Spaceport America), with the thrust curve and drag tables
+    /// loaded from `data_dir`.
+    [[nodiscard]]
+    Expected<Scenario> load_calisto(std::filesystem::path const& data_dir);
+}
@@ -0,0 +1,145 @@
+#include "engine/table.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace seds::trajectory {
+
+namespace {
+    std::string_view trim(std::string_view text) {
+        auto const first = text.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+    }
+
+    /// Splits a line at its commas into exactly `N` numbers.
+    template<size_t N>
+    std::optional<std::array<double, N>> parse_row(std::string_view line) {
+        std::array<double, N> row;
+        for (size_t i = 0; i < N; i++) {
+            auto const comma = line.find(',');
+            if ((comma == std::string_view::npos) != (i + 1 == N)) {
+                return std::nullopt;
+            }
+            auto const field = trim(line.substr(0, comma));
+            auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), row[i]);
+            if (field.empty() || error != std::errc {} || end != field.data() + field.size()) {
+                return std::nullopt;
+            }
+            line.remove_prefix(comma == std::string_view::npos ? line.size() : comma + 1);
+        }
+        return row;
+    }
+}
+
+template<size_t N>
+Expected<std::vector<std::array<double, N>>> read_csv(std::filesystem::path const& path) {
+    std::ifstream file(path);
+    if (!file) {
+        return std::unexpected(path.string() + ": can't open");
+    }
+
+    std::vector<std::array<double, N>> rows;
+    std::string line;
+    for (size_t number = 1; std::getline(file, line); number++) {
+        if (trim(line).empty()) {
+            continue;
+        }
+        auto const row = parse_row<N>(line);
+        if (!row.has_value()) {
+            // Only the first line may be a header
+            if (number == 1) {
+                continue;
+            }
+            return std::unexpected(path.string() + ":" + std::to_string(number) + ": expected "
+                + std::to_string(N) + " comma-separated numbers");
+        }
+        rows.push_back(*row);
+    }
+
+    if (rows.empty()) {
+        return std::unexpected(path.string() + ": no data");
+    }
+    return rows;
+}
+
+template Expected<std::vector<std::array<double, 2>>> read_csv<2>(std::filesystem::path const&);
+template Expected<std::vector<std::array<double, 3>>> read_csv<3>(std::filesystem::path const&);
+
+LinearTable::LinearTable(std::span<std::pair<double, double> const> points,
+    Extrapolation extrapolation)
+    : extrapolation(extrapolation)
+{
+    for (auto const& [x, y] : points) {
+        this->x.push_back(x);
+        this->y.push_back(y);
+    }
+}
+
+Expected<LinearTable> LinearTable::load_csv(std::filesystem::path const& path,
+    Extrapolation extrapolation)
+{
+    auto const rows = TRY(read_csv<2>(path));
+    std::vector<std::pair<double, double>> points;
+    for (auto const& [x, y] : rows) {
+        if (!points.empty() && x <= points.back().first) {
+            return std::unexpected(path.string() + ": x must increase from row to row");
+        }
+        points.emplace_back(x, y);
+    }
+    return LinearTable(points, extrapolation);
+}
+
+double LinearTable::operator()(double x) const {
+    if (this->x.empty()) {
+        return 0;
+    }
+    if (x < this->x.front() || x > this->x.back()) {
+        if (this->extrapolation == Extrapolation::Zero) {
+            return 0;
+        }
+        return x < this->x.front() ? this->y.front() : this->y.back();
+    }
+
+    if (this->x.size() == 1) {
+        return this->y.front();
+    }
+
+    // The segment [x[i - 1], x[i]] that holds x
+    auto const i = static_cast<size_t>(
+        std::upper_bound(this->x.begin() + 1, this->x.end() - 1, x) - this->x.begin());
+    auto const fraction = (x - this->x[i - 1]) / (this->x[i] - this->x[i - 1]);
+    return this->y[i - 1] + fraction * (this->y[i] - this->y[i - 1]);
+}
+
+ScatteredTable::ScatteredTable(std::vector<std::array<double, 3>> points)
+    : data(std::move(points)) {}
+
+Expected<ScatteredTable> ScatteredTable::load_csv(std::filesystem::path const& path) {
+    return ScatteredTable(TRY(read_csv<3>(path)));
+}
+
+double ScatteredTable::operator()(double x, double y) const {
+    double weighted = 0;
+    double weights = 0;
+    for (auto const& [px, py, pz] : this->data) {
+        auto const distance_squared = (px - x) * (px - x) + (py - y) * (py - y);
+        if (distance_squared == 0) {
+            return pz;
+        }
+        // RocketPy weights by distance^-3
+        auto const weight = 1.0 / (distance_squared * std::sqrt(distance_squared));
+        weighted += weight * pz;
+        weights += weight;
+    }
+    return weights == 0 ? 0 : weighted / weights;
+}
+
+}
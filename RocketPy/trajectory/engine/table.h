@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "engine/errors.h"
+
+namespace seds::trajectory {
+    /// Reads a CSV file of `N` numeric columns, skipping a header line if it has one. Blank lines
+    /// are ignored.
+    template<size_t N>
+    [[nodiscard]]
+    Expected<std::vector<std::array<double, N>>> read_csv(std::filesystem::path const& path);
+
+    /// A function of one variable given by points, interpolated linearly between them the way
+    /// RocketPy's `Function` does with `interpolation="linear"`.
+    class LinearTable {
+    public:
+        /// What the table is outside its first and last points.
+        enum class Extrapolation {
+            /// The nearest point's value.
+            Constant,
+            /// Zero, the way a thrust curve ends.
+            Zero,
+        };
+
+        /// Zero everywhere.
+        LinearTable() = default;
+
+        /// Points must be sorted by x, with no two at the same x.
+        LinearTable(std::span<std::pair<double, double> const> points, Extrapolation extrapolation);
+
+        /// Loads an "x,y" CSV file such as RocketPy's drag curves.
+        [[nodiscard]]
+        static Expected<LinearTable> load_csv(std::filesystem::path const& path,
+            Extrapolation extrapolation);
+
+        [[nodiscard]]
+        double operator()(double x) const;
+
+        [[nodiscard]]
+        std::span<double const> xs() const {
+            return this->x;
+        }
+
+        [[nodiscard]]
+        std::span<double const> ys() const {
+            return this->y;
+        }
+
+    private:
+        std::vector<double> x;
+        std::vector<double> y;
+        Extrapolation extrapolation = Extrapolation::Zero;
+    };
+
+    /// A function of two variables given by scattered points, interpolated by inverse distance
+    /// weighting (Shepard's method) the way RocketPy's `Function` does for data with more than one
+    /// input, such as an air brake drag coefficient by deployment level and Mach number.
+    class ScatteredTable {
+    public:
+        ScatteredTable() = default;
+        explicit ScatteredTable(std::vector<std::array<double, 3>> points);
+
+        /// Loads an "x,y,z" CSV file with a header, such as RocketPy's air_brakes_cd.csv.
+        [[nodiscard]]
+        static Expected<ScatteredTable> load_csv(std::filesystem::path const& path);
+
+        [[nodiscard]]
+        double operator()(double x, double y) const;
+
+        [[nodiscard]]
+        std::span<std::array<double, 3> const> points() const {
+            return this->data;
+        }
+
+    private:
+        std::vector<std::array<double, 3>> data;
+    };
+
+    /// A function of one variable sampled at evenly spaced points and interpolated linearly
+    /// between them, with the nearest end's value outside. Finding the segment is arithmetic
+    /// rather than a search, so a loop looking up many values at once vectorizes.
+    class UniformTable {
+    public:
+        UniformTable() = default;
+
+        /// Samples `function` from `low` to at least `high`, every `spacing`. A LinearTable
+        /// whose points all lie on the samples comes through exactly.
+        template<typename F>
+        UniformTable(F const& function, double low, double high, double spacing)
+            : low(low), inverse_spacing(1 / spacing)
+        {
+            auto const intervals = std::max(1.0, std::ceil((high - low) / spacing - 1e-9));
+            for (size_t i = 0; i <= static_cast<size_t>(intervals); i++) {
+                this->values.push_back(function(low + static_cast<double>(i) * spacing));
+            }
+        }
+
+        /// The table as plain numbers, to take into a loop that should vectorize, where a
+        /// vector member would be reloaded on every pass in case the loop wrote to it.
+        struct View {
+            double const* values;
+            double low;
+            double inverse_spacing;
+            /// The index of the last value.
+            double last;
+
+            [[nodiscard]]
+            double operator()(double x) const {
+                auto const position =
+                    std::clamp((x - this->low) * this->inverse_spacing, 0.0, this->last);
+                auto const i =
+                    std::min(static_cast<int>(position), static_cast<int>(this->last) - 1);
+                auto const fraction = position - i;
+                return this->values[i] + fraction * (this->values[i + 1] - this->values[i]);
+            }
+        };
+
+        [[nodiscard]]
+        View view() const {
+            return View {
+                .values = this->values.data(),
+                .low = this->low,
+                .inverse_spacing = this->inverse_spacing,
+                .last = static_cast<double>(this->values.size() - 1),
+            };
+        }
+
+        [[nodiscard]]
+        double operator()(double x) const {
+            return this->view()(x);
+        }
+
+    private:
+        std::vector<double> values;
+        double low = 0;
+        double inverse_spacing = 1;
+    };
+}
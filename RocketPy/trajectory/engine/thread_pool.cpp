@@ -0,0 +1,106 @@
+#include "engine/thread_pool.h"
+
+#include <algorithm>
+
+namespace seds::trajectory {
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        this->queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        this->threads.emplace_back([this, i] { this->work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(this->mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (auto& thread : this->threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::for_each(size_t count, size_t grain, Task const& task) {
+    grain = std::max<size_t>(grain, 1);
+    auto const chunks = (count + grain - 1) / grain;
+    if (chunks == 0) {
+        return;
+    }
+    this->remaining.store(chunks);
+
+    // Worker w starts with chunks [w·chunks/workers, (w+1)·chunks/workers)
+    auto const workers = this->queues.size();
+    for (size_t w = 0; w < workers; w++) {
+        std::lock_guard lock(this->queues[w]->mutex);
+        for (auto c = w * chunks / workers; c < (w + 1) * chunks / workers; c++) {
+            this->queues[w]->chunks.push_back(Chunk {
+                .begin = c * grain,
+                .end = std::min(count, (c + 1) * grain),
+                .task = &task,
+            });
+        }
+    }
+
+    std::unique_lock lock(this->mutex);
+    this->generation++;
+    this->wake.notify_all();
+    this->done.wait(lock, [this] { return this->remaining.load() == 0; });
+}
+
+bool ThreadPool::take(size_t index, Chunk& chunk) {
+    {
+        auto& own = *this->queues[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            return true;
+        }
+    }
+
+    // Out of work: steal from the far end of the next worker along that has some
+    for (size_t offset = 1; offset < this->queues.size(); offset++) {
+        auto& victim = *this->queues[(index + offset) % this->queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            this->stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t index) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock lock(this->mutex);
+            this->wake.wait(lock, [&] { return this->stopping || this->generation != seen; });
+            if (this->stopping) {
+                return;
+            }
+            seen = this->generation;
+        }
+
+        Chunk chunk;
+        while (this->take(index, chunk)) {
+            (*chunk.task)(chunk.begin, chunk.end);
+            if (this->remaining.fetch_sub(1) == 1) {
+                // Under the lock, so the caller can't miss it between checking and waiting
+                std::lock_guard lock(this->mutex);
+                this->done.notify_all();
+            }
+        }
+    }
+}
+
+}
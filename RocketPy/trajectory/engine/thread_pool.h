@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace seds::trajectory {
+    /// Worker threads that share out a range of independent tasks by work stealing.
+    ///
+    /// Each worker starts with its own contiguous share of the range, in chunks, and works
+    /// through it from the front. A worker that runs out takes chunks from the back of another
+    /// worker's share, so flights that take longer (air brakes that run the controller more, or
+    /// a rocket that flies higher) don't leave the other cores idle at the end of a batch.
+    class ThreadPool {
+    public:
+        /// Runs task(begin, end) for a chunk of the range.
+        using Task = std::function<void(size_t begin, size_t end)>;
+
+        /// Starts `threads` workers, or one per core if zero.
+        explicit ThreadPool(size_t threads = 0);
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool const&) = delete;
+        ThreadPool& operator=(ThreadPool const&) = delete;
+
+        /// Runs `task` over [0, count) in chunks of at most `grain`, and returns once all of
+        /// them have finished. Only one thread may call this at a time.
+        void for_each(size_t count, size_t grain, Task const& task);
+
+        [[nodiscard]]
+        size_t size() const {
+            return this->threads.size();
+        }
+
+        /// Chunks taken from another worker's share since the pool started.
+        [[nodiscard]]
+        uint64_t steals() const {
+            return this->stolen.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct Chunk {
+            size_t begin;
+            size_t end;
+            /// Which batch's task this chunk is for, so a worker that wakes late for one batch
+            /// never runs the next batch's chunks with it.
+            Task const* task;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Chunk> chunks;
+        };
+
+        void work(size_t index);
+        bool take(size_t index, Chunk& chunk);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        uint64_t generation = 0;
+        bool stopping = false;
+        std::atomic<size_t> remaining = 0;
+        std::atomic<uint64_t> stolen = 0;
+    };
+}
@@ -0,0 +1,213 @@
+// Flies many copies of the RocketPyTest rocket, each with its motor impulse, drag, mass, rail
+// angle and wind drawn from the distributions in a dispersions file, across every core. Prints
+// how the apogee and air brake deployment spread, and writes their histograms as CSV.
+//
+// Every run has its own random stream from --seed and its number, so a study gives the same
+// flights on any number of threads.
+//
+//     monte_carlo [--dispersions <file>] [--runs <n>] [--seed <n>] [--threads <n>]
+//                 [--batch <n>] [--bins <n>] [--histograms <prefix>] [--results <file>]
+//                 [--data <dir>] [--model ...] [--method ...] [--step <s>] [--tolerance <x>]
+//                 [--brakes ...] [--target <m>] [--rate <Hz>]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "engine/monte_carlo.h"
+#include "tools/options.h"
+
+using namespace seds::trajectory;
+using namespace std::chrono;
+
+namespace {
+    struct Options {
+        char const* data_dir = TRAJECTORY_DATA_DIR;
+        char const* dispersions_path = TRAJECTORY_DISPERSIONS;
+        StudyConfig study;
+        Brakes brakes;
+        size_t threads = 0;
+        size_t bins = 40;
+        char const* histogram_prefix = nullptr;
+        char const* results_path = nullptr;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: monte_carlo [--dispersions <file>] [--runs <n>] [--seed <n>] [--threads <n>]\n"
+            "                   [--batch <n>] [--bins <n>] [--histograms <prefix>]\n"
+            "                   [--results <file>]\n"
+            "                   [--data <dir>] [--model vertical|point-mass] [--method rk4|rk45]\n"
+            "                   [--step <s>] [--tolerance <x>]\n"
+            "                   [--brakes off|example|apogee|apogee-identified|\n"
+            "                             apogee-closed-form|<level>]\n"
+            "                   [--target <m>] [--rate <Hz>]\n"
+            "\n"
+            "  --dispersions  what to vary and how (default: dispersions.txt)\n"
+            "  --runs         flights to fly (default: 1000)\n"
+            "  --seed         seed for the whole study (default: 1)\n"
+            "  --threads      worker threads (default: one per core)\n"
+            "  --batch        step this many point-mass rk45 flights together (default: 64, or\n"
+            "                 0 to fly each on its own)\n"
+            "  --bins         bins in each histogram (default: 40)\n"
+            "  --histograms   write <prefix>apogee.csv and <prefix>deployment.csv\n"
+            "  --results      write every run's parameters and results to this CSV file\n"
+            "\n"
+            "and --data, --model, --method, --step, --tolerance, --brakes, --target and --rate as\n"
+            "for simulate.\n");
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        options.study.batch = 64;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            i++;
+            auto const count = std::strtoull(argv[i], nullptr, 10);
+            if (arg == "--data") {
+                options.data_dir = argv[i];
+            } else if (arg == "--dispersions") {
+                options.dispersions_path = argv[i];
+            } else if (parse_solver(arg, argv[i], options.study.solver)
+                || parse_brakes(arg, argv[i], options.brakes)) {
+                continue;
+            } else if (arg == "--runs" && count > 0) {
+                options.study.runs = count;
+            } else if (arg == "--seed") {
+                options.study.seed = count;
+            } else if (arg == "--batch" && number(argv[i]).has_value()) {
+                options.study.batch = count;
+            } else if (arg == "--threads" && count > 0) {
+                options.threads = count;
+            } else if (arg == "--bins" && count > 0) {
+                options.bins = count;
+            } else if (arg == "--histograms") {
+                options.histogram_prefix = argv[i];
+            } else if (arg == "--results") {
+                options.results_path = argv[i];
+            } else {
+                return std::nullopt;
+            }
+        }
+        return options;
+    }
+
+    /// The value below which `fraction` of the sorted `values` lie.
+    double percentile(std::vector<double> const& sorted, double fraction) {
+        auto const index = fraction * static_cast<double>(sorted.size() - 1);
+        auto const below = static_cast<size_t>(index);
+        auto const above = std::min(below + 1, sorted.size() - 1);
+        return sorted[below] + (index - below) * (sorted[above] - sorted[below]);
+    }
+
+    void print_spread(char const* name, char const* unit, std::vector<double> values) {
+        std::ranges::sort(values);
+        double sum = 0;
+        for (auto value : values) {
+            sum += value;
+        }
+        auto const mean = sum / static_cast<double>(values.size());
+        double squares = 0;
+        for (auto value : values) {
+            squares += (value - mean) * (value - mean);
+        }
+        auto const sd = std::sqrt(squares / static_cast<double>(values.size()));
+        std::printf("%-14s %.3f ± %.3f %s (min %.3f, 5%% %.3f, median %.3f, 95%% %.3f, max %.3f)\n",
+            name, mean, sd, unit, values.front(), percentile(values, 0.05),
+            percentile(values, 0.5), percentile(values, 0.95), values.back());
+    }
+
+    bool write_results(char const* path, std::vector<RunResult> const& results) {
+        auto* file = std::fopen(path, "w");
+        if (file == nullptr) {
+            std::perror(path);
+            return false;
+        }
+        std::fprintf(file, "run, impulse scale, drag scale, mass (kg), inclination (deg), "
+            "heading (deg), wind speed (m/s), wind from (deg), reached apogee, apogee (m), "
+            "apogee time (s), deployment, max mach\n");
+        for (size_t run = 0; run < results.size(); run++) {
+            auto const& [draw, flight] = results[run];
+            std::fprintf(file, "%zu,%.5f,%.5f,%.4f,%.3f,%.3f,%.3f,%.2f,%d,%.3f,%.4f,%.4f,%.4f\n",
+                run, draw.impulse, draw.drag, draw.mass, draw.inclination, draw.heading,
+                draw.wind_speed, draw.wind_from, flight.reached_apogee, flight.apogee,
+                flight.apogee_time, flight.deployment, flight.max_mach);
+        }
+        return std::fclose(file) == 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto scenario = load_calisto(options->data_dir);
+    if (!scenario.has_value()) {
+        std::fprintf(stderr, "%s\n", scenario.error().c_str());
+        return 1;
+    }
+    scenario->sampling_rate = options->brakes.sampling_rate.value_or(scenario->sampling_rate);
+    auto const dispersions = Dispersions::load(options->dispersions_path);
+    if (!dispersions.has_value()) {
+        std::fprintf(stderr, "%s\n", dispersions.error().c_str());
+        return 1;
+    }
+
+    ThreadPool pool(options->threads);
+    auto const make = controller_factory(options->brakes, *scenario);
+    auto const start = steady_clock::now();
+    auto const results = run_study(*scenario, *dispersions, options->study, make, pool);
+    auto const elapsed = duration<double>(steady_clock::now() - start).count();
+
+    std::vector<double> apogees;
+    std::vector<double> deployments;
+    size_t failed = 0;
+    for (auto const& [draw, flight] : results) {
+        if (!flight.reached_apogee) {
+            failed++;
+            continue;
+        }
+        apogees.push_back(flight.apogee);
+        deployments.push_back(flight.deployment);
+    }
+
+    std::printf("runs           %zu on %zu threads, %.0f flights/s, %llu chunks stolen\n",
+        results.size(), pool.size(), static_cast<double>(results.size()) / elapsed,
+        static_cast<unsigned long long>(pool.steals()));
+    if (failed > 0) {
+        std::printf("no apogee      %zu runs\n", failed);
+    }
+    if (apogees.empty()) {
+        return 1;
+    }
+    print_spread("apogee", "m", apogees);
+    print_spread("deployment", "", deployments);
+
+    if (options->histogram_prefix != nullptr) {
+        auto const prefix = std::string(options->histogram_prefix);
+        auto const apogee = Histogram::of(apogees, options->bins)
+            .write_csv(prefix + "apogee.csv", "apogee (m)");
+        auto const deployment = Histogram::of(deployments, options->bins, 0, 1)
+            .write_csv(prefix + "deployment.csv", "deployment");
+        for (auto const* written : { &apogee, &deployment }) {
+            if (!written->has_value()) {
+                std::fprintf(stderr, "%s\n", written->error().c_str());
+                return 1;
+            }
+        }
+    }
+    if (options->results_path != nullptr && !write_results(options->results_path, results)) {
+        return 1;
+    }
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+// Option parsing shared by the trajectory tools.
+
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "engine/apogee_controller.h"
+#include "engine/flight.h"
+#include "engine/monte_carlo.h"
+
+namespace seds::trajectory {
+    /// A whole argument as a number, or empty if it isn't one.
+    inline std::optional<double> number(char const* text) {
+        char* end;
+        auto const value = std::strtod(text, &end);
+        if (end == text || *end != '\0') {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    /// Takes --model, --method, --step or --tolerance into `solver`. Returns false if `arg` is
+    /// none of these or `text` isn't a value it takes.
+    inline bool parse_solver(std::string_view arg, char const* text, SolverConfig& solver) {
+        std::string_view const value = text;
+        if (arg == "--model" && (value == "vertical" || value == "point-mass")) {
+            solver.model = value == "vertical" ? Model::Vertical : Model::PointMass;
+        } else if (arg == "--method" && (value == "rk4" || value == "rk45")) {
+            solver.method = value == "rk4" ? Method::Rk4 : Method::Rk45;
+        } else if (arg == "--step" && number(text).value_or(0) > 0) {
+            solver.step = *number(text);
+        } else if (arg == "--tolerance" && number(text).value_or(0) > 0) {
+            solver.tolerance = *number(text);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /// The air brakes as --brakes, --target and --rate set them.
+    struct Brakes {
+        enum class Kind {
+            /// Stowed.
+            Off,
+            /// RocketPyExampleController.
+            Example,
+            /// A fixed deployment `level` after burnout.
+            Level,
+            /// The air brake computer's ApogeeTargetController, aiming for `target` m with its
+            /// apogee predictor.
+            Apogee,
+            /// The same, fitting the drag in flight and predicting with the fit.
+            ApogeeIdentified,
+            /// The same, predicting with the controller's closed form instead.
+            ApogeeClosedForm,
+        };
+
+        Kind kind = Kind::Off;
+        double level = 0;
+        double target = airbrake::ControllerConfig {}.target_apogee;
+        /// Replaces the scenario's controller sampling rate, Hz.
+        std::optional<double> sampling_rate;
+    };
+
+    /// Takes --brakes off|example|apogee|apogee-identified|apogee-closed-form|<level>,
+    /// --target <m> or --rate <Hz>
+    /// into `brakes`.
+    /// Returns false if `arg` is none of these or `text` isn't a value it takes.
+    inline bool parse_brakes(std::string_view arg, char const* text, Brakes& brakes) {
+        std::string_view const value = text;
+        if (arg == "--brakes" && value == "off") {
+            brakes.kind = Brakes::Kind::Off;
+        } else if (arg == "--brakes" && value == "example") {
+            brakes.kind = Brakes::Kind::Example;
+        } else if (arg == "--brakes" && value == "apogee") {
+            brakes.kind = Brakes::Kind::Apogee;
+        } else if (arg == "--brakes" && value == "apogee-identified") {
+            brakes.kind = Brakes::Kind::ApogeeIdentified;
+        } else if (arg == "--brakes" && value == "apogee-closed-form") {
+            brakes.kind = Brakes::Kind::ApogeeClosedForm;
+        } else if (arg == "--brakes" && number(text).value_or(-1) >= 0) {
+            brakes.kind = Brakes::Kind::Level;
+            brakes.level = *number(text);
+        } else if (arg == "--target" && number(text).has_value()) {
+            brakes.target = *number(text);
+        } else if (arg == "--rate" && number(text).value_or(0) > 0) {
+            brakes.sampling_rate = *number(text);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    /// Makes a fresh controller for `brakes` on `scenario` for each flight, since the controllers
+    /// remember earlier samples. The apogee predictor is built once, here, from the nominal
+    /// rocket, as the air brake computer's would be.
+    inline ControllerFactory controller_factory(Brakes const& brakes, Scenario const& scenario) {
+        airbrake::ControllerConfig const config {
+            .target_apogee = static_cast<float>(brakes.target),
+            .identify_drag = brakes.kind == Brakes::Kind::ApogeeIdentified,
+        };
+        switch (brakes.kind) {
+        case Brakes::Kind::Off:
+            return [] { return Controller {}; };
+        case Brakes::Kind::Example:
+            return [rate = scenario.sampling_rate] {
+                return Controller(RocketPyExampleController(rate));
+            };
+        case Brakes::Kind::Level:
+            return [level = brakes.level] {
+                return Controller([level](ControllerInput const& input) {
+                    return input.burning ? 0.0 : level;
+                });
+            };
+        case Brakes::Kind::Apogee:
+        case Brakes::Kind::ApogeeIdentified: {
+            auto const predictor =
+                std::make_shared<airbrake::ApogeePredictor const>(predictor_config(scenario));
+            return [config, predictor] {
+                return Controller(ApogeeTargetController(config, predictor));
+            };
+        }
+        case Brakes::Kind::ApogeeClosedForm:
+            return [config] { return Controller(ApogeeTargetController(config)); };
+        }
+        return [] { return Controller {}; };
+    }
+}
@@ -0,0 +1,149 @@
+// Flies the rocket from RocketPyTest (the Calisto example with a Cesaroni N2200) from ignition to
+// apogee and prints the events of the flight, optionally writing the whole trajectory as CSV.
+//
+// With --runs, the same flight is repeated to measure how many flights a second one core can
+// simulate.
+//
+//     simulate [--data <dir>] [--model vertical|point-mass] [--method rk4|rk45] [--step <s>]
+//              [--tolerance <x>]
+//              [--brakes off|example|apogee|apogee-identified|apogee-closed-form|<level>]
+//              [--target <m>] [--rate <Hz>] [--runs <n>] [--csv <file>]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+
+#include "engine/flight.h"
+#include "tools/options.h"
+
+using namespace seds::trajectory;
+using namespace std::chrono;
+
+namespace {
+    struct Options {
+        char const* data_dir = TRAJECTORY_DATA_DIR;
+        SolverConfig solver;
+        Brakes brakes;
+        int runs = 1;
+        char const* csv_path = nullptr;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: simulate [--data <dir>] [--model vertical|point-mass] [--method rk4|rk45]\n"
+            "                [--step <s>] [--tolerance <x>]\n"
+            "                [--brakes off|example|apogee|apogee-identified|\n"
+            "                          apogee-closed-form|<level>]\n"
+            "                [--target <m>] [--rate <Hz>] [--runs <n>] [--csv <file>]\n"
+            "\n"
+            "  --data       directory with the motor and drag files (default: RocketPyTest)\n"
+            "  --model      vertical (1-DOF) or point-mass (3-DOF) (default: point-mass)\n"
+            "  --method     fixed-step rk4 or adaptive rk45 (default: rk45)\n"
+            "  --step       rk4 step, or first rk45 step, in seconds (default: 0.01)\n"
+            "  --tolerance  rk45 error allowed per step (default: 1e-7)\n"
+            "  --brakes     stowed, the controller from AirbreaksDataTest.py, the air brake\n"
+            "               computer's apogee controller with its apogee predictor, with the\n"
+            "               predictor and a drag fit, or with its closed form, or a fixed\n"
+            "               deployment level from 0 to 1 after burnout\n"
+            "               (default: off)\n"
+            "  --target     apogee for --brakes apogee to aim for, m (default: 5200)\n"
+            "  --rate       controller samples per second (default: 10, as RocketPy)\n"
+            "  --runs       repeat the flight this many times and report flights per second\n"
+            "  --csv        write every step of the trajectory to this file\n");
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            i++;
+            if (arg == "--data") {
+                options.data_dir = argv[i];
+            } else if (parse_solver(arg, argv[i], options.solver)
+                || parse_brakes(arg, argv[i], options.brakes)) {
+                continue;
+            } else if (arg == "--runs" && std::atoi(argv[i]) > 0) {
+                options.runs = std::atoi(argv[i]);
+            } else if (arg == "--csv") {
+                options.csv_path = argv[i];
+            } else {
+                return std::nullopt;
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto scenario = load_calisto(options->data_dir);
+    if (!scenario.has_value()) {
+        std::fprintf(stderr, "%s\n", scenario.error().c_str());
+        return 1;
+    }
+    scenario->sampling_rate = options->brakes.sampling_rate.value_or(scenario->sampling_rate);
+
+    FILE* csv = nullptr;
+    Observer observer;
+    if (options->csv_path != nullptr) {
+        csv = std::fopen(options->csv_path, "w");
+        if (csv == nullptr) {
+            std::perror(options->csv_path);
+            return 1;
+        }
+        std::fprintf(csv, "time (s), x (m), y (m), z (m), vx (m/s), vy (m/s), vz (m/s), mach, "
+            "deployment\n");
+        observer = [csv](TrajectoryPoint const& point) {
+            std::fprintf(csv, "%.6f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.5f,%.4f\n", point.time,
+                point.position[0], point.position[1], point.position[2], point.velocity[0],
+                point.velocity[1], point.velocity[2], point.mach, point.deployment);
+        };
+    }
+
+    auto const make_controller = controller_factory(options->brakes, *scenario);
+    auto const result = simulate(*scenario, options->solver, make_controller(), observer);
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+
+    // The rest of the runs only for timing, without the CSV
+    auto const start = steady_clock::now();
+    for (int i = 1; i < options->runs; i++) {
+        auto const repeat = simulate(*scenario, options->solver, make_controller());
+        if (repeat.apogee != result.apogee) {
+            std::fprintf(stderr, "run %d reached a different apogee\n", i);
+            return 1;
+        }
+    }
+    auto const elapsed = duration<double>(steady_clock::now() - start).count();
+
+    std::printf("rail exit      %.3f s, %.1f m/s\n", result.rail_exit_time,
+        result.rail_exit_speed);
+    std::printf("burnout        %.3f s, %.1f m, %.1f m/s\n", result.burn_out_time,
+        result.burn_out_altitude, result.burn_out_speed);
+    std::printf("max speed      %.1f m/s, Mach %.3f\n", result.max_speed, result.max_mach);
+    if (result.reached_apogee) {
+        std::printf("apogee         %.2f m above the pad, %.3f s after ignition\n",
+            result.apogee, result.apogee_time);
+        std::printf("air brakes     %.3f deployed at apogee\n", result.deployment);
+    } else {
+        std::printf("apogee         not reached in %.0f s\n", options->solver.max_time);
+    }
+    std::printf("steps          %u accepted, %u rejected, %u evaluations\n", result.steps,
+        result.rejected_steps, result.evaluations);
+    if (options->runs > 1) {
+        std::printf("speed          %.0f flights/s over %d runs\n", (options->runs - 1) / elapsed,
+            options->runs);
+    }
+    return result.reached_apogee ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+# Turns the RocketPyTest rocket's power-off drag curve and air brake drag coefficients into
+# airbrake/drag_data.h, as constexpr arrays that airbrake/drag_tables.h builds its tables from at
+# compile time. The curves end up in flash, and editing a CSV file regenerates the header.
+#
+#     include(<this file>)
+#     airbrake_drag_data(<output directory>)
+#
+# then put <output directory> on the include path.
+
+set(AIRBRAKE_DRAG_DATA_DIR ${CMAKE_CURRENT_LIST_DIR}/../RocketPy/RocketPyTest)
+
+# Sets `out` to the rows of a CSV file of numbers as C++ initializers, one per line, skipping any
+# line that doesn't start with a number (the header).
+function(airbrake_csv_rows path out)
+    file(STRINGS ${path} lines)
+    set(rows "")
+    foreach(line IN LISTS lines)
+        string(REPLACE " " "" line "${line}")
+        if(NOT line MATCHES "^[-+.0-9]")
+            continue()
+        endif()
+        string(REPLACE "," ", " line "${line}")
+        string(APPEND rows "        { ${line} },\n")
+    endforeach()
+    set(${out} "${rows}" PARENT_SCOPE)
+endfunction()
+
+function(airbrake_drag_data output_dir)
+    set(power_off ${AIRBRAKE_DRAG_DATA_DIR}/powerOffDragCurve.csv)
+    set(air_brakes ${AIRBRAKE_DRAG_DATA_DIR}/air_brakes_cd.csv)
+    airbrake_csv_rows(${power_off} power_off_rows)
+    airbrake_csv_rows(${air_brakes} air_brake_rows)
+
+    set(content "#pragma once
+
+// Generated by airbrake-computer/drag_data.cmake from powerOffDragCurve.csv and air_brakes_cd.csv
+// in RocketPy/RocketPyTest. Edit those instead.
+
+namespace seds::airbrake::drag_data {
+    struct CurvePoint {
+        double mach;
+        double cd;
+    };
+
+    struct BrakePoint {
+        double deployment;
+        double mach;
+        double cd;
+    };
+
+    /// The airframe's drag coefficient after burnout, by Mach number.
+    inline constexpr CurvePoint POWER_OFF[] = {
+${power_off_rows}    };
+
+    /// The air brakes' drag coefficient against their own reference area, scattered over
+    /// deployment level and Mach number.
+    inline constexpr BrakePoint AIR_BRAKES[] = {
+${air_brake_rows}    };
+}
+")
+    # Only touch the header when it changes, so a reconfigure doesn't rebuild everything
+    file(WRITE ${output_dir}/airbrake/drag_data.h.new "${content}")
+    configure_file(${output_dir}/airbrake/drag_data.h.new ${output_dir}/airbrake/drag_data.h
+        COPYONLY)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${power_off} ${air_brakes})
+endfunction()
@@ -0,0 +1,157 @@
+#pragma once
+
+// The air brake controller, header-only so the same code builds into the air brake computer's
+// firmware and into the trajectory engine (RocketPy/trajectory), where it is tuned. It takes the
+// flight computer's estimates, so flight-computer/esp-idf-port/main has to be on the include
+// path too.
+//
+// Everything is float, which the ESP32's FPU does in hardware, and nothing is allocated.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "airbrake/apogee_predictor.h"
+#include "airbrake/drag_identifier.h"
+#include "estimation/estimate.h"
+
+namespace seds::airbrake {
+    struct ControllerConfig {
+        /// Apogee to aim for, m above the pad. The default suits the RocketPyTest rocket, which
+        /// reaches about 5300 m with the brakes stowed.
+        float target_apogee = 5200.0f;
+        /// How fast to open the brakes for each metre the predicted apogee is over the target,
+        /// in deployment levels per second. Negative errors close them the same way.
+        float gain = 0.01f;
+        /// Fastest the brakes may open or close, deployment levels per second, the same as
+        /// AirbreaksDataTest.py.
+        float max_rate = 0.2f;
+        /// Below this vertical velocity, m/s, apogee is close enough that the brakes are closed
+        /// again rather than steered by a prediction that is mostly noise.
+        float min_velocity = 10.0f;
+        /// The longest gap between updates that counts in full, s. A longer gap (a stalled
+        /// task) doesn't let the brakes jump.
+        float max_step = 0.1f;
+        /// Whether to fit the drag in flight (DragIdentifier) and predict with the fit rather
+        /// than the tables alone. Only with an ApogeePredictor.
+        bool identify_drag = false;
+    };
+
+    /// Steers the predicted apogee onto a target by opening and closing the air brakes.
+    ///
+    /// Each update predicts the apogee from the estimate, taking the drag as it is now and
+    /// scaling it with the square of the speed. With k the drag deceleration per (m/s)², that
+    /// coast has a closed form:
+    ///
+    ///     apogee = h + ln(1 + k v² / g) / 2k
+    ///
+    /// The deployment then moves at `gain` times the error, rate limited to `max_rate` and
+    /// clamped to 0..1, so it settles wherever the prediction meets the target. Only while
+    /// coasting upward; otherwise the brakes close, at the same rate limit.
+    ///
+    /// An update is a fixed handful of float operations and one log1pf with no loops, so it
+    /// costs about the same every call. Run it at 100 Hz or more.
+    ///
+    /// The closed form reads low through the transonic drag rise. Given an ApogeePredictor, the
+    /// controller asks that instead, with the brakes held where they are: a fixed 128 drag
+    /// evaluations per update, against the real drag curves. The predictor has to outlive it.
+    /// With `identify_drag`, every steering update also fits the drag curves' scales to the
+    /// measured drag first, and the prediction uses them.
+    class ApogeeController {
+    public:
+        ApogeeController() : ApogeeController(ControllerConfig {}) {}
+        explicit ApogeeController(ControllerConfig const& config) : config(config) {}
+        ApogeeController(ControllerConfig const& config, ApogeePredictor const& predictor)
+            : config(config), predictor(&predictor) {}
+
+        /// Forget the last update and close the brakes.
+        void reset() {
+            this->level = 0;
+            this->predicted = 0;
+            this->last_ms = -1;
+            this->identifier.reset();
+        }
+
+        /// Advance to `estimate`, where `coasting` says the motor has burned out and the rocket
+        /// is still going up (FlightPhase::Coast on the flight computer). Returns the new
+        /// deployment level, 0 to 1.
+        float update(estimation::Estimate const& estimate, bool coasting) {
+            auto const step = this->last_ms < 0 ? 0.0f
+                : std::clamp(static_cast<float>(estimate.time_ms - this->last_ms) * 0.001f, 0.0f,
+                    this->config.max_step);
+            this->last_ms = estimate.time_ms;
+            auto const steering = coasting && estimate.velocity > this->config.min_velocity;
+
+            if (this->predictor == nullptr) {
+                this->predicted = predict_apogee(estimate);
+            } else {
+                if (steering && this->config.identify_drag) {
+                    // The drag as the accelerometers measure it. The filter's bias soaks up the
+                    // barometers' errors through the coast, so it's added back.
+                    auto const drag =
+                        -(estimate.acceleration + estimate.accel_bias) - estimation::GRAVITY;
+                    this->identifier.update(estimate.time_ms, estimate.velocity, drag,
+                        this->predictor->regressors(estimate.altitude, estimate.velocity,
+                            this->level));
+                }
+                this->predicted =
+                    this->predictor->predict(estimate, this->level, this->identifier.scales());
+            }
+
+            auto const rate = steering
+                ? this->config.gain * (this->predicted - this->config.target_apogee)
+                : -this->config.max_rate;
+            auto const change = std::clamp(rate, -this->config.max_rate, this->config.max_rate);
+            this->level = std::clamp(this->level + change * step, 0.0f, 1.0f);
+            return this->level;
+        }
+
+        /// The deployment level from the last update.
+        [[nodiscard]]
+        float deployment() const {
+            return this->level;
+        }
+
+        /// The apogee the last update predicted, m above the pad.
+        [[nodiscard]]
+        float predicted_apogee() const {
+            return this->predicted;
+        }
+
+        /// The drag fit so far, which stays at the tables' own scales without `identify_drag`.
+        [[nodiscard]]
+        DragIdentifier const& drag_identifier() const {
+            return this->identifier;
+        }
+
+        [[nodiscard]]
+        ControllerConfig const& configuration() const {
+            return this->config;
+        }
+
+        /// Where a coast from `estimate` tops out with the drag it has now, m above the pad. The
+        /// altitude itself once the rocket is no longer going up.
+        [[nodiscard]]
+        static float predict_apogee(estimation::Estimate const& estimate) {
+            auto const v = std::max(estimate.velocity, 0.0f);
+            auto const v2 = v * v;
+            // What's left of the acceleration after gravity is drag, and never negative
+            auto const drag = std::max(-estimate.acceleration - estimation::GRAVITY, 0.0f);
+            // Below this the closed form loses its digits; the vacuum answer is as good there
+            constexpr float MIN_DRAG = 1e-6f;
+            auto const k = drag / std::max(v2, 1.0f);
+            auto const coast = k > MIN_DRAG
+                ? std::log1p(k * v2 / estimation::GRAVITY) / (2 * k)
+                : v2 / (2 * estimation::GRAVITY);
+            return estimate.altitude + coast;
+        }
+
+    private:
+        ControllerConfig config;
+        ApogeePredictor const* predictor = nullptr;
+        DragIdentifier identifier;
+        float level = 0;
+        float predicted = 0;
+        int64_t last_ms = -1;
+    };
+}
@@ -0,0 +1,226 @@
+#pragma once
+
+// The apogee predictor the air brake controller asks every cycle. Header-only and float, like
+// the controller, with fixed-size tables and a fixed amount of work per prediction.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "airbrake/drag_tables.h"
+#include "estimation/estimate.h"
+
+namespace seds::airbrake {
+    /// The rocket as it coasts. The defaults are the RocketPyTest rocket, whose drag curves are
+    /// the ones in drag_tables.h.
+    struct PredictorConfig {
+        /// After burnout, kg.
+        float mass = 16.241f;
+        /// The airframe's drag reference area, m².
+        float area = 0.012668f;
+        /// The air brakes' reference area, m². RocketPy uses the airframe's when it's given none.
+        float brake_area = 0.012668f;
+        /// Multiplies the airframe's drag curve, to match it to flight data.
+        float drag_scale = 1;
+        /// Height of the pad above sea level, m, where the standard atmosphere is read from.
+        float pad_elevation = 1400;
+        /// m/s². The RocketPyTest site's, 33°N, at about the middle of the coast.
+        float gravity = 9.784f;
+    };
+
+    /// Multipliers on the predictor's drag tables, which DragIdentifier fits in flight.
+    struct DragScales {
+        float body = 1;
+        float brakes = 1;
+    };
+
+    /// The drag deceleration each of the predictor's tables accounts for at one state, m/s².
+    struct DragRegressors {
+        float body;
+        float brakes;
+    };
+
+    /// Predicts the apogee by flying a reduced ballistic model forward from the current
+    /// altitude and vertical velocity: straight up, through the standard atmosphere, with the
+    /// drag of the airframe and of the air brakes held at one deployment level.
+    ///
+    /// The model is integrated with speed as the independent variable rather than time, so a
+    /// prediction is always STEPS classic Runge-Kutta steps from the current speed down to zero,
+    /// however far away apogee is: 4 × STEPS lookups and a division each, and nothing else.
+    /// That's about 12 000 cycles on an x86 host, against the 160 000 a 1 ms control cycle has
+    /// at 160 MHz (see BM_ApogeePredictor in flight_bench, and CONFIG_SEDS_AIRBRAKE_TIMING for
+    /// the figure on the board). Fewer steps lose accuracy fast: 16 are 3 m off the engine's
+    /// vertical flights, against 1.5 m for 32.
+    ///
+    /// Construction scales the drag coefficients of drag_tables.h by the reference areas and
+    /// mass into deceleration per unit of density and speed², by Mach number: one table for the
+    /// airframe and one per deployment level for the air brakes. A prediction blends them into
+    /// the one table it looks up. Construction also tabulates the atmosphere above the pad, so
+    /// no transcendental is left in a prediction.
+    class ApogeePredictor {
+    public:
+        /// Runge-Kutta steps per prediction.
+        static constexpr size_t STEPS = 32;
+        /// The atmosphere is tabulated every ALTITUDE_STEP m up to 12 km above the pad.
+        static constexpr float ALTITUDE_STEP = 100;
+        static constexpr size_t ALTITUDE_POINTS = 121;
+
+        ApogeePredictor() : ApogeePredictor(PredictorConfig {}) {}
+
+        explicit ApogeePredictor(PredictorConfig const& config) : config(config) {
+            // The International Standard Atmosphere's troposphere and the isothermal layer
+            // above it, which covers 12 km above any pad we'd fly from
+            constexpr double gas_constant = 287.05287;
+            constexpr double sea_level_temperature = 288.15;
+            constexpr double lapse_rate = -0.0065;
+            constexpr double tropopause = 11000;
+            constexpr double exponent = -estimation::GRAVITY / (gas_constant * lapse_rate);
+            constexpr double tropopause_temperature =
+                sea_level_temperature + lapse_rate * tropopause;
+            for (size_t i = 0; i < ALTITUDE_POINTS; i++) {
+                auto const height = config.pad_elevation + static_cast<double>(i) * ALTITUDE_STEP;
+                auto const temperature =
+                    std::max(sea_level_temperature + lapse_rate * height, tropopause_temperature);
+                auto pressure = 101325
+                    * std::pow(tropopause_temperature / sea_level_temperature, exponent)
+                    * std::exp(-estimation::GRAVITY * (height - tropopause)
+                        / (gas_constant * tropopause_temperature));
+                if (height < tropopause) {
+                    pressure = 101325 * std::pow(temperature / sea_level_temperature, exponent);
+                }
+                this->density[i] = static_cast<float>(pressure / (gas_constant * temperature));
+                this->inverse_sound[i] =
+                    static_cast<float>(1 / std::sqrt(1.4 * gas_constant * temperature));
+            }
+
+            for (size_t i = 0; i < drag_tables::MACH_POINTS; i++) {
+                this->body[i] =
+                    config.drag_scale * drag_tables::BODY[i] * config.area / (2 * config.mass);
+            }
+            for (size_t level = 0; level < drag_tables::DEPLOYMENT_LEVELS; level++) {
+                for (size_t i = 0; i < drag_tables::MACH_POINTS; i++) {
+                    this->brakes[level][i] =
+                        drag_tables::BRAKES[level][i] * config.brake_area / (2 * config.mass);
+                }
+            }
+        }
+
+        /// The apogee, m above the pad, of a coast from `altitude` (m above the pad) at
+        /// `velocity` (m/s, up) with the air brakes held at `deployment` (0 to 1), and the drag
+        /// tables multiplied by `scales`. Just the altitude once the rocket is going down.
+        [[nodiscard]]
+        float predict(float altitude, float velocity, float deployment,
+            DragScales const& scales = {}) const {
+            if (!(velocity > 0)) {
+                return altitude;
+            }
+
+            // The coast table for this deployment: the airframe's plus a blend of the two brake
+            // levels either side of it
+            auto const [level, fraction] = blend(deployment);
+            auto const& low = this->brakes[level];
+            auto const& high = this->brakes[level + 1];
+            drag_tables::Row coast;
+            for (size_t i = 0; i < drag_tables::MACH_POINTS; i++) {
+                coast[i] = scales.body * this->body[i]
+                    + scales.brakes * (low[i] + fraction * (high[i] - low[i]));
+            }
+
+            // dh/ds = v / deceleration, where s is the speed lost so far and v = v0 - s
+            auto const ds = velocity / STEPS;
+            auto const rise = [&](float height, float speed) {
+                auto const air = this->air(height);
+                auto const drag = drag_tables::lookup(coast, speed * air.inverse_sound);
+                return speed / (this->config.gravity + drag * air.density * speed * speed);
+            };
+            auto height = altitude;
+            auto speed = velocity;
+            for (size_t i = 0; i < STEPS; i++) {
+                auto const half = speed - 0.5f * ds;
+                auto const end = speed - ds;
+                auto const k1 = rise(height, speed);
+                auto const k2 = rise(height + 0.5f * ds * k1, half);
+                auto const k3 = rise(height + 0.5f * ds * k2, half);
+                auto const k4 = rise(height + ds * k3, std::max(end, 0.0f));
+                height += ds / 6 * (k1 + 2 * k2 + 2 * k3 + k4);
+                speed = end;
+            }
+            return height;
+        }
+
+        [[nodiscard]]
+        float predict(estimation::Estimate const& estimate, float deployment,
+            DragScales const& scales = {}) const {
+            return this->predict(estimate.altitude, estimate.velocity, deployment, scales);
+        }
+
+        /// The drag deceleration, m/s², that the airframe's and the air brakes' tables each give
+        /// at `altitude` (m above the pad) and `speed` (m/s) with the brakes at `deployment`:
+        /// what DragIdentifier fits their scales against.
+        [[nodiscard]]
+        DragRegressors regressors(float altitude, float speed, float deployment) const {
+            auto const air = this->air(altitude);
+            auto const mach = speed * air.inverse_sound;
+            auto const pressure = air.density * speed * speed;
+            auto const [level, fraction] = blend(deployment);
+            auto const low = drag_tables::lookup(this->brakes[level], mach);
+            auto const high = drag_tables::lookup(this->brakes[level + 1], mach);
+            return {
+                .body = pressure * drag_tables::lookup(this->body, mach),
+                .brakes = pressure * (low + fraction * (high - low)),
+            };
+        }
+
+        [[nodiscard]]
+        PredictorConfig const& configuration() const {
+            return this->config;
+        }
+
+    private:
+        struct Air {
+            /// kg/m³
+            float density;
+            /// 1 / the speed of sound, s/m.
+            float inverse_sound;
+        };
+
+        struct Blend {
+            size_t level;
+            float fraction;
+        };
+
+        /// The air at `altitude`, m above the pad.
+        Air air(float altitude) const {
+            constexpr auto per_step = 1 / ALTITUDE_STEP;
+            auto const position = std::clamp(altitude * per_step, 0.0f,
+                static_cast<float>(ALTITUDE_POINTS - 1));
+            auto const i = std::min(static_cast<size_t>(position), ALTITUDE_POINTS - 2);
+            auto const fraction = position - static_cast<float>(i);
+            return {
+                .density = this->density[i] + fraction * (this->density[i + 1] - this->density[i]),
+                .inverse_sound = this->inverse_sound[i]
+                    + fraction * (this->inverse_sound[i + 1] - this->inverse_sound[i]),
+            };
+        }
+
+        /// The brake levels either side of `deployment`, as the lower one and how far to the
+        /// next.
+        static Blend blend(float deployment) {
+            constexpr auto last_level = static_cast<float>(drag_tables::DEPLOYMENT_LEVELS - 1);
+            auto const position = std::clamp(deployment, 0.0f, 1.0f) * last_level;
+            auto const level = std::min(static_cast<size_t>(position),
+                drag_tables::DEPLOYMENT_LEVELS - 2);
+            return { level, position - static_cast<float>(level) };
+        }
+
+        PredictorConfig config;
+        std::array<float, ALTITUDE_POINTS> density {};
+        /// 1 / the speed of sound, s/m.
+        std::array<float, ALTITUDE_POINTS> inverse_sound {};
+        /// The airframe's deceleration per kg/m³ of air and (m/s)² of speed, by Mach number.
+        drag_tables::Row body {};
+        /// The same for the air brakes, by deployment level then Mach number.
+        std::array<drag_tables::Row, drag_tables::DEPLOYMENT_LEVELS> brakes {};
+    };
+}
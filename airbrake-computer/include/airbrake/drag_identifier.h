@@ -0,0 +1,146 @@
+#pragma once
+
+// Fits the rocket's drag in flight, so the apogee predictor flies the real vehicle instead of the
+// drag curves it was built with. Header-only and float, like the controller and the predictor.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "airbrake/apogee_predictor.h"
+
+namespace seds::airbrake {
+    struct IdentifierConfig {
+        /// How long the fit remembers, s: a sample this old counts e⁻¹ as much as a new one.
+        float memory = 5;
+        /// Standard deviation of the measured drag deceleration, m/s².
+        float noise = 1;
+        /// Standard deviation of each scale before any samples, around 1. The uncertainty never
+        /// grows past it, however long a scale goes unseen.
+        float prior = 0.5f;
+        /// Below this vertical velocity, m/s, drag is too small to measure against the
+        /// accelerometers' bias, and samples are ignored.
+        float min_speed = 50;
+        /// The scales are reported within these, so a bad stretch of data can't take the
+        /// predictor anywhere absurd.
+        float min_scale = 0.25f;
+        float max_scale = 4;
+    };
+
+    /// Identifies the airframe's effective drag coefficient and the air brakes' increment over
+    /// it by recursive least squares, as multipliers on the predictor's tables (DragScales).
+    ///
+    /// Each coasting sample gives the drag deceleration, measured as the estimated acceleration
+    /// less gravity, and the predictor's regressors: the deceleration the airframe's and the
+    /// brakes' tables give at that altitude, speed and deployment. The fit is linear in the two
+    /// scales:
+    ///
+    ///     drag = body scale × body regressor + brake scale × brake regressor
+    ///
+    /// so an update is a 2×2 covariance update: about 30 float operations, and the same every
+    /// sample. The brake regressor is zero while they're stowed, which leaves the brake scale
+    /// alone until they open. Old samples are forgotten exponentially, so the fit follows the
+    /// drag as it changes through the coast.
+    ///
+    /// It sees vertical speed only, like the predictor, so off vertical the body scale also
+    /// takes up the difference between the rocket's airspeed and its vertical speed. That is
+    /// the error the predictor makes, so the prediction still improves.
+    class DragIdentifier {
+    public:
+        DragIdentifier() : DragIdentifier(IdentifierConfig {}) {}
+
+        explicit DragIdentifier(IdentifierConfig const& config) : config(config) {
+            this->reset();
+        }
+
+        /// Back to the tables as they are, with the prior uncertainty.
+        void reset() {
+            auto const prior = this->config.prior * this->config.prior;
+            this->theta[0] = 1;
+            this->theta[1] = 1;
+            this->p00 = prior;
+            this->p01 = 0;
+            this->p11 = prior;
+            this->last_ms = -1;
+            this->count = 0;
+        }
+
+        /// Fit the drag deceleration `drag` (m/s²) measured at `time_ms` against `regressors`
+        /// from ApogeePredictor::regressors at `velocity`. Returns whether the sample was used.
+        bool update(int64_t time_ms, float velocity, float drag, DragRegressors const& regressors) {
+            if (!(velocity > this->config.min_speed) || !std::isfinite(drag)) {
+                return false;
+            }
+
+            // Forget: inflate the covariance by the time since the last sample, up to the prior
+            auto const prior = this->config.prior * this->config.prior;
+            if (this->last_ms >= 0 && time_ms > this->last_ms) {
+                auto const step = static_cast<float>(time_ms - this->last_ms) * 0.001f;
+                auto const forget = 1 + std::min(step / this->config.memory, 1.0f);
+                this->p00 = std::min(this->p00 * forget, prior);
+                this->p11 = std::min(this->p11 * forget, prior);
+                auto const bound = std::sqrt(this->p00 * this->p11);
+                this->p01 = std::clamp(this->p01 * forget, -bound, bound);
+            }
+            this->last_ms = time_ms;
+
+            auto const x0 = regressors.body;
+            auto const x1 = regressors.brakes;
+            auto const px0 = this->p00 * x0 + this->p01 * x1;
+            auto const px1 = this->p01 * x0 + this->p11 * x1;
+            auto const innovation_variance =
+                this->config.noise * this->config.noise + x0 * px0 + x1 * px1;
+            auto const error = drag - (this->theta[0] * x0 + this->theta[1] * x1);
+            auto const k0 = px0 / innovation_variance;
+            auto const k1 = px1 / innovation_variance;
+
+            this->theta[0] += k0 * error;
+            this->theta[1] += k1 * error;
+            // P - K xᵀP, kept symmetric and positive
+            constexpr float min_variance = 1e-9f;
+            this->p00 = std::max(this->p00 - k0 * px0, min_variance);
+            this->p01 = this->p01 - k0 * px1;
+            this->p11 = std::max(this->p11 - k1 * px1, min_variance);
+            this->count++;
+            return true;
+        }
+
+        /// The scales fitted so far, for ApogeePredictor::predict, within the configured bounds.
+        /// Only the answer is clamped, not the fit: the two scales are strongly correlated, and
+        /// holding one at a bound would drive the other the wrong way.
+        [[nodiscard]]
+        DragScales scales() const {
+            return {
+                .body = std::clamp(this->theta[0], this->config.min_scale, this->config.max_scale),
+                .brakes = std::clamp(this->theta[1], this->config.min_scale, this->config.max_scale),
+            };
+        }
+
+        /// The standard deviation of each scale.
+        [[nodiscard]]
+        DragScales uncertainty() const {
+            return { .body = std::sqrt(this->p00), .brakes = std::sqrt(this->p11) };
+        }
+
+        /// The samples fitted since the last reset.
+        [[nodiscard]]
+        uint32_t samples() const {
+            return this->count;
+        }
+
+        [[nodiscard]]
+        IdentifierConfig const& configuration() const {
+            return this->config;
+        }
+
+    private:
+        IdentifierConfig config;
+        float theta[2] = {};
+        /// The covariance of the scales, which is symmetric.
+        float p00 = 0;
+        float p01 = 0;
+        float p11 = 0;
+        int64_t last_ms = -1;
+        uint32_t count = 0;
+    };
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+// The drag coefficients the apogee predictor flies with, resampled at compile time from the
+// curves in airbrake/drag_data.h (generated from the RocketPy files by drag_data.cmake) onto
+// evenly spaced Mach numbers and deployment levels, so a lookup is two multiplies, a truncation
+// and a lerp.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "airbrake/drag_data.h"
+
+namespace seds::airbrake::drag_tables {
+    /// Mach numbers from 0 to MAX_MACH, every MACH_STEP. The RocketPy curves are given every
+    /// 0.1, which these land on exactly.
+    constexpr double MACH_STEP = 0.05;
+    constexpr double MAX_MACH = 3.0;
+    constexpr size_t MACH_POINTS = 61;
+
+    /// Deployment levels from 0 to 1, every 1 / (DEPLOYMENT_LEVELS - 1).
+    constexpr size_t DEPLOYMENT_LEVELS = 11;
+
+    using Row = std::array<float, MACH_POINTS>;
+
+    namespace detail {
+        constexpr double sqrt(double x) {
+            if (x <= 0) {
+                return 0;
+            }
+            double root = x > 1 ? x : 1;
+            for (int i = 0; i < 60; i++) {
+                root = 0.5 * (root + x / root);
+            }
+            return root;
+        }
+
+        constexpr double abs(double x) {
+            return x < 0 ? -x : x;
+        }
+
+        /// The power-off curve at `mach`, linear between its points and constant past its
+        /// ends, as RocketPy and the trajectory engine read it.
+        constexpr double body_cd(double mach) {
+            auto const& curve = drag_data::POWER_OFF;
+            constexpr size_t points = std::size(drag_data::POWER_OFF);
+            if (mach <= curve[0].mach) {
+                return curve[0].cd;
+            }
+            for (size_t i = 1; i < points; i++) {
+                if (mach <= curve[i].mach) {
+                    auto const fraction = (mach - curve[i - 1].mach)
+                        / (curve[i].mach - curve[i - 1].mach);
+                    return curve[i - 1].cd + fraction * (curve[i].cd - curve[i - 1].cd);
+                }
+            }
+            return curve[points - 1].cd;
+        }
+
+        /// The air brakes at (`deployment`, `mach`) by RocketPy's Shepard interpolation
+        /// (distance⁻³ weights), and nothing at all when stowed.
+        constexpr double brake_cd(double deployment, double mach) {
+            if (deployment <= 0) {
+                return 0;
+            }
+            double weighted = 0;
+            double weights = 0;
+            for (auto const& point : drag_data::AIR_BRAKES) {
+                auto const dx = point.deployment - deployment;
+                auto const dy = point.mach - mach;
+                auto const distance_squared = dx * dx + dy * dy;
+                if (distance_squared == 0) {
+                    return point.cd;
+                }
+                auto const weight = 1 / (distance_squared * sqrt(distance_squared));
+                weighted += weight * point.cd;
+                weights += weight;
+            }
+            return weighted / weights;
+        }
+
+        constexpr double mach_at(size_t i) {
+            return static_cast<double>(i) * MACH_STEP;
+        }
+
+        constexpr double deployment_at(size_t level) {
+            return static_cast<double>(level) / (DEPLOYMENT_LEVELS - 1);
+        }
+
+        constexpr Row build_body() {
+            Row row {};
+            for (size_t i = 0; i < MACH_POINTS; i++) {
+                row[i] = static_cast<float>(body_cd(mach_at(i)));
+            }
+            return row;
+        }
+
+        constexpr std::array<Row, DEPLOYMENT_LEVELS> build_brakes() {
+            std::array<Row, DEPLOYMENT_LEVELS> rows {};
+            for (size_t level = 0; level < DEPLOYMENT_LEVELS; level++) {
+                for (size_t i = 0; i < MACH_POINTS; i++) {
+                    auto const cd = brake_cd(deployment_at(level), mach_at(i));
+                    rows[level][i] = static_cast<float>(cd);
+                }
+            }
+            return rows;
+        }
+    }
+
+    /// The airframe after burnout, by Mach number.
+    inline constexpr Row BODY = detail::build_body();
+    /// The air brakes against their own reference area, by deployment level then Mach number.
+    inline constexpr std::array<Row, DEPLOYMENT_LEVELS> BRAKES = detail::build_brakes();
+
+    namespace detail {
+        /// Whether every point of the RocketPy files that lies on the grid comes through to
+        /// float precision.
+        constexpr bool reproduces_data() {
+            for (auto const& point : drag_data::POWER_OFF) {
+                auto const i = static_cast<size_t>(point.mach / MACH_STEP + 0.5);
+                if (i < MACH_POINTS && abs(mach_at(i) - point.mach) < 1e-9
+                    && abs(BODY[i] - point.cd) > 1e-6) {
+                    return false;
+                }
+            }
+            for (auto const& point : drag_data::AIR_BRAKES) {
+                auto const i = static_cast<size_t>(point.mach / MACH_STEP + 0.5);
+                auto const level =
+                    static_cast<size_t>(point.deployment * (DEPLOYMENT_LEVELS - 1) + 0.5);
+                auto const on_grid = abs(deployment_at(level) - point.deployment) < 1e-9
+                    && abs(mach_at(i) - point.mach) < 1e-9;
+                if (level > 0 && on_grid && abs(BRAKES[level][i] - point.cd) > 1e-6) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static_assert(mach_at(MACH_POINTS - 1) == MAX_MACH, "the Mach grid must end at MAX_MACH");
+        static_assert(reproduces_data(), "the drag tables lost a point of the RocketPy curves");
+    }
+
+    /// `row` at `mach`, linear between points and constant past the ends.
+    [[nodiscard]]
+    inline float lookup(Row const& row, float mach) {
+        constexpr auto per_step = static_cast<float>(1 / MACH_STEP);
+        auto const position =
+            std::min(std::max(mach * per_step, 0.0f), static_cast<float>(MACH_POINTS - 1));
+        auto const i = std::min(static_cast<size_t>(position), MACH_POINTS - 2);
+        auto const fraction = position - static_cast<float>(i);
+        return row[i] + fraction * (row[i + 1] - row[i]);
+    }
+}
@@ -0,0 +1,332 @@
+// Antenna tracking: flies the RocketPyTest rocket with the trajectory engine, sends its telemetry
+// down as the flight computer would, through the frame encoder, with noisy sensors and a link
+// that delays every frame, and checks that the tracker keeps the antenna on the rocket. Also
+// what a pointing costs.
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "engine/flight.h"
+#include "tracking/tracker.h"
+
+namespace seds::tracking {
+    namespace {
+        using namespace seds::telemetry;
+
+        /// The Calisto example's pad at Spaceport America. The trajectory engine only needs its
+        /// latitude and elevation; the longitude is RocketPy's.
+        constexpr double PAD_LONGITUDE = -106.974998;
+        /// The antenna, east and north of the pad, m. Close enough that boost sweeps the
+        /// elevation quickly, and to the side of the rail's heading so azimuth moves too.
+        constexpr double SITE_EAST = 800;
+        constexpr double SITE_NORTH = -600;
+
+        /// The link: the least a frame takes, and at most how much longer it can take, s.
+        constexpr double LINK_LATENCY = 0.08;
+        constexpr double LINK_JITTER = 0.04;
+        constexpr double ACTUATION_LATENCY = 0.1;
+        /// The ground's clock less the flight computer's, s. Anything; the tracker has to find it.
+        constexpr double CLOCK_OFFSET = 5000;
+        /// Telemetry before ignition, s, to settle the filters and clocks on the pad.
+        constexpr double PAD_TIME = 5;
+        /// The mount's command rate, Hz.
+        constexpr double COMMAND_RATE = 100;
+        /// Worst error allowed once the tracker knows the rocket is flying, degrees: a quarter of
+        /// a narrow 10° beam.
+        constexpr double MAX_ERROR = 2.5;
+
+        /// The true flight, every millisecond from ignition to apogee, with the pad before it.
+        struct Truth {
+            std::vector<trajectory::TrajectoryPoint> points;
+            double burn_out_time = 0;
+
+            /// Position, velocity and acceleration from the pad at `time` since ignition.
+            [[nodiscard]]
+            std::array<Enu, 3> at(double time) const {
+                if (time <= 0) {
+                    return {};
+                }
+                auto const after = std::ranges::upper_bound(this->points, time, {},
+                    &trajectory::TrajectoryPoint::time);
+                auto const i = std::min(
+                    static_cast<size_t>(std::max(after - this->points.begin() - 1, ptrdiff_t(0))),
+                    this->points.size() - 3);
+                auto const& a = this->points[i];
+                auto const& b = this->points[i + 1];
+                auto const& c = this->points[i + 2];
+                auto const f = std::clamp((time - a.time) / (b.time - a.time), 0.0, 1.0);
+                std::array<Enu, 3> result;
+                for (size_t axis = 0; axis < 3; axis++) {
+                    result[0][axis] = a.position[axis] + f * (b.position[axis] - a.position[axis]);
+                    result[1][axis] = a.velocity[axis] + f * (b.velocity[axis] - a.velocity[axis]);
+                    auto const before = (b.velocity[axis] - a.velocity[axis]) / (b.time - a.time);
+                    auto const after = (c.velocity[axis] - b.velocity[axis]) / (c.time - b.time);
+                    result[2][axis] = before + f * (after - before);
+                }
+                return result;
+            }
+
+            [[nodiscard]]
+            double end() const {
+                return this->points.back().time;
+            }
+        };
+
+        /// The RocketPyTest rocket to apogee, flown once. Empty if it couldn't be.
+        Truth const& truth() {
+            static auto const flight = [] {
+                Truth truth;
+                auto const scenario = trajectory::load_calisto(TRAJECTORY_DATA_DIR);
+                if (!scenario.has_value()) {
+                    return truth;
+                }
+                auto const result = trajectory::simulate(*scenario,
+                    trajectory::SolverConfig { .method = trajectory::Method::Rk4, .step = 0.001 },
+                    {}, [&](trajectory::TrajectoryPoint const& point) {
+                        truth.points.push_back(point);
+                    });
+                if (!result.reached_apogee || truth.points.size() < 3) {
+                    truth.points.clear();
+                }
+                truth.burn_out_time = result.burn_out_time;
+                return truth;
+            }();
+            return flight;
+        }
+
+        Geodetic pad() {
+            return { .latitude = 32.990254, .longitude = PAD_LONGITUDE, .altitude = 1400 };
+        }
+
+        TrackerConfig config() {
+            LocalFrame const pad_frame(pad());
+            return {
+                .site = pad_frame.to_geodetic({ SITE_EAST, SITE_NORTH, 0 }),
+                .pad = pad(),
+                .link_latency = LINK_LATENCY,
+                .actuation_latency = ACTUATION_LATENCY,
+            };
+        }
+
+        /// What came down the link: a frame and when it was decoded, on the ground's clock.
+        struct Received {
+            Frame frame;
+            double arrival;
+        };
+
+        /// The telemetry of `truth` at `rate` frames a second, as decoded on the ground. The
+        /// flight computer's altitude, velocity and acceleration and the GPS are the truth plus
+        /// noise, and the GPS goes down at most once a second, as the Downlink budgets it.
+        std::vector<Received> downlink(Truth const& truth, double rate, uint32_t seed) {
+            LocalFrame const pad_frame(pad());
+            std::mt19937 rng(seed);
+            std::normal_distribution<double> noise;
+            std::uniform_real_distribution<double> jitter(0, LINK_JITTER);
+            auto const gps_every = std::max(1, static_cast<int>(std::lround(rate)));
+
+            std::vector<Received> received;
+            auto const count = static_cast<int>((PAD_TIME + truth.end()) * rate);
+            for (int n = 0; n < count; n++) {
+                auto const time = n / rate - PAD_TIME;
+                auto const time_ms = static_cast<uint32_t>(std::lround((time + PAD_TIME) * 1000));
+                auto const [position, velocity, acceleration] = truth.at(time);
+                auto const phase = time <= 0 ? FlightPhase::Pad
+                    : time < truth.burn_out_time ? FlightPhase::Boost : FlightPhase::Coast;
+                uint8_t contents = GROUP_STATE;
+                if (n % gps_every == gps_every - 1) {
+                    contents |= GROUP_GPS;
+                }
+
+                std::array<uint8_t, FRAME_LEN> bytes;
+                begin_frame(bytes.data(), static_cast<uint16_t>(n), time_ms, contents);
+                auto* out = &bytes[FRAME_HEADER_LEN];
+                out += encode_state(out, static_cast<float>(position[2] + noise(rng)),
+                    static_cast<float>(velocity[2] + 0.5 * noise(rng)),
+                    static_cast<float>(acceleration[2] + noise(rng)), phase);
+                if (contents & GROUP_GPS) {
+                    auto const fix = pad_frame.to_geodetic({ position[0] + 3 * noise(rng),
+                        position[1] + 3 * noise(rng), position[2] + 8 * noise(rng) });
+                    out += encode_gps(out, {
+                        .latitude_e7 = static_cast<int32_t>(std::lround(fix.latitude * 1e7)),
+                        .longitude_e7 = static_cast<int32_t>(std::lround(fix.longitude * 1e7)),
+                        .altitude = static_cast<float>(fix.altitude),
+                        .satellites = 9,
+                        .fix = GpsFixType::Fix3D,
+                    });
+                }
+                finish_frame(bytes.data(), out - &bytes[FRAME_HEADER_LEN]);
+
+                auto const frame = decode_frame(bytes.data());
+                if (!frame.has_value()) {
+                    return {};
+                }
+                received.push_back({ *frame,
+                    time_ms / 1000.0 + CLOCK_OFFSET + LINK_LATENCY + jitter(rng) });
+            }
+            // Later frames can overtake earlier ones only in the arrival times drawn, never on a
+            // real serial link
+            for (size_t i = 1; i < received.size(); i++) {
+                received[i].arrival = std::max(received[i].arrival, received[i - 1].arrival);
+            }
+            return received;
+        }
+
+        /// Degrees between two directions.
+        double angle(Enu const& a, Enu const& b) {
+            auto const dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+            auto const norms = std::hypot(a[0], a[1], a[2]) * std::hypot(b[0], b[1], b[2]);
+            return std::acos(std::clamp(dot / norms, -1.0, 1.0)) * 180 / std::numbers::pi;
+        }
+
+        double percentile(std::vector<double> values, double fraction) {
+            if (values.empty()) {
+                return 0;
+            }
+            auto const nth = values.begin()
+                + static_cast<ptrdiff_t>(fraction * static_cast<double>(values.size() - 1));
+            std::nth_element(values.begin(), nth, values.end());
+            return *nth;
+        }
+
+        struct Errors {
+            /// Degrees off the rocket at every command during boost, and after it to apogee.
+            /// Boost starts counting once a frame sent after ignition has come in: until then
+            /// nothing on the ground can know the rocket has left the pad.
+            std::vector<double> boost;
+            std::vector<double> coast;
+            /// The same for an antenna pointed where the last frames said the rocket was.
+            std::vector<double> naive_boost;
+            /// Time from ignition until the ground heard of it, s.
+            double unseen = 0;
+        };
+
+        /// Runs the tracker over `received` at the command rate, and measures each command
+        /// against where the rocket really is once the mount has moved.
+        Errors track(Truth const& truth, std::vector<Received> const& received) {
+            auto const settings = config();
+            LocalFrame const pad_frame(pad());
+            LocalFrame const site_frame(settings.site);
+            auto const from_site = [&](Enu const& from_pad) {
+                return site_frame.to_enu(pad_frame.to_geodetic(from_pad));
+            };
+
+            Tracker tracker(settings);
+            Errors errors;
+            Enu last_gps = tracker.pad_position();
+            double last_altitude = 0;
+            size_t next = 0;
+            bool launched = false;
+            auto const start = CLOCK_OFFSET + LINK_LATENCY;
+            auto const commands = static_cast<int>((PAD_TIME + truth.end()) * COMMAND_RATE);
+            for (int n = 0; n < commands; n++) {
+                auto const now = start + n / COMMAND_RATE;
+                for (; next < received.size() && received[next].arrival <= now; next++) {
+                    auto const& frame = received[next].frame;
+                    tracker.update(frame, received[next].arrival);
+                    last_altitude = frame.state.altitude;
+                    launched = launched || frame.state.phase != FlightPhase::Pad;
+                    if (frame.contents & GROUP_GPS) {
+                        last_gps = site_frame.to_enu({ .latitude = frame.gps.latitude_e7 * 1e-7,
+                            .longitude = frame.gps.longitude_e7 * 1e-7,
+                            .altitude = frame.gps.altitude });
+                    }
+                }
+
+                auto const pointing = tracker.point(now);
+                auto const time = now + ACTUATION_LATENCY - CLOCK_OFFSET - PAD_TIME;
+                if (!pointing.valid || time <= 0 || time > truth.end()) {
+                    continue;
+                }
+                auto const actual = from_site(truth.at(time)[0]);
+                auto const error = angle(pointing.position, actual);
+                if (!launched) {
+                    errors.unseen = time;
+                } else if (time < truth.burn_out_time) {
+                    errors.boost.push_back(error);
+                    auto const naive = Enu { last_gps[0], last_gps[1],
+                        settings.pad.altitude + last_altitude - settings.site.altitude };
+                    errors.naive_boost.push_back(angle(naive, actual));
+                } else {
+                    errors.coast.push_back(error);
+                }
+            }
+            return errors;
+        }
+    }
+
+    /// The flight at a telemetry rate of `range(0)` frames a second, with the antenna commanded
+    /// at 100 Hz. The counters are the pointing error in degrees, during boost and after it to
+    /// apogee, and the boost error of pointing at the last measurements instead. `unseen_s` is
+    /// how long after ignition the first frame saying so came in, which no tracker can do
+    /// anything about.
+    static void BM_Tracking_Flight(benchmark::State& state) {
+        auto const& flight = truth();
+        if (flight.points.empty()) {
+            state.SkipWithError("couldn't fly the RocketPyTest rocket");
+            return;
+        }
+        auto const rate = static_cast<double>(state.range(0));
+        auto const received = downlink(flight, rate, static_cast<uint32_t>(state.range(0)));
+        if (received.empty()) {
+            state.SkipWithError("a frame didn't decode");
+            return;
+        }
+
+        Errors errors;
+        for (auto _ : state) {
+            errors = track(flight, received);
+            benchmark::DoNotOptimize(errors);
+        }
+
+        auto const max = [](std::vector<double> const& values) {
+            return values.empty() ? 0 : *std::ranges::max_element(values);
+        };
+        state.SetItemsProcessed(state.iterations()
+            * static_cast<int64_t>(errors.boost.size() + errors.coast.size()));
+        state.counters["boost_max_deg"] = max(errors.boost);
+        state.counters["boost_p95_deg"] = percentile(errors.boost, 0.95);
+        state.counters["coast_max_deg"] = max(errors.coast);
+        state.counters["naive_boost_max_deg"] = max(errors.naive_boost);
+        state.counters["unseen_s"] = errors.unseen;
+        if (errors.boost.empty()) {
+            state.SkipWithError("never pointed during boost");
+        } else if (max(errors.boost) > MAX_ERROR) {
+            state.SkipWithError("lost the rocket during boost");
+        } else if (max(errors.coast) > MAX_ERROR) {
+            state.SkipWithError("lost the rocket after boost");
+        } else if (max(errors.boost) >= max(errors.naive_boost)) {
+            state.SkipWithError("no better than pointing at the last measurements");
+        }
+    }
+    BENCHMARK(BM_Tracking_Flight)->Arg(1)->Arg(2)->Arg(5)->Arg(10)->Unit(benchmark::kMillisecond);
+
+    /// One command to the mount, between frames.
+    static void BM_Tracking_Point(benchmark::State& state) {
+        Tracker tracker(config());
+        GpsFix const fix {
+            .latitude_e7 = 329'912'000,
+            .longitude_e7 = -1'069'750'000,
+            .altitude = 2400,
+            .satellites = 9,
+            .fix = GpsFixType::Fix3D,
+        };
+        tracker.update_state(10'000, { .altitude = 1000, .velocity = 250, .acceleration = 60 }, 10);
+        tracker.update_gps(10'000, fix, 10);
+
+        auto now = 10.1;
+        double azimuth = 0;
+        for (auto _ : state) {
+            auto const pointing = tracker.point(now);
+            azimuth += pointing.azimuth;
+            now += 1e-9;
+        }
+        benchmark::DoNotOptimize(azimuth);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_Tracking_Point);
+}
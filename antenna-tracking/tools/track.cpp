@@ -0,0 +1,233 @@
+// Points the antenna at the rocket: listens to the telemetry radio like ground_station, and at a
+// fixed rate works out where the rocket will be once the mount has moved, however long ago the
+// last frame came in.
+//
+// The commands go to a file (or a pipe to the mount's driver) as lines of ground time,
+// azimuth, elevation and range, and a status line is printed once a second.
+//
+//     track --site <lat>,<lon>,<alt> --pad <lat>,<lon>,<alt>
+//           (--serial <device> [--baud <rate>] | --pty | --udp <port>)
+//           [--rate <Hz>] [--link-latency <s>] [--actuation-latency <s>] [--commands <file>]
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "station/ingest.h"
+#include "tracking/tracker.h"
+
+using namespace seds;
+using namespace seds::station;
+using namespace seds::tracking;
+using namespace std::chrono;
+
+namespace {
+    struct Options {
+        enum class Kind { None, Serial, Pty, Udp };
+
+        Kind kind = Kind::None;
+        char const* path = nullptr;
+        uint32_t baud = 115200;
+        uint16_t port = 0;
+        std::optional<Geodetic> site;
+        std::optional<Geodetic> pad;
+        /// Commands per second.
+        double rate = 100;
+        double link_latency = TrackerConfig{}.link_latency;
+        double actuation_latency = TrackerConfig{}.actuation_latency;
+        char const* commands = nullptr;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: track --site <lat>,<lon>,<alt> --pad <lat>,<lon>,<alt>\n"
+            "             (--serial <device> [--baud <rate>] | --pty | --udp <port>)\n"
+            "             [--rate <Hz>] [--link-latency <s>] [--actuation-latency <s>]\n"
+            "             [--commands <file>]\n"
+            "\n"
+            "  --site               the antenna, degrees and m above sea level\n"
+            "  --pad                the launch pad, likewise\n"
+            "  --serial             the receiver's serial port\n"
+            "  --baud               its baud rate (default: 115200)\n"
+            "  --pty                make a pty for radio_sim to write to, and print its path\n"
+            "  --udp                take datagrams sent to this port, as radio_sim sends them\n"
+            "  --rate               commands per second (default: 100)\n"
+            "  --link-latency       least time from a sample to its frame arriving, s\n"
+            "                       (default: 0.08)\n"
+            "  --actuation-latency  time for the mount to get where it's told, s (default: 0.1)\n"
+            "  --commands           write the commands to this file, one line each\n");
+    }
+
+    std::optional<Geodetic> parse_geodetic(char const* text) {
+        Geodetic geodetic;
+        if (std::sscanf(text, "%lf,%lf,%lf", &geodetic.latitude, &geodetic.longitude,
+                &geodetic.altitude) != 3) {
+            return std::nullopt;
+        }
+        return geodetic;
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--pty") {
+                options.kind = Options::Kind::Pty;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            i++;
+            auto const number = std::atol(argv[i]);
+            auto const real = std::atof(argv[i]);
+            if (arg == "--site") {
+                options.site = parse_geodetic(argv[i]);
+            } else if (arg == "--pad") {
+                options.pad = parse_geodetic(argv[i]);
+            } else if (arg == "--serial") {
+                options.kind = Options::Kind::Serial;
+                options.path = argv[i];
+            } else if (arg == "--baud" && number > 0) {
+                options.baud = static_cast<uint32_t>(number);
+            } else if (arg == "--udp" && number > 0 && number < 65536) {
+                options.kind = Options::Kind::Udp;
+                options.port = static_cast<uint16_t>(number);
+            } else if (arg == "--rate" && real > 0) {
+                options.rate = real;
+            } else if (arg == "--link-latency" && real >= 0) {
+                options.link_latency = real;
+            } else if (arg == "--actuation-latency" && real >= 0) {
+                options.actuation_latency = real;
+            } else if (arg == "--commands") {
+                options.commands = argv[i];
+            } else {
+                return std::nullopt;
+            }
+        }
+        if (options.kind == Options::Kind::None || !options.site.has_value()
+            || !options.pad.has_value()) {
+            return std::nullopt;
+        }
+        return options;
+    }
+
+    Expected<std::unique_ptr<Source>> open_source(Options const& options) {
+        switch (options.kind) {
+        case Options::Kind::Serial:
+            return open_serial(options.path, options.baud);
+        case Options::Kind::Pty:
+            return open_pty();
+        case Options::Kind::Udp:
+        case Options::Kind::None:
+            break;
+        }
+        return open_udp(options.port);
+    }
+
+    std::atomic<bool> interrupted = false;
+
+    double seconds_since_epoch(steady_clock::time_point time) {
+        return duration<double>(time.time_since_epoch()).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto source = open_source(*options);
+    if (!source.has_value()) {
+        std::fprintf(stderr, "%s\n", source.error().c_str());
+        return 1;
+    }
+    FILE* commands = nullptr;
+    if (options->commands != nullptr) {
+        commands = std::fopen(options->commands, "w");
+        if (commands == nullptr) {
+            std::fprintf(stderr, "couldn't open %s\n", options->commands);
+            return 1;
+        }
+        // The mount's driver may be reading it as it's written
+        std::setvbuf(commands, nullptr, _IOLBF, 0);
+    }
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    std::printf("listening on %s\n", (*source)->name().c_str());
+
+    Ingest ingest(std::move(*source));
+    if (auto started = ingest.start({}); !started.has_value()) {
+        std::fprintf(stderr, "%s\n", started.error().c_str());
+        return 1;
+    }
+    std::signal(SIGINT, [](int) { interrupted.store(true); });
+
+    Tracker tracker({
+        .site = *options->site,
+        .pad = *options->pad,
+        .link_latency = options->link_latency,
+        .actuation_latency = options->actuation_latency,
+    });
+    auto const period = duration_cast<steady_clock::duration>(duration<double>(1 / options->rate));
+    auto next = steady_clock::now();
+    auto last_print = next;
+    uint64_t version = 0;
+    uint32_t gps_ms = 0;
+    while (!interrupted.load() && !ingest.done()) {
+        std::this_thread::sleep_until(next);
+        auto const now = steady_clock::now();
+        next += period;
+        if (next < now) {
+            // Fell behind; don't make up for it with a burst of stale commands
+            next = now + period;
+        }
+
+        // The snapshot has only the newest frame of each batch the ingest took, which at the
+        // radio's rate is nearly always the one frame
+        if (ingest.version() != version) {
+            version = ingest.version();
+            auto const snapshot = ingest.snapshot();
+            auto const arrival = static_cast<double>(snapshot.received_ns) * 1e-9;
+            if (snapshot.stats.frames > 0) {
+                tracker.update_state(snapshot.time_ms, snapshot.state, arrival);
+            }
+            if ((snapshot.heard & telemetry::GROUP_GPS) && snapshot.gps_ms != gps_ms) {
+                gps_ms = snapshot.gps_ms;
+                tracker.update_gps(snapshot.gps_ms, snapshot.gps, arrival);
+            }
+        }
+
+        auto const pointing = tracker.point(seconds_since_epoch(now));
+        if (pointing.valid && commands != nullptr) {
+            std::fprintf(commands, "%.3f,%.3f,%.3f,%.1f\n", seconds_since_epoch(now),
+                pointing.azimuth, pointing.elevation, pointing.range);
+        }
+        if (now - last_print >= seconds(1)) {
+            last_print = now;
+            if (pointing.valid) {
+                std::printf("%9.2f s  azimuth %7.2f  elevation %6.2f  range %8.1f m\n",
+                    *tracker.flight_time(seconds_since_epoch(now)), pointing.azimuth,
+                    pointing.elevation, pointing.range);
+            } else {
+                std::printf("no frames yet\n");
+            }
+        }
+    }
+
+    auto const stopped = ingest.stop();
+    if (commands != nullptr) {
+        std::fclose(commands);
+    }
+    if (!stopped.has_value()) {
+        std::fprintf(stderr, "%s\n", stopped.error().c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "tracking/filter.h"
+
+namespace seds::tracking {
+
+namespace {
+    /// How far a stationary rocket's velocity and acceleration could be from zero before the
+    /// first measurement of them.
+    constexpr double START_VELOCITY_VARIANCE = 1;
+    constexpr double START_ACCELERATION_VARIANCE = 100 * 100;
+}
+
+AxisFilter::AxisFilter(double position, double position_variance, double jerk_density)
+    : x { position, 0, 0 }, p {}, q(jerk_density) {
+    this->p[POSITION][POSITION] = position_variance;
+    this->p[VELOCITY][VELOCITY] = START_VELOCITY_VARIANCE;
+    this->p[ACCELERATION][ACCELERATION] = START_ACCELERATION_VARIANCE;
+}
+
+void AxisFilter::predict(double dt) {
+    if (dt <= 0) {
+        return;
+    }
+
+    this->x = this->extrapolate(dt);
+
+    // P = F P Fᵀ + Q, with F = [[1, dt, dt²/2], [0, 1, dt], [0, 0, 1]]
+    auto const half_dt2 = dt * dt / 2;
+    std::array<std::array<double, 3>, 3> fp;
+    for (size_t j = 0; j < 3; j++) {
+        fp[0][j] = this->p[0][j] + dt * this->p[1][j] + half_dt2 * this->p[2][j];
+        fp[1][j] = this->p[1][j] + dt * this->p[2][j];
+        fp[2][j] = this->p[2][j];
+    }
+    for (size_t i = 0; i < 3; i++) {
+        this->p[i][0] = fp[i][0] + dt * fp[i][1] + half_dt2 * fp[i][2];
+        this->p[i][1] = fp[i][1] + dt * fp[i][2];
+        this->p[i][2] = fp[i][2];
+    }
+
+    // White-noise jerk integrated over the step
+    auto const dt2 = dt * dt;
+    auto const dt3 = dt2 * dt;
+    auto const dt4 = dt3 * dt;
+    auto const dt5 = dt4 * dt;
+    double const noise[3][3] = {
+        { dt5 / 20, dt4 / 8, dt3 / 6 },
+        { dt4 / 8, dt3 / 3, dt2 / 2 },
+        { dt3 / 6, dt2 / 2, dt },
+    };
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            this->p[i][j] += this->q * noise[i][j];
+        }
+    }
+}
+
+void AxisFilter::update(Component component, double value, double variance) {
+    // A scalar measurement of one component: H picks out column `component`
+    auto const innovation = value - this->x[component];
+    auto const s = this->p[component][component] + variance;
+    if (s <= 0) {
+        return;
+    }
+    std::array<double, 3> gain;
+    for (size_t i = 0; i < 3; i++) {
+        gain[i] = this->p[i][component] / s;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        this->x[i] += gain[i] * innovation;
+    }
+
+    // P = (I - K H) P, keeping it symmetric
+    auto const row = this->p[component];
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = i; j < 3; j++) {
+            this->p[i][j] -= gain[i] * row[j];
+            this->p[j][i] = this->p[i][j];
+        }
+    }
+}
+
+std::array<double, 3> AxisFilter::extrapolate(double dt) const {
+    auto const [position, velocity, acceleration] = this->x;
+    return {
+        position + velocity * dt + acceleration * dt * dt / 2,
+        velocity + acceleration * dt,
+        acceleration,
+    };
+}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+// A Kalman filter for one axis of the rocket's motion, assuming its acceleration changes
+// smoothly.
+
+#include <array>
+#include <cstddef>
+
+namespace seds::tracking {
+    /// Position, velocity and acceleration along one axis, under a constant-acceleration model
+    /// driven by white-noise jerk.
+    ///
+    /// Any of the three can be measured, each with its own variance, as often as it comes in.
+    /// Between measurements the state is carried forward assuming the acceleration holds, and
+    /// the uncertainty grows with the jerk the rocket could have had in that time.
+    class AxisFilter {
+    public:
+        enum Component : size_t {
+            POSITION,
+            VELOCITY,
+            ACCELERATION,
+        };
+
+        /// Starts with `position` known to within `position_variance`, at rest but not knowing
+        /// how fast it may start moving.
+        AxisFilter(double position, double position_variance, double jerk_density);
+
+        /// Carries the state `dt` seconds forward.
+        void predict(double dt);
+
+        /// Folds in a measurement of one component.
+        void update(Component component, double value, double variance);
+
+        /// The state `dt` seconds after the last prediction, without changing the filter.
+        [[nodiscard]]
+        std::array<double, 3> extrapolate(double dt) const;
+
+        [[nodiscard]]
+        std::array<double, 3> const& state() const {
+            return this->x;
+        }
+
+        [[nodiscard]]
+        double variance(Component component) const {
+            return this->p[component][component];
+        }
+
+    private:
+        std::array<double, 3> x;
+        std::array<std::array<double, 3>, 3> p;
+        /// Spectral density of the jerk, (m/s³)²/Hz.
+        double q;
+    };
+}
@@ -0,0 +1,105 @@
+#include "tracking/geodesy.h"
+
+#include <cmath>
+#include <numbers>
+
+namespace seds::tracking {
+
+namespace {
+    // WGS 84
+    constexpr double A = 6'378'137;
+    constexpr double F = 1 / 298.257223563;
+    constexpr double B = A * (1 - F);
+    constexpr double E2 = F * (2 - F);
+    /// Second eccentricity squared.
+    constexpr double EP2 = E2 / (1 - E2);
+
+    constexpr double radians(double degrees) {
+        return degrees * std::numbers::pi / 180;
+    }
+
+    constexpr double degrees(double radians) {
+        return radians * 180 / std::numbers::pi;
+    }
+}
+
+Ecef to_ecef(Geodetic const& point) {
+    auto const lat = radians(point.latitude);
+    auto const lon = radians(point.longitude);
+    auto const sin_lat = std::sin(lat);
+    // Radius of curvature in the prime vertical
+    auto const n = A / std::sqrt(1 - E2 * sin_lat * sin_lat);
+    auto const horizontal = (n + point.altitude) * std::cos(lat);
+    return {
+        horizontal * std::cos(lon),
+        horizontal * std::sin(lon),
+        (n * (1 - E2) + point.altitude) * sin_lat,
+    };
+}
+
+Geodetic to_geodetic(Ecef const& point) {
+    auto const [x, y, z] = point;
+    auto const p = std::hypot(x, y);
+    auto const lon = std::atan2(y, x);
+
+    // Bowring: start from the reduced latitude, and refine it once more
+    auto beta = std::atan2(z * A, p * B);
+    double lat = 0;
+    for (int i = 0; i < 2; i++) {
+        auto const sin_beta = std::sin(beta);
+        auto const cos_beta = std::cos(beta);
+        lat = std::atan2(z + EP2 * B * sin_beta * sin_beta * sin_beta,
+            p - E2 * A * cos_beta * cos_beta * cos_beta);
+        beta = std::atan2((1 - F) * std::sin(lat), std::cos(lat));
+    }
+
+    auto const sin_lat = std::sin(lat);
+    auto const n = A / std::sqrt(1 - E2 * sin_lat * sin_lat);
+    // Away from the poles the horizontal distance gives the height best
+    auto const altitude = std::abs(lat) < radians(80)
+        ? p / std::cos(lat) - n
+        : z / sin_lat - n * (1 - E2);
+    return { .latitude = degrees(lat), .longitude = degrees(lon), .altitude = altitude };
+}
+
+LocalFrame::LocalFrame(Geodetic const& origin)
+    : centre(origin), centre_ecef(to_ecef(origin)) {
+    auto const lat = radians(origin.latitude);
+    auto const lon = radians(origin.longitude);
+    auto const sin_lat = std::sin(lat);
+    auto const cos_lat = std::cos(lat);
+    auto const sin_lon = std::sin(lon);
+    auto const cos_lon = std::cos(lon);
+    this->axes = { {
+        { -sin_lon, cos_lon, 0 },
+        { -sin_lat * cos_lon, -sin_lat * sin_lon, cos_lat },
+        { cos_lat * cos_lon, cos_lat * sin_lon, sin_lat },
+    } };
+}
+
+Enu LocalFrame::to_enu(Geodetic const& point) const {
+    auto const ecef = to_ecef(point);
+    Ecef const offset = {
+        ecef[0] - this->centre_ecef[0],
+        ecef[1] - this->centre_ecef[1],
+        ecef[2] - this->centre_ecef[2],
+    };
+    Enu enu;
+    for (size_t i = 0; i < 3; i++) {
+        auto const& axis = this->axes[i];
+        enu[i] = axis[0] * offset[0] + axis[1] * offset[1] + axis[2] * offset[2];
+    }
+    return enu;
+}
+
+Geodetic LocalFrame::to_geodetic(Enu const& point) const {
+    Ecef ecef = this->centre_ecef;
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            ecef[j] += this->axes[i][j] * point[i];
+        }
+    }
+    return tracking::to_geodetic(ecef);
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+// Positions on the WGS 84 ellipsoid, and the flat east-north-up frame around the tracker that
+// the filter and the pointing work in.
+
+#include <array>
+
+namespace seds::tracking {
+    /// A point by latitude, longitude and height.
+    struct Geodetic {
+        /// Degrees, north positive.
+        double latitude = 0;
+        /// Degrees, east positive.
+        double longitude = 0;
+        /// Above the ellipsoid, m. GPS receivers and the telemetry give height above mean sea
+        /// level; the difference is the same for every point near the launch site, so either
+        /// works as long as all of them use the same one.
+        double altitude = 0;
+    };
+
+    /// Earth-centred, earth-fixed x, y and z, m.
+    using Ecef = std::array<double, 3>;
+
+    /// East, north and up, m.
+    using Enu = std::array<double, 3>;
+
+    /// Mean radius of the earth, m.
+    constexpr double EARTH_RADIUS = 6'371'000;
+
+    Ecef to_ecef(Geodetic const& point);
+
+    /// Exact to well under a millimetre anywhere a rocket flies (Bowring's method, iterated
+    /// twice).
+    Geodetic to_geodetic(Ecef const& point);
+
+    /// East, north and up around a fixed origin, with up along the ellipsoid's normal there.
+    class LocalFrame {
+    public:
+        explicit LocalFrame(Geodetic const& origin);
+
+        [[nodiscard]]
+        Enu to_enu(Geodetic const& point) const;
+
+        [[nodiscard]]
+        Geodetic to_geodetic(Enu const& point) const;
+
+        [[nodiscard]]
+        Geodetic const& origin() const {
+            return this->centre;
+        }
+
+    private:
+        Geodetic centre;
+        Ecef centre_ecef;
+        /// Rows are the east, north and up unit vectors in ECEF.
+        std::array<Ecef, 3> axes;
+    };
+}
@@ -0,0 +1,130 @@
+#include "tracking/tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace seds::tracking {
+
+using namespace seds::telemetry;
+
+Tracker::Tracker(TrackerConfig const& config)
+    : config(config), frame(config.site), pad(this->frame.to_enu(config.pad)) {}
+
+void Tracker::update(Frame const& frame, double arrival) {
+    this->update_state(frame.time_ms, frame.state, arrival);
+    if (frame.contents & GROUP_GPS) {
+        this->update_gps(frame.time_ms, frame.gps, arrival);
+    }
+}
+
+void Tracker::update_state(uint32_t time_ms, State const& state, double arrival) {
+    this->observe_clock(time_ms, arrival);
+    if (!this->advance(time_ms / 1000.0)) {
+        return;
+    }
+
+    // The altitude is above the pad's ground; from the antenna, the ground falls away with the
+    // earth's curvature
+    auto& [east, north, up] = *this->axes;
+    auto const e = east.state()[AxisFilter::POSITION];
+    auto const n = north.state()[AxisFilter::POSITION];
+    auto const height = this->config.pad.altitude + state.altitude - this->config.site.altitude
+        - (e * e + n * n) / (2 * EARTH_RADIUS);
+
+    auto const square = [](double x) { return x * x; };
+    up.update(AxisFilter::POSITION, height, square(this->config.altitude_sigma));
+    up.update(AxisFilter::VELOCITY, state.velocity, square(this->config.velocity_sigma));
+    up.update(AxisFilter::ACCELERATION, state.acceleration,
+        square(this->config.acceleration_sigma));
+}
+
+void Tracker::update_gps(uint32_t time_ms, GpsFix const& fix, double arrival) {
+    this->observe_clock(time_ms, arrival);
+    if (fix.fix != GpsFixType::Fix3D || !this->advance(time_ms / 1000.0)) {
+        return;
+    }
+
+    auto const position = this->frame.to_enu({
+        .latitude = fix.latitude_e7 * 1e-7,
+        .longitude = fix.longitude_e7 * 1e-7,
+        .altitude = fix.altitude,
+    });
+    auto const horizontal = this->config.gps_horizontal_sigma * this->config.gps_horizontal_sigma;
+    auto const vertical = this->config.gps_vertical_sigma * this->config.gps_vertical_sigma;
+    auto& axes = *this->axes;
+    axes[0].update(AxisFilter::POSITION, position[0], horizontal);
+    axes[1].update(AxisFilter::POSITION, position[1], horizontal);
+    axes[2].update(AxisFilter::POSITION, position[2], vertical);
+}
+
+void Tracker::observe_clock(uint32_t time_ms, double arrival) {
+    auto const offset = arrival - time_ms / 1000.0;
+    if (!this->clock_offset.has_value() || offset < *this->clock_offset) {
+        this->clock_offset = offset;
+    }
+}
+
+bool Tracker::advance(double time) {
+    if (!this->axes.has_value()) {
+        auto const variance = this->config.pad_sigma * this->config.pad_sigma;
+        auto const horizontal = this->config.horizontal_jerk_density;
+        this->axes = { {
+            AxisFilter(this->pad[0], variance, horizontal),
+            AxisFilter(this->pad[1], variance, horizontal),
+            AxisFilter(this->pad[2], variance, this->config.vertical_jerk_density),
+        } };
+        this->filter_time = time;
+        return true;
+    }
+    if (time < this->filter_time) {
+        return false;
+    }
+
+    for (auto& axis : *this->axes) {
+        axis.predict(time - this->filter_time);
+    }
+    this->filter_time = time;
+    return true;
+}
+
+std::optional<double> Tracker::flight_time(double now) const {
+    if (!this->clock_offset.has_value()) {
+        return std::nullopt;
+    }
+    // The fastest frame took the link's latency, so the clocks are that much closer than it
+    // looked
+    return now - *this->clock_offset + this->config.link_latency;
+}
+
+Pointing Tracker::point(double now) const {
+    auto const time = this->flight_time(now);
+    if (!this->axes.has_value() || !time.has_value()) {
+        return {};
+    }
+
+    // Where the rocket will be once the mount has moved
+    auto const ahead = std::max(0.0, *time + this->config.actuation_latency - this->filter_time);
+    auto const accelerating = std::min(ahead, this->config.max_extrapolation);
+    Enu position;
+    for (size_t i = 0; i < 3; i++) {
+        auto const [p, v, a] = (*this->axes)[i].extrapolate(accelerating);
+        position[i] = p + v * (ahead - accelerating);
+    }
+
+    auto const [east, north, up] = position;
+    auto const horizontal = std::hypot(east, north);
+    auto azimuth = std::atan2(east, north) * 180 / std::numbers::pi;
+    if (azimuth < 0) {
+        azimuth += 360;
+    }
+    return {
+        .valid = true,
+        .azimuth = azimuth,
+        .elevation = std::atan2(up, horizontal) * 180 / std::numbers::pi,
+        .range = std::hypot(horizontal, up),
+        .position = position,
+    };
+}
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Where to point the ground station's antenna, from the telemetry: the rocket's position carried
+// forward past the time its frames took to arrive and the mount takes to move.
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "telemetry/frame.h"
+#include "tracking/filter.h"
+#include "tracking/geodesy.h"
+
+namespace seds::tracking {
+    /// Settings for Tracker.
+    struct TrackerConfig {
+        /// The antenna.
+        Geodetic site;
+        /// The launch pad. The telemetry's altitudes are above it.
+        Geodetic pad;
+        /// The least time from the flight computer taking a sample to its frame being decoded
+        /// here, s. About a frame's airtime (50 ms at 640 bytes/s) plus the receiver's delay.
+        double link_latency = 0.08;
+        /// Time from commanding the mount to it pointing there, s.
+        double actuation_latency = 0.1;
+        /// How far past the last measurement the acceleration is trusted to hold, s. Beyond this
+        /// the prediction carries on at constant velocity, so a lost link doesn't fling the
+        /// antenna off on a parabola.
+        double max_extrapolation = 1;
+
+        /// Spectral density of the jerk the filter allows for vertically, (m/s³)²/Hz. High
+        /// enough for ignition and burnout.
+        double vertical_jerk_density = 5000;
+        /// The same horizontally, where the rocket is pushed only by the little of the thrust
+        /// off vertical and by the wind. Lower, so that GPS noise isn't taken for sideways
+        /// acceleration when fixes are a second apart.
+        double horizontal_jerk_density = 50;
+        /// Standard deviations of the measurements, in m, m/s and m/s².
+        double gps_horizontal_sigma = 3;
+        double gps_vertical_sigma = 8;
+        double altitude_sigma = 1;
+        double velocity_sigma = 0.5;
+        double acceleration_sigma = 1;
+        /// How well the pad's position is known, for before the first GPS fix, m.
+        double pad_sigma = 5;
+    };
+
+    /// A direction to point the antenna.
+    struct Pointing {
+        /// Whether any telemetry has come in yet. Nothing else is set until it has.
+        bool valid = false;
+        /// Degrees clockwise from true north, [0, 360).
+        double azimuth = 0;
+        /// Degrees above the horizon.
+        double elevation = 0;
+        /// m
+        double range = 0;
+        /// Where the rocket will be, east, north and up from the antenna, m.
+        Enu position = {};
+    };
+
+    /// Tracks the rocket from its telemetry and says where to point the antenna, as often as
+    /// asked.
+    ///
+    /// Every measurement goes into a constant-acceleration filter per east, north and up axis,
+    /// at the flight computer time it was taken: GPS fixes for all three, and the flight
+    /// computer's altitude, vertical velocity and acceleration for up. The flight computer's
+    /// clock is matched to the ground's by the fastest any frame has arrived, less the link's
+    /// known latency. `point` then carries the filter's state forward to when the mount will
+    /// have moved, so between frames, which may come only once a second, the antenna keeps
+    /// leading the rocket instead of pointing at where it was. It costs a few multiplications,
+    /// so it can run at the mount's rate, 100 Hz or more.
+    class Tracker {
+    public:
+        explicit Tracker(TrackerConfig const& config);
+
+        /// Takes the groups of a decoded frame that say where the rocket is, which arrived at
+        /// `arrival`, in seconds on the ground's clock.
+        void update(telemetry::Frame const& frame, double arrival);
+
+        /// Takes the rocket's altitude above the pad, vertical velocity and acceleration, as of
+        /// `time_ms` on the flight computer's clock.
+        void update_state(uint32_t time_ms, telemetry::State const& state, double arrival);
+
+        /// Takes a GPS fix as of `time_ms` on the flight computer's clock. Fixes without a 3D
+        /// position are ignored.
+        void update_gps(uint32_t time_ms, telemetry::GpsFix const& fix, double arrival);
+
+        /// Where to point the antenna at `now`, on the ground's clock, so that it is on the
+        /// rocket once the mount gets there.
+        [[nodiscard]]
+        Pointing point(double now) const;
+
+        /// The flight computer's time at `now` on the ground's clock, s. Empty before any
+        /// telemetry.
+        [[nodiscard]]
+        std::optional<double> flight_time(double now) const;
+
+        [[nodiscard]]
+        Enu const& pad_position() const {
+            return this->pad;
+        }
+
+    private:
+        /// Matches the clocks with one more frame's arrival.
+        void observe_clock(uint32_t time_ms, double arrival);
+
+        /// Starts the filters at the pad if they haven't started, and carries them forward to
+        /// `time`, on the flight computer's clock. Returns false for a measurement older than
+        /// ones already taken.
+        bool advance(double time);
+
+        TrackerConfig config;
+        LocalFrame frame;
+        /// The pad, from the antenna.
+        Enu pad;
+        /// East, north, up. Empty until the first measurement.
+        std::optional<std::array<AxisFilter, 3>> axes;
+        /// Flight computer time the filters are at, s.
+        double filter_time = 0;
+        /// Smallest arrival less flight computer time seen, s.
+        std::optional<double> clock_offset;
+    };
+}
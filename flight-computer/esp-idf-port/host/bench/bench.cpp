@@ -0,0 +1,48 @@
+#include "bench.h"
+
+#include "esp_log.h"
+
+namespace seds::bench {
+    sim::Rig& rig() {
+        [[maybe_unused]] static bool const quiet = (esp_log_level_set("*", ESP_LOG_NONE), true);
+        static sim::Rig rig;
+        return rig;
+    }
+
+    SensorSample typical_sample() {
+        return SensorSample {
+            .time_ms = 1'234'567,
+            .imu = { .ax = 0.0123f, .ay = -0.0456f, .az = 1.0012f, .gx = 0.061f, .gy = -0.0305f, .gz = 0.0152f },
+            .baro1 = { .baro_temp = 22.0188f, .pressure = 101325.0f },
+            .baro2 = { .baro_temp = 21.9873f, .pressure = 101320.28f },
+            .high_g = { .h_ax = 0.0f, .h_ay = 0.0488f, .h_az = 1.0244f },
+            .temp = 22.0625f,
+        };
+    }
+
+    RawSensorSample typical_raw_sample() {
+        return RawSensorSample {
+            .time_ms = 1'234'567,
+            .imu = { .ax = 50, .ay = -187, .az = 4105, .gx = 1, .gy = 0, .gz = 0 },
+            .baro1 = { .temp = 1'443'024, .pressure = 6'484'800 },
+            .baro2 = { .temp = 1'440'960, .pressure = 6'484'498 },
+            .high_g = { .x = 0, .y = 1, .z = 21 },
+            .temp = 353,
+            .valid = VALID_ALL,
+        };
+    }
+
+    SensorCalibration typical_calibration() {
+        SensorCalibration calibration;
+        calibration.imu = {{
+            { .gain = 0.9987f, .offset = 0 }, { .gain = 0.9987f, .offset = 0 },
+            { .gain = 0.9987f, .offset = 0 }, { .gain = 1, .offset = -0.061f },
+            { .gain = 1, .offset = 0.0305f }, { .gain = 1, .offset = -0.0152f },
+        }};
+        calibration.high_g = {{
+            { .gain = 1, .offset = 0.012f }, { .gain = 1, .offset = -0.094f },
+            { .gain = 1, .offset = -0.0232f },
+        }};
+        return calibration;
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "computer/computer.h"
+#include "computer/sensors.h"
+#include "rig.h"
+
+namespace seds::bench {
+    /// The process-wide sensor rig, created on first use with logging turned off (logging every
+    /// driver call would dominate the measurements).
+    sim::Rig& rig();
+
+    /// A sample with typical on-pad values in every field.
+    SensorSample typical_sample();
+
+    /// `typical_sample` as the counts the sensors would report at their default settings.
+    RawSensorSample typical_raw_sample();
+
+    /// A pad calibration with a correction in every axis, about as large as the real parts need.
+    SensorCalibration typical_calibration();
+}
@@ -0,0 +1,77 @@
+// Driver read functions against the simulated bus. The bus is zero-latency, so these measure the
+// register decoding and raw-to-SI conversion plus the fixed cost of the I2C wrapper.
+
+#include <benchmark/benchmark.h>
+
+#include "errors.h"
+#include "i2c_bus.h"
+#include "bench.h"
+
+namespace seds::bench {
+    static void BM_BMI323_ReadImu(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto imu = errors::unwrap(BMI323::create(errors::unwrap(rig.i2c->get_device(BMI323::default_address))));
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(imu.read_imu());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_BMI323_ReadImu);
+
+    static void BM_BMI323_ReadImuRaw(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto imu = errors::unwrap(BMI323::create(errors::unwrap(rig.i2c->get_device(BMI323::default_address))));
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(imu.read_raw());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_BMI323_ReadImuRaw);
+
+    static void BM_BMP581_ReadData(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto baro = errors::unwrap(BMP581::create(errors::unwrap(rig.i2c->get_device(BMP581::address_1))));
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(baro.read_data());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_BMP581_ReadData);
+
+    static void BM_HighGAccel_ReadAcceleration(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto accel = errors::unwrap(HighGAccel::create(errors::unwrap(rig.i2c->get_device(HighGAccel::default_address))));
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(accel.read_acceleration());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_HighGAccel_ReadAcceleration);
+
+    static void BM_TMP1075_ReadTemperature(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto temp = errors::unwrap(rig.i2c->get_device<TMP1075>());
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(temp.read_temperature());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_TMP1075_ReadTemperature);
+
+    /// Baseline: one register read through the wrapper with no conversion.
+    static void BM_I2CDevice_ReadRegister(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto device = errors::unwrap(rig.i2c->get_device(BMP581::address_1));
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(device.read_le_register<uint64_t>(0x1D));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_I2CDevice_ReadRegister);
+}
@@ -0,0 +1,230 @@
+// Row encoding: the CSV writer used by FlightComputer::process against cheaper alternatives,
+// including the raw log format. The `bytes_per_row` counter shows what each format costs in SD
+// bandwidth. Decoding raw logs offline, by the compiled-in layout and by the schema the log
+// carries, is here too.
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench.h"
+#include "replay/log_schema.h"
+
+namespace seds::bench {
+    namespace {
+        /// The floats in a sample, in CSV column order.
+        std::array<float, 14> columns(SensorSample const& s) {
+            return {
+                s.imu.ax, s.imu.ay, s.imu.az, s.imu.gx, s.imu.gy, s.imu.gz,
+                s.baro1.baro_temp, s.baro1.pressure, s.baro2.baro_temp, s.baro2.pressure,
+                s.high_g.h_ax, s.high_g.h_ay, s.high_g.h_az, s.temp,
+            };
+        }
+
+        /// Shortest round-trip representation of every float.
+        size_t format_to_chars(char* dest, size_t len, SensorSample const& sample) {
+            char* out = dest;
+            char* const end = dest + len;
+            out = std::to_chars(out, end, sample.time_ms).ptr;
+            for (float value : columns(sample)) {
+                *out++ = ',';
+                out = std::to_chars(out, end, value).ptr;
+            }
+            *out++ = '\n';
+            return out - dest;
+        }
+
+        /// Every float as a fixed-point integer in thousandths.
+        size_t format_fixed_point(char* dest, size_t len, SensorSample const& sample) {
+            char* out = dest;
+            char* const end = dest + len;
+            out = std::to_chars(out, end, sample.time_ms).ptr;
+            for (float value : columns(sample)) {
+                *out++ = ',';
+                out = std::to_chars(out, end, std::lround(value * 1000.0f)).ptr;
+            }
+            *out++ = '\n';
+            return out - dest;
+        }
+    }
+
+    static void BM_FormatRow_Snprintf(benchmark::State& state) {
+        auto const sample = typical_sample();
+        char row[CSV_ROW_MAX_LEN];
+        size_t written = 0;
+
+        for (auto _ : state) {
+            written = format_csv_row(row, sizeof(row), sample);
+            benchmark::DoNotOptimize(row);
+        }
+        state.SetBytesProcessed(state.iterations() * written);
+        state.counters["bytes_per_row"] = written;
+    }
+    BENCHMARK(BM_FormatRow_Snprintf);
+
+    static void BM_FormatRow_ToChars(benchmark::State& state) {
+        auto const sample = typical_sample();
+        char row[CSV_ROW_MAX_LEN];
+        size_t written = 0;
+
+        for (auto _ : state) {
+            written = format_to_chars(row, sizeof(row), sample);
+            benchmark::DoNotOptimize(row);
+        }
+        state.SetBytesProcessed(state.iterations() * written);
+        state.counters["bytes_per_row"] = written;
+    }
+    BENCHMARK(BM_FormatRow_ToChars);
+
+    static void BM_FormatRow_FixedPoint(benchmark::State& state) {
+        auto const sample = typical_sample();
+        char row[CSV_ROW_MAX_LEN];
+        size_t written = 0;
+
+        for (auto _ : state) {
+            written = format_fixed_point(row, sizeof(row), sample);
+            benchmark::DoNotOptimize(row);
+        }
+        state.SetBytesProcessed(state.iterations() * written);
+        state.counters["bytes_per_row"] = written;
+    }
+    BENCHMARK(BM_FormatRow_FixedPoint);
+
+    static void BM_EncodeRow_Binary(benchmark::State& state) {
+        auto const sample = typical_sample();
+        alignas(8) char row[sizeof(SensorSample)];
+
+        for (auto _ : state) {
+            std::memcpy(row, &sample, sizeof(sample));
+            benchmark::DoNotOptimize(row);
+        }
+        state.SetBytesProcessed(state.iterations() * sizeof(SensorSample));
+        state.counters["bytes_per_row"] = sizeof(SensorSample);
+    }
+    BENCHMARK(BM_EncodeRow_Binary);
+
+    static void BM_EncodeRow_Raw(benchmark::State& state) {
+        auto const sample = typical_raw_sample();
+        uint8_t row[RAW_SAMPLE_RECORD_LEN];
+        size_t written = 0;
+
+        for (auto _ : state) {
+            written = encode_raw_sample(row, sample);
+            benchmark::DoNotOptimize(row);
+        }
+        state.SetBytesProcessed(state.iterations() * written);
+        state.counters["bytes_per_row"] = written;
+    }
+    BENCHMARK(BM_EncodeRow_Raw);
+
+    /// The deferred raw-to-SI conversion that raw logging moves out of the flight loop.
+    static void BM_ConvertRaw(benchmark::State& state) {
+        auto const scales = rig().make_computer().scales();
+        auto sample = typical_raw_sample();
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(sample);
+            benchmark::DoNotOptimize(scales.convert(sample));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ConvertRaw);
+
+    /// Conversion with a pad calibration folded in, which should cost no more than without.
+    static void BM_ConvertRaw_Calibrated(benchmark::State& state) {
+        CalibratedScales const scales(rig().make_computer().scales(), typical_calibration());
+        auto sample = typical_raw_sample();
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(sample);
+            benchmark::DoNotOptimize(scales.convert(sample));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ConvertRaw_Calibrated);
+
+    static void BM_DecodeRow_Raw(benchmark::State& state) {
+        uint8_t row[RAW_SAMPLE_RECORD_LEN];
+        encode_raw_sample(row, typical_raw_sample());
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(row);
+            benchmark::DoNotOptimize(decode_raw_sample(&row[1]));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_DecodeRow_Raw);
+
+    /// What a tool that knows nothing about the sensors pays to read a sample, going by the
+    /// schema. Fails if it reads anything other than what the sample converts to, calibrated.
+    static void BM_DecodeRow_Schema(benchmark::State& state) {
+        CalibratedScales const scales(rig().make_computer(LogFormat::Raw).scales(),
+            typical_calibration());
+        auto const sample = typical_raw_sample();
+
+        // A log of one scales record, one calibration record and a run of samples
+        constexpr size_t rows = 64;
+        std::vector<uint8_t> log(RAW_LOG_HEADER.begin(), RAW_LOG_HEADER.end());
+        log.resize(log.size() + RAW_SCALES_RECORD_LEN + RAW_CALIBRATION_RECORD_LEN
+            + rows * RAW_SAMPLE_RECORD_LEN);
+        auto dest = &log[RAW_LOG_HEADER.size()];
+        dest += encode_raw_scales(dest, scales.scales);
+        dest += encode_raw_calibration(dest, scales.calibration);
+        for (size_t i = 0; i < rows; i++) {
+            dest += encode_raw_sample(dest, sample);
+        }
+
+        FILE* file = fmemopen(log.data(), log.size(), "rb");
+        fseek(file, sizeof(RAW_LOG_MAGIC), SEEK_SET);
+        auto decoder = replay::SchemaDecoder::open(file);
+        if (!decoder.has_value()) {
+            state.SkipWithError(decoder.error()->what());
+            fclose(file);
+            return;
+        }
+        auto const records = ftell(file);
+        auto const sample_record = decoder->schema().find_role("sample").value_or(0);
+
+        decoder->next();
+        decoder->next();
+        decoder->next();
+        auto const expected = scales.convert(sample);
+        std::array<float, FlightSensors::column_count + 1> values {};
+        values[0] = static_cast<float>(expected.time_ms);
+        size_t column = 1;
+        FlightSensors::for_each([&]<typename S, size_t>() {
+            for (float value : S::DriverType::values(expected.*S::data)) {
+                values[column++] = value;
+            }
+        });
+        for (size_t i = 0; i < values.size(); i++) {
+            // The schema's fields are the time, the valid bits, then the columns. The decoder
+            // applies the scale and the calibration one after the other, in doubles.
+            auto const field = i == 0 ? 0 : i + 1;
+            auto const value = static_cast<float>(decoder->value(sample_record, field));
+            if (std::abs(value - values[i]) > 1e-5f * std::max(1.0f, std::abs(values[i]))) {
+                state.SkipWithError("the schema decoder disagrees with the sample");
+                fclose(file);
+                return;
+            }
+        }
+
+        fseek(file, records, SEEK_SET);
+        for (auto _ : state) {
+            auto record = decoder->next();
+            if (!record.has_value()) {
+                fseek(file, records, SEEK_SET);
+                record = decoder->next();
+            }
+            benchmark::DoNotOptimize(decoder->value(*record, 2));
+        }
+        state.SetItemsProcessed(state.iterations());
+        fclose(file);
+    }
+    BENCHMARK(BM_DecodeRow_Schema);
+}
@@ -0,0 +1,636 @@
+// Altitude estimation: the pressure-to-altitude table against the formula it replaces, the
+// altitude filter's cost per sample and how closely it tracks a simulated flight, and how the
+// barometer voter keeps it on track when one barometer goes bad. Also the air brake controller
+// that runs on those estimates, and its apogee predictor.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ctime>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "airbrake/apogee_controller.h"
+#include "airbrake/apogee_predictor.h"
+#include "bench.h"
+#include "computer/flight_phase.h"
+#include "estimation/altitude_filter.h"
+#include "estimation/baro_voter.h"
+#include "estimation/pad_calibration.h"
+#include "memory.h"
+
+namespace seds::bench {
+    using estimation::AltitudeFilter;
+    using estimation::BaroStatus;
+    using estimation::BaroVoter;
+    using estimation::GRAVITY;
+    using estimation::PadCalibrator;
+    namespace pressure_altitude = estimation::pressure_altitude;
+
+    namespace {
+        constexpr float ground_pressure = 101325.0f;
+
+        /// Standard atmosphere pressure at `altitude` above the ground, the inverse of
+        /// AltitudeAboveGround.
+        float pressure_at(float altitude) {
+            return ground_pressure * std::pow(1.0f - altitude / 44330.77f, 1.0f / 0.190263f);
+        }
+
+        struct TruthPoint {
+            float altitude;
+            float velocity;
+        };
+
+        /// A 100 Hz flight: two seconds on the pad, a 2.5 s burn at 12 g (past the BMI323's 8 g
+        /// range), then a drag-free coast to apogee and two seconds of falling. Sensor readings
+        /// get noise and fixed offsets close to what the real parts show.
+        struct SimulatedFlight {
+            std::vector<RawSensorSample> samples;
+            std::vector<TruthPoint> truth;
+            SensorScales scales;
+            /// `scales`, uncalibrated, as the estimator takes them.
+            CalibratedScales conversion;
+            TruthPoint apogee {};
+            int64_t apogee_ms = 0;
+
+            SimulatedFlight() {
+                auto computer = rig().make_computer(LogFormat::Raw);
+                this->scales = computer.scales();
+                this->conversion = this->scales;
+
+                std::mt19937 rng(1234);
+                std::normal_distribution<float> imu_noise(0.0f, 0.02f);
+                std::normal_distribution<float> high_g_noise(0.0f, 0.1f);
+                std::normal_distribution<float> baro_noise(0.0f, 6.0f);
+                constexpr float imu_offset = 0.03f;
+                constexpr float high_g_offset = -0.2f;
+
+                auto const imu_full_scale = 32767 * this->scales.imu.g_per_lsb;
+                float altitude = 0;
+                float velocity = 0;
+                for (int64_t ms = 0; this->apogee_ms == 0 || ms < this->apogee_ms + 2000; ms += 10) {
+                    // Acceleration, and the specific force along z that the accelerometers feel
+                    auto const t = ms / 1000.0f;
+                    float accel = -GRAVITY;
+                    float felt_g = 0;
+                    if (t < 2.0f) {
+                        accel = 0;
+                        felt_g = 1;
+                    } else if (t < 4.5f) {
+                        accel = 12.0f * GRAVITY;
+                        felt_g = 13;
+                    }
+
+                    auto const imu_g = std::clamp(felt_g + imu_offset + imu_noise(rng),
+                        -imu_full_scale, imu_full_scale);
+                    auto const high_g = felt_g + high_g_offset + high_g_noise(rng);
+
+                    RawSensorSample sample = typical_raw_sample();
+                    sample.time_ms = ms;
+                    sample.imu.az = static_cast<int16_t>(std::lround(imu_g / this->scales.imu.g_per_lsb));
+                    sample.high_g.z = static_cast<int16_t>(std::lround(high_g / this->scales.high_g.g_per_lsb));
+                    sample.baro1.pressure = std::lround((pressure_at(altitude) + baro_noise(rng))
+                        / this->scales.baro.pa_per_lsb);
+                    sample.baro2.pressure = std::lround((pressure_at(altitude) + baro_noise(rng))
+                        / this->scales.baro.pa_per_lsb);
+                    this->samples.push_back(sample);
+                    this->truth.push_back({ altitude, velocity });
+                    if (t > 2.0f && velocity < 0 && this->apogee_ms == 0) {
+                        this->apogee = this->truth[this->truth.size() - 2];
+                        this->apogee_ms = ms - 10;
+                    }
+
+                    altitude += velocity * 0.01f + 0.5f * accel * 0.0001f;
+                    velocity += accel * 0.01f;
+                }
+            }
+        };
+
+        SimulatedFlight const& flight() {
+            static SimulatedFlight const flight;
+            return flight;
+        }
+
+        /// The voter and filter together, as FlightComputer::handle_sample runs them.
+        struct Estimator {
+            BaroVoter voter;
+            AltitudeFilter filter;
+
+            Estimator() {
+                this->filter.set_ground_pressure(ground_pressure);
+            }
+
+            estimation::Estimate const& update(RawSensorSample const& sample,
+                CalibratedScales const& scales)
+            {
+                auto const& vote = this->voter.update(sample, scales.scales,
+                    this->filter.estimate());
+                return this->filter.update(sample, scales, vote);
+            }
+        };
+
+        /// Ways for barometer 2 to go bad three seconds in, half way through the burn.
+        enum class Fault {
+            None,
+            /// Keeps returning its last reading.
+            Stuck,
+            /// Drifts upward by 200 Pa/s (about 17 m/s of false descent).
+            Drift,
+            /// Stops answering.
+            Dead,
+            /// Every 20th reading is 2 kPa off.
+            Spikes,
+            /// Both barometers read 3 kPa low around 280 m/s, the way shock waves passing the
+            /// static ports make them.
+            Transonic,
+        };
+
+        char const* fault_name(Fault fault) {
+            switch (fault) {
+                case Fault::None: return "none";
+                case Fault::Stuck: return "baro 2 stuck";
+                case Fault::Drift: return "baro 2 drifting";
+                case Fault::Dead: return "baro 2 dead";
+                case Fault::Spikes: return "baro 2 spiking";
+                case Fault::Transonic: return "transonic dip on both";
+            }
+            return "unknown";
+        }
+
+        constexpr int64_t FAULT_MS = 3000;
+
+        std::vector<RawSensorSample> with_fault(SimulatedFlight const& flight, Fault fault) {
+            auto samples = flight.samples;
+            auto const pa_per_lsb = flight.scales.baro.pa_per_lsb;
+            int32_t stuck_counts = 0;
+
+            for (size_t i = 0; i < samples.size(); i++) {
+                auto& sample = samples[i];
+                if (fault == Fault::Transonic) {
+                    if (flight.truth[i].velocity > 270 && flight.truth[i].velocity < 290) {
+                        auto const dip = std::lround(-3000 / pa_per_lsb);
+                        sample.baro1.pressure += dip;
+                        sample.baro2.pressure += dip;
+                    }
+                    continue;
+                }
+                if (sample.time_ms < FAULT_MS) {
+                    stuck_counts = sample.baro2.pressure;
+                    continue;
+                }
+
+                auto const seconds = (sample.time_ms - FAULT_MS) / 1000.0f;
+                switch (fault) {
+                    case Fault::None:
+                    case Fault::Transonic:
+                        break;
+                    case Fault::Stuck:
+                        sample.baro2.pressure = stuck_counts;
+                        break;
+                    case Fault::Drift:
+                        sample.baro2.pressure += std::lround(200 * seconds / pa_per_lsb);
+                        break;
+                    case Fault::Dead:
+                        sample.valid &= ~VALID_BARO2;
+                        break;
+                    case Fault::Spikes:
+                        if (i % 20 == 0) {
+                            sample.baro2.pressure += std::lround(2000 / pa_per_lsb);
+                        }
+                        break;
+                }
+            }
+            return samples;
+        }
+
+        /// Pressures spread across the table, in a scrambled order so that consecutive lookups
+        /// don't hit the same segment.
+        std::array<float, 1024> const& sweep_pressures() {
+            static auto const pressures = [] {
+                std::array<float, 1024> pressures;
+                for (size_t i = 0; i < pressures.size(); i++) {
+                    auto const step = (i * 389) % pressures.size();
+                    pressures[i] = pressure_altitude::MIN_PRESSURE
+                        + (pressure_altitude::MAX_PRESSURE - pressure_altitude::MIN_PRESSURE)
+                        * step / pressures.size();
+                }
+                return pressures;
+            }();
+            return pressures;
+        }
+    }
+
+    static void BM_PressureAltitude_Pow(benchmark::State& state) {
+        auto const& pressures = sweep_pressures();
+        for (auto _ : state) {
+            for (float pressure : pressures) {
+                benchmark::DoNotOptimize(pressure_altitude::exact_standard_altitude(pressure));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * pressures.size());
+    }
+    BENCHMARK(BM_PressureAltitude_Pow);
+
+    static void BM_PressureAltitude_Table(benchmark::State& state) {
+        auto const& pressures = sweep_pressures();
+        for (auto _ : state) {
+            for (float pressure : pressures) {
+                benchmark::DoNotOptimize(pressure_altitude::standard_altitude(pressure));
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * pressures.size());
+    }
+    BENCHMARK(BM_PressureAltitude_Table);
+
+    /// Every float pressure in the table's range, at the barometer's 1/64 Pa resolution, against
+    /// the formula in double precision. This fails if the table is ever off by more than
+    /// MAX_ERROR, which the compile-time check can only sample.
+    static void BM_PressureAltitude_Accuracy(benchmark::State& state) {
+        double max_error = 0;
+        for (auto _ : state) {
+            max_error = 0;
+            for (float pressure = pressure_altitude::MIN_PRESSURE;
+                 pressure < pressure_altitude::MAX_PRESSURE;
+                 pressure += 1.0f / 64) {
+                auto const exact = pressure_altitude::HEIGHT_SCALE * (1 - std::pow(
+                    pressure / pressure_altitude::SEA_LEVEL_PRESSURE, pressure_altitude::EXPONENT));
+                max_error = std::max(max_error,
+                    std::abs(pressure_altitude::standard_altitude(pressure) - exact));
+            }
+        }
+
+        state.counters["max_error_m"] = max_error;
+        if (max_error > pressure_altitude::MAX_ERROR) {
+            state.SkipWithError("the altitude table is off by more than MAX_ERROR");
+        }
+    }
+    BENCHMARK(BM_PressureAltitude_Accuracy)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+    /// One vote and filter update with both barometers and both accelerometers, which is the most
+    /// work an update ever does.
+    static void BM_AltitudeFilter_Update(benchmark::State& state) {
+        CalibratedScales const scales(rig().make_computer(LogFormat::Raw).scales(),
+            typical_calibration());
+        Estimator estimator;
+        auto sample = typical_raw_sample();
+
+        for (auto _ : state) {
+            sample.time_ms += 10;
+            // Keep the barometers from looking stuck
+            sample.baro1.pressure ^= 1;
+            sample.baro2.pressure ^= 1;
+            benchmark::DoNotOptimize(estimator.update(sample, scales));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_AltitudeFilter_Update);
+
+    /// The whole simulated flight through a fresh filter. The counters show how far the estimate
+    /// strayed from the truth (m and m/s) after the first second on the pad.
+    static void BM_AltitudeFilter_Flight(benchmark::State& state) {
+        auto const& flight = bench::flight();
+        float max_altitude_error = 0;
+        float max_velocity_error = 0;
+        float apogee_error = 0;
+
+        for (auto _ : state) {
+            Estimator estimator;
+            max_altitude_error = 0;
+            max_velocity_error = 0;
+            float apogee = 0;
+
+            for (size_t i = 0; i < flight.samples.size(); i++) {
+                auto const& estimate = estimator.update(flight.samples[i], flight.conversion);
+                apogee = std::max(apogee, estimate.altitude);
+                if (i >= 100) {
+                    max_altitude_error = std::max(max_altitude_error,
+                        std::abs(estimate.altitude - flight.truth[i].altitude));
+                    max_velocity_error = std::max(max_velocity_error,
+                        std::abs(estimate.velocity - flight.truth[i].velocity));
+                }
+            }
+            apogee_error = apogee - flight.apogee.altitude;
+        }
+
+        state.SetItemsProcessed(state.iterations() * flight.samples.size());
+        state.counters["apogee_error_m"] = apogee_error;
+        state.counters["max_altitude_error_m"] = max_altitude_error;
+        state.counters["max_velocity_error_mps"] = max_velocity_error;
+    }
+    BENCHMARK(BM_AltitudeFilter_Flight)->Unit(benchmark::kMicrosecond);
+
+    /// The simulated flight through the filter and the phase tracker. The counters show how long
+    /// after the real event launch, burnout and apogee were detected (ms), which is mostly the
+    /// debounce time.
+    static void BM_PhaseTracker_Flight(benchmark::State& state) {
+        auto const& flight = bench::flight();
+        int64_t detected_ms[FLIGHT_PHASE_COUNT] = {};
+
+        for (auto _ : state) {
+            Estimator estimator;
+            PhaseTracker tracker;
+
+            for (auto const& sample : flight.samples) {
+                if (tracker.update(estimator.update(sample, flight.conversion))) {
+                    detected_ms[static_cast<size_t>(tracker.phase())] = sample.time_ms;
+                }
+            }
+        }
+
+        state.SetItemsProcessed(state.iterations() * flight.samples.size());
+        state.counters["launch_delay_ms"] = detected_ms[static_cast<size_t>(FlightPhase::Boost)] - 2000;
+        state.counters["burnout_delay_ms"] = detected_ms[static_cast<size_t>(FlightPhase::Coast)] - 4500;
+        state.counters["apogee_delay_ms"] = detected_ms[static_cast<size_t>(FlightPhase::Apogee)]
+            - flight.apogee_ms;
+    }
+    BENCHMARK(BM_PhaseTracker_Flight)->Unit(benchmark::kMicrosecond);
+
+    /// One air brake controller update while steering, which is the most work an update does,
+    /// with the closed-form prediction (0), the apogee predictor (1) or the predictor and the
+    /// drag fit (2). Heap allocation is armed, so the run aborts if an update allocates.
+    static void BM_ApogeeController_Update(benchmark::State& state) {
+        static airbrake::ApogeePredictor const predictor;
+        auto const config = airbrake::ControllerConfig { .identify_drag = state.range(0) == 2 };
+        auto controller = state.range(0) != 0
+            ? airbrake::ApogeeController(config, predictor)
+            : airbrake::ApogeeController();
+        estimation::Estimate estimate {
+            .time_ms = 0,
+            .altitude = 3000,
+            .velocity = 250,
+            .acceleration = -20,
+        };
+
+        memory::arm();
+        for (auto _ : state) {
+            estimate.time_ms += 10;
+            // Keep the prediction moving so the deployment doesn't saturate
+            estimate.velocity = estimate.velocity > 100 ? estimate.velocity - 0.1f : 250;
+            benchmark::DoNotOptimize(controller.update(estimate, true));
+        }
+        memory::disarm();
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_ApogeeController_Update)->DenseRange(0, 2);
+
+    /// One apogee prediction, from coast states spread over the whole coast and deployment
+    /// range. `evaluations` counts the drag lookups in a prediction, which are the same for
+    /// every state, and `slowest_ns` is the slowest state in thread CPU time. The ESP32 has
+    /// 160 000 cycles for a prediction at 160 MHz; a prediction is one dependent chain of
+    /// lookups and divisions, so an out-of-order host doesn't take many fewer cycles than the
+    /// in-order ESP32 would. Fails if a prediction does more than `max_evaluations` lookups,
+    /// which doesn't depend on the machine, or takes over 100 µs of CPU time, ten times what it
+    /// takes here, so only a gross regression trips it on a busy host.
+    /// CONFIG_SEDS_AIRBRAKE_TIMING times it on the board. Heap allocation is armed.
+    static void BM_ApogeePredictor(benchmark::State& state) {
+        constexpr size_t max_evaluations = 128;
+        constexpr double max_cpu_ns = 100'000;
+        airbrake::ApogeePredictor const predictor;
+        std::array<std::array<float, 3>, 64> states {};
+        for (size_t i = 0; i < states.size(); i++) {
+            auto const fraction = static_cast<float>(i) / static_cast<float>(states.size() - 1);
+            states[i] = { 4500 * fraction, 300 * (1 - fraction) + 10, (i % 5) * 0.25f };
+        }
+
+        size_t i = 0;
+        memory::arm();
+        for (auto _ : state) {
+            auto const& [altitude, velocity, deployment] = states[i++ % states.size()];
+            benchmark::DoNotOptimize(predictor.predict(altitude, velocity, deployment));
+        }
+        memory::disarm();
+
+        // The slowest of the states, each timed over enough predictions to read the clock. CPU
+        // time of this thread, so other processes on the host only cost it cache misses.
+        auto const cpu_ns = [] {
+            timespec now {};
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+            return static_cast<double>(now.tv_sec) * 1e9 + static_cast<double>(now.tv_nsec);
+        };
+        constexpr int repeats = 1000;
+        double slowest_ns = 0;
+        for (auto const& [altitude, velocity, deployment] : states) {
+            auto const start = cpu_ns();
+            for (int repeat = 0; repeat < repeats; repeat++) {
+                benchmark::DoNotOptimize(predictor.predict(altitude, velocity, deployment));
+            }
+            slowest_ns = std::max(slowest_ns, (cpu_ns() - start) / repeats);
+        }
+
+        constexpr auto evaluations = 4 * airbrake::ApogeePredictor::STEPS;
+        state.SetItemsProcessed(state.iterations());
+        state.counters["evaluations"] = evaluations;
+        state.counters["slowest_ns"] = slowest_ns;
+        if (evaluations > max_evaluations) {
+            state.SkipWithError("a prediction does too many drag lookups");
+        } else if (slowest_ns > max_cpu_ns) {
+            state.SkipWithError("a prediction is too slow for the air brake computer");
+        }
+    }
+    BENCHMARK(BM_ApogeePredictor);
+
+    /// The controller on the filter's estimates of the simulated flight, aiming 200 m under its
+    /// apogee, with the brakes doing nothing to the flight. Fails if the deployment ever leaves
+    /// 0..1 or moves faster than the rate limit. The counters show how far the prediction on
+    /// the first coasting sample was from the real apogee (m), and how far the brakes opened.
+    static void BM_ApogeeController_Flight(benchmark::State& state) {
+        auto const& flight = bench::flight();
+        float max_change = 0;
+        float max_deployment = 0;
+        float first_prediction_error = 0;
+        auto const config = airbrake::ControllerConfig {
+            .target_apogee = flight.apogee.altitude - 200,
+        };
+
+        for (auto _ : state) {
+            Estimator estimator;
+            PhaseTracker tracker;
+            airbrake::ApogeeController controller(config);
+            max_change = 0;
+            max_deployment = 0;
+            auto predicted = false;
+
+            for (auto const& sample : flight.samples) {
+                auto const& estimate = estimator.update(sample, flight.conversion);
+                tracker.update(estimate);
+                auto const coasting = tracker.phase() == FlightPhase::Coast;
+                auto const previous = controller.deployment();
+                auto const deployment = controller.update(estimate, coasting);
+                max_change = std::max(max_change, std::abs(deployment - previous));
+                max_deployment = std::max(max_deployment, deployment);
+                if (coasting && !predicted) {
+                    first_prediction_error = controller.predicted_apogee() - flight.apogee.altitude;
+                    predicted = true;
+                }
+                if (deployment < 0 || deployment > 1) {
+                    state.SkipWithError("the deployment left 0..1");
+                    return;
+                }
+            }
+        }
+
+        // Samples are 10 ms apart
+        if (max_change > config.max_rate * 0.01f + 1e-6f) {
+            state.SkipWithError("the deployment moved faster than the rate limit");
+            return;
+        }
+        state.SetItemsProcessed(state.iterations() * flight.samples.size());
+        state.counters["prediction_error_m"] = first_prediction_error;
+        state.counters["max_deployment"] = max_deployment;
+    }
+    BENCHMARK(BM_ApogeeController_Flight)->Unit(benchmark::kMicrosecond);
+
+    namespace {
+        struct FaultRun {
+            float max_altitude_error = 0;
+            float apogee_error = 0;
+            float min_health = 1;
+            std::array<BaroStatus, BaroVoter::BAROMETERS> statuses {};
+            std::array<uint32_t, BaroVoter::BAROMETERS> spikes {};
+        };
+
+        FaultRun fly(SimulatedFlight const& flight, std::vector<RawSensorSample> const& samples) {
+            Estimator estimator;
+            FaultRun run;
+            float apogee = 0;
+
+            for (size_t i = 0; i < samples.size(); i++) {
+                auto const& estimate = estimator.update(samples[i], flight.conversion);
+                apogee = std::max(apogee, estimate.altitude);
+                if (i >= 100) {
+                    run.max_altitude_error = std::max(run.max_altitude_error,
+                        std::abs(estimate.altitude - flight.truth[i].altitude));
+                    run.min_health = std::min(run.min_health, estimator.voter.vote().health);
+                }
+            }
+
+            run.apogee_error = apogee - flight.apogee.altitude;
+            for (size_t i = 0; i < BaroVoter::BAROMETERS; i++) {
+                run.statuses[i] = estimator.voter.status(i);
+                run.spikes[i] = estimator.voter.spikes(i);
+            }
+            return run;
+        }
+    }
+
+    /// The simulated flight with one of the faults above. The counters show the worst altitude
+    /// error (m) and the error at apogee, what the voter made of barometer 2 by landing, and the
+    /// lowest vote health seen. Fails if the fault moved the estimate more than a few metres
+    /// from where the same flight without it puts it, if the voter blamed barometer 1, or if it
+    /// missed the fault.
+    static void BM_BaroVoter_Fault(benchmark::State& state) {
+        auto const& flight = bench::flight();
+        auto const fault = static_cast<Fault>(state.range(0));
+        auto const samples = with_fault(flight, fault);
+        auto const clean = fly(flight, flight.samples);
+        FaultRun run;
+
+        for (auto _ : state) {
+            run = fly(flight, samples);
+        }
+
+        auto const baro2 = run.statuses[1];
+        state.SetLabel(fault_name(fault));
+        state.SetItemsProcessed(state.iterations() * samples.size());
+        state.counters["max_altitude_error_m"] = run.max_altitude_error;
+        state.counters["apogee_error_m"] = run.apogee_error;
+        state.counters["baro2_status"] = static_cast<double>(baro2);
+        state.counters["baro2_spikes"] = run.spikes[1];
+        state.counters["min_health"] = run.min_health;
+
+        if (run.max_altitude_error > clean.max_altitude_error + 5.0f
+            || std::abs(run.apogee_error - clean.apogee_error) > 1.0f) {
+            state.SkipWithError("the fault pulled the altitude estimate off");
+        } else if (run.statuses[0] != BaroStatus::Ok) {
+            state.SkipWithError("the voter blamed the good barometer");
+        } else if ((fault == Fault::None && (baro2 != BaroStatus::Ok || run.spikes[1] != 0))
+            || (fault == Fault::Stuck && baro2 != BaroStatus::Stuck)
+            || (fault == Fault::Drift && baro2 != BaroStatus::Diverged)
+            || (fault == Fault::Dead && baro2 != BaroStatus::Dead)
+            || ((fault == Fault::Spikes || fault == Fault::Transonic) && run.spikes[1] == 0)) {
+            state.SkipWithError("the voter got the fault wrong");
+        }
+    }
+    BENCHMARK(BM_BaroVoter_Fault)->DenseRange(0, static_cast<int>(Fault::Transonic))
+        ->Unit(benchmark::kMicrosecond);
+
+    /// The pad calibration against a rocket with known sensor errors: a gyro bias, a BMI323 that
+    /// reads 3% high, an ADXL375 offset from it, and a rail a few degrees off vertical. Someone
+    /// bumps the rocket during the first window, which has to be thrown away; the second is
+    /// still. The counters show how far the calibration is from undoing the errors. Fails if it
+    /// used the bumped window or is further off than the noise explains.
+    static void BM_PadCalibration(benchmark::State& state) {
+        auto const scales = rig().make_computer(LogFormat::Raw).scales();
+        constexpr std::array<float, 3> gyro_bias = { 0.8f, -0.5f, 0.3f };
+        constexpr float accel_scale = 1.03f;
+        constexpr std::array<float, 3> high_g_offset = { 0.3f, -0.2f, 0.4f };
+        constexpr std::array<float, 3> gravity = { 0.0499f, -0.0299f, 0.9983f };
+
+        std::mt19937 rng(99);
+        std::normal_distribution<float> imu_noise(0.0f, 0.005f);
+        std::normal_distribution<float> gyro_noise(0.0f, 0.1f);
+        std::normal_distribution<float> high_g_noise(0.0f, 0.1f);
+        std::normal_distribution<float> bump(0.0f, 0.3f);
+        auto const imu_counts = [&](float g) {
+            return static_cast<int16_t>(std::lround(g / scales.imu.g_per_lsb));
+        };
+        auto const gyro_counts = [&](float dps) {
+            return static_cast<int16_t>(std::lround(dps / scales.imu.dps_per_lsb));
+        };
+        auto const high_g_counts = [&](float g) {
+            return static_cast<int16_t>(std::lround(g / scales.high_g.g_per_lsb));
+        };
+
+        constexpr uint32_t window = estimation::CalibrationConfig {}.samples;
+        std::vector<RawSensorSample> samples;
+        for (uint32_t i = 0; i < 2 * window; i++) {
+            auto const bumped = i < window ? bump(rng) : 0.0f;
+            RawSensorSample sample = typical_raw_sample();
+            sample.time_ms = i * 100;
+            sample.imu.ax = imu_counts(accel_scale * (gravity[0] + bumped) + imu_noise(rng));
+            sample.imu.ay = imu_counts(accel_scale * gravity[1] + imu_noise(rng));
+            sample.imu.az = imu_counts(accel_scale * gravity[2] + imu_noise(rng));
+            sample.imu.gx = gyro_counts(gyro_bias[0] + gyro_noise(rng));
+            sample.imu.gy = gyro_counts(gyro_bias[1] + gyro_noise(rng));
+            sample.imu.gz = gyro_counts(gyro_bias[2] + gyro_noise(rng));
+            sample.high_g.x = high_g_counts(gravity[0] + bumped + high_g_offset[0] + high_g_noise(rng));
+            sample.high_g.y = high_g_counts(gravity[1] + high_g_offset[1] + high_g_noise(rng));
+            sample.high_g.z = high_g_counts(gravity[2] + high_g_offset[2] + high_g_noise(rng));
+            samples.push_back(sample);
+        }
+
+        PadCalibrator calibrator;
+        uint32_t calibrations = 0;
+        for (auto _ : state) {
+            calibrator = PadCalibrator();
+            calibrations = 0;
+            for (auto const& sample : samples) {
+                calibrations += calibrator.update(sample, scales);
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * samples.size());
+
+        if (calibrations != 1 || calibrator.rejected() != 1) {
+            state.SkipWithError("the calibration didn't throw away just the bumped window");
+            return;
+        }
+        auto const& calibration = *calibrator.calibration();
+        float gyro_error = 0;
+        float high_g_error = 0;
+        for (size_t i = 0; i < 3; i++) {
+            gyro_error = std::max(gyro_error, std::abs(calibration.imu[3 + i].offset + gyro_bias[i]));
+            high_g_error = std::max(high_g_error,
+                std::abs(calibration.high_g[i].offset + high_g_offset[i]));
+        }
+        auto const gain_error = std::abs(calibration.imu[2].gain * accel_scale - 1.0f);
+        state.counters["gyro_bias_error_dps"] = gyro_error;
+        state.counters["accel_gain_error"] = gain_error;
+        state.counters["high_g_offset_error_g"] = high_g_error;
+        if (gyro_error > 0.05f || gain_error > 0.002f || high_g_error > 0.05f) {
+            state.SkipWithError("the calibration is further off than the noise explains");
+        }
+    }
+    BENCHMARK(BM_PadCalibration)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,446 @@
+// FlightComputer::process end to end: sensor reads, row encoding, the flush buffer and the SD
+// writes, with the SD card backed by the host filesystem.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench.h"
+#include "clock.h"
+#include "i2c_bus.h"
+#include "memory.h"
+#include "sdkconfig.h"
+
+namespace seds::bench {
+    /// Matches LOOPS_BEFORE_FLUSH in computer.cpp, so every iteration ends with exactly one flush.
+    constexpr uint32_t rows_per_flush = CONFIG_SEDS_LOG_BUFFER_ROWS;
+
+    /// The flight loop in each log format. Fails if telemetry frames pile up with no radio task
+    /// to take them.
+    static void BM_FlightComputer_Process(benchmark::State& state) {
+        auto const format = static_cast<LogFormat>(state.range(0));
+        auto computer = rig().make_computer(format);
+        // The pad policy flushes more often than the buffer size
+        computer.rows_per_flush = rows_per_flush;
+
+        for (auto _ : state) {
+            computer.process(rows_per_flush, false);
+        }
+        state.SetItemsProcessed(state.iterations() * rows_per_flush);
+        state.SetLabel(format == LogFormat::Raw ? "raw" : "csv");
+
+        // Nothing takes the telemetry here, as on the board for now
+        if (computer.next_telemetry_frame() != nullptr
+            || computer.stats().telemetry_overruns != 0) {
+            state.SkipWithError("telemetry was encoded with nothing to take it");
+        }
+    }
+    BENCHMARK(BM_FlightComputer_Process)
+        ->Arg(static_cast<int>(LogFormat::Csv))
+        ->Arg(static_cast<int>(LogFormat::Raw))
+        ->Unit(benchmark::kMillisecond);
+
+    /// The flight loop with the IMU unplugged, so every loop creates and logs an error. With
+    /// SEDS_STATIC_MEMORY (the default), this also checks that errors don't touch the heap.
+    static void BM_FlightComputer_Process_ImuFault(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto computer = rig.make_computer(LogFormat::Raw);
+        computer.rows_per_flush = rows_per_flush;
+        rig.imu_model.present = false;
+
+        for (auto _ : state) {
+            computer.process(rows_per_flush, false);
+        }
+        state.SetItemsProcessed(state.iterations() * rows_per_flush);
+
+        rig.imu_model.present = true;
+    }
+    BENCHMARK(BM_FlightComputer_Process_ImuFault)->Unit(benchmark::kMillisecond);
+
+    /// A nothrow allocation while armed, which should fail with nullptr like a real one rather
+    /// than abort. Without SEDS_STATIC_MEMORY arming does nothing, so it should succeed.
+    static void BM_Memory_NothrowArmed(benchmark::State& state) {
+        void* ptr = nullptr;
+        for (auto _ : state) {
+            memory::arm();
+            ptr = ::operator new(64, std::nothrow);
+            memory::disarm();
+            benchmark::DoNotOptimize(ptr);
+            ::operator delete(ptr);
+        }
+
+#if CONFIG_SEDS_STATIC_MEMORY
+        if (ptr != nullptr) {
+            state.SkipWithError("nothrow new allocated while armed");
+        }
+#else
+        if (ptr == nullptr) {
+            state.SkipWithError("nothrow new failed with the check off");
+        }
+#endif
+    }
+    BENCHMARK(BM_Memory_NothrowArmed);
+
+    /// The flight loop with barometer 2 unplugged. Once the voter has marked it dead it is only
+    /// read once a second, so the counter should show close to its one read per sample saved
+    /// against everything plugged in. On the real bus each of those would be a full timeout.
+    static void BM_FlightComputer_Process_BaroFault(benchmark::State& state) {
+        auto& rig = bench::rig();
+        auto computer = rig.make_computer(LogFormat::Raw);
+        computer.rows_per_flush = rows_per_flush;
+        auto const& bus = sim::I2CBus::instance();
+
+        auto before = bus.transaction_count();
+        computer.process(rows_per_flush, false);
+        auto const healthy = bus.transaction_count() - before;
+
+        rig.baro2_model.present = false;
+        computer.process(rows_per_flush, false);
+
+        before = bus.transaction_count();
+        for (auto _ : state) {
+            computer.process(rows_per_flush, false);
+        }
+        auto const faulty = bus.transaction_count() - before;
+        auto const rows = state.iterations() * rows_per_flush;
+        state.SetItemsProcessed(rows);
+        state.counters["transactions_saved_per_sample"] =
+            static_cast<double>(healthy) / rows_per_flush - static_cast<double>(faulty) / rows;
+
+        if (computer.baro_voter.status(1) != estimation::BaroStatus::Dead) {
+            state.SkipWithError("the voter didn't mark the unplugged barometer dead");
+        }
+        rig.baro2_model.present = true;
+    }
+    BENCHMARK(BM_FlightComputer_Process_BaroFault)->Unit(benchmark::kMillisecond);
+
+    namespace {
+        enum class BusFault {
+            None,
+            /// The IMU stops answering, so its reads are NACKed.
+            UnpluggedImu,
+            /// Something holds the bus for one transaction, until the bus is reset.
+            Glitch,
+            /// The bus is held for good, so every device times out.
+            Jammed,
+        };
+
+        char const* bus_fault_name(BusFault fault) {
+            switch (fault) {
+                case BusFault::None: return "none";
+                case BusFault::UnpluggedImu: return "imu unplugged";
+                case BusFault::Glitch: return "bus glitch";
+                case BusFault::Jammed: return "bus jammed";
+            }
+            return "unknown";
+        }
+    }
+
+    /// Ten seconds of 100 Hz steps on simulated time, so the I2C backoffs play out, with the fault
+    /// starting a second in. On the real bus the loop blocks for as long as its transactions take,
+    /// so the counters are the bus time (µs) of the slowest, fastest and mean step once the fault
+    /// has started, and how many times the bus was reset. Fails if retrying an unplugged sensor
+    /// ever costs a step more than 300 µs over the slowest healthy one (which includes the
+    /// sensor supervisor's routine probes), if the loop hasn't recovered from a glitch by the
+    /// end, or if a jammed bus ever costs a step more than `max_jammed_us`: two timeouts cut
+    /// short by the SCL wait and two resets, before the bus is backed off.
+    static void BM_FlightComputer_Step_BusFault(benchmark::State& state) {
+        constexpr int64_t step_us = 10'000;
+        constexpr int64_t fault_us = 1'000'000;
+        constexpr int64_t end_us = 10'000'000;
+        constexpr uint64_t max_jammed_us = 2 * (I2CDevice::SCL_WAIT_US + 100);
+        auto const fault = static_cast<BusFault>(state.range(0));
+        auto& rig = bench::rig();
+        auto& bus = sim::I2CBus::instance();
+
+        uint64_t healthy_worst_us = 0;
+        uint64_t worst_us = 0;
+        uint64_t best_us = 0;
+        uint64_t total_us = 0;
+        uint64_t last_us = 0;
+        uint32_t resets = 0;
+        size_t steps = 0;
+
+        for (auto _ : state) {
+            auto computer = rig.make_computer(LogFormat::Raw);
+            sim::use_virtual_time(0);
+            auto const resets_before = bus.reset_count();
+            worst_us = 0;
+            best_us = UINT64_MAX;
+            total_us = 0;
+            steps = 0;
+
+            for (int64_t now_us = 0; now_us < end_us; now_us += step_us) {
+                if (now_us == fault_us) {
+                    switch (fault) {
+                        case BusFault::None: break;
+                        case BusFault::UnpluggedImu: rig.imu_model.present = false; break;
+                        case BusFault::Glitch: bus.jam(true); break;
+                        case BusFault::Jammed: bus.jam(false); break;
+                    }
+                }
+
+                sim::set_virtual_time(now_us);
+                auto const before = bus.wire_time_us();
+                computer.step();
+                last_us = bus.wire_time_us() - before;
+
+                if (now_us < fault_us) {
+                    healthy_worst_us = std::max(healthy_worst_us, last_us);
+                } else {
+                    worst_us = std::max(worst_us, last_us);
+                    best_us = std::min(best_us, last_us);
+                    total_us += last_us;
+                    steps++;
+                }
+            }
+
+            resets = bus.reset_count() - resets_before;
+            rig.imu_model.present = true;
+            bus.unjam();
+            // The bus object outlives the computer, so let it find the bus free again before the
+            // clock goes back for the next run
+            auto const max_backoff_us = std::chrono::microseconds(I2CDevice::MAX_BACKOFF).count();
+            sim::set_virtual_time(end_us + max_backoff_us);
+            computer.step();
+            sim::use_real_time();
+        }
+
+        state.SetLabel(bus_fault_name(fault));
+        state.counters["worst_step_bus_us"] = worst_us;
+        state.counters["best_step_bus_us"] = best_us;
+        state.counters["mean_step_bus_us"] = static_cast<double>(total_us) / steps;
+        state.counters["bus_resets"] = resets;
+
+        if (fault == BusFault::UnpluggedImu && worst_us > healthy_worst_us + 300) {
+            state.SkipWithError("an unplugged sensor slowed the loop down");
+        } else if (fault == BusFault::Glitch && (resets == 0 || last_us > healthy_worst_us)) {
+            state.SkipWithError("the bus didn't recover from a glitch");
+        } else if (fault == BusFault::Jammed && worst_us > max_jammed_us) {
+            state.SkipWithError("a jammed bus slowed the loop down");
+        }
+    }
+    BENCHMARK(BM_FlightComputer_Step_BusFault)
+        ->DenseRange(0, static_cast<int>(BusFault::Jammed))
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
+
+    /// Two seconds of the acquisition loop under one phase's policy, on simulated time. The
+    /// sampling timer ticks at the policy's period, and each read holds the task for as long as
+    /// its transactions hold the bus, so a read that runs past the next tick misses periods the
+    /// way `acquisition_loop` counts them. The first read includes switching the IMU to the
+    /// phase's data rate. The counters are the missed periods and the slowest read's bus time
+    /// (µs). Fails if any period is missed.
+    static void BM_FlightComputer_Step_PhasePeriod(benchmark::State& state) {
+        constexpr int64_t end_us = 2'000'000;
+        auto const phase = static_cast<FlightPhase>(state.range(0));
+        int64_t const period_us = policy_for(phase).sample_period_us;
+        auto& bus = sim::I2CBus::instance();
+
+        uint32_t missed = 0;
+        uint64_t worst_us = 0;
+
+        for (auto _ : state) {
+            auto computer = rig().make_computer(LogFormat::Raw);
+            // Only the sensor side follows this; the phase tracker stays on the pad
+            computer.current_phase = phase;
+            sim::use_virtual_time(0);
+            missed = 0;
+            worst_us = 0;
+
+            int64_t now_us = 0;
+            int64_t next_tick_us = 0;
+            while (next_tick_us < end_us) {
+                // Wait for the next tick, or take every tick that went by during the last read
+                now_us = std::max(now_us, next_tick_us);
+                uint32_t periods = 0;
+                for (; next_tick_us <= now_us; next_tick_us += period_us) {
+                    periods++;
+                }
+                missed += periods - 1;
+
+                sim::set_virtual_time(now_us);
+                auto const before = bus.wire_time_us();
+                computer.step();
+                auto const took_us = bus.wire_time_us() - before;
+                worst_us = std::max(worst_us, took_us);
+                now_us += static_cast<int64_t>(took_us);
+            }
+            sim::use_real_time();
+        }
+
+        state.SetLabel(to_string(phase));
+        state.counters["period_us"] = static_cast<double>(period_us);
+        state.counters["worst_step_bus_us"] = static_cast<double>(worst_us);
+        state.counters["missed_periods"] = missed;
+
+        if (missed > 0) {
+            state.SkipWithError("the bus can't keep up with the phase's sampling period");
+        }
+    }
+    BENCHMARK(BM_FlightComputer_Step_PhasePeriod)
+        ->DenseRange(0, FLIGHT_PHASE_COUNT - 1)
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
+
+    namespace {
+        void power_cycle(sim::Rig& rig, SensorId sensor) {
+            switch (sensor) {
+                case SensorId::Imu: rig.imu_model.power_cycle(); break;
+                case SensorId::HighG: rig.high_g_model.power_cycle(); break;
+                case SensorId::Baro1: rig.baro1_model.power_cycle(); break;
+                case SensorId::Baro2: rig.baro2_model.power_cycle(); break;
+                case SensorId::Temperature: rig.temp_model.power_cycle(); break;
+            }
+        }
+
+        /// Whether `sensor` reads the same in both samples.
+        bool same_reading(RawSensorSample const& a, RawSensorSample const& b, SensorId sensor) {
+            switch (sensor) {
+                case SensorId::Imu: return std::memcmp(&a.imu, &b.imu, sizeof(a.imu)) == 0;
+                case SensorId::HighG: return std::memcmp(&a.high_g, &b.high_g, sizeof(a.high_g)) == 0;
+                case SensorId::Baro1: return std::memcmp(&a.baro1, &b.baro1, sizeof(a.baro1)) == 0;
+                case SensorId::Baro2: return std::memcmp(&a.baro2, &b.baro2, sizeof(a.baro2)) == 0;
+                case SensorId::Temperature: return a.temp == b.temp;
+            }
+            return false;
+        }
+    }
+
+    /// One sensor browns out a second into two seconds of 100 Hz steps on simulated time, coming
+    /// back in its power-on configuration. Before every step the sensors are read once more to
+    /// see what the step is about to get. The counters are how long that sensor's readings were
+    /// wrong and how many resets the supervisor found. Fails unless the reset was found and the
+    /// readings were back within a couple of samples of the supervisor's stuck threshold. The
+    /// TMP1075 runs in its power-on configuration, so losing it costs nothing and needs no fix.
+    static void BM_FlightComputer_Step_Brownout(benchmark::State& state) {
+        constexpr int64_t step_us = 10'000;
+        constexpr int64_t fault_us = 1'000'000;
+        constexpr int64_t end_us = 2'000'000;
+        constexpr int64_t max_lost_us = (SupervisorConfig {}.stuck_after + 2) * step_us;
+        auto const sensor = static_cast<SensorId>(state.range(0));
+        auto& rig = bench::rig();
+
+        int64_t lost_us = 0;
+        uint32_t resets = 0;
+
+        for (auto _ : state) {
+            auto computer = rig.make_computer(LogFormat::Raw);
+            sim::use_virtual_time(0);
+            RawSensorSample healthy {};
+            int64_t recovered_us = -1;
+
+            for (int64_t now_us = 0; now_us < end_us; now_us += step_us) {
+                if (now_us == fault_us) {
+                    power_cycle(rig, sensor);
+                }
+
+                sim::set_virtual_time(now_us);
+                auto const next = computer.read_sensors_raw();
+                computer.step();
+
+                if (now_us < fault_us) {
+                    healthy = next;
+                } else if (recovered_us < 0 && same_reading(next, healthy, sensor)) {
+                    recovered_us = now_us;
+                }
+            }
+
+            lost_us = recovered_us < 0 ? end_us - fault_us : recovered_us - fault_us;
+            resets = computer.supervisor.health(sensor).resets;
+            sim::use_real_time();
+        }
+
+        state.SetLabel(to_string(sensor));
+        state.counters["data_lost_ms"] = lost_us / 1000.0;
+        state.counters["resets"] = resets;
+
+        if (resets == 0 && sensor != SensorId::Temperature) {
+            state.SkipWithError("the supervisor didn't notice the sensor reset");
+        } else if (lost_us > max_lost_us) {
+            state.SkipWithError("the sensor took too long to come back");
+        }
+    }
+    BENCHMARK(BM_FlightComputer_Step_Brownout)
+        ->DenseRange(0, SENSOR_COUNT - 1)
+        ->Iterations(1)
+        ->Unit(benchmark::kMillisecond);
+
+    /// The flight tasks from FlightComputer::start, left running for a second of real time on the
+    /// pad (so at the pad's sampling rate). This is a soak check more than a speed measurement:
+    /// the counters should show every period sampled, nothing dropped, and how deep the queue
+    /// got while the storage task was flushing.
+    static void BM_FlightComputer_Tasks(benchmark::State& state) {
+        auto computer = rig().make_computer(LogFormat::Raw);
+
+        for (auto _ : state) {
+            errors::unwrap(computer.start());
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            computer.stop();
+        }
+
+        auto const stats = computer.stats();
+        state.counters["samples_read"] = stats.samples_read;
+        state.counters["missed_periods"] = stats.missed_periods;
+        state.counters["queue_overruns"] = stats.queue_overruns;
+        state.counters["max_queue_depth"] = stats.max_queue_depth;
+    }
+    BENCHMARK(BM_FlightComputer_Tasks)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+    /// The buffer reset done after every flush.
+    static void BM_FlushBuffer_Reset(benchmark::State& state) {
+        std::vector<char> buffer(rows_per_flush * CSV_ROW_MAX_LEN);
+
+        for (auto _ : state) {
+            std::memset(buffer.data(), 'X', buffer.size());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    BENCHMARK(BM_FlushBuffer_Reset);
+
+    /// One flush worth of CSV rows appended with SDCard::append_file, which reopens the file.
+    static void BM_SDCard_AppendFlush(benchmark::State& state) {
+        auto computer = rig().make_computer();
+        std::vector<char> buffer;
+        auto const sample = typical_sample();
+        char row[CSV_ROW_MAX_LEN];
+        for (uint32_t i = 0; i < rows_per_flush; i++) {
+            auto const len = format_csv_row(row, sizeof(row), sample);
+            buffer.insert(buffer.end(), row, row + len);
+        }
+
+        for (auto _ : state) {
+            auto result = computer.sd.append_file(computer.filename, (uint8_t *)buffer.data(), buffer.size());
+            benchmark::DoNotOptimize(result);
+        }
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    BENCHMARK(BM_SDCard_AppendFlush);
+
+    /// The same rows written the way FlightComputer::flush does, to a file that stays open.
+    static void BM_AppendFile_WriteSync(benchmark::State& state) {
+        auto computer = rig().make_computer();
+        std::vector<char> buffer;
+        auto const sample = typical_sample();
+        char row[CSV_ROW_MAX_LEN];
+        for (uint32_t i = 0; i < rows_per_flush; i++) {
+            auto const len = format_csv_row(row, sizeof(row), sample);
+            buffer.insert(buffer.end(), row, row + len);
+        }
+
+        for (auto _ : state) {
+            auto written = computer.log_file.write((uint8_t *)buffer.data(), buffer.size());
+            auto synced = computer.log_file.sync();
+            benchmark::DoNotOptimize(written);
+            benchmark::DoNotOptimize(synced);
+        }
+        state.SetBytesProcessed(state.iterations() * buffer.size());
+    }
+    BENCHMARK(BM_AppendFile_WriteSync);
+}
@@ -0,0 +1,182 @@
+// SpscRing, the lock-free ring between the acquisition and storage tasks, against the FreeRTOS
+// queue it replaced (as emulated by the host shim, which also locks and copies every item).
+//
+// The two-thread benchmarks double as stress tests: every record carries a sequence number and
+// the consumer checks that it sees each one exactly once, in order. They fail with an error
+// instead of reporting a time if a record is lost, duplicated or torn.
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include <benchmark/benchmark.h>
+
+#include "bench.h"
+#include "freertos/queue.h"
+#include "spsc_ring.h"
+
+namespace seds::bench {
+    namespace {
+        /// A sample-sized record that can tell when it's been torn.
+        struct Record {
+            uint64_t sequence;
+            RawSensorSample sample;
+            uint64_t check;
+        };
+
+        Record make_record(uint64_t sequence) {
+            auto sample = typical_raw_sample();
+            sample.time_ms = sequence;
+            return Record { .sequence = sequence, .sample = sample, .check = ~sequence };
+        }
+
+        bool is_valid(Record const& record, uint64_t expected) {
+            return record.sequence == expected
+                && record.check == ~expected
+                && record.sample.time_ms == static_cast<int64_t>(expected);
+        }
+
+        constexpr uint64_t records_per_run = 200'000;
+    }
+
+    /// Push then pop on one thread: the uncontended cost of moving a record through the ring.
+    static void BM_SpscRing_PushPop(benchmark::State& state) {
+        static SpscRing<Record, 64> ring;
+        auto const record = make_record(1);
+        Record out;
+
+        for (auto _ : state) {
+            ring.push(record);
+            ring.pop(out);
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_SpscRing_PushPop);
+
+    /// The same through the FreeRTOS queue API.
+    static void BM_FreeRtosQueue_SendReceive(benchmark::State& state) {
+        static StaticQueue_t queue_buffer;
+        static uint8_t storage[64 * sizeof(Record)];
+        auto queue = xQueueCreateStatic(64, sizeof(Record), storage, &queue_buffer);
+        auto const record = make_record(1);
+        Record out;
+
+        for (auto _ : state) {
+            xQueueSend(queue, &record, 0);
+            xQueueReceive(queue, &out, 0);
+            benchmark::DoNotOptimize(out);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_FreeRtosQueue_SendReceive);
+
+    /// A producer and a consumer thread moving records through a small ring (so it's full or
+    /// empty as often as possible), `state.range(0)` records at a time. A batch size of 0 uses
+    /// claim/commit and front/release instead of copying. Each side yields when it can't make
+    /// progress, standing in for the task notification the firmware blocks on, so this still
+    /// finishes on a single core.
+    template<size_t Capacity>
+    static void BM_SpscRing_Stress(benchmark::State& state) {
+        static SpscRing<Record, Capacity> ring;
+        size_t const batch = state.range(0);
+
+        for (auto _ : state) {
+            ring.clear();
+            std::atomic<bool> failed = false;
+
+            std::thread producer([&] {
+                std::array<Record, 64> records;
+                uint64_t next = 0;
+                while (next < records_per_run && !failed) {
+                    if (batch == 0) {
+                        if (Record* slot = ring.claim()) {
+                            *slot = make_record(next++);
+                            ring.commit();
+                        } else {
+                            std::this_thread::yield();
+                        }
+                        continue;
+                    }
+
+                    auto const count = std::min<uint64_t>(batch, records_per_run - next);
+                    for (size_t i = 0; i < count; i++) {
+                        records[i] = make_record(next + i);
+                    }
+                    for (size_t sent = 0; sent < count && !failed;) {
+                        auto const pushed = ring.push(
+                            std::span<Record const>(&records[sent], count - sent));
+                        if (pushed == 0) {
+                            std::this_thread::yield();
+                        }
+                        sent += pushed;
+                    }
+                    next += count;
+                }
+            });
+
+            std::array<Record, 64> records;
+            uint64_t expected = 0;
+            while (expected < records_per_run && !failed) {
+                if (batch == 0) {
+                    if (Record const* record = ring.front()) {
+                        failed = !is_valid(*record, expected++);
+                        ring.release();
+                    } else {
+                        std::this_thread::yield();
+                    }
+                    continue;
+                }
+
+                auto const count = ring.pop(std::span<Record>(records.data(), batch));
+                if (count == 0) {
+                    std::this_thread::yield();
+                }
+                for (size_t i = 0; i < count && !failed; i++) {
+                    failed = !is_valid(records[i], expected++);
+                }
+            }
+
+            producer.join();
+            if (failed) {
+                state.SkipWithError("consumer saw a record out of order or torn");
+                return;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * records_per_run);
+    }
+    BENCHMARK(BM_SpscRing_Stress<4>)->Arg(0)->Arg(1)->Arg(3)->Unit(benchmark::kMillisecond)->UseRealTime();
+    BENCHMARK(BM_SpscRing_Stress<64>)->Arg(0)->Arg(1)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    /// The producer/consumer pair through the FreeRTOS queue API, for comparison.
+    static void BM_FreeRtosQueue_Stress(benchmark::State& state) {
+        static StaticQueue_t queue_buffer;
+        static uint8_t storage[64 * sizeof(Record)];
+
+        for (auto _ : state) {
+            auto queue = xQueueCreateStatic(64, sizeof(Record), storage, &queue_buffer);
+            bool failed = false;
+
+            std::thread producer([&] {
+                for (uint64_t next = 0; next < records_per_run; next++) {
+                    auto const record = make_record(next);
+                    xQueueSend(queue, &record, portMAX_DELAY);
+                }
+            });
+
+            Record record;
+            for (uint64_t expected = 0; expected < records_per_run; expected++) {
+                xQueueReceive(queue, &record, portMAX_DELAY);
+                failed |= !is_valid(record, expected);
+            }
+
+            producer.join();
+            if (failed) {
+                state.SkipWithError("consumer saw a record out of order or torn");
+                return;
+            }
+        }
+        state.SetItemsProcessed(state.iterations() * records_per_run);
+    }
+    BENCHMARK(BM_FreeRtosQueue_Stress)->Unit(benchmark::kMillisecond)->UseRealTime();
+}
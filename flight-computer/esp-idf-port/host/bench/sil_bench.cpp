@@ -0,0 +1,189 @@
+// The software-in-the-loop flight (sil/loop.h): the trajectory engine flying the RocketPyTest
+// rocket with the flight computer and the air brake controller in the loop, under virtual time.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "airbrake/drag_identifier.h"
+#include "bench.h"
+#include "engine/apogee_controller.h"
+#include "loop.h"
+#include "memory.h"
+
+namespace seds::bench {
+    /// One closed-loop flight to apogee per iteration, brakes stowed (0) or flown (1). Fails if
+    /// the flight computer misses apogee or burnout, if its apogee is more than 5% off the
+    /// engine's, or if the loop can't keep up with real time. The counters show how far ahead of
+    /// real time it runs and the cycle latency: host compute plus the modelled I2C wire time.
+    static void BM_SoftwareInTheLoop(benchmark::State& state) {
+        auto const scenario = trajectory::load_calisto(TRAJECTORY_DATA_DIR);
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        sil::Config config;
+        config.brakes = state.range(0) != 0;
+        // Low enough that the brakes have something to do
+        config.target = 4900;
+
+        sil::Result result;
+        for (auto _ : state) {
+            result = sil::fly(rig(), *scenario, config);
+        }
+
+        if (!result.flight.reached_apogee || result.cycles.empty()) {
+            state.SkipWithError("the rocket never reached apogee");
+            return;
+        }
+        auto const& coast = result.phase_times[static_cast<size_t>(FlightPhase::Coast)];
+        if (!coast.has_value() || std::abs(*coast - result.flight.burn_out_time) > 0.5) {
+            state.SkipWithError("burnout was missed or detected more than 0.5 s off");
+            return;
+        }
+        auto const apogee_error =
+            (result.apogee.altitude - result.flight.apogee) / result.flight.apogee;
+        if (std::abs(apogee_error) > 0.05) {
+            state.SkipWithError("the estimated apogee is more than 5% off");
+            return;
+        }
+        if (result.wall_s >= result.simulated_s) {
+            state.SkipWithError("the loop ran slower than real time");
+            return;
+        }
+
+        std::vector<float> latency;
+        double wire = 0;
+        for (auto const& cycle : result.cycles) {
+            latency.push_back(cycle.compute_us + cycle.wire_us);
+            wire += cycle.wire_us;
+        }
+        std::sort(latency.begin(), latency.end());
+        auto const cycles = static_cast<double>(result.cycles.size());
+
+        state.counters["cycles"] = benchmark::Counter(cycles * static_cast<double>(
+            state.iterations()), benchmark::Counter::kIsRate);
+        state.counters["real_time_factor"] = result.simulated_s / result.wall_s;
+        state.counters["p99_latency_us"] = latency[latency.size() * 99 / 100];
+        state.counters["wire_us"] = wire / cycles;
+        state.counters["apogee_error_pct"] = 100 * apogee_error;
+        state.counters["deployment"] = result.flight.deployment;
+    }
+    BENCHMARK(BM_SoftwareInTheLoop)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+    namespace {
+        /// A closed-loop flight of a rocket 15% draggier than the air brake computer's tables,
+        /// brakes stowed, flown once and kept for replaying the flight computer's estimates.
+        struct RecordedFlight {
+            static constexpr double drag_error = 1.15;
+            std::optional<trajectory::Scenario> scenario;
+            sil::Result result;
+            /// The cycles after burnout was detected, while the rocket was still going up.
+            std::vector<sil::Cycle> coast;
+
+            RecordedFlight() {
+                auto loaded = trajectory::load_calisto(TRAJECTORY_DATA_DIR);
+                if (!loaded.has_value()) {
+                    return;
+                }
+                this->scenario = *loaded;
+                sil::Config config;
+                config.brakes = false;
+                config.drag_error = drag_error;
+                this->result = sil::fly(rig(), *this->scenario, config);
+
+                auto const& burn_out = this->result.phase_times[static_cast<size_t>(
+                    FlightPhase::Coast)];
+                if (!burn_out.has_value()) {
+                    return;
+                }
+                auto const coast_ms = std::llround((config.pad + *burn_out) * 1000);
+                for (auto const& cycle : this->result.cycles) {
+                    if (cycle.estimate.time_ms >= coast_ms && cycle.estimate.velocity > 0) {
+                        this->coast.push_back(cycle);
+                    }
+                }
+            }
+        };
+
+        RecordedFlight const& recorded_flight() {
+            static RecordedFlight const flight;
+            return flight;
+        }
+    }
+
+    /// The drag identifier replaying the flight computer's estimates of a flight 15% draggier
+    /// than the predictor's tables: the predictor's regressors and one fit per coast sample,
+    /// which is what it adds to each controller update. Heap allocation is armed. Fails if a
+    /// sample costs over 1 µs, a guard far inside the 1 ms control cycle, or if the fit doesn't
+    /// move toward the flown rocket: an airframe scale over 1, and a better prediction 6 s after
+    /// burnout than the tables give. How close it gets is limited by the estimates it reads,
+    /// whose altitude and velocity run about 3% high here. trajectory_bench's
+    /// BM_DragIdentifier_Accuracy and BM_DragIdentifier_Convergence check that the fit itself
+    /// converges on the engine's true state. The counters
+    /// show the fitted airframe scale at apogee and how far the two predictions were from the
+    /// estimated apogee, m.
+    static void BM_DragIdentifier_Replay(benchmark::State& state) {
+        auto const& flight = recorded_flight();
+        if (flight.coast.empty()) {
+            state.SkipWithError("the recorded flight has no coast");
+            return;
+        }
+        airbrake::ApogeePredictor const predictor(trajectory::predictor_config(*flight.scenario));
+        auto const fit = [&](airbrake::DragIdentifier& identifier, sil::Cycle const& cycle) {
+            auto const& estimate = cycle.estimate;
+            auto const drag =
+                -(estimate.acceleration + estimate.accel_bias) - estimation::GRAVITY;
+            identifier.update(estimate.time_ms, estimate.velocity, drag,
+                predictor.regressors(estimate.altitude, estimate.velocity, cycle.deployment));
+        };
+
+        airbrake::DragIdentifier identifier;
+        auto const start = std::chrono::steady_clock::now();
+        memory::arm();
+        for (auto _ : state) {
+            identifier.reset();
+            for (auto const& cycle : flight.coast) {
+                fit(identifier, cycle);
+            }
+            benchmark::DoNotOptimize(identifier);
+        }
+        memory::disarm();
+        std::chrono::duration<double, std::nano> const elapsed =
+            std::chrono::steady_clock::now() - start;
+        auto const samples = static_cast<double>(state.iterations() * flight.coast.size());
+        auto const ns_per_sample = elapsed.count() / samples;
+        auto const body = identifier.scales().body;
+
+        // Replay again up to 6 s into the coast, and predict from there
+        identifier.reset();
+        auto const first_ms = flight.coast.front().estimate.time_ms;
+        auto const apogee = flight.result.apogee.altitude;
+        float tables_error = 0;
+        float fitted_error = 0;
+        for (auto const& cycle : flight.coast) {
+            if (cycle.estimate.time_ms - first_ms >= 6000) {
+                tables_error = predictor.predict(cycle.estimate, 0) - apogee;
+                fitted_error = predictor.predict(cycle.estimate, 0, identifier.scales()) - apogee;
+                break;
+            }
+            fit(identifier, cycle);
+        }
+
+        state.SetItemsProcessed(static_cast<int64_t>(samples));
+        state.counters["ns_per_sample"] = ns_per_sample;
+        state.counters["body_scale"] = body;
+        state.counters["tables_error_m"] = tables_error;
+        state.counters["fitted_error_m"] = fitted_error;
+        if (ns_per_sample > 1000) {
+            state.SkipWithError("a drag fit is too slow for the control loop");
+        } else if (!(body > 1) || !(std::abs(fitted_error) < std::abs(tables_error))) {
+            state.SkipWithError("the drag fit didn't move toward the flown rocket");
+        }
+    }
+    BENCHMARK(BM_DragIdentifier_Replay);
+}
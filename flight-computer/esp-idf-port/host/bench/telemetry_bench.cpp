@@ -0,0 +1,370 @@
+// The telemetry downlink (telemetry/downlink.h and telemetry/frame.h): what a frame costs to
+// encode on the flight computer, how well the ground finds frames in a damaged byte stream, and
+// what a software-in-the-loop flight puts down the link at a given budget.
+//
+// Each one checks what it measures and fails with an error instead of reporting a time if a
+// value doesn't survive the round trip, a damaged frame is accepted, or the link goes over
+// budget.
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "bench.h"
+#include "loop.h"
+#include "memory.h"
+#include "telemetry/downlink.h"
+
+namespace seds::bench {
+    using namespace seds::telemetry;
+
+    namespace {
+        estimation::Estimate const coast_estimate = {
+            .time_ms = 0,
+            .altitude = 2345.6f,
+            .velocity = 187.3f,
+            .acceleration = -21.7f,
+            .accel_bias = 0.043f,
+            .high_g_weight = 0.25f,
+            .altitude_variance = 2.25f,
+        };
+
+        Health const some_health = {
+            .valid = VALID_ALL & ~VALID_BARO2,
+            .dead = VALID_BARO2,
+            .queue_overruns = 3,
+            .missed_periods = 70'000,
+            .max_queue_depth = 12,
+        };
+
+        GpsFix const some_fix = {
+            .latitude_e7 = 329'906'120,
+            .longitude_e7 = -1'069'746'430,
+            .altitude = 1401.4f,
+            .satellites = 9,
+            .fix = GpsFixType::Fix3D,
+        };
+
+        /// Milliseconds between frames at `budget`.
+        int64_t frame_period_ms(uint32_t budget) {
+            return static_cast<int64_t>(std::ceil(FRAME_LEN * 1000.0 / budget));
+        }
+
+        bool near(float decoded, float value, float resolution) {
+            return std::abs(decoded - value) <= resolution / 2 + 1e-4f * std::abs(value);
+        }
+
+        /// Whether the groups `frame` carries hold what was encoded.
+        bool round_trips(Frame const& frame, estimation::Estimate const& estimate) {
+            bool ok = frame.time_ms == static_cast<uint32_t>(estimate.time_ms)
+                && frame.state.phase == FlightPhase::Coast
+                && near(frame.state.altitude, estimate.altitude, 0.5f)
+                && near(frame.state.velocity, estimate.velocity, 0.05f)
+                && near(frame.state.acceleration, estimate.acceleration, 0.02f);
+            if (frame.contents & GROUP_HEALTH) {
+                ok = ok && frame.health.valid == some_health.valid
+                    && frame.health.dead == some_health.dead
+                    && frame.health.queue_overruns == some_health.queue_overruns
+                    && frame.health.missed_periods == UINT16_MAX
+                    && frame.health.max_queue_depth == some_health.max_queue_depth;
+            }
+            if (frame.contents & GROUP_ESTIMATOR) {
+                ok = ok && near(frame.estimator.altitude_sigma, 1.5f, 0.1f)
+                    && near(frame.estimator.high_g_weight, estimate.high_g_weight, 1 / 255.0f)
+                    && near(frame.estimator.accel_bias, estimate.accel_bias, 0.01f);
+            }
+            if (frame.contents & GROUP_GPS) {
+                ok = ok && frame.gps.latitude_e7 == some_fix.latitude_e7
+                    && frame.gps.longitude_e7 == some_fix.longitude_e7
+                    && near(frame.gps.altitude, some_fix.altitude, 1)
+                    && frame.gps.satellites == some_fix.satellites && frame.gps.fix == some_fix.fix;
+            }
+            return ok;
+        }
+    }
+
+    /// One frame's worth of Downlink work per iteration: the scheduler's decision, quantizing
+    /// the estimate and health, and the CRC, with heap allocation armed. Afterwards a second of
+    /// frames with a GPS fix every second is decoded; it fails if any group doesn't come back
+    /// as encoded, within its resolution, or if the health, estimator and GPS groups don't all
+    /// go down. `payload_used` is the share of each frame's payload that carried groups.
+    static void BM_Telemetry_Encode(benchmark::State& state) {
+        DownlinkConfig const config;
+        auto const period_ms = frame_period_ms(config.budget);
+        Downlink downlink(config);
+        auto estimate = coast_estimate;
+        FrameBytes frame;
+
+        memory::arm();
+        for (auto _ : state) {
+            estimate.time_ms += period_ms;
+            if (downlink.due(estimate.time_ms)) {
+                downlink.encode(frame.data(), estimate, FlightPhase::Coast, some_health);
+            }
+            benchmark::DoNotOptimize(frame);
+        }
+        memory::disarm();
+
+        downlink = Downlink(config);
+        uint8_t seen = 0;
+        size_t payload = 0;
+        size_t frames = 0;
+        for (int64_t time_ms = 1; time_ms <= 1000; time_ms += period_ms) {
+            estimate.time_ms = time_ms;
+            if (time_ms % 1000 == 1) {
+                downlink.update_gps(some_fix);
+            }
+            if (!downlink.due(time_ms)) {
+                continue;
+            }
+            downlink.encode(frame.data(), estimate, FlightPhase::Coast, some_health);
+            auto const decoded = decode_frame(frame.data());
+            if (!decoded.has_value() || !round_trips(*decoded, estimate)) {
+                state.SkipWithError("a frame didn't decode to what was encoded");
+                return;
+            }
+            seen |= decoded->contents;
+            for (size_t i = 0; i < GROUP_COUNT; i++) {
+                payload += decoded->contents & (1 << i) ? GROUP_LEN[i] : 0;
+            }
+            frames++;
+        }
+        if (seen != (GROUP_STATE | GROUP_HEALTH | GROUP_ESTIMATOR | GROUP_GPS)) {
+            state.SkipWithError("a group never went down");
+            return;
+        }
+
+        state.SetBytesProcessed(state.iterations() * FRAME_LEN);
+        state.counters["payload_used"] = static_cast<double>(payload)
+            / static_cast<double>(frames * FRAME_PAYLOAD_LEN);
+    }
+    BENCHMARK(BM_Telemetry_Encode);
+
+    /// Scheduler::due once per sample, with samples every 2 ms as in boost, for a minute that
+    /// starts well after boot and has half a second without samples every 3 s. Fails if two
+    /// frames go out within one period of the budget, or if the frames fall behind the
+    /// budget's rate while samples are coming in. The counter is the shortest time between
+    /// frames, in periods.
+    static void BM_Telemetry_Schedule(benchmark::State& state) {
+        constexpr int64_t sample_ms = 2;
+        constexpr int64_t stretch_ms = 3'000;
+        constexpr int64_t gap_ms = 500;
+        DownlinkConfig const config;
+        auto const period_us = static_cast<int64_t>(FRAME_LEN) * 1'000'000 / config.budget;
+
+        size_t frames = 0;
+        int64_t shortest_ms = INT64_MAX;
+        for (auto _ : state) {
+            Scheduler scheduler(config);
+            frames = 0;
+            shortest_ms = INT64_MAX;
+            std::optional<int64_t> last_ms;
+            for (int64_t start_ms = 60'000; start_ms < 120'000; start_ms += stretch_ms) {
+                for (int64_t time_ms = start_ms; time_ms < start_ms + stretch_ms - gap_ms;
+                    time_ms += sample_ms) {
+                    if (!scheduler.due(time_ms)) {
+                        continue;
+                    }
+                    if (last_ms.has_value()) {
+                        shortest_ms = std::min(shortest_ms, time_ms - *last_ms);
+                    }
+                    last_ms = time_ms;
+                    frames++;
+                }
+            }
+            benchmark::DoNotOptimize(frames);
+        }
+
+        // Each stretch of samples has room for this many whole periods, starting on its first
+        auto const stretches = 60'000 / stretch_ms;
+        auto const expected = stretches * ((stretch_ms - gap_ms) * 1000 / period_us);
+        state.SetItemsProcessed(state.iterations() * stretches * (stretch_ms - gap_ms) / sample_ms);
+        state.counters["shortest_periods"] = static_cast<double>(shortest_ms * 1000)
+            / static_cast<double>(period_us);
+        if (shortest_ms * 1000 < period_us) {
+            state.SkipWithError("two frames went out within one period of the budget");
+        } else if (static_cast<int64_t>(frames) < expected) {
+            state.SkipWithError("frames went out slower than the budget allows");
+        }
+    }
+    BENCHMARK(BM_Telemetry_Schedule);
+
+    /// The ground's Deframer over a stream of 1000 frames in which every byte is damaged or lost
+    /// with a probability of `range(0)` in 10,000. Fails if a frame decodes to anything but what
+    /// was sent, or if any frame that came through intact isn't found. The counter is the share
+    /// of frames recovered.
+    static void BM_Telemetry_Deframe(benchmark::State& state) {
+        constexpr size_t frame_count = 1000;
+        auto const error_rate = static_cast<double>(state.range(0)) / 10'000;
+
+        DownlinkConfig const config;
+        auto const period_ms = frame_period_ms(config.budget);
+        Downlink downlink(config);
+        auto estimate = coast_estimate;
+        std::vector<FrameBytes> sent(frame_count);
+        for (size_t i = 0; i < frame_count; i++) {
+            estimate.time_ms = static_cast<int64_t>(i + 1) * period_ms;
+            estimate.altitude = coast_estimate.altitude + static_cast<float>(i);
+            if (!downlink.due(estimate.time_ms)) {
+                state.SkipWithError("a frame wasn't due at the budget's rate");
+                return;
+            }
+            downlink.encode(sent[i].data(), estimate, FlightPhase::Coast, some_health);
+        }
+
+        // Flip or drop bytes, and note which frames come through untouched
+        std::mt19937 rng(7);
+        std::bernoulli_distribution damaged(error_rate);
+        std::bernoulli_distribution dropped(0.5);
+        std::uniform_int_distribution<int> flip(1, 255);
+        std::vector<uint8_t> stream;
+        size_t intact = 0;
+        for (auto const& frame : sent) {
+            bool touched = false;
+            for (auto byte : frame) {
+                if (damaged(rng)) {
+                    touched = true;
+                    if (dropped(rng)) {
+                        continue;
+                    }
+                    byte ^= static_cast<uint8_t>(flip(rng));
+                }
+                stream.push_back(byte);
+            }
+            intact += !touched;
+        }
+
+        Deframer deframer;
+        for (auto _ : state) {
+            deframer = Deframer();
+            for (auto byte : stream) {
+                benchmark::DoNotOptimize(deframer.push(byte));
+            }
+        }
+
+        // Once more, checking every frame against what was sent
+        deframer = Deframer();
+        for (auto byte : stream) {
+            auto const frame = deframer.push(byte);
+            if (!frame.has_value()) {
+                continue;
+            }
+            if (frame->sequence >= frame_count
+                || frame != decode_frame(sent[frame->sequence].data())) {
+                state.SkipWithError("a damaged frame was accepted");
+                return;
+            }
+        }
+        if (deframer.frames() < intact) {
+            state.SkipWithError("an intact frame was missed");
+            return;
+        }
+
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(stream.size()));
+        state.counters["recovered"] = static_cast<double>(deframer.frames()) / frame_count;
+    }
+    BENCHMARK(BM_Telemetry_Deframe)->Arg(0)->Arg(10)->Arg(100);
+
+    /// A software-in-the-loop flight to apogee with a telemetry budget of `range(0)` bytes/s,
+    /// decoded on the ground. Fails if the link carried more than the budget, a frame went
+    /// missing or out of order, two frames went out within one period of the budget, an
+    /// altitude came down more than its resolution off the estimate it was taken from, a phase
+    /// the flight computer entered never went down, or the health and estimator groups came
+    /// down slower than the rates the scheduler granted them. The counters show the link's use
+    /// and each group's rate over the flight, Hz.
+    static void BM_Telemetry_Downlink(benchmark::State& state) {
+        auto const scenario = trajectory::load_calisto(TRAJECTORY_DATA_DIR);
+        if (!scenario.has_value()) {
+            state.SkipWithError(scenario.error().c_str());
+            return;
+        }
+        sil::Config config;
+        config.telemetry_budget = static_cast<uint32_t>(state.range(0));
+
+        sil::Result result;
+        for (auto _ : state) {
+            result = sil::fly(rig(), *scenario, config);
+        }
+
+        Scheduler const schedule({ .budget = config.telemetry_budget });
+        Deframer deframer;
+        size_t cycle = 0;
+        size_t frames = 0;
+        size_t group_frames[GROUP_COUNT] = {};
+        bool phase_seen[FLIGHT_PHASE_COUNT] = {};
+        uint32_t first_ms = 0;
+        uint32_t last_ms = 0;
+        for (auto byte : result.downlink) {
+            auto const frame = deframer.push(byte);
+            if (!frame.has_value()) {
+                continue;
+            }
+            if (frame->sequence != static_cast<uint16_t>(frames)) {
+                state.SkipWithError("a frame went missing or out of order");
+                return;
+            }
+            // Frames are taken with a sample, and the cycles are in order
+            while (cycle < result.cycles.size()
+                && result.cycles[cycle].estimate.time_ms < frame->time_ms) {
+                cycle++;
+            }
+            if (cycle == result.cycles.size()
+                || result.cycles[cycle].estimate.time_ms != frame->time_ms
+                || !near(frame->state.altitude, result.cycles[cycle].estimate.altitude, 0.5f)) {
+                state.SkipWithError("a frame's altitude doesn't match the estimate");
+                return;
+            }
+            for (size_t i = 0; i < GROUP_COUNT; i++) {
+                group_frames[i] += (frame->contents >> i) & 1;
+            }
+            phase_seen[static_cast<size_t>(frame->state.phase)] = true;
+            if (frames > 0 && (frame->time_ms - last_ms) * 1000
+                < FRAME_LEN * 1'000'000 / config.telemetry_budget) {
+                state.SkipWithError("two frames went out within one period of the budget");
+                return;
+            }
+            first_ms = frames == 0 ? frame->time_ms : first_ms;
+            last_ms = frame->time_ms;
+            frames++;
+        }
+
+        if (frames < 2 || frames * FRAME_LEN != result.downlink.size()) {
+            state.SkipWithError("the downlink isn't whole frames");
+            return;
+        }
+
+        auto const span_s = static_cast<double>(last_ms - first_ms) / 1000;
+        // Each frame's bytes take until the next one goes out
+        auto const bytes_per_s = static_cast<double>((frames - 1) * FRAME_LEN) / span_s;
+        auto const rate = [&](Group group) {
+            return static_cast<double>(group_frames[std::countr_zero(
+                static_cast<unsigned>(group))]) / span_s;
+        };
+        state.counters["bytes_per_s"] = bytes_per_s;
+        state.counters["frames"] = static_cast<double>(frames);
+        state.counters["state_hz"] = rate(GROUP_STATE);
+        state.counters["health_hz"] = rate(GROUP_HEALTH);
+        state.counters["estimator_hz"] = rate(GROUP_ESTIMATOR);
+
+        if (bytes_per_s > config.telemetry_budget) {
+            state.SkipWithError("the downlink went over budget");
+        } else if (rate(GROUP_HEALTH) < 0.9 * schedule.rate(GROUP_HEALTH)
+            || rate(GROUP_ESTIMATOR) < 0.9 * schedule.rate(GROUP_ESTIMATOR)) {
+            state.SkipWithError("a group went down slower than its granted rate");
+        } else {
+            for (size_t i = 0; i < FLIGHT_PHASE_COUNT; i++) {
+                if (result.phase_times[i].has_value() && !phase_seen[i]) {
+                    state.SkipWithError("a phase never went down");
+                    return;
+                }
+            }
+        }
+    }
+    BENCHMARK(BM_Telemetry_Downlink)->Arg(CONFIG_SEDS_TELEMETRY_BUDGET)->Arg(96)
+        ->Unit(benchmark::kMillisecond);
+}
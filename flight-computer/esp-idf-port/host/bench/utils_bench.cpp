@@ -0,0 +1,65 @@
+// Byte-order helpers from utils.h, which every register access goes through.
+
+#include <benchmark/benchmark.h>
+
+#include "utils.h"
+
+namespace seds::bench {
+    template<typename T>
+    static void BM_FromLeBytes(benchmark::State& state) {
+        std::array<uint8_t, sizeof(T)> bytes {};
+        for (size_t i = 0; i < bytes.size(); i++) {
+            bytes[i] = i * 37 + 1;
+        }
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(bytes);
+            benchmark::DoNotOptimize(num::from_le_bytes<T>(bytes));
+        }
+    }
+    BENCHMARK(BM_FromLeBytes<uint16_t>);
+    BENCHMARK(BM_FromLeBytes<uint32_t>);
+    BENCHMARK(BM_FromLeBytes<uint64_t>);
+
+    template<typename T>
+    static void BM_FromBeBytes(benchmark::State& state) {
+        std::array<uint8_t, sizeof(T)> bytes {};
+        for (size_t i = 0; i < bytes.size(); i++) {
+            bytes[i] = i * 37 + 1;
+        }
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(bytes);
+            benchmark::DoNotOptimize(num::from_be_bytes<T>(bytes));
+        }
+    }
+    BENCHMARK(BM_FromBeBytes<uint16_t>);
+    BENCHMARK(BM_FromBeBytes<uint32_t>);
+    BENCHMARK(BM_FromBeBytes<uint64_t>);
+
+    template<typename T>
+    static void BM_ToBeBytes(benchmark::State& state) {
+        T value = static_cast<T>(0x0123456789ABCDEFull);
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(value);
+            benchmark::DoNotOptimize(num::to_be_bytes(value));
+        }
+    }
+    BENCHMARK(BM_ToBeBytes<uint16_t>);
+    BENCHMARK(BM_ToBeBytes<uint32_t>);
+    BENCHMARK(BM_ToBeBytes<uint64_t>);
+
+    template<typename T>
+    static void BM_ToLeBytes(benchmark::State& state) {
+        T value = static_cast<T>(0x0123456789ABCDEFull);
+
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(value);
+            benchmark::DoNotOptimize(num::to_le_bytes(value));
+        }
+    }
+    BENCHMARK(BM_ToLeBytes<uint16_t>);
+    BENCHMARK(BM_ToLeBytes<uint32_t>);
+    BENCHMARK(BM_ToLeBytes<uint64_t>);
+}
@@ -0,0 +1,134 @@
+// Converts a raw flight log to CSV in engineering units, going only by the schema the log carries.
+//
+// Unlike replay, this knows nothing about the sensors that wrote the log, so it reads logs from
+// any firmware whose raw logs have a schema (version 2 on), however their records are laid out.
+// Readings from sensors that failed to read are left empty.
+//
+//     decode_log [--settings] <log> > <csv>
+
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "errors.h"
+#include "log_schema.h"
+
+using namespace seds;
+
+namespace {
+    void usage() {
+        std::fprintf(stderr,
+            "usage: decode_log [--settings] <log>\n"
+            "\n"
+            "  --settings  print the sensor settings to stderr whenever they change\n");
+    }
+
+    /// Whether any field of any record is converted by `field` of `record`.
+    bool is_scale(replay::LogSchema const& schema, size_t record, size_t field) {
+        for (auto const& other : schema.records) {
+            for (auto const& f : other.fields) {
+                if (f.scale == std::pair { record, field }) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+}
+
+int main(int argc, char** argv) {
+    char const* path = nullptr;
+    bool settings = false;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--settings") {
+            settings = true;
+        } else if (!arg.starts_with("-") && path == nullptr) {
+            path = argv[i];
+        } else {
+            usage();
+            return 2;
+        }
+    }
+    if (path == nullptr) {
+        usage();
+        return 2;
+    }
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    // Only the name is checked, since the schema says what each version holds
+    uint8_t magic[8] = {};
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, "SEDSRAW", 7) != 0
+        || magic[7] < 2) {
+        std::fprintf(stderr, "%s is not a raw log with a schema (version 2 or later)\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    auto decoder = errors::unwrap(replay::SchemaDecoder::open(file));
+    auto const& schema = decoder.schema();
+    auto const sample_record = schema.find_role("sample");
+    if (!sample_record.has_value()) {
+        std::fprintf(stderr, "%s has no sample records\n", path);
+        fclose(file);
+        return 1;
+    }
+
+    // Every sample field but the valid bits, which decide which values are left empty
+    auto const& samples = schema.records[*sample_record];
+    std::vector<size_t> columns;
+    for (size_t i = 0; i < samples.fields.size(); i++) {
+        if (samples.fields[i].name != "valid") {
+            columns.push_back(i);
+        }
+    }
+
+    for (size_t i = 0; i < columns.size(); i++) {
+        auto const& field = samples.fields[columns[i]];
+        std::printf("%s%s (%s)", i == 0 ? "" : ", ", field.name.c_str(), field.unit.c_str());
+    }
+    std::printf("\n");
+
+    size_t rows = 0;
+    double last_time = 0;
+    auto const time_field = samples.find("time");
+    while (auto const record = decoder.next()) {
+        if (*record == *sample_record) {
+            for (size_t i = 0; i < columns.size(); i++) {
+                std::printf(i == 0 ? "" : ",");
+                if (decoder.valid(*record, columns[i])) {
+                    std::printf("%.9g", decoder.value(*record, columns[i]));
+                }
+            }
+            std::printf("\n");
+            if (time_field.has_value()) {
+                last_time = decoder.value(*record, *time_field);
+            }
+            rows++;
+            continue;
+        }
+
+        if (settings) {
+            // Scale factors are already applied, so only the settings behind them are news
+            std::fprintf(stderr, "after %.0f ms:", last_time);
+            auto const& fields = schema.records[*record].fields;
+            for (size_t i = 0; i < fields.size(); i++) {
+                if (!is_scale(schema, *record, i)) {
+                    std::fprintf(stderr, " %s %g %s;", fields[i].name.c_str(),
+                        decoder.value(*record, i), fields[i].unit.c_str());
+                }
+            }
+            std::fprintf(stderr, "\n");
+        }
+    }
+
+    fclose(file);
+    std::fprintf(stderr, "decoded %zu samples\n", rows);
+    return 0;
+}
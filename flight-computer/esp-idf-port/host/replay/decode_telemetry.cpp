@@ -0,0 +1,93 @@
+// Converts the telemetry radio's byte stream to CSV, one row per frame.
+//
+// The stream can start anywhere and have bytes missing or damaged, as it would coming off a real
+// receiver: frames are found by their sync and checked by their CRC (see telemetry/frame.h).
+// Fields of groups a frame didn't carry are left empty. How much of the stream made it through
+// is printed to stderr at the end, with frames lost in between counted by their sequence numbers.
+//
+//     decode_telemetry <stream> > <csv>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <string_view>
+
+#include "telemetry/frame.h"
+
+using namespace seds;
+using namespace seds::telemetry;
+
+namespace {
+    void usage() {
+        std::fprintf(stderr, "usage: decode_telemetry <stream>\n");
+    }
+
+    void print_frame(Frame const& frame) {
+        std::printf("%u,%" PRIu32 ",%s,%.1f,%.2f,%.2f", frame.sequence, frame.time_ms,
+            to_string(frame.state.phase), frame.state.altitude, frame.state.velocity,
+            frame.state.acceleration);
+        if (frame.contents & GROUP_HEALTH) {
+            auto const& health = frame.health;
+            std::printf(",0x%02x,0x%02x,%" PRIu32 ",%" PRIu32 ",%" PRIu32, health.valid,
+                health.dead, health.queue_overruns, health.missed_periods, health.max_queue_depth);
+        } else {
+            std::printf(",,,,,");
+        }
+        if (frame.contents & GROUP_ESTIMATOR) {
+            auto const& estimator = frame.estimator;
+            std::printf(",%.1f,%.3f,%.2f", estimator.altitude_sigma, estimator.high_g_weight,
+                estimator.accel_bias);
+        } else {
+            std::printf(",,,");
+        }
+        if (frame.contents & GROUP_GPS) {
+            auto const& gps = frame.gps;
+            std::printf(",%.7f,%.7f,%.0f,%u,%u", gps.latitude_e7 * 1e-7, gps.longitude_e7 * 1e-7,
+                gps.altitude, gps.satellites, static_cast<unsigned>(gps.fix));
+        } else {
+            std::printf(",,,,,");
+        }
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 || std::string_view(argv[1]).starts_with("-")) {
+        usage();
+        return 2;
+    }
+    char const* path = argv[1];
+
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr) {
+        std::fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    std::printf("sequence,time (ms),phase,altitude (m),velocity (m/s),acceleration (m/s^2),"
+        "valid,dead,queue overruns,missed periods,max queue depth,altitude sigma (m),"
+        "high g weight,accel bias (m/s^2),latitude (deg),longitude (deg),gps altitude (m),"
+        "satellites,fix\n");
+
+    Deframer deframer;
+    std::optional<uint16_t> last_sequence;
+    uint32_t lost = 0;
+    uint8_t chunk[4096];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        deframer.feed(chunk, len, [&](Frame const& frame) {
+            if (last_sequence.has_value()) {
+                lost += static_cast<uint16_t>(frame.sequence - *last_sequence - 1);
+            }
+            last_sequence = frame.sequence;
+            print_frame(frame);
+        });
+    }
+    fclose(file);
+
+    std::fprintf(stderr, "%" PRIu32 " frames, %" PRIu32 " lost, %" PRIu32 " corrupted, %" PRIu32
+        " bytes skipped\n", deframer.frames(), lost, deframer.corrupted(), deframer.skipped());
+    return 0;
+}
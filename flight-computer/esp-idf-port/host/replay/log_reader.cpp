@@ -0,0 +1,282 @@
+#include "log_reader.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "esp_log.h"
+
+static const char *TAG = "replay";
+
+namespace seds::replay {
+    namespace {
+        /// Parses exactly `N` comma-separated numbers from a CSV row.
+        template<size_t N>
+        std::optional<std::array<double, N>> parse_row(std::string_view row) {
+            std::array<double, N> values {};
+            char const* cursor = row.data();
+            char const* const end = row.data() + row.size();
+
+            for (size_t i = 0; i < N; i++) {
+                while (cursor < end && *cursor == ' ') {
+                    cursor++;
+                }
+
+                auto [next, error] = std::from_chars(cursor, end, values[i]);
+                if (error != std::errc {}) {
+                    return std::nullopt;
+                }
+
+                cursor = next;
+                char const expected = (i + 1 == N) ? '\n' : ',';
+                if (cursor < end && *cursor != expected) {
+                    return std::nullopt;
+                }
+                cursor++;
+            }
+
+            return values;
+        }
+
+        /// The header CSV logs had before it was generated from FlightSensors. The columns are the
+        /// same, so older logs still replay.
+        constexpr char LEGACY_CSV_HEADER[] = "timestamp, accel x, accel y, accel z, degrees x, degrees y, degrees z, baro 1 temp, baro 1 pressure, baro 2 temp, baro 2 pressure, high g accel x, high g accel y, high g accel z, temp\n";
+
+        /// Reads the rest of a raw record whose type byte is already in `record[0]`.
+        bool read_body(uint8_t* record, size_t len, FILE* file) {
+            return fread(&record[1], 1, len - 1, file) == len - 1;
+        }
+
+        /// The magic bytes, without the version.
+        constexpr size_t RAW_LOG_MAGIC_LEN = sizeof(RAW_LOG_MAGIC) - 1;
+
+        // Version 1 raw logs: a fixed scales record, and sample records laid out as they still are
+        constexpr size_t LEGACY_SCALES_RECORD_LEN = 1 + 2 * 4 + 3 + 4 * 4;
+        static_assert(RAW_SAMPLE_RECORD_LEN == 38, "version 1 sample records need their own decoder");
+
+        SensorScales decode_legacy_scales(uint8_t const* src) {
+            auto const f32 = [&] {
+                float value;
+                memcpy(&value, src, sizeof(value));
+                src += sizeof(value);
+                return value;
+            };
+
+            SensorScales scales;
+            scales.imu.g_per_lsb = f32();
+            scales.imu.dps_per_lsb = f32();
+            scales.imu.accel_range = *src++;
+            scales.imu.gyro_range = *src++;
+            scales.imu.sensor_hz = *src++;
+            scales.baro.c_per_lsb = f32();
+            scales.baro.pa_per_lsb = f32();
+            scales.high_g.g_per_lsb = f32();
+            scales.temp.c_per_lsb = f32();
+            return scales;
+        }
+
+        /// The name a column or setting has in raw logs' schemas.
+        std::string column_name(std::string_view sensor, char const* field) {
+            std::string name(sensor);
+            if (*field != '\0') {
+                name += ' ';
+                name += field;
+            }
+            return name;
+        }
+    }
+
+    Expected<std::unique_ptr<LogReader>> open_log(char const* path) {
+        FILE* file = fopen(path, "rb");
+        if (file == nullptr) {
+            return std::unexpected(std::make_unique<Error>(strerror(errno)));
+        }
+
+        uint8_t magic[sizeof(RAW_LOG_MAGIC)] = {};
+        if (fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+            && memcmp(magic, RAW_LOG_MAGIC, RAW_LOG_MAGIC_LEN) == 0) {
+            auto const version = magic[RAW_LOG_MAGIC_LEN];
+            if (version == 1) {
+                return std::make_unique<LegacyRawLogReader>(file);
+            }
+
+            // Every later version describes itself
+            return TRY(RawLogReader::open(file));
+        }
+        rewind(file);
+
+        char header[std::max(sizeof(CSV_HEADER), sizeof(LEGACY_CSV_HEADER)) + 1] = {};
+        if (fgets(header, sizeof(header), file) != nullptr
+            && (strcmp(header, CSV_HEADER.data()) == 0 || strcmp(header, LEGACY_CSV_HEADER) == 0)) {
+            return std::make_unique<CsvLogReader>(file);
+        }
+
+        fclose(file);
+        return std::unexpected(std::make_unique<Error>(
+            "unrecognized log format (header doesn't match any log the flight computer writes)"
+        ));
+    }
+
+    CsvLogReader::~CsvLogReader() {
+        fclose(this->file);
+    }
+
+    std::optional<LogSample> CsvLogReader::next() {
+        char row[CSV_ROW_MAX_LEN + 1];
+
+        while (fgets(row, sizeof(row), this->file) != nullptr) {
+            this->line++;
+
+            auto const values = parse_row<FlightSensors::column_count + 1>(row);
+            if (!values.has_value()) {
+                ESP_LOGW(TAG, "skipping malformed row on line %zu", this->line);
+                continue;
+            }
+
+            return sample_from_csv(*values);
+        }
+
+        return std::nullopt;
+    }
+
+    Expected<std::unique_ptr<RawLogReader>> RawLogReader::open(FILE* file) {
+        auto decoder = SchemaDecoder::open(file);
+        if (!decoder.has_value()) {
+            fclose(file);
+            return std::unexpected(std::move(decoder).error());
+        }
+        // From here on the reader closes the file
+        auto reader = std::unique_ptr<RawLogReader>(new RawLogReader(file, std::move(decoder).value()));
+        auto const& schema = reader->decoder.schema();
+        auto const scales = schema.find_role("scales");
+        auto const samples = schema.find_role("sample");
+        if (!scales.has_value() || !samples.has_value()) {
+            return std::unexpected(std::make_unique<Error>("raw log's schema has no scales or sample record"));
+        }
+
+        reader->scales_record = *scales;
+        reader->sample_record = *samples;
+
+        auto const& scale_fields = schema.records[*scales];
+        auto const& sample_fields = schema.records[*samples];
+        reader->time_field = sample_fields.find("time");
+        for (size_t i = 0; i < FlightSensors::column_count; i++) {
+            auto const& column = FlightSensors::columns[i];
+            auto const name = column_name(column.sensor, column.field.name);
+            reader->columns[i] = sample_fields.find(name);
+            reader->per_count[i] = scale_fields.find(name + " scale");
+            if (!reader->columns[i].has_value()) {
+                ESP_LOGW(TAG, "log has no %s column, so %.*s will read as failed", name.c_str(),
+                    (int)column.sensor.size(), column.sensor.data());
+            }
+        }
+        for (size_t i = 0; i < FlightSensors::config_count; i++) {
+            auto const& config = FlightSensors::configs[i];
+            reader->configs[i] = scale_fields.find(column_name(config.sensor, config.field.name));
+        }
+        if (!reader->time_field.has_value()) {
+            return std::unexpected(std::make_unique<Error>("raw log's samples have no time"));
+        }
+
+        return reader;
+    }
+
+    RawLogReader::RawLogReader(FILE* file, SchemaDecoder&& decoder)
+        : file(file), decoder(std::move(decoder)) {}
+
+    RawLogReader::~RawLogReader() {
+        fclose(this->file);
+    }
+
+    std::optional<LogSample> RawLogReader::next() {
+        auto const get = [&](size_t record, std::optional<size_t> field) {
+            return field.has_value() ? this->decoder.raw(record, *field) : 0.0;
+        };
+
+        while (auto const record = this->decoder.next()) {
+            if (*record == this->scales_record) {
+                SensorScales scales;
+                size_t column = 0;
+                size_t config = 0;
+                FlightSensors::for_each([&]<typename S, size_t>() {
+                    std::array<float, S::fields.size()> per_count;
+                    for (auto& value : per_count) {
+                        value = static_cast<float>(get(*record, this->per_count[column++]));
+                    }
+                    std::array<float, S::config_fields.size()> settings;
+                    for (auto& value : settings) {
+                        value = static_cast<float>(get(*record, this->configs[config++]));
+                    }
+                    scales.*S::scale = S::DriverType::scale_from(per_count, settings);
+                });
+                this->current_scales = scales;
+                continue;
+            }
+            if (*record != this->sample_record) {
+                continue;
+            }
+            if (!this->current_scales.has_value()) {
+                ESP_LOGW(TAG, "skipping sample before the first scales record");
+                continue;
+            }
+
+            RawSensorSample sample {};
+            sample.time_ms = static_cast<int64_t>(get(*record, this->time_field));
+            sample.valid = FlightSensors::valid_all;
+            size_t column = 0;
+            FlightSensors::for_each([&]<typename S, size_t I>() {
+                std::array<int32_t, S::fields.size()> counts;
+                for (auto& count : counts) {
+                    auto const field = this->columns[column++];
+                    count = static_cast<int32_t>(get(*record, field));
+                    if (!field.has_value() || !this->decoder.valid(*record, *field)) {
+                        sample.valid &= ~FlightSensors::valid_bit<I>;
+                    }
+                }
+                sample.*S::raw = S::DriverType::from_counts(counts);
+            });
+            return sample;
+        }
+
+        return std::nullopt;
+    }
+
+    LegacyRawLogReader::~LegacyRawLogReader() {
+        fclose(this->file);
+    }
+
+    std::optional<LogSample> LegacyRawLogReader::next() {
+        uint8_t record[std::max(LEGACY_SCALES_RECORD_LEN, RAW_SAMPLE_RECORD_LEN)];
+
+        while (fread(record, 1, 1, this->file) == 1) {
+            switch (static_cast<RawRecordType>(record[0])) {
+                case RawRecordType::Scales:
+                    if (!read_body(record, LEGACY_SCALES_RECORD_LEN, this->file)) {
+                        break;
+                    }
+                    this->current_scales = decode_legacy_scales(&record[1]);
+                    continue;
+                case RawRecordType::Sample:
+                    if (!read_body(record, RAW_SAMPLE_RECORD_LEN, this->file)) {
+                        break;
+                    }
+                    if (!this->current_scales.has_value()) {
+                        ESP_LOGW(TAG, "skipping sample before the first scales record");
+                        continue;
+                    }
+                    return decode_raw_sample(&record[1]);
+                default:
+                    break;
+            }
+
+            // Records carry no length, so there is no way to find the next one after this
+            ESP_LOGW(TAG, "stopping at truncated or unknown record at offset %ld", ftell(this->file));
+            break;
+        }
+
+        return std::nullopt;
+    }
+}
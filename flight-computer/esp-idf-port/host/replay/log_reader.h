@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdio>
+#include <memory>
+#include <optional>
+#include <variant>
+
+#include "computer/computer.h"
+#include "computer/sensors.h"
+#include "errors.h"
+#include "log_schema.h"
+
+namespace seds::replay {
+    using namespace seds::errors;
+
+    /// A sample read back from a log: engineering units from CSV logs, raw counts from raw logs.
+    using LogSample = std::variant<SensorSample, RawSensorSample>;
+
+    [[nodiscard]]
+    inline int64_t time_ms(LogSample const& sample) {
+        return std::visit([](auto const& s) { return s.time_ms; }, sample);
+    }
+
+    /// Reads samples back out of a flight log.
+    class LogReader {
+    public:
+        virtual ~LogReader() = default;
+
+        /// Returns the next sample, or nothing at the end of the log. Malformed rows are skipped
+        /// with a warning.
+        virtual std::optional<LogSample> next() = 0;
+
+        /// The scales that applied when the sample most recently returned by `next` was recorded,
+        /// for logs that store them.
+        [[nodiscard]]
+        virtual std::optional<SensorScales> scales() const {
+            return std::nullopt;
+        }
+    };
+
+    /// Opens a log written by FlightComputer, picking the reader from the file's header.
+    [[nodiscard]]
+    Expected<std::unique_ptr<LogReader>> open_log(char const* path);
+
+    /// Reads the CSV logs written by FlightComputer::init and FlightComputer::log_sample.
+    class CsvLogReader final : public LogReader {
+    public:
+        /// Takes ownership of a file positioned just after the header line.
+        explicit CsvLogReader(FILE* file) : file(file) {}
+        ~CsvLogReader() override;
+
+        std::optional<LogSample> next() override;
+
+    private:
+        FILE* file;
+        size_t line = 1;
+    };
+
+    /// Reads the raw logs written when FlightComputer::log_format is LogFormat::Raw, going by the
+    /// schema at the start of the log. Columns are matched up with FlightSensors by name, so logs
+    /// with fields in a different order or width still replay. A sensor with a column missing
+    /// from the log reads as failed.
+    class RawLogReader final : public LogReader {
+    public:
+        /// Takes ownership of a file positioned just after the magic bytes, and reads the schema
+        /// that follows them. The file is closed if that fails.
+        [[nodiscard]]
+        static Expected<std::unique_ptr<RawLogReader>> open(FILE* file);
+        ~RawLogReader() override;
+
+        std::optional<LogSample> next() override;
+
+        [[nodiscard]]
+        std::optional<SensorScales> scales() const override {
+            return this->current_scales;
+        }
+
+    private:
+        RawLogReader(FILE* file, SchemaDecoder&& decoder);
+
+        FILE* file;
+        SchemaDecoder decoder;
+        size_t scales_record = 0;
+        size_t sample_record = 0;
+        std::optional<size_t> time_field;
+        /// Where each column, scale factor and setting of FlightSensors is in the log's records.
+        std::array<std::optional<size_t>, FlightSensors::column_count> columns;
+        std::array<std::optional<size_t>, FlightSensors::column_count> per_count;
+        std::array<std::optional<size_t>, FlightSensors::config_count> configs;
+        std::optional<SensorScales> current_scales;
+    };
+
+    /// Reads raw logs from before they carried a schema (version 1), whose scales record had a
+    /// fixed layout.
+    class LegacyRawLogReader final : public LogReader {
+    public:
+        /// Takes ownership of a file positioned just after the magic bytes.
+        explicit LegacyRawLogReader(FILE* file) : file(file) {}
+        ~LegacyRawLogReader() override;
+
+        std::optional<LogSample> next() override;
+
+        [[nodiscard]]
+        std::optional<SensorScales> scales() const override {
+            return this->current_scales;
+        }
+
+    private:
+        FILE* file;
+        std::optional<SensorScales> current_scales;
+    };
+}
@@ -0,0 +1,285 @@
+#include "log_schema.h"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+
+#include "esp_log.h"
+
+static const char *TAG = "replay";
+
+namespace seds::replay {
+    namespace {
+        /// Splits a schema line at its tabs into exactly `N` pieces.
+        template<size_t N>
+        std::optional<std::array<std::string_view, N>> split(std::string_view line) {
+            std::array<std::string_view, N> pieces;
+            for (size_t i = 0; i < N; i++) {
+                auto const tab = line.find('\t');
+                if ((tab == std::string_view::npos) != (i + 1 == N)) {
+                    return std::nullopt;
+                }
+                pieces[i] = line.substr(0, tab);
+                line.remove_prefix(tab == std::string_view::npos ? line.size() : tab + 1);
+            }
+            return pieces;
+        }
+
+        std::optional<size_t> parse_number(std::string_view text) {
+            size_t value = 0;
+            auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+            if (error != std::errc {} || end != text.data() + text.size()) {
+                return std::nullopt;
+            }
+            return value;
+        }
+
+        /// Fills in the width and signedness of `field` from a type like "i16" or "f32".
+        bool parse_type(std::string_view type, SchemaField& field) {
+            if (type.empty()) {
+                return false;
+            }
+            auto const bits = parse_number(type.substr(1));
+            if (!bits.has_value() || *bits % 8 != 0 || *bits == 0 || *bits > 32) {
+                return false;
+            }
+
+            field.bytes = *bits / 8;
+            field.is_signed = type[0] == 'i';
+            field.is_float = type[0] == 'f';
+            return (type[0] == 'u' || field.is_signed || (field.is_float && field.bytes == 4));
+        }
+
+        /// A field line before the fields it refers to, such as its scale, are looked up.
+        struct PendingReference {
+            size_t record;
+            size_t field;
+            std::string_view name;
+            std::optional<std::pair<size_t, size_t>> SchemaField::* reference;
+        };
+    }
+
+    double SchemaField::read(uint8_t const* body) const {
+        uint8_t bytes[4] = {};
+        memcpy(bytes, &body[this->offset], this->bytes);
+
+        uint32_t bits = 0;
+        for (size_t i = 0; i < this->bytes; i++) {
+            bits |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+        }
+
+        if (this->is_float) {
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        if (this->is_signed) {
+            auto const shift = 32 - 8 * this->bytes;
+            return static_cast<int32_t>(bits << shift) >> shift;
+        }
+        return bits;
+    }
+
+    std::optional<size_t> SchemaRecord::find(std::string_view name) const {
+        for (size_t i = 0; i < this->fields.size(); i++) {
+            if (this->fields[i].name == name) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Expected<LogSchema> LogSchema::parse(std::string_view text) {
+        LogSchema schema;
+        std::vector<PendingReference> references;
+
+        while (!text.empty()) {
+            auto const end = text.find('\n');
+            auto const line = text.substr(0, end);
+            text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            if (line.empty()) {
+                continue;
+            }
+
+            if (line.starts_with("record\t")) {
+                auto const pieces = split<4>(line);
+                auto const len = pieces.has_value() ? parse_number((*pieces)[2]) : std::nullopt;
+                if (!len.has_value() || (*pieces)[1].size() != 1) {
+                    return std::unexpected(std::make_unique<Error>("malformed record in log schema"));
+                }
+                schema.records.push_back(SchemaRecord {
+                    .type = (*pieces)[1][0],
+                    .len = *len,
+                    .role = std::string((*pieces)[3]),
+                    .fields = {},
+                });
+            } else if (line.starts_with("field\t")) {
+                // Version 2 logs have no calibration, so no gain or offset either
+                auto pieces = split<10>(line);
+                if (auto const old = split<8>(line); !pieces.has_value() && old.has_value()) {
+                    pieces.emplace();
+                    std::copy(old->begin(), old->end(), pieces->begin());
+                    (*pieces)[8] = "-";
+                    (*pieces)[9] = "-";
+                }
+                if (!pieces.has_value()) {
+                    return std::unexpected(std::make_unique<Error>("malformed field in log schema"));
+                }
+                auto const& [_, type, offset, kind, name, unit, scale, valid_bit, gain, by] =
+                    *pieces;
+
+                // Fields follow the record they belong to
+                auto const record = schema.find(type.size() == 1 ? type[0] : '\0');
+                if (!record.has_value()) {
+                    return std::unexpected(std::make_unique<Error>("log schema field of an unknown record"));
+                }
+                auto& fields = schema.records[*record].fields;
+
+                SchemaField field {};
+                field.name = std::string(name);
+                field.unit = std::string(unit);
+                auto const start = parse_number(offset);
+                if (!start.has_value() || !parse_type(kind, field)
+                    || *start + field.bytes > schema.records[*record].len) {
+                    return std::unexpected(std::make_unique<Error>("malformed field in log schema"));
+                }
+                field.offset = *start;
+                if (valid_bit != "-") {
+                    auto const bit = parse_number(valid_bit);
+                    if (!bit.has_value() || *bit > 31) {
+                        return std::unexpected(std::make_unique<Error>("malformed field in log schema"));
+                    }
+                    field.valid_bit = *bit;
+                }
+                for (auto const& [reference, member] : {
+                    std::pair { scale, &SchemaField::scale },
+                    std::pair { gain, &SchemaField::gain },
+                    std::pair { by, &SchemaField::offset_by },
+                }) {
+                    if (reference != "-") {
+                        references.push_back(
+                            PendingReference { *record, fields.size(), reference, member });
+                    }
+                }
+                fields.push_back(std::move(field));
+            } else {
+                // Lines this reader doesn't know about are for later readers
+                ESP_LOGD(TAG, "ignoring log schema line: %.*s", (int)line.size(), line.data());
+            }
+        }
+
+        // A scale, gain or offset can be any field of any record, typically one of the scales or
+        // calibration record's
+        for (auto const& pending : references) {
+            auto& field = schema.records[pending.record].fields[pending.field];
+            auto& reference = field.*pending.reference;
+            for (size_t r = 0; r < schema.records.size() && !reference.has_value(); r++) {
+                if (auto const i = schema.records[r].find(pending.name); i.has_value()) {
+                    reference = std::pair { r, *i };
+                }
+            }
+            if (!reference.has_value()) {
+                return std::unexpected(std::make_unique<Error>("log schema refers to a missing field"));
+            }
+        }
+
+        return schema;
+    }
+
+    std::optional<size_t> LogSchema::find(char type) const {
+        for (size_t i = 0; i < this->records.size(); i++) {
+            if (this->records[i].type == type) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::optional<size_t> LogSchema::find_role(std::string_view role) const {
+        for (size_t i = 0; i < this->records.size(); i++) {
+            if (this->records[i].role == role) {
+                return i;
+            }
+        }
+        return std::nullopt;
+    }
+
+    Expected<SchemaDecoder> SchemaDecoder::open(FILE* file) {
+        uint8_t header[3];
+        if (fread(header, 1, sizeof(header), file) != sizeof(header) || header[0] != 'H') {
+            return std::unexpected(std::make_unique<Error>("raw log has no schema record"));
+        }
+
+        std::string text(header[1] | (header[2] << 8), '\0');
+        if (fread(text.data(), 1, text.size(), file) != text.size()) {
+            return std::unexpected(std::make_unique<Error>("raw log's schema record is truncated"));
+        }
+
+        return SchemaDecoder(file, TRY(LogSchema::parse(text)));
+    }
+
+    SchemaDecoder::SchemaDecoder(FILE* file, LogSchema&& schema)
+        : file(file), log_schema(std::move(schema))
+    {
+        size_t longest = 0;
+        for (auto const& record : this->log_schema.records) {
+            this->values.emplace_back(record.fields.size(), 0.0);
+            this->seen_records.push_back(false);
+            this->valid_fields.push_back(record.find("valid"));
+            longest = std::max(longest, record.len);
+        }
+        this->body.resize(longest);
+    }
+
+    std::optional<size_t> SchemaDecoder::next() {
+        uint8_t type;
+        if (fread(&type, 1, 1, this->file) != 1) {
+            return std::nullopt;
+        }
+
+        auto const index = this->log_schema.find(static_cast<char>(type));
+        if (!index.has_value()) {
+            // Without a length, there is no way to find the next record after this
+            ESP_LOGW(TAG, "stopping at record type 0x%02x, which the schema doesn't describe", type);
+            return std::nullopt;
+        }
+
+        auto const& record = this->log_schema.records[*index];
+        if (fread(this->body.data(), 1, record.len, this->file) != record.len) {
+            ESP_LOGW(TAG, "stopping at truncated record at offset %ld", ftell(this->file));
+            return std::nullopt;
+        }
+
+        for (size_t i = 0; i < record.fields.size(); i++) {
+            this->values[*index][i] = record.fields[i].read(this->body.data());
+        }
+        this->seen_records[*index] = true;
+        return index;
+    }
+
+    double SchemaDecoder::value(size_t record, size_t field) const {
+        auto const& description = this->log_schema.records[record].fields[field];
+        auto value = this->raw(record, field);
+        if (auto const& scale = description.scale; scale.has_value()) {
+            value *= this->raw(scale->first, scale->second);
+        }
+        // Before the first calibration record, fields read as if uncorrected
+        if (auto const& gain = description.gain; gain.has_value() && this->seen(gain->first)) {
+            value *= this->raw(gain->first, gain->second);
+        }
+        if (auto const& by = description.offset_by; by.has_value() && this->seen(by->first)) {
+            value += this->raw(by->first, by->second);
+        }
+        return value;
+    }
+
+    bool SchemaDecoder::valid(size_t record, size_t field) const {
+        auto const& bit = this->log_schema.records[record].fields[field].valid_bit;
+        auto const& valid = this->valid_fields[record];
+        if (!bit.has_value() || !valid.has_value()) {
+            return true;
+        }
+        return (static_cast<uint32_t>(this->raw(record, *valid)) >> *bit) & 1;
+    }
+}
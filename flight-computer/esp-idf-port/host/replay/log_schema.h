@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "errors.h"
+
+namespace seds::replay {
+    using namespace seds::errors;
+
+    /// One field of a record, as described by a raw log's schema (see "Raw logs" in
+    /// computer/log_format.h).
+    struct SchemaField {
+        std::string name;
+        std::string unit;
+        /// Where the field starts, after the record's type byte.
+        size_t offset;
+        uint8_t bytes;
+        bool is_signed;
+        bool is_float;
+        /// The field whose latest value converts this one into `unit`, as a record and a field
+        /// index. Empty if the field is already in `unit`.
+        std::optional<std::pair<size_t, size_t>> scale;
+        /// The fields whose latest values correct this one once it is in `unit`, as value × gain
+        /// + offset. Empty if the field isn't calibrated, or in logs before version 3.
+        std::optional<std::pair<size_t, size_t>> gain;
+        std::optional<std::pair<size_t, size_t>> offset_by;
+        /// The bit of its record's "valid" field that says whether it was read.
+        std::optional<uint8_t> valid_bit;
+
+        /// Reads the field out of the body of a record.
+        [[nodiscard]]
+        double read(uint8_t const* body) const;
+    };
+
+    /// One kind of record in a raw log.
+    struct SchemaRecord {
+        char type;
+        /// Bytes after the type byte.
+        size_t len;
+        /// What the record holds, such as "scales" or "sample".
+        std::string role;
+        std::vector<SchemaField> fields;
+
+        /// The index of the field called `name`.
+        [[nodiscard]]
+        std::optional<size_t> find(std::string_view name) const;
+    };
+
+    /// The layout of every record in a raw log, read from the log itself.
+    struct LogSchema {
+        std::vector<SchemaRecord> records;
+
+        /// Parses the text of a schema record.
+        [[nodiscard]]
+        static Expected<LogSchema> parse(std::string_view text);
+
+        /// The index of the record with type byte `type`.
+        [[nodiscard]]
+        std::optional<size_t> find(char type) const;
+
+        /// The index of the record that holds `role`.
+        [[nodiscard]]
+        std::optional<size_t> find_role(std::string_view role) const;
+    };
+
+    /// Reads the records of a raw log by its schema alone, so it can read any version of the
+    /// format from 2 on without knowing the sensors that wrote it.
+    class SchemaDecoder {
+    public:
+        /// Reads the schema record from a file positioned just after the magic bytes. The file
+        /// stays owned by the caller.
+        [[nodiscard]]
+        static Expected<SchemaDecoder> open(FILE* file);
+
+        [[nodiscard]]
+        LogSchema const& schema() const {
+            return this->log_schema;
+        }
+
+        /// Reads the next record and returns its index in the schema, or nothing at the end of
+        /// the log or at a record the schema doesn't describe. Doesn't allocate.
+        std::optional<size_t> next();
+
+        /// A field of the latest record of its kind, as stored.
+        [[nodiscard]]
+        double raw(size_t record, size_t field) const {
+            return this->values[record][field];
+        }
+
+        /// A field of the latest record of its kind, in its unit.
+        [[nodiscard]]
+        double value(size_t record, size_t field) const;
+
+        /// Whether a field of the latest record of its kind was read, according to its valid bit.
+        [[nodiscard]]
+        bool valid(size_t record, size_t field) const;
+
+        /// Whether a record of this kind has been read yet.
+        [[nodiscard]]
+        bool seen(size_t record) const {
+            return this->seen_records[record];
+        }
+
+    private:
+        SchemaDecoder(FILE* file, LogSchema&& schema);
+
+        FILE* file;
+        LogSchema log_schema;
+        /// The fields of the latest record of each kind.
+        std::vector<std::vector<double>> values;
+        std::vector<bool> seen_records;
+        /// The "valid" field of each record, if it has one.
+        std::vector<std::optional<size_t>> valid_fields;
+        std::vector<uint8_t> body;
+    };
+}
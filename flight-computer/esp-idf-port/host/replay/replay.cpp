@@ -0,0 +1,236 @@
+// Replays a recorded flight log through FlightComputer.
+//
+// Each recorded sample is written into the register models behind the simulated I2C bus, so the
+// real drivers decode it and the flight computer processes and logs it exactly as it would in
+// flight. Time comes from the recording, so the pipeline can run at any multiple of real time.
+//
+// Raw logs are loaded into the models as the counts that were recorded, and sensors that failed to
+// read in flight fail to read again. Replaying with a different --format converts between CSV and
+// raw logs.
+//
+//     replay [--speed <multiplier>|max] [--out <dir>] [--format csv|raw] [--verbose] <log>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "clock.h"
+#include "errors.h"
+#include "esp_log.h"
+#include "log_reader.h"
+#include "memory.h"
+#include "rig.h"
+
+using namespace seds;
+using namespace std::chrono;
+
+namespace {
+    struct Options {
+        char const* log_path = nullptr;
+        char const* out_dir = "replay-out";
+        /// Multiple of real time to replay at. Zero means as fast as possible.
+        double speed = 0;
+        LogFormat format = LogFormat::Csv;
+        bool verbose = false;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: replay [--speed <multiplier>|max] [--out <dir>] [--format csv|raw] [--verbose] <log>\n"
+            "\n"
+            "  --speed    replay at this multiple of real time (default: max)\n"
+            "  --out      directory the replayed log is written to (default: replay-out)\n"
+            "  --format   format of the replayed log (default: csv)\n"
+            "  --verbose  show the flight computer's log output\n");
+    }
+
+    /// Whether counts recorded under `recorded` mean the same as they do under `current`. The
+    /// sampling rate is part of the scales, but changes with the flight phase and doesn't matter
+    /// here.
+    bool same_units(SensorScales recorded, SensorScales const& current) {
+        recorded.imu.sensor_hz = current.imu.sensor_hz;
+        return recorded == current;
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--speed" && i + 1 < argc) {
+                std::string_view value = argv[++i];
+                options.speed = value == "max" ? 0 : std::atof(argv[i]);
+                if (value != "max" && options.speed <= 0) {
+                    return std::nullopt;
+                }
+            } else if (arg == "--out" && i + 1 < argc) {
+                options.out_dir = argv[++i];
+            } else if (arg == "--format" && i + 1 < argc) {
+                std::string_view value = argv[++i];
+                if (value == "csv") {
+                    options.format = LogFormat::Csv;
+                } else if (value == "raw") {
+                    options.format = LogFormat::Raw;
+                } else {
+                    return std::nullopt;
+                }
+            } else if (arg == "--verbose") {
+                options.verbose = true;
+            } else if (!arg.starts_with("-") && options.log_path == nullptr) {
+                options.log_path = argv[i];
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        if (options.log_path == nullptr) {
+            return std::nullopt;
+        }
+        return options;
+    }
+
+    /// Loads a sample in engineering units into the sensor models.
+    void load(sim::Rig& rig, SensorSample const& sample) {
+        rig.imu_model.set(
+            { sample.imu.ax, sample.imu.ay, sample.imu.az },
+            { sample.imu.gx, sample.imu.gy, sample.imu.gz }
+        );
+        rig.baro1_model.set(sample.baro1.baro_temp, sample.baro1.pressure);
+        rig.baro2_model.set(sample.baro2.baro_temp, sample.baro2.pressure);
+        rig.high_g_model.set({ sample.high_g.h_ax, sample.high_g.h_ay, sample.high_g.h_az });
+        rig.temp_model.set(sample.temp);
+    }
+
+    /// Loads raw counts into the sensor models. The drivers convert them with their own scales,
+    /// which only match the recording if the sensors are configured the same way.
+    void load(sim::Rig& rig, RawSensorSample const& sample) {
+        rig.imu_model.set_raw(
+            { sample.imu.ax, sample.imu.ay, sample.imu.az },
+            { sample.imu.gx, sample.imu.gy, sample.imu.gz }
+        );
+        rig.baro1_model.set_raw(sample.baro1.temp, sample.baro1.pressure);
+        rig.baro2_model.set_raw(sample.baro2.temp, sample.baro2.pressure);
+        rig.high_g_model.set_raw(sample.high_g.x, sample.high_g.y, sample.high_g.z);
+        rig.temp_model.set_raw(sample.temp);
+
+        rig.imu_model.present = sample.valid & VALID_IMU;
+        rig.baro1_model.present = sample.valid & VALID_BARO1;
+        rig.baro2_model.present = sample.valid & VALID_BARO2;
+        rig.high_g_model.present = sample.valid & VALID_HIGH_G;
+        rig.temp_model.present = sample.valid & VALID_TEMP;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto reader = errors::unwrap(replay::open_log(options->log_path));
+    auto first = reader->next();
+    if (!first.has_value()) {
+        std::fprintf(stderr, "%s has no samples\n", options->log_path);
+        return 1;
+    }
+
+    // The flight computer writes under ./sdcard, so run from the output directory.
+    std::filesystem::create_directories(options->out_dir);
+    std::filesystem::current_path(options->out_dir);
+
+    esp_log_level_set("*", options->verbose ? ESP_LOG_INFO : ESP_LOG_WARN);
+    sim::use_virtual_time(replay::time_ms(*first) * 1000);
+
+    sim::Rig rig;
+    auto computer = rig.make_computer(options->format);
+
+    auto const recording_start_ms = replay::time_ms(*first);
+    auto recording_end_ms = recording_start_ms;
+    auto const wall_start = steady_clock::now();
+    nanoseconds busy {};
+    nanoseconds slowest_step {};
+    size_t samples = 0;
+    bool warned_scales = false;
+    estimation::Estimate apogee {};
+    // When each phase was entered, relative to the start of the log
+    std::optional<int64_t> phase_times_ms[FLIGHT_PHASE_COUNT];
+    phase_times_ms[static_cast<size_t>(computer.phase())] = 0;
+
+    // Like FlightComputer::process, the loop must not allocate (see memory.h)
+    memory::arm();
+    for (auto sample = first; sample.has_value(); sample = reader->next()) {
+        if (options->speed > 0) {
+            auto const offset = milliseconds(replay::time_ms(*sample) - recording_start_ms);
+            std::this_thread::sleep_until(wall_start + duration_cast<nanoseconds>(offset / options->speed));
+        }
+
+        auto const recorded_scales = reader->scales();
+        if (recorded_scales.has_value() && !same_units(*recorded_scales, computer.scales())
+            && !warned_scales) {
+            std::fprintf(stderr, "warning: the log was recorded with different sensor settings, "
+                "so replayed values will be scaled differently\n");
+            warned_scales = true;
+        }
+
+        auto const time_ms = replay::time_ms(*sample);
+        std::visit([&](auto const& s) { load(rig, s); }, *sample);
+        sim::set_virtual_time(time_ms * 1000);
+
+        auto const step_start = steady_clock::now();
+        computer.step();
+        auto const step_time = steady_clock::now() - step_start;
+
+        if (computer.estimate().altitude > apogee.altitude) {
+            apogee = computer.estimate();
+        }
+        auto& phase_time = phase_times_ms[static_cast<size_t>(computer.phase())];
+        if (!phase_time.has_value()) {
+            phase_time = time_ms - recording_start_ms;
+        }
+
+        busy += step_time;
+        slowest_step = std::max(slowest_step, duration_cast<nanoseconds>(step_time));
+        recording_end_ms = std::max(recording_end_ms, time_ms);
+        samples++;
+    }
+    computer.flush();
+    memory::disarm();
+
+    auto const wall_s = duration<double>(steady_clock::now() - wall_start).count();
+    auto const recorded_s = (recording_end_ms - recording_start_ms) / 1000.0;
+    auto const busy_s = duration<double>(busy).count();
+
+    std::printf("replayed %zu samples (%.3f s of flight) into %s/%s\n",
+        samples, recorded_s, options->out_dir, computer.filename);
+    std::printf("wall time      %.3f s (%.1fx real time)\n",
+        wall_s, wall_s > 0 ? recorded_s / wall_s : 0.0);
+    std::printf("pipeline       %.0f samples/s, %.2f us/sample mean, %.2f us slowest\n",
+        busy_s > 0 ? samples / busy_s : 0.0,
+        samples > 0 ? busy_s * 1e6 / samples : 0.0,
+        duration<double, std::micro>(slowest_step).count());
+    std::printf("apogee         %.1f m estimated, %.3f s into the log\n",
+        apogee.altitude, (apogee.time_ms - recording_start_ms) / 1000.0);
+    std::printf("phases        ");
+    for (size_t i = 0; i < FLIGHT_PHASE_COUNT; i++) {
+        if (phase_times_ms[i].has_value()) {
+            std::printf(" %s %.2f s,", to_string(static_cast<FlightPhase>(i)), *phase_times_ms[i] / 1000.0);
+        }
+    }
+    std::printf("\n");
+    std::printf("barometers    ");
+    for (size_t i = 0; i < estimation::BaroVoter::BAROMETERS; i++) {
+        auto const& voter = computer.baro_voter;
+        std::printf(" %zu %s (health %.2f, %" PRIu32 " spikes),", i + 1,
+            estimation::to_string(voter.status(i)), voter.health(i), voter.spikes(i));
+    }
+    std::printf("\n");
+
+    return 0;
+}
@@ -0,0 +1,30 @@
+#include "esp_log.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+
+#include "esp_timer.h"
+
+static std::atomic<esp_log_level_t> max_level = ESP_LOG_INFO;
+
+void esp_log_level_set(const char *, esp_log_level_t level) {
+    max_level = level;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    if (level > max_level) {
+        return;
+    }
+
+    static constexpr char letters[] = { 'N', 'E', 'W', 'I', 'D', 'V' };
+    std::fprintf(stderr, "%c (%lld) %s: ", letters[level],
+        static_cast<long long>(esp_timer_get_time() / 1000), tag);
+
+    va_list args;
+    va_start(args, format);
+    std::vfprintf(stderr, format, args);
+    va_end(args);
+
+    std::fputc('\n', stderr);
+}
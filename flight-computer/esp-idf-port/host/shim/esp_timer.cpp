@@ -0,0 +1,152 @@
+#include "esp_timer.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    int64_t deadline_us = 0;
+    uint64_t period_us = 0;
+    bool armed = false;
+};
+
+namespace {
+    /// Real time since startup. The dispatcher ignores the virtual clock in sim/clock.h.
+    int64_t real_time_us() {
+        static auto const start = std::chrono::steady_clock::now();
+        auto const elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    }
+
+    /// Runs timer callbacks on one background thread, like ESP_TIMER_TASK.
+    class Dispatcher {
+    public:
+        static Dispatcher& instance() {
+            // Never destroyed: the detached thread is still waiting on `wake` at exit, and
+            // destroying a condition variable with a waiter blocks forever.
+            static Dispatcher& dispatcher = *new Dispatcher();
+            return dispatcher;
+        }
+
+        void arm(esp_timer *timer, uint64_t timeout_us, uint64_t period_us) {
+            std::scoped_lock guard(this->lock);
+            timer->deadline_us = real_time_us() + timeout_us;
+            timer->period_us = period_us;
+            timer->armed = true;
+            this->timers.insert(timer);
+            this->wake.notify_one();
+        }
+
+        void disarm(esp_timer *timer) {
+            std::scoped_lock guard(this->lock);
+            timer->armed = false;
+            this->timers.erase(timer);
+        }
+
+    private:
+        Dispatcher() : thread([this] { this->run(); }) {
+            this->thread.detach();
+        }
+
+        void run() {
+            std::unique_lock guard(this->lock);
+            while (true) {
+                esp_timer *next = nullptr;
+                for (auto *timer : this->timers) {
+                    if (next == nullptr || timer->deadline_us < next->deadline_us) {
+                        next = timer;
+                    }
+                }
+
+                if (next == nullptr) {
+                    this->wake.wait(guard);
+                    continue;
+                }
+
+                auto const now = real_time_us();
+                if (next->deadline_us > now) {
+                    this->wake.wait_for(guard, std::chrono::microseconds(next->deadline_us - now));
+                    continue;
+                }
+
+                if (next->period_us == 0) {
+                    next->armed = false;
+                    this->timers.erase(next);
+                } else {
+                    next->deadline_us += next->period_us;
+                }
+
+                auto const callback = next->callback;
+                auto *const arg = next->arg;
+                guard.unlock();
+                callback(arg);
+                guard.lock();
+            }
+        }
+
+        std::mutex lock;
+        std::condition_variable wake;
+        std::set<esp_timer*> timers;
+        std::thread thread;
+    };
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    if (create_args == nullptr || create_args->callback == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *out_handle = new esp_timer { .callback = create_args->callback, .arg = create_args->arg };
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Dispatcher::instance().arm(timer, timeout_us, 0);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Dispatcher::instance().arm(timer, period, period);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    auto const period = timer->period_us == 0 ? 0 : timeout_us;
+    Dispatcher::instance().disarm(timer);
+    Dispatcher::instance().arm(timer, timeout_us, period);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    Dispatcher::instance().disarm(timer);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer->armed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    delete timer;
+    return ESP_OK;
+}
@@ -0,0 +1,150 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+namespace {
+    /// How long to wait for `ticks`, or nothing for portMAX_DELAY.
+    std::chrono::milliseconds ticks_to_ms(TickType_t ticks) {
+        return std::chrono::milliseconds(static_cast<int64_t>(ticks) * portTICK_PERIOD_MS);
+    }
+
+    /// Waits on `wake` until `ready` returns true or `ticks` pass. Returns the final `ready()`.
+    template<typename Ready>
+    bool wait(std::unique_lock<std::mutex>& guard, std::condition_variable& wake, TickType_t ticks, Ready ready) {
+        if (ticks == portMAX_DELAY) {
+            wake.wait(guard, ready);
+            return true;
+        }
+        return wake.wait_for(guard, ticks_to_ms(ticks), ready);
+    }
+}
+
+struct HostTask {
+    std::mutex lock;
+    std::condition_variable wake;
+    uint32_t notifications = 0;
+};
+
+static_assert(sizeof(HostTask) <= sizeof(StaticTask_t));
+
+namespace {
+    thread_local HostTask* current_task = nullptr;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(ticks_to_ms(ticks));
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(
+    TaskFunction_t task,
+    char const*,
+    uint32_t,
+    void* parameters,
+    UBaseType_t,
+    StackType_t*,
+    StaticTask_t* task_buffer,
+    BaseType_t
+) {
+    auto* handle = new (task_buffer->storage) HostTask();
+    std::thread([=] {
+        current_task = handle;
+        task(parameters);
+    }).detach();
+    return handle;
+}
+
+void vTaskDelete(TaskHandle_t) {
+    // Only self-deletion is supported, and the task function returns right after.
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    // Threads that weren't created as tasks (like main) get a handle the first time they ask.
+    if (current_task == nullptr) {
+        current_task = new HostTask();
+    }
+    return current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::scoped_lock guard(task->lock);
+        task->notifications++;
+    }
+    task->wake.notify_one();
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait) {
+    auto* task = xTaskGetCurrentTaskHandle();
+    std::unique_lock guard(task->lock);
+    wait(guard, task->wake, ticks_to_wait, [&] { return task->notifications > 0; });
+
+    auto const count = task->notifications;
+    if (count > 0) {
+        task->notifications = clear_on_exit ? 0 : count - 1;
+    }
+    return count;
+}
+
+struct HostQueue {
+    std::mutex lock;
+    std::condition_variable changed;
+    uint8_t* storage;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head = 0;
+    UBaseType_t count = 0;
+};
+
+static_assert(sizeof(HostQueue) <= sizeof(StaticQueue_t));
+
+QueueHandle_t xQueueCreateStatic(
+    UBaseType_t length,
+    UBaseType_t item_size,
+    uint8_t* storage,
+    StaticQueue_t* queue_buffer
+) {
+    auto* queue = new (queue_buffer->storage) HostQueue();
+    queue->storage = storage;
+    queue->length = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, void const* item, TickType_t ticks_to_wait) {
+    std::unique_lock guard(queue->lock);
+    if (!wait(guard, queue->changed, ticks_to_wait, [&] { return queue->count < queue->length; })) {
+        return pdFAIL;
+    }
+
+    auto const slot = (queue->head + queue->count) % queue->length;
+    std::memcpy(&queue->storage[slot * queue->item_size], item, queue->item_size);
+    queue->count++;
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    std::unique_lock guard(queue->lock);
+    if (!wait(guard, queue->changed, ticks_to_wait, [&] { return queue->count > 0; })) {
+        return pdFAIL;
+    }
+
+    std::memcpy(buffer, &queue->storage[queue->head * queue->item_size], queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    queue->changed.notify_all();
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    std::scoped_lock guard(queue->lock);
+    return queue->count;
+}
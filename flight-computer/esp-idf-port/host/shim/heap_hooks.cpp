@@ -0,0 +1,80 @@
+// Replaces the global operator new so that C++ allocations reach esp_heap_trace_alloc_hook, as
+// they would through ESP-IDF's heap with CONFIG_HEAP_USE_HOOKS. Unlike on the ESP32, plain malloc
+// calls (from C code such as stdio) aren't seen.
+//
+// Replacement operators only take effect if this object is linked directly into the executable,
+// which is why it's built as an object library rather than as part of esp_host.
+//
+// The nothrow forms fail the way a real allocation does: with CONFIG_SEDS_STATIC_MEMORY set they
+// return nullptr while the flight loop has allocation armed, instead of reaching the hook and
+// aborting, and any of them return nullptr when malloc does.
+
+#include <cstdlib>
+#include <new>
+
+#include "esp_heap_caps.h"
+
+namespace seds::memory {
+    // From the firmware's memory.cpp. Weak, so that executables without the firmware still link.
+    [[gnu::weak]] bool is_armed();
+}
+
+namespace {
+    /// Allocates through malloc and the hook, or returns nullptr if malloc fails.
+    void* try_allocate(size_t size) {
+        void* ptr = std::malloc(size == 0 ? 1 : size);
+        if (ptr != nullptr && esp_heap_trace_alloc_hook != nullptr) {
+            esp_heap_trace_alloc_hook(ptr, size, 0);
+        }
+        return ptr;
+    }
+
+    void* allocate(size_t size) {
+        void* ptr = try_allocate(size);
+        if (ptr == nullptr) {
+            std::abort();
+        }
+        return ptr;
+    }
+
+    void* allocate_nothrow(size_t size) noexcept {
+#if CONFIG_SEDS_STATIC_MEMORY
+        if (seds::memory::is_armed != nullptr && seds::memory::is_armed()) {
+            return nullptr;
+        }
+#endif
+        return try_allocate(size);
+    }
+}
+
+void* operator new(size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](size_t size) {
+    return allocate(size);
+}
+
+void* operator new(size_t size, std::nothrow_t const&) noexcept {
+    return allocate_nothrow(size);
+}
+
+void* operator new[](size_t size, std::nothrow_t const&) noexcept {
+    return allocate_nothrow(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
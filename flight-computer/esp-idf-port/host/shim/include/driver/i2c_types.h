@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+typedef enum {
+    I2C_NUM_0 = 0,
+    I2C_NUM_1,
+} i2c_port_num_t;
+
+typedef enum {
+    I2C_ADDR_BIT_LEN_7 = 0,
+    I2C_ADDR_BIT_LEN_10,
+} i2c_addr_bit_len_t;
+
+typedef enum {
+    I2C_CLK_SRC_DEFAULT = 0,
+} i2c_clock_source_t;
+
+typedef struct i2c_master_bus_t *i2c_master_bus_handle_t;
+typedef struct i2c_master_dev_t *i2c_master_dev_handle_t;
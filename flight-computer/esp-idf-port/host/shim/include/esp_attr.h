@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for esp_attr.h. Memory placement doesn't mean anything on the host.
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
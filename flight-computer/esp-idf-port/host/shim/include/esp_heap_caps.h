@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for esp_heap_caps.h. Only the allocation hook is provided: the host build calls it
+// from operator new (see heap_hooks.cpp), the way ESP-IDF calls it from its allocator when
+// CONFIG_HEAP_USE_HOOKS is set.
+
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+    __attribute__((weak)) void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps);
+}
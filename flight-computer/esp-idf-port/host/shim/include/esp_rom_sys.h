@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for esp_rom_sys.h.
+
+#include <cstdio>
+
+#define esp_rom_printf(...) std::fprintf(stderr, __VA_ARGS__)
@@ -0,0 +1,48 @@
+#pragma once
+
+// Host stand-in for the FAT-on-SD-card mount helpers. "Mounting" creates the mount point as a
+// directory relative to the working directory, so log files land on the host filesystem.
+
+#include <cstddef>
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "sdmmc_cmd.h"
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+} spi_host_device_t;
+
+#define SDSPI_DEFAULT_DMA 3
+
+typedef struct {
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+} spi_bus_config_t;
+
+typedef struct {
+    spi_host_device_t host_id;
+    gpio_num_t gpio_cs;
+} sdspi_device_config_t;
+
+typedef struct {
+    bool format_if_mount_failed;
+    int max_files;
+    size_t allocation_unit_size;
+    bool disk_status_check_enable;
+    bool use_one_fat;
+} esp_vfs_fat_sdmmc_mount_config_t;
+
+#define SDSPI_HOST_DEFAULT() (sdmmc_host_t { .slot = SPI2_HOST, .max_freq_khz = 20000 })
+#define SDSPI_DEVICE_CONFIG_DEFAULT() (sdspi_device_config_t { .host_id = SPI2_HOST, .gpio_cs = GPIO_NUM_13 })
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, int dma_chan);
+
+esp_err_t esp_vfs_fat_sdspi_mount(const char *base_path, const sdmmc_host_t *host_config, const sdspi_device_config_t *slot_config, const esp_vfs_fat_sdmmc_mount_config_t *mount_config, sdmmc_card_t **out_card);
+esp_err_t esp_vfs_fat_sdcard_format(const char *base_path, sdmmc_card_t *card);
@@ -0,0 +1,20 @@
+#pragma once
+
+// Host stand-in for FreeRTOS.h. Ticks run at CONFIG_FREERTOS_HZ like on the ESP32.
+
+#include <cstdint>
+
+#include "sdkconfig.h"
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t) 1000 / CONFIG_FREERTOS_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t) (((TickType_t) (ms) * (TickType_t) CONFIG_FREERTOS_HZ) / (TickType_t) 1000U))
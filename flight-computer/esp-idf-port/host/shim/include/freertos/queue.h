@@ -0,0 +1,23 @@
+#pragma once
+
+// Host stand-in for freertos/queue.h. Only statically-allocated queues are supported.
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostQueue* QueueHandle_t;
+
+/// Storage for a statically-allocated queue. The host keeps its own bookkeeping in here.
+typedef struct {
+    alignas(16) uint8_t storage[192];
+} StaticQueue_t;
+
+QueueHandle_t xQueueCreateStatic(
+    UBaseType_t length,
+    UBaseType_t item_size,
+    uint8_t* storage,
+    StaticQueue_t* queue_buffer
+);
+
+BaseType_t xQueueSend(QueueHandle_t queue, void const* item, TickType_t ticks_to_wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
@@ -0,0 +1,40 @@
+#pragma once
+
+// Host stand-in for freertos/task.h. Tasks are std::threads, and core affinity and priorities are
+// ignored. As on the ESP32, stack sizes are in bytes.
+
+#include "freertos/FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void*);
+typedef struct HostTask* TaskHandle_t;
+typedef uint8_t StackType_t;
+
+/// Storage for a statically-allocated task. The host keeps its own bookkeeping in here.
+typedef struct {
+    alignas(16) uint8_t storage[256];
+} StaticTask_t;
+
+#define tskNO_AFFINITY ((BaseType_t) 0x7FFFFFFF)
+
+void vTaskDelay(TickType_t ticks);
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(
+    TaskFunction_t task,
+    char const* name,
+    uint32_t stack_depth,
+    void* parameters,
+    UBaseType_t priority,
+    StackType_t* stack_buffer,
+    StaticTask_t* task_buffer,
+    BaseType_t core_id
+);
+
+/// Must be the last thing a task does. On the host, `vTaskDelete(NULL)` returns and the task
+/// function is expected to return right after, which ends the thread. Deleting other tasks isn't
+/// supported.
+void vTaskDelete(TaskHandle_t task);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
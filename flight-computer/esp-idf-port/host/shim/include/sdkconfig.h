@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in for the generated sdkconfig.h. Keep these in sync with ../../../sdkconfig for the
+// options the firmware reads.
+
+#define CONFIG_FREERTOS_HZ 100
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_SEDS_LOG_BUFFER_ROWS 100
+#define CONFIG_SEDS_LOG_BUFFER_INTERNAL 1
+#define CONFIG_SEDS_SAMPLE_PERIOD_US 10000
+#define CONFIG_SEDS_SAMPLE_QUEUE_LENGTH 64
+#define CONFIG_SEDS_ACQUISITION_CORE 1
+#define CONFIG_SEDS_ACQUISITION_PRIORITY 20
+#define CONFIG_SEDS_ACQUISITION_STACK_SIZE 4096
+#define CONFIG_SEDS_STORAGE_CORE 0
+#define CONFIG_SEDS_STORAGE_PRIORITY 10
+#define CONFIG_SEDS_STORAGE_STACK_SIZE 6144
+#define CONFIG_SEDS_PHASE_POLICY 1
+#define CONFIG_SEDS_MAIN_DEPLOY_ALTITUDE_M 300
+// Off on the board, which has no radio driver yet; on here for the software-in-the-loop harness.
+#define CONFIG_SEDS_TELEMETRY 1
+#define CONFIG_SEDS_TELEMETRY_BUDGET 640
+#define CONFIG_SEDS_TELEMETRY_QUEUE_LENGTH 16
+// CONFIG_SEDS_STATIC_MEMORY is set from CMake (see the SEDS_STATIC_MEMORY option).
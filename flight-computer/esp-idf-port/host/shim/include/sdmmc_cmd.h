@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdio>
+
+typedef struct {
+    int slot;
+    int max_freq_khz;
+} sdmmc_host_t;
+
+typedef struct {
+    const char *name;
+} sdmmc_card_t;
+
+void sdmmc_card_print_info(FILE *stream, const sdmmc_card_t *card);
@@ -0,0 +1,156 @@
+#include "loop.h"
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include "airbrake/apogee_controller.h"
+#include "airbrake/apogee_predictor.h"
+#include "clock.h"
+#include "engine/apogee_controller.h"
+#include "i2c_bus.h"
+#include "memory.h"
+
+using namespace std::chrono;
+
+namespace seds::sil {
+    namespace {
+        /// Writes the rocket's true state into the sensor models, with the noise and offsets of
+        /// the real parts (the same as flight_bench's simulated flight).
+        class SensorRenderer {
+        public:
+            SensorRenderer(sim::Rig& rig, trajectory::Atmosphere const& atmosphere, unsigned seed)
+                : rig(rig), atmosphere(atmosphere), rng(seed) {}
+
+            /// At `altitude` above the pad with `specific_force` (m/s²) along the rocket.
+            void render(double altitude, double specific_force) {
+                constexpr float imu_offset = 0.03f;
+                constexpr float high_g_offset = -0.2f;
+                constexpr std::array<float, 3> gyro_bias = { 0.05f, -0.03f, 0.01f };
+
+                auto const air = this->atmosphere.air(altitude);
+                auto const temperature = static_cast<float>(air.temperature - 273.15);
+                auto const pressure = static_cast<float>(air.pressure);
+                this->rig.baro1_model.set(temperature, pressure + this->baro_noise(this->rng));
+                this->rig.baro2_model.set(temperature, pressure + this->baro_noise(this->rng));
+
+                // The models saturate at whatever ranges the drivers configured
+                auto const felt_g = static_cast<float>(specific_force) / estimation::GRAVITY;
+                this->rig.imu_model.set(
+                    {
+                        this->imu_noise(this->rng),
+                        this->imu_noise(this->rng),
+                        felt_g + imu_offset + this->imu_noise(this->rng),
+                    },
+                    {
+                        gyro_bias[0] + this->gyro_noise(this->rng),
+                        gyro_bias[1] + this->gyro_noise(this->rng),
+                        gyro_bias[2] + this->gyro_noise(this->rng),
+                    });
+                this->rig.high_g_model.set({
+                    this->high_g_noise(this->rng),
+                    this->high_g_noise(this->rng),
+                    felt_g + high_g_offset + this->high_g_noise(this->rng),
+                });
+                this->rig.temp_model.set(22.0f);
+            }
+
+        private:
+            sim::Rig& rig;
+            trajectory::Atmosphere const& atmosphere;
+            std::mt19937 rng;
+            std::normal_distribution<float> imu_noise { 0.0f, 0.02f };
+            std::normal_distribution<float> gyro_noise { 0.0f, 0.1f };
+            std::normal_distribution<float> high_g_noise { 0.0f, 0.1f };
+            std::normal_distribution<float> baro_noise { 0.0f, 6.0f };
+        };
+    }
+
+    Result fly(sim::Rig& rig, trajectory::Scenario scenario, Config const& config) {
+        scenario.sampling_rate = config.rate;
+        sim::use_virtual_time(0);
+
+        SensorRenderer renderer(rig, scenario.atmosphere, config.seed);
+        renderer.render(0, scenario.atmosphere.gravity(0));
+        auto computer = rig.make_computer(config.log_format);
+        computer.downlink = telemetry::Downlink({ .budget = config.telemetry_budget });
+        // The loop below drains the frames as the radio would
+        computer.telemetry_consumer = true;
+
+        airbrake::ApogeePredictor const predictor(trajectory::predictor_config(scenario));
+        airbrake::ApogeeController controller({
+            .target_apogee = config.target,
+            .identify_drag = config.identify_drag,
+        }, predictor);
+        // The predictor was built for the rocket as designed
+        scenario.rocket.drag_scale *= config.drag_error;
+
+        auto const period_us = static_cast<int64_t>(std::llround(1e6 / config.rate));
+        auto const pad_us = static_cast<int64_t>(std::llround(config.pad * 1e6));
+        auto& bus = sim::I2CBus::instance();
+        Result result;
+        // Room for a minute of flight, so the loop doesn't reallocate
+        result.cycles.reserve(static_cast<size_t>((config.pad + 60) * config.rate));
+        result.downlink.reserve(static_cast<size_t>((config.pad + 60) * config.telemetry_budget));
+
+        // One sampling period: the sensors report the state at `time_us`, the flight computer
+        // takes a sample, and the controller updates on its estimate
+        auto const cycle = [&](int64_t time_us, double altitude, double specific_force) {
+            renderer.render(altitude, specific_force);
+            sim::set_virtual_time(time_us);
+
+            auto const wire_start = bus.wire_time_us();
+            auto const start = steady_clock::now();
+            memory::arm();
+            computer.step();
+            auto const coasting = computer.phase() == FlightPhase::Coast;
+            auto const deployment = controller.update(computer.estimate(), coasting);
+            memory::disarm();
+            auto const compute = steady_clock::now() - start;
+
+            // The radio takes the frames as soon as they're encoded
+            for (auto frame = computer.next_telemetry_frame(); frame != nullptr;
+                frame = computer.next_telemetry_frame()) {
+                result.downlink.insert(result.downlink.end(), frame->begin(), frame->end());
+                computer.release_telemetry_frame();
+            }
+
+            auto const flown = config.brakes ? deployment : 0.0f;
+            result.cycles.push_back({
+                .compute_us = duration<float, std::micro>(compute).count(),
+                .wire_us = static_cast<float>(bus.wire_time_us() - wire_start),
+                .estimate = computer.estimate(),
+                .deployment = flown,
+            });
+            if (computer.estimate().altitude > result.apogee.altitude) {
+                result.apogee = computer.estimate();
+            }
+            auto& phase_time = result.phase_times[static_cast<size_t>(computer.phase())];
+            if (!phase_time.has_value()) {
+                phase_time = static_cast<double>(time_us - pad_us) / 1e6;
+            }
+            return static_cast<double>(flown);
+        };
+
+        auto const wall_start = steady_clock::now();
+        for (int64_t time_us = 0; time_us < pad_us; time_us += period_us) {
+            cycle(time_us, 0, scenario.atmosphere.gravity(0));
+        }
+        result.flight = trajectory::simulate(scenario, trajectory::SolverConfig {},
+            [&](trajectory::ControllerInput const& input) {
+                auto const time_us = pad_us + std::llround(input.time * 1e6);
+                return cycle(time_us, input.altitude, input.specific_force);
+            });
+        computer.flush();
+        result.wall_s = duration<double>(steady_clock::now() - wall_start).count();
+        sim::use_real_time();
+
+        result.predicted_apogee = controller.predicted_apogee();
+        result.drag_scales = controller.drag_identifier().scales();
+        result.simulated_s = config.pad + result.flight.apogee_time;
+        std::strncpy(result.filename, computer.filename, sizeof(result.filename) - 1);
+        return result;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+// The closed loop behind the sil tool and flight_bench's BM_SoftwareInTheLoop: the trajectory
+// engine flies the rocket, the sensor models report its true state to the unmodified flight
+// computer, and the air brake controller's deployment on the flight computer's estimate goes
+// back into the engine.
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "airbrake/apogee_controller.h"
+#include "computer/computer.h"
+#include "engine/flight.h"
+#include "rig.h"
+
+namespace seds::sil {
+    struct Config {
+        /// Sensor samples per second, which is also how often the air brake controller runs.
+        double rate = 1e6 / CONFIG_SEDS_SAMPLE_PERIOD_US;
+        /// Time on the pad before ignition, for the pad calibration, s.
+        double pad = 5;
+        /// Whether the engine obeys the air brake controller. It runs either way.
+        bool brakes = true;
+        /// Apogee for the controller to aim for, m above the pad.
+        float target = airbrake::ControllerConfig {}.target_apogee;
+        /// Whether the controller fits the drag in flight (ControllerConfig::identify_drag).
+        bool identify_drag = false;
+        /// How much draggier the engine's rocket is than the drag curves the air brake computer
+        /// carries, as a multiplier on the airframe's.
+        double drag_error = 1;
+        /// Bytes per second the telemetry radio carries (telemetry::DownlinkConfig::budget).
+        uint32_t telemetry_budget = CONFIG_SEDS_TELEMETRY_BUDGET;
+        /// Seed for the sensor noise.
+        unsigned seed = 1;
+        LogFormat log_format = LogFormat::Raw;
+    };
+
+    /// One sampling period of the loop.
+    struct Cycle {
+        /// Host time for the flight computer's step and the controller's update, µs.
+        float compute_us;
+        /// Time the step's I2C transactions would have held a real bus, µs.
+        float wire_us;
+        /// The flight computer's estimate after the step.
+        estimation::Estimate estimate;
+        /// The deployment the engine flew through the period, 0 to 1.
+        float deployment;
+    };
+
+    struct Result {
+        /// The flight as the engine flew it.
+        trajectory::FlightResult flight;
+        /// The flight computer's estimate at its highest.
+        estimation::Estimate apogee;
+        /// The controller's last prediction, m above the pad.
+        float predicted_apogee = 0;
+        /// The controller's drag fit at the end, as multipliers on its tables.
+        airbrake::DragScales drag_scales;
+        /// When the flight computer entered each phase, s after ignition.
+        std::optional<double> phase_times[FLIGHT_PHASE_COUNT];
+        /// From the first sample on the pad to the last before apogee.
+        std::vector<Cycle> cycles;
+        /// Every telemetry frame the flight computer encoded, in order, as the radio would have
+        /// sent them.
+        std::vector<uint8_t> downlink;
+        /// Flight time simulated, pad included, s.
+        double simulated_s = 0;
+        /// Host time it took, s.
+        double wall_s = 0;
+        /// The flight computer's log, under ./sdcard.
+        char filename[32] = {};
+    };
+
+    /// Flies `scenario` from `config.pad` seconds before ignition to apogee with the flight
+    /// computer in the loop, under virtual time, one cycle per sampling period. `rig` gets a fresh
+    /// flight computer, and the clock goes back to real time at the end. The flight computer's
+    /// part of each cycle must not allocate (see memory.h).
+    Result fly(sim::Rig& rig, trajectory::Scenario scenario, Config const& config);
+}
@@ -0,0 +1,223 @@
+// Software in the loop: the trajectory engine (RocketPy/trajectory) flies the RocketPyTest rocket
+// to apogee, and the unmodified flight computer and air brake controller fly along with it.
+//
+// Every sampling period, the engine's true state is written into the register models behind the
+// simulated I2C bus:
+// - the air pressure and temperature at the rocket, for both BMP581s;
+// - the specific force along the rocket, for the BMI323 and the ADXL375. These get noise and fixed
+//   offsets like the real parts', and saturate at their ranges.
+//
+// FlightComputer reads the models through its real drivers and estimates the flight. The air
+// brake controller steers on that estimate, and its deployment goes back into the engine, which
+// closes the loop. Time is virtual, so the loop runs as fast as the host can.
+//
+// At the end it prints the flight next to what the flight computer made of it. It also prints
+// how long each cycle took: the host time for the flight computer and the controller, plus the
+// time the I2C transactions would have held a real bus. Together those bound the control latency.
+// The telemetry frames the flight computer sent can be saved as the radio's byte stream, for
+// decode_telemetry.
+//
+//     sil [--data <dir>] [--rate <Hz>] [--pad <s>] [--brakes apogee|off] [--target <m>]
+//         [--identify] [--drag <scale>] [--seed <n>] [--out <dir>] [--telemetry <file>]
+//         [--budget <bytes/s>] [--verbose]
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "engine/rocket.h"
+#include "esp_log.h"
+#include "loop.h"
+#include "rig.h"
+
+using namespace seds;
+
+namespace {
+    struct Options {
+        char const* data_dir = TRAJECTORY_DATA_DIR;
+        char const* out_dir = "sil-out";
+        std::optional<std::filesystem::path> telemetry;
+        sil::Config loop;
+        bool verbose = false;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: sil [--data <dir>] [--rate <Hz>] [--pad <s>] [--brakes apogee|off]\n"
+            "           [--target <m>] [--identify] [--drag <scale>] [--seed <n>] [--out <dir>]\n"
+            "           [--telemetry <file>] [--budget <bytes/s>] [--verbose]\n"
+            "\n"
+            "  --data     directory with the motor and drag files (default: RocketPyTest)\n"
+            "  --rate     sensor samples and controller updates per second (default: 100)\n"
+            "  --pad      seconds on the pad before ignition (default: 5)\n"
+            "  --brakes   fly the air brake controller, or keep the brakes stowed while it runs\n"
+            "             (default: apogee)\n"
+            "  --target   apogee for the controller to aim for, m (default: 5200)\n"
+            "  --identify fit the drag in flight and predict with the fit\n"
+            "  --drag     make the rocket this many times draggier than the controller's drag\n"
+            "             curves (default: 1)\n"
+            "  --seed     seed for the sensor noise (default: 1)\n"
+            "  --out      directory the flight computer's log is written to (default: sil-out)\n"
+            "  --telemetry\n"
+            "             write the telemetry frames to this file as the radio would send them\n"
+            "  --budget   bytes per second the telemetry radio carries (default: %d)\n"
+            "  --verbose  show the flight computer's log output\n", CONFIG_SEDS_TELEMETRY_BUDGET);
+    }
+
+    std::optional<double> number(char const* text) {
+        char* end;
+        auto const value = std::strtod(text, &end);
+        if (end == text || *end != '\0') {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--verbose") {
+                options.verbose = true;
+                continue;
+            }
+            if (arg == "--identify") {
+                options.loop.identify_drag = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            std::string_view const value = argv[++i];
+            auto const parsed = number(argv[i]);
+            if (arg == "--data") {
+                options.data_dir = argv[i];
+            } else if (arg == "--out") {
+                options.out_dir = argv[i];
+            } else if (arg == "--telemetry") {
+                // The output directory becomes the working directory, so resolve this first
+                options.telemetry = std::filesystem::absolute(argv[i]);
+            } else if (arg == "--budget" && parsed.value_or(-1) >= 0) {
+                options.loop.telemetry_budget = static_cast<uint32_t>(*parsed);
+            } else if (arg == "--rate" && parsed.value_or(0) > 0) {
+                options.loop.rate = *parsed;
+            } else if (arg == "--pad" && parsed.value_or(-1) >= 0) {
+                options.loop.pad = *parsed;
+            } else if (arg == "--brakes" && (value == "apogee" || value == "off")) {
+                options.loop.brakes = value == "apogee";
+            } else if (arg == "--target" && parsed.has_value()) {
+                options.loop.target = static_cast<float>(*parsed);
+            } else if (arg == "--drag" && parsed.value_or(0) > 0) {
+                options.loop.drag_error = *parsed;
+            } else if (arg == "--seed" && parsed.value_or(-1) >= 0) {
+                options.loop.seed = static_cast<unsigned>(*parsed);
+            } else {
+                return std::nullopt;
+            }
+        }
+        return options;
+    }
+
+    /// The `fraction` quantile of `values`, which it sorts.
+    float quantile(std::vector<float>& values, double fraction) {
+        if (values.empty()) {
+            return 0;
+        }
+        std::sort(values.begin(), values.end());
+        auto const i = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+        return values[i];
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto scenario = trajectory::load_calisto(options->data_dir);
+    if (!scenario.has_value()) {
+        std::fprintf(stderr, "%s\n", scenario.error().c_str());
+        return 1;
+    }
+
+    // The flight computer writes under ./sdcard, so run from the output directory.
+    std::filesystem::create_directories(options->out_dir);
+    std::filesystem::current_path(options->out_dir);
+    esp_log_level_set("*", options->verbose ? ESP_LOG_INFO : ESP_LOG_WARN);
+
+    sim::Rig rig;
+    auto result = sil::fly(rig, *scenario, options->loop);
+    if (!result.flight.reached_apogee) {
+        std::fprintf(stderr, "the rocket never reached apogee\n");
+        return 1;
+    }
+
+    auto const period_us = 1e6 / options->loop.rate;
+    std::vector<float> compute;
+    std::vector<float> latency;
+    double compute_total = 0;
+    double wire_total = 0;
+    size_t overruns = 0;
+    for (auto const& cycle : result.cycles) {
+        compute.push_back(cycle.compute_us);
+        latency.push_back(cycle.compute_us + cycle.wire_us);
+        compute_total += cycle.compute_us;
+        wire_total += cycle.wire_us;
+        overruns += latency.back() > period_us;
+    }
+    auto const count = static_cast<double>(std::max<size_t>(result.cycles.size(), 1));
+
+    std::printf("flew %zu cycles at %.0f Hz (%.3f s with %.1f s on the pad) into %s/%s\n",
+        result.cycles.size(), options->loop.rate, result.simulated_s, options->loop.pad,
+        options->out_dir, result.filename);
+    std::printf("wall time      %.3f s (%.0fx real time)\n", result.wall_s,
+        result.simulated_s / result.wall_s);
+    std::printf("apogee         %.1f m true, %.1f m estimated, %.3f s after ignition\n",
+        result.flight.apogee, result.apogee.altitude, result.flight.apogee_time);
+    std::printf("air brakes     %s, %.3f deployed at apogee, last predicted apogee %.1f m\n",
+        options->loop.brakes ? "flown" : "stowed", result.flight.deployment,
+        result.predicted_apogee);
+    if (options->loop.identify_drag) {
+        std::printf("drag fit       %.3f x the airframe's curve (truth %.3f), %.3f x the brakes'\n",
+            result.drag_scales.body, options->loop.drag_error, result.drag_scales.brakes);
+    }
+    auto const frames = result.downlink.size() / telemetry::FRAME_LEN;
+    std::printf("telemetry      %zu frames, %.0f bytes/s of %" PRIu32 "\n", frames,
+        static_cast<double>(result.downlink.size()) / result.simulated_s,
+        options->loop.telemetry_budget);
+    std::printf("phases        ");
+    for (size_t i = 1; i < FLIGHT_PHASE_COUNT; i++) {
+        if (result.phase_times[i].has_value()) {
+            std::printf(" %s at %.2f s", to_string(static_cast<FlightPhase>(i)),
+                *result.phase_times[i]);
+        }
+    }
+    std::printf(" after ignition\n");
+    std::printf("compute        %.2f us mean, %.2f us median, %.2f us p99, %.2f us slowest\n",
+        compute_total / count, quantile(compute, 0.5), quantile(compute, 0.99),
+        quantile(compute, 1));
+    std::printf("i2c wire       %.1f us mean per cycle\n", wire_total / count);
+    std::printf("latency        %.1f us median, %.1f us p99, %.1f us slowest, %zu cycles over the "
+        "%.0f us period\n", quantile(latency, 0.5), quantile(latency, 0.99), quantile(latency, 1),
+        overruns, period_us);
+
+    if (options->telemetry.has_value()) {
+        std::ofstream out(*options->telemetry, std::ios::binary);
+        out.write(reinterpret_cast<char const*>(result.downlink.data()),
+            static_cast<std::streamsize>(result.downlink.size()));
+        if (!out) {
+            std::fprintf(stderr, "couldn't write %s\n", options->telemetry->c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
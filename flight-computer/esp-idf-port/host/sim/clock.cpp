@@ -0,0 +1,36 @@
+#include "clock.h"
+
+#include <atomic>
+#include <chrono>
+
+#include "esp_timer.h"
+
+namespace seds::sim {
+    namespace {
+        std::atomic<bool> is_virtual = false;
+        std::atomic<int64_t> virtual_now_us = 0;
+    }
+
+    void use_virtual_time(int64_t now_us) {
+        virtual_now_us = now_us;
+        is_virtual = true;
+    }
+
+    void set_virtual_time(int64_t now_us) {
+        virtual_now_us = now_us;
+    }
+
+    void use_real_time() {
+        is_virtual = false;
+    }
+}
+
+int64_t esp_timer_get_time(void) {
+    if (seds::sim::is_virtual) {
+        return seds::sim::virtual_now_us;
+    }
+
+    static auto const start = std::chrono::steady_clock::now();
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace seds::sim {
+    /// Makes `esp_timer_get_time()` return a manually advanced time instead of the real time
+    /// since startup, so recorded or simulated data can be run faster than real time.
+    ///
+    /// esp_timer callbacks are still scheduled against the real clock.
+    void use_virtual_time(int64_t now_us);
+
+    /// Moves the virtual clock. Only valid after `use_virtual_time`.
+    void set_virtual_time(int64_t now_us);
+
+    /// Goes back to reporting the real time since startup.
+    void use_real_time();
+}
@@ -0,0 +1,170 @@
+#include "i2c_bus.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "driver/i2c_master.h"
+
+struct i2c_master_bus_t {
+    i2c_port_num_t port;
+};
+
+struct i2c_master_dev_t {
+    uint16_t address;
+    uint32_t scl_speed_hz;
+    uint32_t scl_wait_us;
+};
+
+namespace seds::sim {
+    I2CBus& I2CBus::instance() {
+        static I2CBus bus;
+        return bus;
+    }
+
+    void I2CBus::attach(uint16_t address, I2CModel& model) {
+        std::scoped_lock guard(this->lock);
+        this->models.at(address) = &model;
+    }
+
+    void I2CBus::detach(uint16_t address) {
+        std::scoped_lock guard(this->lock);
+        this->models.at(address) = nullptr;
+    }
+
+    void I2CBus::jam(bool clears_on_reset) {
+        std::scoped_lock guard(this->lock);
+        this->jammed = true;
+        this->jam_clears_on_reset = clears_on_reset;
+    }
+
+    void I2CBus::unjam() {
+        std::scoped_lock guard(this->lock);
+        this->jammed = false;
+    }
+
+    void I2CBus::reset() {
+        std::scoped_lock guard(this->lock);
+        this->resets++;
+        // Nine clocks and a stop at 100 kHz
+        this->wire_us += 100;
+        if (this->jam_clears_on_reset) {
+            this->jammed = false;
+        }
+    }
+
+    esp_err_t I2CBus::transact(
+        uint16_t address,
+        std::span<uint8_t const> write,
+        std::span<uint8_t> read,
+        uint32_t scl_speed_hz,
+        uint32_t scl_wait_us,
+        int timeout_ms
+    ) {
+        std::scoped_lock guard(this->lock);
+        this->transactions++;
+
+        if (this->jammed) {
+            auto const timeout_us = static_cast<uint64_t>(timeout_ms) * 1000;
+            this->wire_us += scl_wait_us > 0
+                ? std::min<uint64_t>(scl_wait_us, timeout_us)
+                : timeout_us;
+            return ESP_ERR_TIMEOUT;
+        }
+
+        // Nine clocks per byte including the ACK, plus the starts and the stop
+        auto const clocks_to_us = [&](uint64_t clocks) {
+            return clocks * 1'000'000 / scl_speed_hz;
+        };
+        if (address >= this->models.size() || this->models[address] == nullptr) {
+            this->wire_us += clocks_to_us(9 + 2);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        auto const result = this->models[address]->transact(write, read);
+        if (result != ESP_OK) {
+            // Models fail like a NACKed address
+            this->wire_us += clocks_to_us(9 + 2);
+        } else {
+            auto const bytes = 1 + write.size() + (read.empty() ? 0 : 1 + read.size());
+            this->wire_us += clocks_to_us(bytes * 9 + (read.empty() ? 2 : 3));
+        }
+        return result;
+    }
+}
+
+esp_err_t i2c_new_master_bus(
+    const i2c_master_bus_config_t *bus_config,
+    i2c_master_bus_handle_t *ret_bus_handle
+) {
+    *ret_bus_handle = new i2c_master_bus_t { .port = bus_config->i2c_port };
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus_handle) {
+    delete bus_handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_reset(i2c_master_bus_handle_t bus_handle) {
+    if (bus_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    seds::sim::I2CBus::instance().reset();
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(
+    i2c_master_bus_handle_t bus_handle,
+    const i2c_device_config_t *dev_config,
+    i2c_master_dev_handle_t *ret_handle
+) {
+    if (bus_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *ret_handle = new i2c_master_dev_t {
+        .address = dev_config->device_address,
+        .scl_speed_hz = dev_config->scl_speed_hz,
+        .scl_wait_us = dev_config->scl_wait_us,
+    };
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle) {
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(
+    i2c_master_dev_handle_t i2c_dev,
+    const uint8_t *write_buffer,
+    size_t write_size,
+    int xfer_timeout_ms
+) {
+    return seds::sim::I2CBus::instance().transact(
+        i2c_dev->address,
+        { write_buffer, write_size },
+        {},
+        i2c_dev->scl_speed_hz,
+        i2c_dev->scl_wait_us,
+        xfer_timeout_ms
+    );
+}
+
+esp_err_t i2c_master_transmit_receive(
+    i2c_master_dev_handle_t i2c_dev,
+    const uint8_t *write_buffer,
+    size_t write_size,
+    uint8_t *read_buffer,
+    size_t read_size,
+    int xfer_timeout_ms
+) {
+    return seds::sim::I2CBus::instance().transact(
+        i2c_dev->address,
+        { write_buffer, write_size },
+        { read_buffer, read_size },
+        i2c_dev->scl_speed_hz,
+        i2c_dev->scl_wait_us,
+        xfer_timeout_ms
+    );
+}
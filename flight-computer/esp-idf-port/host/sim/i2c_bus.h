@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+
+#include "esp_err.h"
+
+namespace seds::sim {
+    /// A device model that answers I2C transactions addressed to it.
+    class I2CModel {
+    public:
+        virtual ~I2CModel() = default;
+
+        /// Handle a write (and optional repeated-start read) transaction. `read` is empty for
+        /// write-only transactions. Return anything other than ESP_OK to simulate a NACK or timeout.
+        virtual esp_err_t transact(std::span<uint8_t const> write, std::span<uint8_t> read) = 0;
+    };
+
+    /// The simulated I2C bus behind the host `i2c_master_*` functions.
+    ///
+    /// Models are attached by 7-bit address. Transactions to an address with no model attached fail
+    /// with ESP_ERR_INVALID_STATE, which is what ESP-IDF reports for an address NACK.
+    ///
+    /// The bus also keeps a tally of the time the transactions would have taken on a real wire,
+    /// since none of it shows up in the host's own timing: the whole transfer for a completed
+    /// one, the address byte for a NACK, and for one that hangs, the device's SCL wait if it set
+    /// one (the controller gives up then) or else the full timeout.
+    class I2CBus {
+    public:
+        static I2CBus& instance();
+
+        void attach(uint16_t address, I2CModel& model);
+        void detach(uint16_t address);
+
+        /// Number of transactions that have been routed through the bus, including failed ones.
+        [[nodiscard]]
+        uint64_t transaction_count() const {
+            return this->transactions;
+        }
+
+        /// Time the transactions and resets so far would have kept a real bus busy, µs.
+        [[nodiscard]]
+        uint64_t wire_time_us() const {
+            return this->wire_us;
+        }
+
+        /// Simulate a device holding SDA low, so every transaction times out. If `clears_on_reset`,
+        /// the next bus reset frees it, like a device left mid-byte. Otherwise it stays jammed, like
+        /// a shorted line, until `unjam`.
+        void jam(bool clears_on_reset = true);
+        void unjam();
+
+        /// Number of times the bus has been reset.
+        [[nodiscard]]
+        uint32_t reset_count() const {
+            return this->resets;
+        }
+
+        esp_err_t transact(uint16_t address, std::span<uint8_t const> write, std::span<uint8_t> read,
+            uint32_t scl_speed_hz, uint32_t scl_wait_us, int timeout_ms);
+
+        /// Clock SCL nine times and send a stop, as `i2c_master_bus_reset` does.
+        void reset();
+
+    private:
+        std::mutex lock;
+        std::array<I2CModel*, 0x80> models {};
+        uint64_t transactions = 0;
+        uint64_t wire_us = 0;
+        bool jammed = false;
+        bool jam_clears_on_reset = true;
+        uint32_t resets = 0;
+    };
+}
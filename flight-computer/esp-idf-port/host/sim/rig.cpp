@@ -0,0 +1,53 @@
+#include "rig.h"
+
+#include "errors.h"
+#include "i2c_bus.h"
+
+namespace seds::sim {
+    Rig::Rig() {
+        auto& bus = I2CBus::instance();
+        bus.attach(BMP581::address_1, this->baro1_model);
+        bus.attach(BMP581::address_2, this->baro2_model);
+        bus.attach(BMI323::default_address, this->imu_model);
+        bus.attach(HighGAccel::default_address, this->high_g_model);
+        bus.attach(TMP1075::default_address, this->temp_model);
+
+        this->baro1_model.set(22.0f, 101'325.0f);
+        this->baro2_model.set(21.98f, 101'320.0f);
+        // Sitting upright on the pad
+        this->imu_model.set({ 0.003f, -0.01f, 1.0f }, { 0.05f, -0.03f, 0.01f });
+        this->high_g_model.set({ 0.0f, 0.05f, 1.02f });
+        this->temp_model.set(22.0f);
+
+        this->i2c = I2C::create();
+    }
+
+    Rig::~Rig() {
+        auto& bus = I2CBus::instance();
+        bus.detach(BMP581::address_1);
+        bus.detach(BMP581::address_2);
+        bus.detach(BMI323::default_address);
+        bus.detach(HighGAccel::default_address);
+        bus.detach(TMP1075::default_address);
+    }
+
+    FlightComputer Rig::make_computer(LogFormat log_format) {
+        using errors::unwrap;
+
+        auto sd = unwrap(SDCard::create());
+        unwrap(sd.format_fatfs());
+
+        auto computer = FlightComputer {
+            .baro1 = unwrap(BMP581::create(unwrap(this->i2c->get_device(BMP581::address_1)))),
+            .baro2 = unwrap(BMP581::create(unwrap(this->i2c->get_device(BMP581::address_2)))),
+            .imu = unwrap(BMI323::create(unwrap(this->i2c->get_device(BMI323::default_address)))),
+            .high_g_accel = unwrap(HighGAccel::create(unwrap(this->i2c->get_device(HighGAccel::default_address)))),
+            .temp = unwrap(this->i2c->get_device<TMP1075>()),
+            .sd = std::move(sd),
+            .log_format = log_format,
+        };
+        unwrap(computer.init());
+
+        return computer;
+    }
+}
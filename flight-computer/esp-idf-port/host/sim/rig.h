@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+
+#include "computer/computer.h"
+#include "i2c/I2C.h"
+#include "sensor_models.h"
+
+namespace seds::sim {
+    /// Models of the flight computer's sensors, attached to the simulated bus at the addresses
+    /// the firmware uses. Only one rig can exist at a time since there is only one bus.
+    struct Rig {
+        BMP581Model baro1_model;
+        BMP581Model baro2_model;
+        BMI323Model imu_model;
+        ADXL375Model high_g_model;
+        TMP1075Model temp_model;
+
+        std::shared_ptr<I2C> i2c;
+
+        /// Attaches the models with plausible on-pad readings.
+        Rig();
+        ~Rig();
+
+        Rig(Rig const&) = delete;
+        Rig& operator=(Rig const&) = delete;
+
+        /// Builds a flight computer that owns fresh drivers for every sensor in the rig, the same
+        /// way app_main does, and runs its init. The SD "card" is the local sdcard/ directory,
+        /// which is wiped first.
+        FlightComputer make_computer(LogFormat log_format = LogFormat::Csv);
+    };
+}
@@ -0,0 +1,277 @@
+#include "sensor_models.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "i2c/BMI323.h"
+#include "i2c/BMP581.h"
+#include "i2c/high_g_accel.h"
+#include "i2c/TMP1075.h"
+
+namespace seds::sim {
+    namespace {
+        /// Rounds to the nearest count and saturates like the sensor's ADC.
+        template<typename T>
+        T to_counts(float value, float limit = std::numeric_limits<T>::max()) {
+            auto const clamped = std::clamp(std::round(value), -limit, limit);
+            return static_cast<T>(std::clamp<float>(
+                clamped,
+                std::numeric_limits<T>::min(),
+                std::numeric_limits<T>::max()
+            ));
+        }
+
+        // Nominal sensitivities come straight from the drivers in main/i2c, so that values set here
+        // read back unchanged through them.
+        constexpr auto const& bmi323_accel_lsb_per_g = BMI323::accel_lsb_per_g;
+        constexpr auto const& bmi323_gyro_lsb_per_dps = BMI323::gyro_lsb_per_dps;
+        constexpr float adxl375_lsb_per_g = 1.0f / HighGAccel::scale().g_per_lsb;
+        constexpr float bmp581_lsb_per_c = 1.0f / BMP581::scale().c_per_lsb;
+        constexpr float bmp581_lsb_per_pa = 1.0f / BMP581::scale().pa_per_lsb;
+        constexpr float tmp1075_lsb_per_c = 1.0f / TMP1075::c_per_lsb;
+    }
+
+    esp_err_t ByteRegisterModel::transact(std::span<uint8_t const> write, std::span<uint8_t> read) {
+        if (!this->present) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (write.empty()) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        size_t reg = write[0];
+        for (auto value : write.subspan(1)) {
+            this->regs[reg % this->regs.size()] = value;
+            this->on_write(reg % this->regs.size(), value);
+            reg++;
+        }
+
+        for (auto& value : read) {
+            value = this->regs[reg % this->regs.size()];
+            reg++;
+        }
+
+        return ESP_OK;
+    }
+
+    void ByteRegisterModel::store_le24(uint8_t reg, int32_t value) {
+        this->regs[reg] = value & 0xFF;
+        this->regs[reg + 1] = (value >> 8) & 0xFF;
+        this->regs[reg + 2] = (value >> 16) & 0xFF;
+    }
+
+    void ByteRegisterModel::store_le16(uint8_t reg, int16_t value) {
+        this->regs[reg] = value & 0xFF;
+        this->regs[reg + 1] = (value >> 8) & 0xFF;
+    }
+
+    BMP581Model::BMP581Model() {
+        this->power_cycle();
+    }
+
+    void BMP581Model::power_cycle() {
+        this->regs.fill(0);
+        this->regs[0x01] = 0x50; // CHIP_ID
+        this->regs[0x28] = 0x02; // STATUS: NVM ready
+        this->regs[0x36] = 0x00; // OSR_CONFIG
+        this->regs[0x37] = 0x70; // ODR_CONFIG: standby, 1 Hz
+    }
+
+    void BMP581Model::on_write(uint8_t reg, uint8_t) {
+        if (reg == 0x37) {
+            this->render();
+        }
+    }
+
+    void BMP581Model::render() {
+        // No conversions in standby, so the outputs hold whatever they last were
+        if ((this->regs[0x37] & 0x03) == 0) {
+            return;
+        }
+        this->store_le24(0x1D, this->temperature);
+        this->store_le24(0x20, this->pressure);
+    }
+
+    void BMP581Model::set_raw(int32_t temperature, int32_t pressure) {
+        this->temperature = temperature;
+        this->pressure = pressure;
+        this->render();
+    }
+
+    void BMP581Model::set(float temperature, float pressure) {
+        this->set_raw(
+            to_counts<int32_t>(temperature * bmp581_lsb_per_c, 0x7FFFFF),
+            to_counts<int32_t>(pressure * bmp581_lsb_per_pa, 0xFFFFFF)
+        );
+    }
+
+    ADXL375Model::ADXL375Model() {
+        this->power_cycle();
+    }
+
+    void ADXL375Model::power_cycle() {
+        this->regs.fill(0);
+        this->regs[0x00] = 0xE5; // DEVID
+        this->regs[0x2D] = 0x00; // POWER_CTL: standby
+        this->regs[0x31] = 0x0B; // DATA_FORMAT
+    }
+
+    void ADXL375Model::on_write(uint8_t reg, uint8_t) {
+        if (reg == 0x2D) {
+            this->render();
+        }
+    }
+
+    void ADXL375Model::render() {
+        // Only measurement mode updates the outputs
+        if (!(this->regs[0x2D] & 0x08)) {
+            return;
+        }
+        this->store_le16(0x32, this->accel[0]);
+        this->store_le16(0x34, this->accel[1]);
+        this->store_le16(0x36, this->accel[2]);
+    }
+
+    void ADXL375Model::set_raw(int16_t x, int16_t y, int16_t z) {
+        this->accel = { x, y, z };
+        this->render();
+    }
+
+    void ADXL375Model::set(std::array<float, 3> accel) {
+        // 13-bit output at full resolution
+        constexpr float limit = 4095;
+        this->set_raw(
+            to_counts<int16_t>(accel[0] * adxl375_lsb_per_g, limit),
+            to_counts<int16_t>(accel[1] * adxl375_lsb_per_g, limit),
+            to_counts<int16_t>(accel[2] * adxl375_lsb_per_g, limit)
+        );
+    }
+
+    BMI323Model::BMI323Model() {
+        this->reset();
+    }
+
+    void BMI323Model::reset() {
+        this->regs.fill(0);
+        this->regs[0x00] = 0x0043; // CHIP_ID
+        this->regs[0x02] = 0x0001; // STATUS: power-on reset detected
+        this->regs[0x20] = 0x0028; // ACC_CFG: suspend, 8g, 50 Hz
+        this->regs[0x21] = 0x0048; // GYR_CFG: suspend, 2000 dps, 50 Hz
+        this->render();
+    }
+
+    void BMI323Model::render() {
+        constexpr uint16_t disabled = 0x8000;
+        bool const accel_on = (this->regs[0x20] >> 12) & 0x7;
+        bool const gyro_on = (this->regs[0x21] >> 12) & 0x7;
+        auto const accel_range = std::min<size_t>((this->regs[0x20] >> 4) & 0x7, 3);
+        auto const gyro_range = std::min<size_t>((this->regs[0x21] >> 4) & 0x7, 4);
+        for (size_t i = 0; i < 3; i++) {
+            int16_t accel = this->raw_accel[i];
+            int16_t gyro = this->raw_gyro[i];
+            if (this->has_physical) {
+                accel = to_counts<int16_t>(this->accel[i] * bmi323_accel_lsb_per_g[accel_range]);
+                gyro = to_counts<int16_t>(this->gyro[i] * bmi323_gyro_lsb_per_dps[gyro_range]);
+            }
+            this->regs[0x03 + i] = accel_on ? static_cast<uint16_t>(accel) : disabled;
+            this->regs[0x06 + i] = gyro_on ? static_cast<uint16_t>(gyro) : disabled;
+        }
+    }
+
+    esp_err_t BMI323Model::transact(std::span<uint8_t const> write, std::span<uint8_t> read) {
+        if (!this->present) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (write.empty()) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        size_t reg = write[0];
+        auto data = write.subspan(1);
+        for (size_t i = 0; i + 1 < data.size(); i += 2) {
+            uint16_t const value = data[i] | (data[i + 1] << 8);
+            if (reg == 0x7E) {
+                if (value == 0xDEAF) {
+                    this->reset();
+                }
+            } else {
+                this->regs[reg % this->regs.size()] = value;
+            }
+            reg++;
+        }
+        if (!data.empty()) {
+            // A range or mode change rescales or disables the data registers.
+            this->render();
+        }
+
+        // The first two bytes of every read are dummy bytes.
+        for (size_t i = 0; i < read.size(); i++) {
+            if (i < 2) {
+                read[i] = 0;
+                continue;
+            }
+
+            uint16_t const value = this->regs[(reg + (i - 2) / 2) % this->regs.size()];
+            read[i] = (i % 2 == 0) ? (value & 0xFF) : (value >> 8);
+        }
+
+        return ESP_OK;
+    }
+
+    void BMI323Model::set_raw(std::array<int16_t, 3> accel, std::array<int16_t, 3> gyro) {
+        this->has_physical = false;
+        this->raw_accel = accel;
+        this->raw_gyro = gyro;
+        this->render();
+    }
+
+    void BMI323Model::set(std::array<float, 3> accel, std::array<float, 3> gyro) {
+        this->accel = accel;
+        this->gyro = gyro;
+        this->has_physical = true;
+        this->render();
+    }
+
+    TMP1075Model::TMP1075Model() {
+        this->power_cycle();
+    }
+
+    void TMP1075Model::power_cycle() {
+        // The temperature register carries on converting
+        this->regs[0x01] = 0x00FF; // CFGR
+        this->regs[0x02] = 0x4B00; // LLIM
+        this->regs[0x03] = 0x5000; // HLIM
+        this->regs[0x0F] = 0x7500; // DIEID
+    }
+
+    esp_err_t TMP1075Model::transact(std::span<uint8_t const> write, std::span<uint8_t> read) {
+        if (!this->present) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (write.empty()) {
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        this->pointer = write[0] % this->regs.size();
+        if (write.size() >= 3) {
+            this->regs[this->pointer] = (write[1] << 8) | write[2];
+        }
+
+        // The pointer doesn't auto-increment, so long reads repeat the same register.
+        for (size_t i = 0; i < read.size(); i++) {
+            uint16_t const value = this->regs[this->pointer];
+            read[i] = (i % 2 == 0) ? (value >> 8) : (value & 0xFF);
+        }
+
+        return ESP_OK;
+    }
+
+    void TMP1075Model::set_raw(int16_t temperature) {
+        this->regs[0x00] = static_cast<uint16_t>(temperature << 4);
+    }
+
+    void TMP1075Model::set(float temperature) {
+        this->set_raw(to_counts<int16_t>(temperature * tmp1075_lsb_per_c, 2047));
+    }
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "i2c_bus.h"
+
+// Register-level models of the flight computer's I2C sensors. Each model exposes the registers
+// the drivers in main/i2c touch, with the power-on values from the datasheets, so the unmodified
+// drivers can run against them on the host.
+
+namespace seds::sim {
+    /// A device with 8-bit registers and an auto-incrementing register pointer (ADXL375, BMP581).
+    class ByteRegisterModel : public I2CModel {
+    public:
+        esp_err_t transact(std::span<uint8_t const> write, std::span<uint8_t> read) override;
+
+        /// When false, every transaction fails as if the device had been unplugged.
+        bool present = true;
+
+    protected:
+        /// Called after a register is written by the bus master.
+        virtual void on_write([[maybe_unused]] uint8_t reg, [[maybe_unused]] uint8_t value) {}
+
+        void store_le24(uint8_t reg, int32_t value);
+        void store_le16(uint8_t reg, int16_t value);
+
+        std::array<uint8_t, 0x80> regs {};
+    };
+
+    /// Bosch BMP581 barometer. The outputs only update outside standby, which is where it
+    /// powers on.
+    class BMP581Model final : public ByteRegisterModel {
+    public:
+        BMP581Model();
+
+        /// Set the raw 24-bit temperature (1/65536 °C) and pressure (1/64 Pa) outputs.
+        void set_raw(int32_t temperature, int32_t pressure);
+
+        /// Set the outputs from a temperature in °C and a pressure in Pa.
+        void set(float temperature, float pressure);
+
+        /// Lose power for a moment: every register goes back to its power-on value.
+        void power_cycle();
+
+    protected:
+        void on_write(uint8_t reg, uint8_t value) override;
+
+    private:
+        void render();
+
+        int32_t temperature = 0;
+        int32_t pressure = 0;
+    };
+
+    /// Analog Devices ADXL375 high-g accelerometer. The outputs only update in measurement mode,
+    /// which it doesn't power on in.
+    class ADXL375Model final : public ByteRegisterModel {
+    public:
+        ADXL375Model();
+
+        /// Set the raw right-justified axis outputs.
+        void set_raw(int16_t x, int16_t y, int16_t z);
+
+        /// Set the outputs from an acceleration in g, saturating at the ±200 g range.
+        void set(std::array<float, 3> accel);
+
+        /// Lose power for a moment: every register goes back to its power-on value.
+        void power_cycle();
+
+    protected:
+        void on_write(uint8_t reg, uint8_t value) override;
+
+    private:
+        void render();
+
+        std::array<int16_t, 3> accel {};
+    };
+
+    /// Bosch BMI323 IMU. Registers are 16 bits wide, and reads over I2C are preceded by two dummy
+    /// bytes. A suspended accelerometer or gyroscope, as at power-on, reads -32768 on every axis.
+    class BMI323Model final : public I2CModel {
+    public:
+        BMI323Model();
+
+        esp_err_t transact(std::span<uint8_t const> write, std::span<uint8_t> read) override;
+
+        /// Set the raw accelerometer and gyroscope outputs.
+        void set_raw(std::array<int16_t, 3> accel, std::array<int16_t, 3> gyro);
+
+        /// Set the outputs from an acceleration in g and a rotation rate in °/s, using whichever
+        /// ranges the driver last configured. Values outside the range saturate.
+        void set(std::array<float, 3> accel, std::array<float, 3> gyro);
+
+        /// Lose power for a moment: every register goes back to its power-on value.
+        void power_cycle() {
+            this->reset();
+        }
+
+        bool present = true;
+
+    private:
+        void reset();
+        void render();
+
+        std::array<uint16_t, 0x80> regs {};
+        std::array<float, 3> accel {};
+        std::array<float, 3> gyro {};
+        std::array<int16_t, 3> raw_accel {};
+        std::array<int16_t, 3> raw_gyro {};
+        bool has_physical = false;
+    };
+
+    /// TI TMP1075 temperature sensor. Registers are 16 bits wide and big-endian.
+    class TMP1075Model final : public I2CModel {
+    public:
+        TMP1075Model();
+
+        esp_err_t transact(std::span<uint8_t const> write, std::span<uint8_t> read) override;
+
+        /// Set the raw 12-bit temperature output (1/16 °C).
+        void set_raw(int16_t temperature);
+
+        /// Set the output from a temperature in °C.
+        void set(float temperature);
+
+        /// Lose power for a moment: the configuration goes back to its power-on value.
+        void power_cycle();
+
+        bool present = true;
+
+    private:
+        std::array<uint16_t, 0x10> regs {};
+        uint8_t pointer = 0;
+    };
+}
@@ -1,20 +1,66 @@
 #include "computer.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include "computer/sensors.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include <sys/time.h>
+#include "memory.h"
+#include "sdkconfig.h"
+#include "spsc_ring.h"
 
 static const char *TAG = "computer";
 
 namespace seds {
 
+// The counters and flags below are written by one task and read by others
+static void bump(uint32_t& counter, uint32_t by = 1) {
+    std::atomic_ref(counter).fetch_add(by, std::memory_order_relaxed);
+}
+
+static uint32_t load(uint32_t& counter) {
+    return std::atomic_ref(counter).load(std::memory_order_relaxed);
+}
+
+static bool load(bool& flag) {
+    return std::atomic_ref(flag).load(std::memory_order_acquire);
+}
+
+static void store(bool& flag, bool value) {
+    std::atomic_ref(flag).store(value, std::memory_order_release);
+}
+
+static FlightPhase load(FlightPhase& phase) {
+    return std::atomic_ref(phase).load(std::memory_order_acquire);
+}
+
+static void store(FlightPhase& phase, FlightPhase value) {
+    std::atomic_ref(phase).store(value, std::memory_order_release);
+}
+
+static uint8_t load(uint8_t& mask) {
+    return std::atomic_ref(mask).load(std::memory_order_relaxed);
+}
+
+static void store(uint8_t& mask, uint8_t value) {
+    std::atomic_ref(mask).store(value, std::memory_order_relaxed);
+}
+
+#if CONFIG_SEDS_TELEMETRY
+/// Frames encoded by the storage task, waiting for the radio.
+SpscRing<telemetry::FrameBytes, CONFIG_SEDS_TELEMETRY_QUEUE_LENGTH> telemetry_ring;
+#endif
+
 Expected<std::monostate> FlightComputer::init() {
-    char data[] = "timestamp, accel x, accel y, accel z, degrees x, degrees y, degrees z, baro 1 temp, baro 1 pressure, baro 2 temp, baro 2 pressure, high g accel x, high g accel y, high g accel z, temp\n";
+    char const* extension = this->log_format == LogFormat::Raw ? "bin" : "csv";
+
     // test different filenames
     bool broke = false;
     struct stat st;
@@ -22,7 +68,7 @@ Expected<std::monostate> FlightComputer::init() {
         // should write SD functions for this
         // TODO
         // also improve interface so we dont have to do what we do in process()
-        snprintf(this->filename, FlightComputer::buf_len, "%s/data%d.csv", MOUNT_POINT, i);
+        snprintf(this->filename, FlightComputer::buf_len, "%s/data%d.%s", MOUNT_POINT, i, extension);
         ESP_LOGI("computer", "filename: %s, res: %d", this->filename, stat(this->filename, &st));
         if (stat(this->filename, &st) == -1) {
             // doesn't exist, we go with it
@@ -32,106 +78,546 @@ Expected<std::monostate> FlightComputer::init() {
     } 
     
     if (!broke) {
-        strcpy(this->filename, MOUNT_POINT"/data.csv");
+        snprintf(this->filename, FlightComputer::buf_len, "%s/data.%s", MOUNT_POINT, extension);
     }
     ESP_LOGI("computer", "filename: %s", this->filename);
 
-    return this->sd.create_file(this->filename, (uint8_t *)data, sizeof(data)-1); // subtract one
+    if (this->log_format == LogFormat::Raw) {
+        // The schema is fixed at compile time, then the scales and (so far empty) calibration go
+        // first so the first sample can be converted
+        TRY(this->sd.create_file(this->filename, RAW_LOG_HEADER.data(), RAW_LOG_HEADER.size()));
+        uint8_t records[RAW_SCALES_RECORD_LEN + RAW_CALIBRATION_RECORD_LEN];
+        this->logged_scales = this->scales();
+        this->logged_calibration = this->conversion.calibration;
+        auto len = encode_raw_scales(records, this->logged_scales);
+        len += encode_raw_calibration(&records[len], this->logged_calibration);
+        TRY(this->sd.append_file(this->filename, records, len));
+    } else {
+        TRY(this->sd.create_file(this->filename, (uint8_t *)CSV_HEADER.data(), sizeof(CSV_HEADER)-1)); // subtract one
+    }
+
+    // Keep the log open from here on, so flushes don't have to open it (which allocates)
+    this->log_file = TRY(this->sd.open_append(this->filename));
+
+#if CONFIG_SEDS_TELEMETRY
+    // A computer made before this one may have left frames behind
+    telemetry_ring.clear();
+#endif
+
+    return std::monostate {};
 }
 
-constexpr size_t LOOPS_BEFORE_FLUSH = 100;
-char buffer[LOOPS_BEFORE_FLUSH * (40 + 14 * 20 + 13 + 1 + 1)];
+constexpr size_t LOOPS_BEFORE_FLUSH = CONFIG_SEDS_LOG_BUFFER_ROWS;
 
-void FlightComputer::process(uint32_t times, bool endless) {
-    FILE *data_file = fopen(this->filename, "a");
+#if CONFIG_SEDS_LOG_BUFFER_EXTERNAL
+#define LOG_BUFFER_ATTR EXT_RAM_BSS_ATTR
+#else
+#define LOG_BUFFER_ATTR DRAM_ATTR
+#endif
 
-    struct timeval tv_now;
-    memset(buffer, 'X', sizeof(buffer));
-    size_t idx = 0;
-    for (int i = 0; i < times || endless; i++) {
-        gettimeofday(&tv_now, NULL);
-        int64_t time_ms = (int64_t)tv_now.tv_sec * 1000L + (int64_t)tv_now.tv_usec / 1000L;
-        IMUData imu_data = {.ax = 0, .ay = 0, .az = 0, .gx = 0, .gy = 0, .gz = 0};
-        BarometerData baro_1_data = { .baro_temp = 0, .pressure = 0 };
-        BarometerData baro_2_data = { .baro_temp = 0, .pressure = 0 };
-        HighGAccelData high_g_data = { .h_ax = 0, .h_ay = 0, .h_az = 0 };
-        float tmp = 0.0;
-
-        auto imu_data_try = this->imu.read_imu();
-        if (imu_data_try.has_value()) {
-            imu_data = imu_data_try.value();
-        } else {
-            ESP_LOGE(TAG, "imu data read failed");
+LOG_BUFFER_ATTR char buffer[LOOPS_BEFORE_FLUSH * CSV_ROW_MAX_LEN];
+static_assert(RAW_SCALES_RECORD_LEN + RAW_CALIBRATION_RECORD_LEN + RAW_SAMPLE_RECORD_LEN
+    <= CSV_ROW_MAX_LEN,
+    "a raw row must fit wherever a CSV row does");
+
+SensorScales FlightComputer::scales() const {
+    SensorScales scales;
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        scales.*S::scale = (this->*S::driver).scale();
+    });
+    return scales;
+}
+
+SensorSample FlightComputer::read_sensors() {
+    return this->scales().convert(this->read_sensors_raw());
+}
+
+RawSensorSample FlightComputer::read_sensors_raw() {
+    RawSensorSample sample = {};
+    sample.time_ms = esp_timer_get_time() / 1000;
+
+    FlightSensors::for_each([&]<typename S, size_t I>() {
+        if (!this->should_read(I, sample.time_ms)) {
+            return;
         }
 
-        auto baro_1_data_try = this->baro1.read_data();
-        if (baro_1_data_try.has_value()) {
-            baro_1_data = baro_1_data_try.value();
+        auto reading = (this->*S::driver).read_raw();
+        if (reading.has_value()) {
+            sample.*S::raw = reading.value();
+            sample.valid |= FlightSensors::valid_bit<I>;
         } else {
-            ESP_LOGE(TAG, "baro 1 data read failed");
+            ESP_LOGE(TAG, "%s data read failed", S::name.data());
         }
+    });
 
-        auto baro_2_data_try = this->baro2.read_data();
-        if (baro_2_data_try.has_value()) {
-            baro_2_data = baro_2_data_try.value();
-        } else {
-            ESP_LOGE(TAG, "baro 2 data read failed");
+    return sample;
+}
+
+/// How often a dead sensor is read to see if it's back.
+constexpr int64_t DEAD_SENSOR_RETRY_MS = 1000;
+
+bool FlightComputer::should_read(size_t index, int64_t now_ms) {
+    uint8_t const bit = 1 << index;
+    if (!(load(this->dead_sensors) & bit)) {
+        return true;
+    }
+
+    // Reading a dead sensor costs a bus timeout, so only try now and then
+    if (now_ms < this->next_retry_ms[index]) {
+        return false;
+    }
+    this->next_retry_ms[index] = now_ms + DEAD_SENSOR_RETRY_MS;
+    return true;
+}
+
+/// Time a routine probe needs left in the sampling period, enough for the reconfiguration that
+/// may follow it, µs.
+constexpr int64_t PROBE_BUDGET_US = 2000;
+
+void FlightComputer::supervise_sensors(RawSensorSample const& sample, int64_t period_start_us) {
+    this->supervisor.observe(sample);
+
+    auto const now_us = esp_timer_get_time();
+    int64_t const period_us = policy_for(load(this->current_phase)).sample_period_us;
+    bool const idle = now_us - period_start_us + PROBE_BUDGET_US <= period_us;
+
+    auto const sensor = this->supervisor.next_probe(now_us / 1000, idle);
+    if (sensor.has_value()) {
+        this->supervisor.record(*sensor, now_us / 1000, this->probe_sensor(*sensor));
+    }
+}
+
+std::optional<ProbeResult> FlightComputer::probe_sensor(SensorId sensor) {
+    std::optional<ProbeResult> result;
+    FlightSensors::visit(static_cast<size_t>(sensor), [&]<typename S, size_t>() {
+        auto& driver = this->*S::driver;
+        auto const probe = driver.probe();
+        if (!probe.has_value()) {
+            return;
+        }
+        result = probe.value();
+        if (result == ProbeResult::Ok) {
+            return;
         }
 
-        auto high_g_data_try = this->high_g_accel.read_acceleration();
-        if (high_g_data_try.has_value()) {
-            high_g_data = high_g_data_try.value();
-        } else {
-            ESP_LOGE(TAG, "high g data read failed");
+        ESP_LOGW(TAG, "%s %s, reconfiguring it", S::name.data(),
+            result == ProbeResult::Reset ? "reset" : "reported an error");
+        auto const reinit = driver.reinit();
+        if (!reinit.has_value()) {
+            ESP_LOGE(TAG, "reconfiguring %s failed: %s", S::name.data(), reinit.error()->what());
         }
+    });
+    return result;
+}
 
-        auto tmp_try = this->temp.read_temperature();
-        if (tmp_try.has_value()) {
-            tmp = tmp_try.value();
-        } else {
-            ESP_LOGE(TAG, "temp data read failed");
-        } 
-       
-        idx += snprintf(&buffer[idx], 40 + 20 * 14 + 14, "%lld,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g,%g\n",
-            time_ms,
-            imu_data.ax, imu_data.ay, imu_data.az, imu_data.gx, imu_data.gy, imu_data.gz,
-            baro_1_data.baro_temp, baro_1_data.pressure, baro_2_data.baro_temp, baro_2_data.pressure,
-            high_g_data.h_ax, high_g_data.h_ay, high_g_data.h_az, tmp
+void FlightComputer::log_sample(RawSensorSample const& sample, CalibratedScales const& scales) {
+    if (this->log_finalized) {
+        return;
+    }
+
+    if (this->log_format == LogFormat::Raw) {
+        auto dest = reinterpret_cast<uint8_t*>(&buffer[this->buffer_len]);
+
+        // A sensor was reconfigured, so later samples need the new scales to make sense
+        if (scales.scales != this->logged_scales) {
+            this->logged_scales = scales.scales;
+            this->buffer_len += encode_raw_scales(dest, scales.scales);
+            dest = reinterpret_cast<uint8_t*>(&buffer[this->buffer_len]);
+        }
+
+        // Likewise when the pad calibration finishes
+        if (scales.calibration != this->logged_calibration) {
+            this->logged_calibration = scales.calibration;
+            this->buffer_len += encode_raw_calibration(dest, scales.calibration);
+            dest = reinterpret_cast<uint8_t*>(&buffer[this->buffer_len]);
+        }
+
+        this->buffer_len += encode_raw_sample(dest, sample);
+    } else {
+        this->buffer_len += format_csv_row(
+            &buffer[this->buffer_len], CSV_ROW_MAX_LEN, scales.convert(sample)
         );
-        
-        // speed this up!s
-        if ((i % LOOPS_BEFORE_FLUSH) == LOOPS_BEFORE_FLUSH - 1) {
-            ESP_LOGI(TAG, "Flushing");
-            errno = 0;
-            //fwrite((void *)buffer, 1, idx, data_file);
-            if (errno != 0) {
-                ESP_LOGE(TAG, "err: %s", strerror(errno));
-            }
-            errno = 0;
-            fflush(data_file);
-            if (errno != 0) {
-                ESP_LOGE(TAG, "err: %s", strerror(errno));
-            }
-            errno = 0;
-            fsync(fileno(data_file));
-            if (errno != 0) {
-                ESP_LOGE(TAG, "err: %s", strerror(errno));
+    }
+    this->rows_buffered++;
+
+    // The buffer holds LOOPS_BEFORE_FLUSH rows, and the phase may ask for flushes more often
+    if (this->rows_buffered >= std::min<uint32_t>(this->rows_per_flush, LOOPS_BEFORE_FLUSH)) {
+        this->flush();
+    }
+}
+
+void FlightComputer::flush() {
+    if (this->buffer_len == 0) {
+        return;
+    }
+
+    ESP_LOGI(TAG, "Flushing");
+
+    auto append_res = this->log_file.write((uint8_t *)buffer, this->buffer_len);
+    if (!append_res.has_value()) {
+        ESP_LOGE(TAG, "flight computer append error: %s", append_res.error()->what());
+    }
+
+    // Commit the data to the card so it survives losing power
+    auto sync_res = this->log_file.sync();
+    if (!sync_res.has_value()) {
+        ESP_LOGE(TAG, "flight computer sync error: %s", sync_res.error()->what());
+    }
+
+    memset(buffer, 'X', sizeof(buffer));
+    this->buffer_len = 0;
+    this->rows_buffered = 0;
+}
+
+void FlightComputer::finalize_log() {
+    if (this->log_finalized) {
+        return;
+    }
+
+    this->flush();
+    auto close_res = this->log_file.close();
+    if (!close_res.has_value()) {
+        ESP_LOGE(TAG, "closing the log failed: %s", close_res.error()->what());
+    }
+
+    this->log_finalized = true;
+    ESP_LOGI(TAG, "log finalized");
+}
+
+void FlightComputer::step() {
+    auto const start_us = esp_timer_get_time();
+    this->apply_sensor_policy();
+    auto const sample = this->read_sensors_raw();
+    this->supervise_sensors(sample, start_us);
+    this->handle_sample(sample, this->scales());
+}
+
+void FlightComputer::process(uint32_t times, bool endless) {
+    memory::arm();
+
+    for (uint32_t i = 0; i < times || endless; i++) {
+        this->step();
+    }
+
+    // Don't lose the rows since the last flush when we stop on our own.
+    this->flush();
+
+    memory::disarm();
+}
+
+// Everything the flight tasks need is allocated here, so starting them can't fail for lack of
+// memory and nothing is allocated while they run.
+StaticTask_t acquisition_tcb;
+StaticTask_t storage_tcb;
+StackType_t acquisition_stack[CONFIG_SEDS_ACQUISITION_STACK_SIZE];
+StackType_t storage_stack[CONFIG_SEDS_STORAGE_STACK_SIZE];
+
+/// A sample with the scales it was read under. The acquisition task may reconfigure the sensors
+/// at any time, so the storage task can't ask the drivers.
+struct AcquiredSample {
+    RawSensorSample sample;
+    SensorScales scales;
+};
+
+SpscRing<AcquiredSample, CONFIG_SEDS_SAMPLE_QUEUE_LENGTH> sample_ring;
+
+
+/// How long the tasks block before checking whether they've been stopped.
+constexpr TickType_t STOP_POLL_TICKS = pdMS_TO_TICKS(100);
+
+FlightPhase FlightComputer::phase() {
+    return load(this->current_phase);
+}
+
+void FlightComputer::handle_sample(RawSensorSample const& sample, SensorScales const& scales) {
+    // Calibrate for as long as the rocket is on the pad, so it's calibrated as it was last set up
+    if (this->phases.phase() == FlightPhase::Pad && this->calibrator.update(sample, scales)) {
+        auto const& calibration = *this->calibrator.calibration();
+        ESP_LOGI(TAG, "pad calibration: accel gain %.4f, gyro bias %.3f %.3f %.3f dps, "
+            "high g offset %.3f %.3f %.3f g", calibration.imu[0].gain, -calibration.imu[3].offset,
+            -calibration.imu[4].offset, -calibration.imu[5].offset, calibration.high_g[0].offset,
+            calibration.high_g[1].offset, calibration.high_g[2].offset);
+        this->conversion = CalibratedScales(scales, calibration);
+    } else if (scales != this->conversion.scales) {
+        this->conversion = CalibratedScales(scales, this->conversion.calibration);
+    }
+
+    auto const& vote = this->baro_voter.update(sample, scales, this->estimator.estimate());
+    this->publish_dead_barometers();
+
+    auto const& estimate = this->estimator.update(sample, this->conversion, vote);
+    if (this->phases.update(estimate)) {
+        this->enter_phase(this->phases.phase());
+    }
+
+#if CONFIG_SEDS_TELEMETRY
+    this->send_telemetry(sample);
+#endif
+    this->log_sample(sample, this->conversion);
+}
+
+#if CONFIG_SEDS_TELEMETRY
+void FlightComputer::send_telemetry(RawSensorSample const& sample) {
+    if (!this->telemetry_consumer || !this->downlink.due(sample.time_ms)) {
+        return;
+    }
+
+    // Encode straight into the queue, from the estimate and counters where they are
+    auto* frame = telemetry_ring.claim();
+    if (frame == nullptr) {
+        bump(this->pipeline.telemetry_overruns);
+        return;
+    }
+    this->downlink.encode(frame->data(), this->estimator.estimate(), this->phases.phase(), {
+        .valid = sample.valid,
+        .dead = load(this->dead_sensors),
+        .queue_overruns = load(this->pipeline.queue_overruns),
+        .missed_periods = load(this->pipeline.missed_periods),
+        .max_queue_depth = load(this->pipeline.max_queue_depth),
+    });
+    telemetry_ring.commit();
+}
+
+telemetry::FrameBytes const* FlightComputer::next_telemetry_frame() {
+    return telemetry_ring.front();
+}
+
+void FlightComputer::release_telemetry_frame() {
+    telemetry_ring.release();
+}
+#endif
+
+void FlightComputer::publish_dead_barometers() {
+    uint8_t dead = 0;
+    for (size_t i = 0; i < estimation::BaroVoter::BAROMETERS; i++) {
+        if (this->baro_voter.status(i) == estimation::BaroStatus::Dead) {
+            dead |= i == 0 ? VALID_BARO1 : VALID_BARO2;
+        }
+    }
+
+    auto const before = load(this->dead_sensors);
+    if (dead != before) {
+        for (size_t i = 0; i < estimation::BaroVoter::BAROMETERS; i++) {
+            uint8_t const bit = i == 0 ? VALID_BARO1 : VALID_BARO2;
+            if ((dead ^ before) & bit) {
+                ESP_LOGW(TAG, "baro %d is %s", static_cast<int>(i + 1),
+                    dead & bit ? "dead, reading it once a second from now on" : "back");
             }
-            
-            auto append_res = sd.append_file(FlightComputer::filename, (uint8_t *)buffer, idx);
-            if (!append_res.has_value()) {
-                ESP_LOGE(TAG, "flight computer append error: %s", append_res.error()->what());
+        }
+        store(this->dead_sensors, dead);
+    }
+}
+
+void FlightComputer::enter_phase(FlightPhase phase) {
+    auto const& policy = policy_for(phase);
+    auto const& estimate = this->estimator.estimate();
+    ESP_LOGI(TAG, "%s at %" PRId64 " ms, %.1f m, %.1f m/s", to_string(phase), estimate.time_ms,
+        estimate.altitude, estimate.velocity);
+
+    // The sensor side picks this up before its next read
+    store(this->current_phase, phase);
+    this->rows_per_flush = policy.rows_per_flush;
+    if (this->sample_timer != nullptr) {
+        esp_timer_restart(this->sample_timer, policy.sample_period_us);
+    }
+
+    if (phase == FlightPhase::Landed) {
+        this->finalize_log();
+    }
+}
+
+void FlightComputer::apply_sensor_policy() {
+    auto const phase = load(this->current_phase);
+    if (this->sensor_phase == phase) {
+        return;
+    }
+    this->sensor_phase = phase;
+
+#if CONFIG_SEDS_PHASE_POLICY
+    // The new data rate reaches the log through the scales, which record it
+    auto hz_res = this->imu.set_sensor_hz(policy_for(phase).imu_hz);
+    if (!hz_res.has_value()) {
+        ESP_LOGE(TAG, "setting the IMU data rate failed: %s", hz_res.error()->what());
+    }
+#endif
+}
+
+Expected<std::monostate> FlightComputer::start() {
+    if (this->acquisition_task != nullptr) {
+        return std::unexpected(std::make_unique<Error>("flight tasks already started"));
+    }
+
+    this->pipeline = {};
+    sample_ring.clear();
+#if CONFIG_SEDS_TELEMETRY
+    telemetry_ring.clear();
+#endif
+
+    // The timer only wakes the acquisition task, which does the actual reading. esp_timer fires
+    // between FreeRTOS ticks, so the period can be shorter than a tick. It's created before the
+    // tasks so that failing to create it leaves nothing running.
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* computer) {
+            xTaskNotifyGive(static_cast<FlightComputer*>(computer)->acquisition_task);
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "sample",
+        .skip_unhandled_events = false,
+    };
+    ESP_TRY(esp_timer_create(&timer_args, &this->sample_timer));
+
+    store(this->running, true);
+    store(this->acquiring, true);
+    store(this->storing, true);
+
+    this->storage_task = xTaskCreateStaticPinnedToCore(
+        [](void* computer) { static_cast<FlightComputer*>(computer)->storage_loop(); },
+        "storage",
+        CONFIG_SEDS_STORAGE_STACK_SIZE,
+        this,
+        CONFIG_SEDS_STORAGE_PRIORITY,
+        storage_stack,
+        &storage_tcb,
+        CONFIG_SEDS_STORAGE_CORE
+    );
+    this->acquisition_task = xTaskCreateStaticPinnedToCore(
+        [](void* computer) { static_cast<FlightComputer*>(computer)->acquisition_loop(); },
+        "acquisition",
+        CONFIG_SEDS_ACQUISITION_STACK_SIZE,
+        this,
+        CONFIG_SEDS_ACQUISITION_PRIORITY,
+        acquisition_stack,
+        &acquisition_tcb,
+        CONFIG_SEDS_ACQUISITION_CORE
+    );
+
+    // The timer only reads the task's handle once started
+    auto const started = esp_timer_start_periodic(this->sample_timer,
+        policy_for(this->phase()).sample_period_us);
+    if (started != ESP_OK) {
+        // Without the timer the tasks would wait forever; stop them and free the timer
+        this->stop();
+        return std::unexpected(std::make_unique<errors::EspError>(started));
+    }
+
+    ESP_LOGI(TAG, "flight tasks started");
+
+    return std::monostate {};
+}
+
+void FlightComputer::stop() {
+    if (this->acquisition_task == nullptr) {
+        return;
+    }
+
+    // Acquisition stops first, and the storage task drains everything it queued before stopping
+    store(this->running, false);
+    while (load(this->storing)) {
+        vTaskDelay(1);
+    }
+
+    esp_timer_stop(this->sample_timer);
+    esp_timer_delete(this->sample_timer);
+    this->sample_timer = nullptr;
+    this->acquisition_task = nullptr;
+    this->storage_task = nullptr;
+
+    this->flush();
+    ESP_LOGI(TAG, "flight tasks stopped");
+}
+
+PipelineStats FlightComputer::stats() {
+    return PipelineStats {
+        .samples_read = load(this->pipeline.samples_read),
+        .missed_periods = load(this->pipeline.missed_periods),
+        .queue_overruns = load(this->pipeline.queue_overruns),
+        .max_queue_depth = load(this->pipeline.max_queue_depth),
+#if CONFIG_SEDS_TELEMETRY
+        .telemetry_overruns = load(this->pipeline.telemetry_overruns),
+#endif
+    };
+}
+
+void FlightComputer::acquisition_loop() {
+    // Everything the loop needs was allocated before the task started
+    memory::arm();
+
+    while (load(this->running)) {
+        // Each timer period leaves a notification. More than one means periods went by while
+        // the last read ran long.
+        uint32_t periods = ulTaskNotifyTake(pdTRUE, STOP_POLL_TICKS);
+        if (periods == 0) {
+            continue;
+        }
+        if (periods > 1) {
+            bump(this->pipeline.missed_periods, periods - 1);
+        }
+
+        auto const start_us = esp_timer_get_time();
+        this->apply_sensor_policy();
+
+        // Read straight into the ring. Never wait for the storage task: a late sample is worse
+        // than a dropped one.
+        AcquiredSample* slot = sample_ring.claim();
+        if (slot == nullptr) {
+            bump(this->pipeline.queue_overruns);
+            continue;
+        }
+
+        slot->sample = this->read_sensors_raw();
+        slot->scales = this->scales();
+        // The slot belongs to the storage task once committed
+        auto const sample = slot->sample;
+        sample_ring.commit();
+        bump(this->pipeline.samples_read);
+
+        xTaskNotifyGive(this->storage_task);
+
+        // Fixing a sensor that reset can wait until the sample is on its way
+        this->supervise_sensors(sample, start_us);
+    }
+
+    memory::disarm();
+    store(this->acquiring, false);
+    vTaskDelete(nullptr);
+}
+
+void FlightComputer::storage_loop() {
+    // Flushes go through the log file opened in init
+    memory::arm();
+
+    while (true) {
+        // Check before looking at the ring so that, once acquisition has stopped, an empty ring
+        // means everything has been logged
+        bool const acquisition_stopped = !load(this->acquiring);
+
+        auto const samples = sample_ring.readable();
+        if (samples.empty()) {
+            if (acquisition_stopped) {
+                break;
             }
 
-            memset(buffer, 'X', sizeof(buffer));
-            idx = 0;
+            // Acquisition notifies after every sample
+            ulTaskNotifyTake(pdTRUE, STOP_POLL_TICKS);
+            continue;
+        }
+
+        auto depth = sample_ring.size();
+        if (depth > load(this->pipeline.max_queue_depth)) {
+            std::atomic_ref(this->pipeline.max_queue_depth).store(depth, std::memory_order_relaxed);
         }
 
+        // Handle samples in place, freeing each slot as soon as it's done in case a flush stalls
+        for (auto const& acquired : samples) {
+            this->handle_sample(acquired.sample, acquired.scales);
+            sample_ring.release();
+        }
     }
-    // fixme: with finite loops we could lose data at the end
-    // this will happen with infinite loops too, but there its kind of unavoidable
 
-    fclose(data_file);
+    memory::disarm();
+    store(this->storing, false);
+    vTaskDelete(nullptr);
 }
 
-}
\ No newline at end of file
+}
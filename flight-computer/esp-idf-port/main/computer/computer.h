@@ -1,10 +1,20 @@
 #pragma once
 
 #include <expected>
+#include <optional>
 
 #include "esp_err.h"
 #include "errors.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "computer/flight_phase.h"
+#include "computer/log_format.h"
+#include "computer/sensor_health.h"
+#include "estimation/altitude_filter.h"
+#include "estimation/baro_voter.h"
+#include "estimation/pad_calibration.h"
 #include "i2c/BMI323.h"
 #include "i2c/BMP581.h"
 #include "i2c/high_g_accel.h"
@@ -13,11 +23,31 @@
 #include "i2c/segment7.h"
 #include "i2c/TMP1075.h"
 #include "sd.h"
+#include "sdkconfig.h"
+#if CONFIG_SEDS_TELEMETRY
+#include "telemetry/downlink.h"
+#endif
 #include "utils.h"
 
 namespace seds {
     using namespace seds::errors;
 
+    /// How well the flight tasks are keeping up.
+    struct PipelineStats {
+        /// Samples read by the acquisition task.
+        uint32_t samples_read = 0;
+        /// Sampling periods skipped because the read before them ran long.
+        uint32_t missed_periods = 0;
+        /// Samples dropped because the ring to the storage task was full.
+        uint32_t queue_overruns = 0;
+        /// Most samples ever waiting in the ring.
+        uint32_t max_queue_depth = 0;
+#if CONFIG_SEDS_TELEMETRY
+        /// Telemetry frames dropped because the radio hadn't taken the ones before them.
+        uint32_t telemetry_overruns = 0;
+#endif
+    };
+
     class FlightComputer {
     private:
         static constexpr size_t buf_len = MOUNT_POINT_LEN + 1 + 3 + 4 + 4 + 1;
@@ -32,9 +62,166 @@ namespace seds {
         SDCard sd;
         // mount point, slash, 3 numbers, 'data', '.csv'
         char filename[FlightComputer::buf_len] = MOUNT_POINT"/data.csv"; 
+        /// Set before calling init. Raw logs are written to `.bin` files instead of `.csv`.
+        LogFormat log_format = LogFormat::Csv;
+        // Bytes and rows waiting in the log buffer. These are public only so that the computer can
+        // still be built with designated initializers; leave them alone.
+        size_t buffer_len = 0;
+        uint32_t rows_buffered = 0;
+        SensorScales logged_scales = {};
+        SensorCalibration logged_calibration = {};
+        AppendFile log_file = {};
+        /// Cross-checks the barometers and votes the pressure the estimator uses.
+        estimation::BaroVoter baro_voter = {};
+        /// Altitude and velocity from every sample that goes through the flight loop.
+        estimation::AltitudeFilter estimator = {};
+        /// Calibrates the accelerometers and gyro while the rocket sits on the pad.
+        estimation::PadCalibrator calibrator = {};
+        /// The scales of the latest sample with the latest calibration folded in, which is how
+        /// the estimator and CSV logs convert samples. Only folded again when either changes.
+        CalibratedScales conversion = {};
+        /// Flight phase, worked out from the estimate.
+        PhaseTracker phases = {};
+#if CONFIG_SEDS_TELEMETRY
+        /// Picks what goes down the telemetry radio and encodes it, sample by sample. Set before
+        /// calling start to change the budget or rates from CONFIG_SEDS_TELEMETRY_BUDGET's.
+        telemetry::Downlink downlink = {};
+        /// Whether a task takes the frames from `next_telemetry_frame` to send them. Until one
+        /// does, no frames are encoded: with nothing draining the queue it would fill in a
+        /// second and count every frame after as an overrun. The board has no radio driver yet,
+        /// so only the host's software-in-the-loop harness sets this. Set before calling start.
+        bool telemetry_consumer = false;
+#endif
+        // The phase whose policy is in effect, and the phase the sensors were last configured
+        // for. The task handling samples changes the first; the task reading the sensors catches
+        // the second up. Public only for designated initializers; use phase() instead.
+        FlightPhase current_phase = FlightPhase::Pad;
+        std::optional<FlightPhase> sensor_phase = {};
+        uint32_t rows_per_flush = CONFIG_SEDS_LOG_BUFFER_ROWS;
+        bool log_finalized = false;
+        // Sensors given up on as dead (VALID_* bits; so far only the voter's barometers), set by
+        // the task handling samples, and when the task reading them should next try each one.
+        uint8_t dead_sensors = 0;
+        int64_t next_retry_ms[SENSOR_COUNT] = {};
+        /// Probes the sensors and reconfigures any that reset. Only the task reading the sensors
+        /// uses it, so only look at it while the flight tasks are stopped.
+        SensorSupervisor supervisor = {};
+        // State shared with the flight tasks. Public for the same reason; use start, stop and
+        // stats instead.
+        TaskHandle_t acquisition_task = nullptr;
+        TaskHandle_t storage_task = nullptr;
+        esp_timer_handle_t sample_timer = nullptr;
+        bool running = false;
+        bool acquiring = false;
+        bool storing = false;
+        PipelineStats pipeline = {};
 
         Expected<std::monostate> init(void);
- 
+
+        /// Run `times` iterations of the flight loop (or run forever if `endless` is set), then
+        /// flush whatever is still buffered. Heap allocation is forbidden on the calling task
+        /// while this runs (see memory.h).
         void process(uint32_t times, bool endless);
+
+        /// Run one iteration of the flight loop: read every sensor, update the estimate and flight
+        /// phase, and log the sample.
+        void step();
+
+        /// Start the flight loop in the background, split across both cores. An acquisition task
+        /// reads every sensor each CONFIG_SEDS_SAMPLE_PERIOD_US straight into a lock-free ring
+        /// (see spsc_ring.h), and a storage task updates the estimate and logs them from there,
+        /// so SD card stalls never delay sampling. Cores, priorities and stack sizes are set under
+        /// "Flight tasks" in menuconfig.
+        ///
+        /// Call init first. Only one computer can run at a time, and it must not be moved while
+        /// it runs. Heap allocation is forbidden on the two tasks until they stop (see memory.h).
+        [[nodiscard]]
+        Expected<std::monostate> start();
+
+        /// Stop the flight tasks, log every sample they had queued and flush the log.
+        void stop();
+
+        /// Counters from the flight tasks. Safe to call while they run.
+        PipelineStats stats();
+
+        /// Read every sensor once, converted to engineering units. Fields of sensors that failed
+        /// to read are left as zero.
+        SensorSample read_sensors();
+
+        /// Read every sensor once as raw counts. Use `scales()` to convert them. Sensors marked
+        /// dead are skipped, apart from a retry now and then.
+        RawSensorSample read_sensors_raw();
+
+        /// How to convert the counts from `read_sensors_raw` under the sensors' current settings.
+        SensorScales scales() const;
+
+        /// Feed a sample to the pad calibration (on the pad), barometer voter, estimator and phase
+        /// tracker, then log it. `scales` are the ones the sample was read under.
+        void handle_sample(RawSensorSample const& sample, SensorScales const& scales);
+
+        /// The current flight phase. Safe to call while the flight tasks run.
+        [[nodiscard]]
+        FlightPhase phase();
+
+#if CONFIG_SEDS_TELEMETRY
+        /// The oldest telemetry frame waiting for the radio, or nullptr if there are none. Call
+        /// from the one task that feeds the radio, and `release_telemetry_frame` once it's
+        /// sent. The frame stays where the storage task encoded it until then.
+        telemetry::FrameBytes const* next_telemetry_frame();
+
+        void release_telemetry_frame();
+#endif
+
+        /// The latest altitude and velocity estimate. Once the flight tasks are running, only call
+        /// this from the storage task, which is the one updating it.
+        [[nodiscard]]
+        estimation::Estimate const& estimate() const {
+            return this->estimator.estimate();
+        }
+
+        /// Append a sample to the log buffer in `log_format`, writing the buffer out every
+        /// `rows_per_flush` rows. CSV logs convert and calibrate the counts here; raw logs store
+        /// them as they are, with the scales and calibration whenever those change. Does nothing
+        /// once the log is finalized.
+        void log_sample(RawSensorSample const& sample, CalibratedScales const& scales);
+
+        /// Write any buffered rows to the SD card.
+        void flush();
+
+        /// Write out everything buffered and close the log, so landing or a power cut afterwards
+        /// can't damage it. Nothing more is logged. Happens by itself on landing.
+        void finalize_log();
+
+    private:
+#if CONFIG_SEDS_TELEMETRY
+        /// Encode a telemetry frame into the radio's queue if one is due with `sample`, which
+        /// has just updated the estimate, and something takes the frames (`telemetry_consumer`).
+        void send_telemetry(RawSensorSample const& sample);
+#endif
+
+        /// Switch to the policy for `phase` (see flight_phase.h).
+        void enter_phase(FlightPhase phase);
+
+        /// Configure the sensors for the current phase if they aren't already. Only call this
+        /// from the task that reads the sensors.
+        void apply_sensor_policy();
+
+        /// Whether to read the sensor in FlightSensors slot `index` this time. Dead ones are only
+        /// read once in a while.
+        bool should_read(size_t index, int64_t now_ms);
+
+        /// Tell the task reading the sensors which barometers the voter thinks are dead.
+        void publish_dead_barometers();
+
+        /// Let the supervisor look at a fresh sample and probe a sensor if it wants to. Routine
+        /// probes only happen if the sampling period that started at `period_start_us` has
+        /// time left for them.
+        void supervise_sensors(RawSensorSample const& sample, int64_t period_start_us);
+
+        /// Probe one sensor and reconfigure it if it reset. Empty if it didn't answer.
+        std::optional<ProbeResult> probe_sensor(SensorId sensor);
+
+        void acquisition_loop();
+        void storage_loop();
     };
 }
\ No newline at end of file
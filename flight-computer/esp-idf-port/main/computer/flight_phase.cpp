@@ -0,0 +1,115 @@
+#include "flight_phase.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace seds {
+
+namespace {
+    constexpr uint32_t ALL_ROWS = CONFIG_SEDS_LOG_BUFFER_ROWS;
+
+    /// A flush at least every `rows`, if the buffer holds that many.
+    constexpr uint32_t at_most(uint32_t rows) {
+        return std::min(rows, ALL_ROWS);
+    }
+
+#if CONFIG_SEDS_PHASE_POLICY
+    using Hz = BMI323::SensorHz;
+
+    constexpr std::array<PhasePolicy, FLIGHT_PHASE_COUNT> POLICIES {{
+        // Pad: 10 Hz, and flush every few seconds since we may sit here for an hour
+        { .imu_hz = Hz::_25, .sample_period_us = 100'000, .rows_per_flush = at_most(50) },
+        // Boost: 500 Hz, flushing as rarely as possible. One round of I2C reads holds the bus
+        // for about 1.6 ms at 400 kHz, which BM_FlightComputer_Step_PhasePeriod checks fits
+        { .imu_hz = Hz::_1600, .sample_period_us = 2'000, .rows_per_flush = ALL_ROWS },
+        { .imu_hz = Hz::_800, .sample_period_us = 5'000, .rows_per_flush = ALL_ROWS },
+        { .imu_hz = Hz::_800, .sample_period_us = 5'000, .rows_per_flush = ALL_ROWS },
+        { .imu_hz = Hz::_200, .sample_period_us = 10'000, .rows_per_flush = ALL_ROWS },
+        { .imu_hz = Hz::_100, .sample_period_us = 20'000, .rows_per_flush = at_most(50) },
+        // Landed: the log is finalized on entry, so this only keeps the sensors ticking over
+        { .imu_hz = Hz::_25, .sample_period_us = 1'000'000, .rows_per_flush = 1 },
+    }};
+#else
+    constexpr PhasePolicy FIXED_POLICY = {
+        .imu_hz = BMI323::SensorHz::_100,
+        .sample_period_us = CONFIG_SEDS_SAMPLE_PERIOD_US,
+        .rows_per_flush = ALL_ROWS,
+    };
+#endif
+}
+
+PhasePolicy const& policy_for(FlightPhase phase) {
+#if CONFIG_SEDS_PHASE_POLICY
+    return POLICIES[static_cast<size_t>(phase)];
+#else
+    return FIXED_POLICY;
+#endif
+}
+
+PhaseTracker::PhaseTracker(PhaseConfig const& config) : config(config) {}
+
+bool PhaseTracker::Debounce::update(bool condition, int64_t now_ms, uint32_t hold_ms) {
+    if (!condition) {
+        this->since_ms = -1;
+        return false;
+    }
+    if (this->since_ms < 0) {
+        this->since_ms = now_ms;
+    }
+    return now_ms - this->since_ms >= hold_ms;
+}
+
+void PhaseTracker::enter(FlightPhase phase) {
+    this->current = phase;
+    this->primary.reset();
+    this->backup.reset();
+}
+
+bool PhaseTracker::update(estimation::Estimate const& estimate) {
+    auto const& config = this->config;
+    auto const now = estimate.time_ms;
+    auto const before = this->current;
+    this->highest = std::max(this->highest, estimate.altitude);
+    auto const below_highest = this->highest - estimate.altitude;
+
+    switch (this->current) {
+        case FlightPhase::Pad:
+            if (this->primary.update(estimate.acceleration > config.launch_accel, now, config.launch_hold_ms)
+                || this->backup.update(estimate.altitude > config.launch_altitude, now, config.launch_hold_ms)) {
+                this->enter(FlightPhase::Boost);
+            }
+            break;
+        case FlightPhase::Boost:
+            if (this->primary.update(estimate.acceleration < config.burnout_accel, now, config.burnout_hold_ms)) {
+                this->enter(FlightPhase::Coast);
+            }
+            break;
+        case FlightPhase::Coast:
+            if (this->primary.update(estimate.velocity < config.apogee_velocity, now, config.apogee_hold_ms)
+                || this->backup.update(below_highest > config.apogee_drop, now, config.apogee_hold_ms)) {
+                this->enter(FlightPhase::Apogee);
+            }
+            break;
+        case FlightPhase::Apogee:
+            if (this->primary.update(below_highest > config.apogee_drop, now, config.descent_hold_ms)) {
+                this->enter(FlightPhase::DrogueDescent);
+            }
+            break;
+        case FlightPhase::DrogueDescent:
+            if (this->primary.update(estimate.altitude < config.main_altitude, now, config.main_hold_ms)) {
+                this->enter(FlightPhase::MainDescent);
+            }
+            break;
+        case FlightPhase::MainDescent:
+            if (this->primary.update(std::abs(estimate.velocity) < config.landed_speed, now, config.landed_hold_ms)) {
+                this->enter(FlightPhase::Landed);
+            }
+            break;
+        case FlightPhase::Landed:
+            break;
+    }
+
+    return this->current != before;
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "computer/phase.h"
+#include "estimation/altitude_filter.h"
+#include "i2c/BMI323.h"
+#include "sdkconfig.h"
+
+namespace seds {
+    /// How the flight computer runs during a phase.
+    struct PhasePolicy {
+        /// Output data rate of the BMI323. Above the sampling rate, so every read gets a fresh
+        /// value.
+        BMI323::SensorHz imu_hz;
+        /// How often the acquisition task reads every sensor.
+        uint32_t sample_period_us;
+        /// Rows buffered before each SD card write. Fewer means less lost to a power cut.
+        uint32_t rows_per_flush;
+    };
+
+    /// The policy for each phase: slow on the pad and after landing, as fast as the I2C bus
+    /// allows while the motor burns, and fast again around apogee when the recovery events fire.
+    /// With CONFIG_SEDS_PHASE_POLICY off, every phase samples at CONFIG_SEDS_SAMPLE_PERIOD_US and
+    /// the IMU keeps its startup rate.
+    PhasePolicy const& policy_for(FlightPhase phase);
+
+    /// Thresholds for PhaseTracker. Each condition has to hold for its `_hold_ms` before the
+    /// phase changes, so a single noisy sample can't move the phase.
+    struct PhaseConfig {
+        /// Launch: upward acceleration (m/s²), or altitude (m) as a backup in case the
+        /// accelerometers are out.
+        float launch_accel = 3.0f * estimation::GRAVITY;
+        float launch_altitude = 50.0f;
+        uint32_t launch_hold_ms = 50;
+        /// Burnout: acceleration below this (m/s²). Drag and gravity make it clearly negative.
+        float burnout_accel = 0.0f;
+        uint32_t burnout_hold_ms = 50;
+        /// Apogee: vertical velocity below this (m/s), or altitude this far below the highest
+        /// seen (m) as a backup.
+        float apogee_velocity = 0.0f;
+        float apogee_drop = 5.0f;
+        uint32_t apogee_hold_ms = 100;
+        /// Under drogue once the altitude has been `apogee_drop` below the highest seen for this
+        /// long.
+        uint32_t descent_hold_ms = 100;
+        /// Main parachute altitude above the pad (m).
+        float main_altitude = CONFIG_SEDS_MAIN_DEPLOY_ALTITUDE_M;
+        uint32_t main_hold_ms = 200;
+        /// Landed: vertical speed below this (m/s).
+        float landed_speed = 1.0f;
+        uint32_t landed_hold_ms = 5000;
+    };
+
+    /// Works out the flight phase from the altitude filter's output.
+    class PhaseTracker {
+    public:
+        PhaseTracker() : PhaseTracker(PhaseConfig {}) {}
+        explicit PhaseTracker(PhaseConfig const& config);
+
+        [[nodiscard]]
+        FlightPhase phase() const {
+            return this->current;
+        }
+
+        /// Highest altitude seen so far, m.
+        [[nodiscard]]
+        float max_altitude() const {
+            return this->highest;
+        }
+
+        /// Advance on a new estimate. Returns true if the phase changed.
+        bool update(estimation::Estimate const& estimate);
+
+    private:
+        /// A condition that counts once it has held continuously for a while.
+        class Debounce {
+        public:
+            /// Returns true once `condition` has been true for `hold_ms`.
+            bool update(bool condition, int64_t now_ms, uint32_t hold_ms);
+            void reset() {
+                this->since_ms = -1;
+            }
+
+        private:
+            int64_t since_ms = -1;
+        };
+
+        void enter(FlightPhase phase);
+
+        PhaseConfig config;
+        FlightPhase current = FlightPhase::Pad;
+        float highest = 0;
+        Debounce primary;
+        Debounce backup;
+    };
+}
@@ -0,0 +1,233 @@
+#include "log_format.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "computer/sensors.h"
+#include "utils.h"
+
+namespace seds {
+
+CalibratedScales::CalibratedScales(SensorScales const& scales, SensorCalibration const& calibration)
+    : scales(scales), calibration(calibration)
+{
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        if constexpr (S::calibrated) {
+            auto const per_count = S::DriverType::per_count(scales.*S::scale);
+            auto const& corrections = calibration.*S::calibration;
+            auto& coefficients = this->coefficients.*S::calibration;
+            for (size_t i = 0; i < per_count.size(); i++) {
+                coefficients[i] = AxisCorrection {
+                    .gain = per_count[i] * corrections[i].gain,
+                    .offset = corrections[i].offset,
+                };
+            }
+        }
+    });
+}
+
+SensorSample CalibratedScales::convert(RawSensorSample const& raw) const {
+    SensorSample sample;
+    sample.time_ms = raw.time_ms;
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        if constexpr (S::calibrated) {
+            auto const counts = S::DriverType::counts(raw.*S::raw);
+            auto const& coefficients = this->coefficients.*S::calibration;
+            std::array<float, S::fields.size()> values;
+            for (size_t i = 0; i < values.size(); i++) {
+                // A single multiply-add on an FPU that has one (madd.s on the ESP32)
+                values[i] = static_cast<float>(counts[i]) * coefficients[i].gain
+                    + coefficients[i].offset;
+            }
+            sample.*S::data = S::DriverType::from_values(values);
+        } else {
+            sample.*S::data = (this->scales.*S::scale).convert(raw.*S::raw);
+        }
+    });
+    return sample;
+}
+
+size_t format_csv_row(char* dest, size_t len, SensorSample const& sample) {
+    std::array<float, FlightSensors::column_count> values;
+    size_t column = 0;
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        for (float value : S::DriverType::values(sample.*S::data)) {
+            values[column++] = value;
+        }
+    });
+
+    // One snprintf for the whole row, with the format worked out at compile time
+    int written = [&]<size_t... I>(std::index_sequence<I...>) {
+        return snprintf(dest, len, FlightSensors::csv_format.data(), (long long)sample.time_ms,
+            static_cast<double>(values[I])...);
+    }(std::make_index_sequence<FlightSensors::column_count> {});
+
+    // snprintf reports how long the row would have been, so clamp to what actually fit
+    return std::min(static_cast<size_t>(std::max(written, 0)), len - 1);
+}
+
+SensorSample sample_from_csv(std::span<double const> values) {
+    SensorSample sample {};
+    sample.time_ms = static_cast<int64_t>(values[0]);
+
+    size_t column = 1;
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        std::array<float, S::fields.size()> fields;
+        for (auto& field : fields) {
+            field = static_cast<float>(values[column++]);
+        }
+        sample.*S::data = S::DriverType::from_values(fields);
+    });
+    return sample;
+}
+
+/// Appends little-endian values to a byte buffer.
+class LeWriter {
+public:
+    explicit LeWriter(uint8_t* dest) : dest(dest), start(dest) {}
+
+    template<typename T>
+    void put(T value) {
+        auto bytes = num::to_le_bytes(value);
+        memcpy(this->dest, bytes.data(), bytes.size());
+        this->dest += bytes.size();
+    }
+
+    /// Writes the low `Len` bytes of `value`.
+    template<size_t Len>
+    void put_low(int32_t value) {
+        auto bytes = num::to_le_bytes(value);
+        memcpy(this->dest, bytes.data(), Len);
+        this->dest += Len;
+    }
+
+    size_t written() const {
+        return this->dest - this->start;
+    }
+
+private:
+    uint8_t* dest;
+    uint8_t* start;
+};
+
+/// Reads little-endian values out of a byte buffer.
+class LeReader {
+public:
+    explicit LeReader(uint8_t const* src) : src(src) {}
+
+    template<typename T>
+    T get() {
+        std::array<uint8_t, sizeof(T)> bytes;
+        memcpy(bytes.data(), this->src, bytes.size());
+        this->src += bytes.size();
+        return num::from_le_bytes<T>(bytes);
+    }
+
+    /// Reads a `Len`-byte value, sign extending it if `Signed` is set.
+    template<size_t Len, bool Signed>
+    int32_t get_low() {
+        std::array<uint8_t, 4> bytes = {};
+        memcpy(bytes.data(), this->src, Len);
+        this->src += Len;
+        constexpr auto shift = 32 - 8 * Len;
+        auto const value = num::from_le_bytes<int32_t>(bytes);
+        return Signed ? (value << shift) >> shift : value;
+    }
+
+private:
+    uint8_t const* src;
+};
+
+size_t encode_raw_scales(uint8_t* dest, SensorScales const& scales) {
+    LeWriter out(dest);
+    out.put(static_cast<uint8_t>(RawRecordType::Scales));
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        using Driver = S::DriverType;
+        for (float value : Driver::per_count(scales.*S::scale)) {
+            out.put(value);
+        }
+        for (float value : Driver::config(scales.*S::scale)) {
+            out.put(value);
+        }
+    });
+    return out.written();
+}
+
+size_t encode_raw_calibration(uint8_t* dest, SensorCalibration const& calibration) {
+    LeWriter out(dest);
+    out.put(static_cast<uint8_t>(RawRecordType::Calibration));
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        if constexpr (S::calibrated) {
+            for (auto const& correction : calibration.*S::calibration) {
+                out.put(correction.gain);
+                out.put(correction.offset);
+            }
+        }
+    });
+    return out.written();
+}
+
+size_t encode_raw_sample(uint8_t* dest, RawSensorSample const& sample) {
+    LeWriter out(dest);
+    out.put(static_cast<uint8_t>(RawRecordType::Sample));
+    // Wraps after 49 days, which is longer than the battery lasts
+    out.put(static_cast<uint32_t>(sample.time_ms));
+    out.put(sample.valid);
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        auto const counts = S::DriverType::counts(sample.*S::raw);
+        // Unrolled, so every field is a fixed-size store
+        [&]<size_t... F>(std::index_sequence<F...>) {
+            (out.template put_low<S::fields[F].bytes>(counts[F]), ...);
+        }(std::make_index_sequence<S::fields.size()> {});
+    });
+    return out.written();
+}
+
+SensorScales decode_raw_scales(uint8_t const* src) {
+    LeReader in(src);
+    SensorScales scales;
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        std::array<float, S::fields.size()> per_count;
+        for (auto& value : per_count) {
+            value = in.get<float>();
+        }
+        std::array<float, S::config_fields.size()> config;
+        for (auto& value : config) {
+            value = in.get<float>();
+        }
+        scales.*S::scale = S::DriverType::scale_from(per_count, config);
+    });
+    return scales;
+}
+
+SensorCalibration decode_raw_calibration(uint8_t const* src) {
+    LeReader in(src);
+    SensorCalibration calibration;
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        if constexpr (S::calibrated) {
+            for (auto& correction : calibration.*S::calibration) {
+                correction.gain = in.get<float>();
+                correction.offset = in.get<float>();
+            }
+        }
+    });
+    return calibration;
+}
+
+RawSensorSample decode_raw_sample(uint8_t const* src) {
+    LeReader in(src);
+    RawSensorSample sample;
+    sample.time_ms = in.get<uint32_t>();
+    sample.valid = in.get<uint8_t>();
+    FlightSensors::for_each([&]<typename S, size_t>() {
+        std::array<int32_t, S::fields.size()> counts;
+        [&]<size_t... F>(std::index_sequence<F...>) {
+            ((counts[F] = in.template get_low<S::fields[F].bytes, S::fields[F].is_signed>()), ...);
+        }(std::make_index_sequence<S::fields.size()> {});
+        sample.*S::raw = S::DriverType::from_counts(counts);
+    });
+    return sample;
+}
+
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "i2c/BMI323.h"
+#include "i2c/BMP581.h"
+#include "i2c/high_g_accel.h"
+#include "i2c/TMP1075.h"
+
+namespace seds {
+    /// How FlightComputer writes its log.
+    enum class LogFormat : uint8_t {
+        /// One line of engineering units per sample. Easy to read, but formatting dominates the
+        /// cost of the flight loop.
+        Csv,
+        /// Packed raw counts plus the scales needed to convert them. See "Raw logs" below.
+        Raw,
+    };
+
+    /// One row of sensor readings, as logged by FlightComputer::process.
+    struct SensorSample {
+        int64_t time_ms;
+        IMUData imu;
+        BarometerData baro1;
+        BarometerData baro2;
+        HighGAccelData high_g;
+        float temp;
+    };
+
+    /// Which sensors of a RawSensorSample read successfully.
+    enum SensorValid : uint8_t {
+        VALID_IMU = 1 << 0,
+        VALID_BARO1 = 1 << 1,
+        VALID_BARO2 = 1 << 2,
+        VALID_HIGH_G = 1 << 3,
+        VALID_TEMP = 1 << 4,
+        VALID_ALL = 0x1F,
+    };
+
+    /// One row of sensor readings as the counts the sensors reported. Sensors that failed to read
+    /// are zero and have their bit cleared in `valid`.
+    struct RawSensorSample {
+        int64_t time_ms;
+        IMURaw imu;
+        BarometerRaw baro1;
+        BarometerRaw baro2;
+        HighGAccelRaw high_g;
+        int16_t temp;
+        uint8_t valid;
+    };
+
+    /// Everything needed to turn a RawSensorSample into a SensorSample.
+    struct SensorScales {
+        IMUScale imu;
+        BarometerScale baro;
+        HighGAccelScale high_g;
+        TemperatureScale temp;
+
+        bool operator==(SensorScales const&) const = default;
+
+        SensorSample convert(RawSensorSample const& raw) const {
+            return SensorSample {
+                .time_ms = raw.time_ms,
+                .imu = this->imu.convert(raw.imu),
+                .baro1 = this->baro.convert(raw.baro1),
+                .baro2 = this->baro.convert(raw.baro2),
+                .high_g = this->high_g.convert(raw.high_g),
+                .temp = this->temp.convert(raw.temp),
+            };
+        }
+    };
+
+    /// How one axis is corrected by the on-pad calibration (see estimation/pad_calibration.h),
+    /// in the axis's unit: the corrected value is `value * gain + offset`.
+    struct AxisCorrection {
+        float gain = 1;
+        float offset = 0;
+
+        bool operator==(AxisCorrection const&) const = default;
+    };
+
+    /// Corrections for every calibrated sensor, one per field in the order of its driver's
+    /// `fields`. The default changes nothing.
+    struct SensorCalibration {
+        /// BMI323 accel x y z, gyro x y z.
+        std::array<AxisCorrection, 6> imu;
+        /// ADXL375 x y z, which also brings it into line with the BMI323.
+        std::array<AxisCorrection, 3> high_g;
+
+        bool operator==(SensorCalibration const&) const = default;
+    };
+
+    /// SensorScales with a calibration folded in. Each calibrated axis converts from counts with
+    /// one multiply-add, so calibrating costs an add per axis over the plain scales.
+    /// Fold again whenever either changes.
+    struct CalibratedScales {
+        SensorScales scales;
+        SensorCalibration calibration;
+        /// Counts to corrected value for each calibrated axis: the scale factor times the
+        /// correction's gain, and its offset.
+        SensorCalibration coefficients;
+
+        CalibratedScales() = default;
+        /// Uncalibrated.
+        CalibratedScales(SensorScales const& scales) : CalibratedScales(scales, SensorCalibration {}) {}
+        CalibratedScales(SensorScales const& scales, SensorCalibration const& calibration);
+
+        SensorSample convert(RawSensorSample const& raw) const;
+    };
+
+    // CSV logs
+    //
+    // A header line naming every column with its unit (CSV_HEADER), then one row per sample:
+    // the timestamp and every field of every sensor in FlightSensors order (see sensors.h),
+    // calibrated once the pad calibration has finished.
+
+    /// Formats a sample as one line of the CSV log (including the trailing newline) and returns
+    /// the number of characters written, not counting the null terminator.
+    size_t format_csv_row(char* dest, size_t len, SensorSample const& sample);
+
+    /// Rebuilds a sample from the numbers in a CSV row, timestamp first. `values` must hold every
+    /// column.
+    SensorSample sample_from_csv(std::span<double const> values);
+
+    // Raw logs
+    //
+    // A raw log starts with RAW_LOG_MAGIC and a schema record, and is followed by records, each
+    // starting with a RawRecordType byte. All numbers are little-endian. A scales record and a
+    // calibration record always come before the first sample, and again whenever a sensor is
+    // reconfigured or recalibrated, so every sample can be converted with the most recent ones
+    // before it.
+    //
+    //   schema:      'H', length (u16), then that many bytes of text describing the other records
+    //   scales:      'S', every column's scale factor (f32 each), then every setting of its sensor
+    //                (range, output rate, ...) (f32 each), sensor by sensor in FlightSensors order
+    //   calibration: 'C', gain and offset (f32 each) of every calibrated column, in log order
+    //   sample:      'D', time ms (u32), valid (u8), then the counts of every field of every
+    //                sensor in FlightSensors order, each as wide as its LogField says
+    //
+    // The schema is generated from FlightSensors (see sensors.h), so it always matches the records
+    // that follow, and tools that go by it (host/replay/log_schema.h) read logs written after a
+    // record's layout changes without being changed themselves. It has one tab-separated line per
+    // record and per field of a record:
+    //
+    //   record <type> <bytes after the type byte> <what it holds: scales, calibration or sample>
+    //   field <record type> <offset after the type byte> <type> <name> <unit> <scale> <valid bit>
+    //         <gain> <offset>
+    //
+    // where the type is u8, u16, u24, u32, i8, i16, i24, i32 or f32. A sample's count times the
+    // field named by <scale>, from the latest record holding it, is its value in <unit>. That
+    // times the field named by <gain>, plus the one named by <offset>, is its calibrated value.
+    // It is only valid if bit <valid bit> of the sample's "valid" field is set. Any of these is
+    // "-" for fields it doesn't apply to. Version 2 logs had no calibration, nor the last two
+    // columns.
+    //
+    // Version 1 logs had no schema and a fixed scales record (see host/replay/log_reader.cpp).
+
+    /// First bytes of every raw log. The last byte is the format version.
+    constexpr uint8_t RAW_LOG_MAGIC[8] = {'S', 'E', 'D', 'S', 'R', 'A', 'W', 3};
+
+    enum class RawRecordType : uint8_t {
+        Schema = 'H',
+        Scales = 'S',
+        Calibration = 'C',
+        Sample = 'D',
+    };
+
+    // RAW_LOG_HEADER and the lengths of the other records are worked out from the sensors, in
+    // sensors.h
+
+    /// Encodes a scales record into `dest`, which must hold RAW_SCALES_RECORD_LEN bytes.
+    size_t encode_raw_scales(uint8_t* dest, SensorScales const& scales);
+
+    /// Encodes a calibration record into `dest`, which must hold RAW_CALIBRATION_RECORD_LEN bytes.
+    size_t encode_raw_calibration(uint8_t* dest, SensorCalibration const& calibration);
+
+    /// Encodes a sample record into `dest`, which must hold RAW_SAMPLE_RECORD_LEN bytes.
+    size_t encode_raw_sample(uint8_t* dest, RawSensorSample const& sample);
+
+    /// Decodes the body of a scales record (everything after the type byte).
+    SensorScales decode_raw_scales(uint8_t const* src);
+
+    /// Decodes the body of a calibration record (everything after the type byte).
+    SensorCalibration decode_raw_calibration(uint8_t const* src);
+
+    /// Decodes the body of a sample record (everything after the type byte).
+    RawSensorSample decode_raw_sample(uint8_t const* src);
+}
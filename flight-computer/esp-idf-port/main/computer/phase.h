@@ -0,0 +1,36 @@
+#pragma once
+
+// The flight phases by themselves. The policies and the tracker that moves between them are in
+// flight_phase.h, which needs the drivers; the telemetry format, and the ground station that
+// decodes it, only need to name the phases.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace seds {
+    /// Where we are in the flight. Phases only ever move forward, in this order.
+    enum class FlightPhase : uint8_t {
+        Pad,
+        Boost,
+        Coast,
+        Apogee,
+        DrogueDescent,
+        MainDescent,
+        Landed,
+    };
+
+    constexpr size_t FLIGHT_PHASE_COUNT = static_cast<size_t>(FlightPhase::Landed) + 1;
+
+    constexpr char const* to_string(FlightPhase phase) {
+        switch (phase) {
+            case FlightPhase::Pad: return "pad";
+            case FlightPhase::Boost: return "boost";
+            case FlightPhase::Coast: return "coast";
+            case FlightPhase::Apogee: return "apogee";
+            case FlightPhase::DrogueDescent: return "drogue descent";
+            case FlightPhase::MainDescent: return "main descent";
+            case FlightPhase::Landed: return "landed";
+        }
+        return "unknown";
+    }
+}
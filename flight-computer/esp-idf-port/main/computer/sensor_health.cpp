@@ -0,0 +1,123 @@
+#include "sensor_health.h"
+
+#include <limits>
+
+namespace seds {
+
+char const* to_string(SensorId sensor) {
+    switch (sensor) {
+        case SensorId::Imu: return "imu";
+        case SensorId::Baro1: return "baro 1";
+        case SensorId::Baro2: return "baro 2";
+        case SensorId::HighG: return "high g";
+        case SensorId::Temperature: return "temp";
+    }
+    return "unknown";
+}
+
+namespace {
+    uint64_t pack(int16_t a, int16_t b, int16_t c) {
+        return static_cast<uint16_t>(a)
+            | static_cast<uint64_t>(static_cast<uint16_t>(b)) << 16
+            | static_cast<uint64_t>(static_cast<uint16_t>(c)) << 32;
+    }
+
+    uint64_t pack(BarometerRaw const& raw) {
+        return (static_cast<uint64_t>(raw.temp) & 0xFFFFFF) << 24 | (raw.pressure & 0xFFFFFF);
+    }
+}
+
+SensorSupervisor::SensorSupervisor(SupervisorConfig const& config) : config(config) {}
+
+void SensorSupervisor::check_stuck(Tracked& tracked, uint64_t reading) {
+    if (reading != tracked.last_reading) {
+        tracked.last_reading = reading;
+        tracked.repeats = 0;
+        tracked.still = false;
+        return;
+    }
+
+    if (++tracked.repeats >= this->config.stuck_after && !tracked.still) {
+        tracked.suspect = true;
+    }
+}
+
+void SensorSupervisor::observe(RawSensorSample const& sample) {
+    // Sensors are in the same order as their valid bits
+    for (size_t i = 0; i < SENSOR_COUNT; i++) {
+        if (!(sample.valid & (1 << i))) {
+            this->sensors[i].suspect = true;
+        }
+    }
+
+    auto& imu = this->sensors[static_cast<size_t>(SensorId::Imu)];
+    if (sample.valid & VALID_IMU) {
+        // A disabled BMI323 axis reads -32768
+        constexpr auto disabled = std::numeric_limits<int16_t>::min();
+        if (sample.imu.ax == disabled && sample.imu.ay == disabled && sample.imu.az == disabled) {
+            imu.suspect = true;
+        }
+        this->check_stuck(imu, pack(sample.imu.ax, sample.imu.ay, sample.imu.az));
+    }
+    if (sample.valid & VALID_HIGH_G) {
+        this->check_stuck(this->sensors[static_cast<size_t>(SensorId::HighG)],
+            pack(sample.high_g.x, sample.high_g.y, sample.high_g.z));
+    }
+    if (sample.valid & VALID_BARO1) {
+        this->check_stuck(this->sensors[static_cast<size_t>(SensorId::Baro1)], pack(sample.baro1));
+    }
+    if (sample.valid & VALID_BARO2) {
+        this->check_stuck(this->sensors[static_cast<size_t>(SensorId::Baro2)], pack(sample.baro2));
+    }
+}
+
+std::optional<SensorId> SensorSupervisor::next_probe(int64_t now_ms, bool idle) {
+    // Suspects don't wait for idle time, but one that didn't answer last time waits for its
+    // next routine probe rather than adding to the bus's load while it's backed off
+    for (size_t i = 0; i < SENSOR_COUNT; i++) {
+        auto const& tracked = this->sensors[i];
+        if (tracked.suspect && now_ms >= tracked.next_probe_ms) {
+            return static_cast<SensorId>(i);
+        }
+    }
+
+    if (!idle) {
+        return std::nullopt;
+    }
+
+    for (size_t n = 0; n < SENSOR_COUNT; n++) {
+        auto const i = (this->cursor + n) % SENSOR_COUNT;
+        if (now_ms >= this->sensors[i].next_probe_ms) {
+            this->cursor = (i + 1) % SENSOR_COUNT;
+            return static_cast<SensorId>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+void SensorSupervisor::record(SensorId sensor, int64_t now_ms, std::optional<ProbeResult> result) {
+    auto& tracked = this->sensors[static_cast<size_t>(sensor)];
+    tracked.health.probes++;
+    tracked.next_probe_ms = now_ms + this->config.probe_interval_ms;
+    tracked.suspect = false;
+
+    if (!result.has_value()) {
+        tracked.health.failures++;
+        return;
+    }
+
+    if (*result == ProbeResult::Ok) {
+        // Whatever made it look stuck, the sensor is fine
+        tracked.still = tracked.repeats >= this->config.stuck_after;
+        return;
+    }
+
+    // It has just been reconfigured, so check again on the next sample
+    tracked.health.resets++;
+    tracked.health.last_reset_ms = now_ms;
+    tracked.next_probe_ms = now_ms;
+    tracked.suspect = true;
+    tracked.repeats = 0;
+}
+
+}
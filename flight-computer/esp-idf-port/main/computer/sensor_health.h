@@ -0,0 +1,92 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "computer/log_format.h"
+#include "i2c/I2C.h"
+
+namespace seds {
+    /// The sensors SensorSupervisor looks after, in FlightSensors order (see sensors.h).
+    enum class SensorId : uint8_t {
+        Imu,
+        Baro1,
+        Baro2,
+        HighG,
+        Temperature,
+    };
+
+    constexpr size_t SENSOR_COUNT = static_cast<size_t>(SensorId::Temperature) + 1;
+
+    char const* to_string(SensorId sensor);
+
+    /// Settings for SensorSupervisor.
+    struct SupervisorConfig {
+        /// How often each sensor is probed when nothing looks wrong.
+        uint32_t probe_interval_ms = 100;
+        /// Identical readings in a row after which the IMU, high-g accelerometer or a barometer
+        /// is probed straight away. Noise changes the low bits of almost every live reading.
+        uint32_t stuck_after = 5;
+    };
+
+    /// What the supervisor has found out about one sensor.
+    struct SensorHealth {
+        uint32_t probes = 0;
+        /// Probes that found the sensor reset or faulted, each followed by a `reinit()`.
+        uint32_t resets = 0;
+        /// Probes the sensor didn't answer.
+        uint32_t failures = 0;
+        /// When a probe last found it reset, ms, or -1.
+        int64_t last_reset_ms = -1;
+    };
+
+    /// Decides when to check on each sensor, so one that browns out and comes back in its
+    /// power-on configuration is put back to work within a few samples.
+    ///
+    /// Each sensor is probed every `probe_interval_ms` when the bus has time to spare. A sensor
+    /// that stops producing data, returns the same reading over and over, or reads as disabled
+    /// is probed on the next sample whether or not there's time, since its readings are useless
+    /// until it's fixed. After a reset is found and the sensor reconfigured, it is probed again
+    /// on the next sample to check that took.
+    class SensorSupervisor {
+    public:
+        SensorSupervisor() : SensorSupervisor(SupervisorConfig {}) {}
+        explicit SensorSupervisor(SupervisorConfig const& config);
+
+        /// Look over a fresh sample for sensors that need probing now.
+        void observe(RawSensorSample const& sample);
+
+        /// The sensor to probe now, if any. Only suspects are returned unless `idle`.
+        std::optional<SensorId> next_probe(int64_t now_ms, bool idle);
+
+        /// Record a probe of `sensor`. `result` is empty if it didn't answer.
+        void record(SensorId sensor, int64_t now_ms, std::optional<ProbeResult> result);
+
+        [[nodiscard]]
+        SensorHealth const& health(SensorId sensor) const {
+            return this->sensors[static_cast<size_t>(sensor)].health;
+        }
+
+    private:
+        struct Tracked {
+            SensorHealth health;
+            int64_t next_probe_ms = 0;
+            bool suspect = false;
+            /// The last reading, packed, and how many times in a row it has come back.
+            uint64_t last_reading = 0;
+            uint32_t repeats = 0;
+            /// A probe found the sensor fine despite the repeats, so the world really is that
+            /// still. Don't suspect it again until the reading changes.
+            bool still = false;
+        };
+
+        /// Count a repeat if `reading` is the same as last time.
+        void check_stuck(Tracked& tracked, uint64_t reading);
+
+        SupervisorConfig config;
+        std::array<Tracked, SENSOR_COUNT> sensors;
+        /// Where the round of routine probes is up to.
+        size_t cursor = 0;
+    };
+}
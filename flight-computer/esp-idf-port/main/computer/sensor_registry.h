@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "i2c/sensor.h"
+
+namespace seds {
+    /// A string literal that can be passed as a template argument.
+    template<size_t N>
+    struct FixedString {
+        char chars[N] {};
+
+        constexpr FixedString(char const (&str)[N]) {
+            std::copy_n(str, N, this->chars);
+        }
+
+        constexpr std::string_view view() const {
+            return std::string_view(this->chars, N - 1);
+        }
+    };
+
+    namespace registry_detail {
+        template<typename T>
+        struct MemberOf;
+
+        template<typename Class, typename Member>
+        struct MemberOf<Member Class::*> {
+            using Type = Member;
+        };
+
+        template<auto Pointer>
+        using MemberType = typename MemberOf<decltype(Pointer)>::Type;
+
+        /// Fields the corrections at `Calibration` cover, or 0 for no calibration.
+        template<auto Calibration>
+        constexpr size_t corrections() {
+            if constexpr (std::is_null_pointer_v<decltype(Calibration)>) {
+                return 0;
+            } else {
+                return std::tuple_size_v<MemberType<Calibration>>;
+            }
+        }
+    }
+
+    /// One sensor in a SensorRegistry. `Driver` points at the member of FlightComputer that reads
+    /// it, and `Raw`, `Data` and `Scale` at where its reading and scale go in RawSensorSample,
+    /// SensorSample and SensorScales. `Name` goes in front of its fields' log column names.
+    /// Sensors calibrated on the pad also give `Calibration`, where their corrections go in
+    /// SensorCalibration.
+    template<FixedString Name, auto Driver, auto Raw, auto Data, auto Scale, auto Calibration = nullptr>
+    struct SensorSlot {
+        using DriverType = registry_detail::MemberType<Driver>;
+        static_assert(Sensor<DriverType>);
+        static_assert(std::is_same_v<registry_detail::MemberType<Raw>, typename DriverType::Raw>);
+        static_assert(std::is_same_v<registry_detail::MemberType<Data>, typename DriverType::Data>);
+        static_assert(std::is_same_v<registry_detail::MemberType<Scale>, typename DriverType::Scale>);
+
+        static constexpr std::string_view name = Name.view();
+        static constexpr auto driver = Driver;
+        static constexpr auto raw = Raw;
+        static constexpr auto data = Data;
+        static constexpr auto scale = Scale;
+        static constexpr bool calibrated = !std::is_null_pointer_v<decltype(Calibration)>;
+        static constexpr auto calibration = Calibration;
+        static constexpr auto const& fields = DriverType::fields;
+        static constexpr auto const& config_fields = DriverType::config_fields;
+
+        static_assert(!calibrated || registry_detail::corrections<Calibration>() == fields.size(),
+            "a calibrated sensor needs a correction for every field");
+    };
+
+    /// One column of a log: a field of one sensor.
+    struct LogColumn {
+        std::string_view sensor;
+        /// Where the sensor is in its registry, which is also its bit in RawSensorSample::valid.
+        size_t slot;
+        LogField field;
+        /// Whether the pad calibration corrects it.
+        bool calibrated;
+    };
+
+    /// One setting of one sensor, as recorded in raw logs' scales records.
+    struct ConfigColumn {
+        std::string_view sensor;
+        size_t slot;
+        ConfigField field;
+    };
+
+    namespace registry_detail {
+        /// Hands the CSV header, piece by piece, to `out`.
+        template<size_t N, typename Out>
+        constexpr void csv_header(std::array<LogColumn, N> const& columns, Out&& out) {
+            out("timestamp (ms)");
+            for (auto const& column : columns) {
+                out(", ");
+                out(column.sensor);
+                if (!std::string_view(column.field.name).empty()) {
+                    out(" ");
+                    out(column.field.name);
+                }
+                out(" (");
+                out(column.field.unit);
+                out(")");
+            }
+            out("\n");
+        }
+
+        /// Hands the printf format of a CSV row, piece by piece, to `out`.
+        template<typename Out>
+        constexpr void csv_format(size_t columns, Out&& out) {
+            out("%lld");
+            for (size_t i = 0; i < columns; i++) {
+                out(",%g");
+            }
+            out("\n");
+        }
+
+        /// Hands `value` to `out` in decimal.
+        template<typename Out>
+        constexpr void number(size_t value, Out&& out) {
+            char digits[20] {};
+            size_t start = sizeof(digits);
+            do {
+                digits[--start] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+            out(std::string_view(&digits[start], sizeof(digits) - start));
+        }
+
+        /// Hands the name of a column, with the sensor's name in front, to `out`.
+        template<typename Out>
+        constexpr void column_name(std::string_view sensor, char const* field, Out&& out) {
+            out(sensor);
+            if (!std::string_view(field).empty()) {
+                out(" ");
+                out(field);
+            }
+        }
+
+        /// Hands the schema of a raw log, line by line, to `out`. See "Raw logs" in log_format.h
+        /// for what it means.
+        template<size_t N, size_t C, size_t Slots, typename Out>
+        constexpr void raw_schema(std::array<LogColumn, N> const& columns,
+            std::array<ConfigColumn, C> const& configs, Out&& out)
+        {
+            auto const field = [&](char record, size_t offset, std::string_view type) {
+                out("field\t");
+                out(std::string_view(&record, 1));
+                out("\t");
+                number(offset, out);
+                out("\t");
+                out(type);
+                out("\t");
+            };
+            // Scales: every column's scale factor and every setting, sensor by sensor
+            out("record\tS\t");
+            number(4 * (N + C), out);
+            out("\tscales\n");
+            size_t offset = 0;
+            for (size_t slot = 0; slot < Slots; slot++) {
+                for (auto const& column : columns) {
+                    if (column.slot != slot) {
+                        continue;
+                    }
+                    field('S', offset, "f32");
+                    column_name(column.sensor, column.field.name, out);
+                    out(" scale\t");
+                    out(column.field.unit);
+                    out("\t-\t-\t-\t-\n");
+                    offset += 4;
+                }
+                for (auto const& config : configs) {
+                    if (config.slot != slot) {
+                        continue;
+                    }
+                    field('S', offset, "f32");
+                    column_name(config.sensor, config.field.name, out);
+                    out("\t");
+                    out(config.field.unit);
+                    out("\t-\t-\t-\t-\n");
+                    offset += 4;
+                }
+            }
+
+            // Calibration: a gain and an offset for every calibrated column
+            size_t calibrated = 0;
+            for (auto const& column : columns) {
+                calibrated += column.calibrated;
+            }
+            out("record\tC\t");
+            number(8 * calibrated, out);
+            out("\tcalibration\n");
+            offset = 0;
+            for (auto const& column : columns) {
+                if (!column.calibrated) {
+                    continue;
+                }
+                field('C', offset, "f32");
+                column_name(column.sensor, column.field.name, out);
+                out(" gain\t-\t-\t-\t-\t-\n");
+                field('C', offset + 4, "f32");
+                column_name(column.sensor, column.field.name, out);
+                out(" offset\t");
+                out(column.field.unit);
+                out("\t-\t-\t-\t-\n");
+                offset += 8;
+            }
+
+            // Samples: the time, the valid bits and every column's counts
+            size_t bytes = 4 + 1;
+            for (auto const& column : columns) {
+                bytes += column.field.bytes;
+            }
+            out("record\tD\t");
+            number(bytes, out);
+            out("\tsample\n");
+            field('D', 0, "u32");
+            out("time\tms\t-\t-\t-\t-\n");
+            field('D', 4, "u8");
+            out("valid\t-\t-\t-\t-\t-\n");
+            offset = 4 + 1;
+            for (auto const& column : columns) {
+                // i16, u24 and so on
+                auto const bits = column.field.bytes * 8;
+                char type[3] = {column.field.is_signed ? 'i' : 'u'};
+                size_t len = 1;
+                if (bits >= 10) {
+                    type[len++] = static_cast<char>('0' + bits / 10);
+                }
+                type[len++] = static_cast<char>('0' + bits % 10);
+                field('D', offset, std::string_view(type, len));
+                column_name(column.sensor, column.field.name, out);
+                out("\t");
+                out(column.field.unit);
+                out("\t");
+                column_name(column.sensor, column.field.name, out);
+                out(" scale\t");
+                number(column.slot, out);
+                if (column.calibrated) {
+                    out("\t");
+                    column_name(column.sensor, column.field.name, out);
+                    out(" gain\t");
+                    column_name(column.sensor, column.field.name, out);
+                    out(" offset\n");
+                } else {
+                    out("\t-\t-\n");
+                }
+                offset += column.field.bytes;
+            }
+        }
+
+        /// Collects what `write` produces into a null-terminated array of exactly the right size.
+        template<auto Write>
+        constexpr auto build_string() {
+            constexpr size_t len = [] {
+                size_t len = 0;
+                Write([&](std::string_view piece) { len += piece.size(); });
+                return len;
+            }();
+
+            std::array<char, len + 1> out {};
+            size_t i = 0;
+            Write([&](std::string_view piece) {
+                for (char c : piece) {
+                    out[i++] = c;
+                }
+            });
+            return out;
+        }
+    }
+
+    /// The sensors a flight computer reads, in the order they are read and logged. Everything
+    /// that has to visit each sensor (the acquisition loop, both log formats and their readers)
+    /// is generated from this list at compile time, fully unrolled and without virtual calls.
+    template<typename... Slots>
+    struct SensorRegistry {
+        static constexpr size_t count = sizeof...(Slots);
+        static_assert(count <= 8, "RawSensorSample::valid has one bit per sensor");
+
+        template<size_t I>
+        using Slot = std::tuple_element_t<I, std::tuple<Slots...>>;
+
+        /// The bit in RawSensorSample::valid for the sensor in slot `I`.
+        template<size_t I>
+        static constexpr uint8_t valid_bit = 1 << I;
+
+        static constexpr uint8_t valid_all = (1 << count) - 1;
+
+        /// Calls `f.template operator()<Slot, Index>()` for every sensor in order.
+        template<typename F>
+        static constexpr void for_each(F&& f) {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                (f.template operator()<Slot<I>, I>(), ...);
+            }(std::index_sequence_for<Slots...> {});
+        }
+
+        /// Calls `f.template operator()<Slot, Index>()` for the sensor in slot `index`.
+        template<typename F>
+        static constexpr void visit(size_t index, F&& f) {
+            for_each([&]<typename S, size_t I>() {
+                if (I == index) {
+                    f.template operator()<S, I>();
+                }
+            });
+        }
+
+        /// Every logged value, in log order, not counting the timestamp.
+        static constexpr size_t column_count = (Slots::fields.size() + ... + 0);
+        static constexpr std::array<LogColumn, column_count> columns = [] {
+            std::array<LogColumn, column_count> columns {};
+            size_t i = 0;
+            for_each([&]<typename S, size_t I>() {
+                for (auto const& field : S::fields) {
+                    columns[i++] = LogColumn {
+                        .sensor = S::name, .slot = I, .field = field, .calibrated = S::calibrated,
+                    };
+                }
+            });
+            return columns;
+        }();
+
+        /// Bytes the sensors take up in a raw sample record.
+        static constexpr size_t raw_bytes = [] {
+            size_t bytes = 0;
+            for (auto const& column : columns) {
+                bytes += column.field.bytes;
+            }
+            return bytes;
+        }();
+
+        /// Every setting recorded in raw logs' scales records, in log order.
+        static constexpr size_t config_count = (Slots::config_fields.size() + ... + 0);
+        static constexpr std::array<ConfigColumn, config_count> configs = [] {
+            std::array<ConfigColumn, config_count> configs {};
+            size_t i = 0;
+            for_each([&]<typename S, size_t I>() {
+                for (auto const& field : S::config_fields) {
+                    configs[i++] = ConfigColumn { .sensor = S::name, .slot = I, .field = field };
+                }
+            });
+            return configs;
+        }();
+
+        /// Columns the pad calibration corrects.
+        static constexpr size_t calibrated_count = [] {
+            size_t calibrated = 0;
+            for (auto const& column : columns) {
+                calibrated += column.calibrated;
+            }
+            return calibrated;
+        }();
+
+        /// Bytes a raw calibration record takes after its type byte: a gain and an offset for
+        /// every calibrated column.
+        static constexpr size_t calibration_bytes = 8 * calibrated_count;
+
+        /// Bytes a raw scales record takes after its type byte: a float for every column's scale
+        /// factor and every setting.
+        static constexpr size_t scales_bytes = 4 * (column_count + config_count);
+
+        /// Describes the records of a raw log, so it can be read without this list.
+        /// Null-terminated, though the log leaves the null off.
+        static constexpr auto raw_schema = registry_detail::build_string<[](auto&& out) {
+            registry_detail::raw_schema<column_count, config_count, count>(columns, configs, out);
+        }>();
+
+        /// First line of a CSV log, null-terminated. Every column is labelled with its unit.
+        static constexpr auto csv_header = registry_detail::build_string<[](auto&& out) {
+            registry_detail::csv_header(columns, out);
+        }>();
+
+        /// printf format of one CSV row: the timestamp, then every column.
+        static constexpr auto csv_format = registry_detail::build_string<[](auto&& out) {
+            registry_detail::csv_format(column_count, out);
+        }>();
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "computer/computer.h"
+#include "computer/sensor_registry.h"
+
+namespace seds {
+    /// Every sensor the flight computer reads, in the order they are read and logged.
+    ///
+    /// A new sensor needs a driver that satisfies `Sensor` (see i2c/sensor.h), a member for it in
+    /// FlightComputer and for its reading and scale in RawSensorSample, SensorSample and
+    /// SensorScales (and its corrections in SensorCalibration, if the pad calibration covers it),
+    /// and one line here. The acquisition loop, the CSV header and rows, the raw records and the
+    /// log readers pick it up from this list. The sensor supervisor needs a SensorId for it too.
+    using FlightSensors = SensorRegistry<
+        SensorSlot<"imu", &FlightComputer::imu, &RawSensorSample::imu, &SensorSample::imu, &SensorScales::imu, &SensorCalibration::imu>,
+        SensorSlot<"baro 1", &FlightComputer::baro1, &RawSensorSample::baro1, &SensorSample::baro1, &SensorScales::baro>,
+        SensorSlot<"baro 2", &FlightComputer::baro2, &RawSensorSample::baro2, &SensorSample::baro2, &SensorScales::baro>,
+        SensorSlot<"high g", &FlightComputer::high_g_accel, &RawSensorSample::high_g, &SensorSample::high_g, &SensorScales::high_g, &SensorCalibration::high_g>,
+        SensorSlot<"temp", &FlightComputer::temp, &RawSensorSample::temp, &SensorSample::temp, &SensorScales::temp>
+    >;
+
+    // The rest of the firmware refers to sensors by these
+    static_assert(FlightSensors::valid_bit<0> == VALID_IMU);
+    static_assert(FlightSensors::valid_bit<1> == VALID_BARO1);
+    static_assert(FlightSensors::valid_bit<2> == VALID_BARO2);
+    static_assert(FlightSensors::valid_bit<3> == VALID_HIGH_G);
+    static_assert(FlightSensors::valid_bit<4> == VALID_TEMP);
+    static_assert(FlightSensors::valid_all == VALID_ALL);
+    static_assert(FlightSensors::count == SENSOR_COUNT);
+    static_assert(FlightSensors::valid_bit<static_cast<size_t>(SensorId::Imu)> == VALID_IMU);
+    static_assert(FlightSensors::valid_bit<static_cast<size_t>(SensorId::Baro1)> == VALID_BARO1);
+    static_assert(FlightSensors::valid_bit<static_cast<size_t>(SensorId::Baro2)> == VALID_BARO2);
+    static_assert(FlightSensors::valid_bit<static_cast<size_t>(SensorId::HighG)> == VALID_HIGH_G);
+    static_assert(FlightSensors::valid_bit<static_cast<size_t>(SensorId::Temperature)> == VALID_TEMP);
+
+    /// First line of every CSV log. Tools that read the logs back (e.g. host/replay) expect exactly
+    /// this header.
+    constexpr auto CSV_HEADER = FlightSensors::csv_header;
+
+    /// Upper bound on the length of one CSV row written by `format_csv_row`: the timestamp, up to
+    /// 20 characters per column, the newline and the null terminator.
+    constexpr size_t CSV_ROW_MAX_LEN = 40 + FlightSensors::column_count * 20 + 1 + 1;
+
+    /// Length of a raw sample record: the type byte, time, valid bits and every sensor's counts.
+    constexpr size_t RAW_SAMPLE_RECORD_LEN = 1 + 4 + 1 + FlightSensors::raw_bytes;
+
+    /// Length of a raw scales record: the type byte and every sensor's scale factors and settings.
+    constexpr size_t RAW_SCALES_RECORD_LEN = 1 + FlightSensors::scales_bytes;
+
+    /// Length of a raw calibration record: the type byte and every calibrated column's correction.
+    constexpr size_t RAW_CALIBRATION_RECORD_LEN = 1 + FlightSensors::calibration_bytes;
+
+    /// Start of every raw log: the magic bytes and the schema record.
+    constexpr auto RAW_LOG_HEADER = [] {
+        constexpr size_t schema_len = FlightSensors::raw_schema.size() - 1;
+        static_assert(schema_len <= UINT16_MAX);
+
+        std::array<uint8_t, sizeof(RAW_LOG_MAGIC) + 1 + 2 + schema_len> header {};
+        size_t i = 0;
+        for (auto byte : RAW_LOG_MAGIC) {
+            header[i++] = byte;
+        }
+        header[i++] = static_cast<uint8_t>(RawRecordType::Schema);
+        header[i++] = schema_len & 0xFF;
+        header[i++] = schema_len >> 8;
+        for (size_t c = 0; c < schema_len; c++) {
+            header[i++] = static_cast<uint8_t>(FlightSensors::raw_schema[c]);
+        }
+        return header;
+    }();
+}
@@ -0,0 +1,51 @@
+#include "errors.h"
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace seds::errors {
+    namespace {
+        // Errors are short-lived (they're usually logged and dropped by the caller), so only a
+        // handful are ever alive at once.
+        constexpr size_t pool_slots = 16;
+
+        alignas(std::max_align_t) uint8_t pool[pool_slots][Error::max_size];
+
+        /// Bit `i` is set while `pool[i]` is in use. Atomic so that tasks on both cores can create
+        /// errors without a lock.
+        std::atomic<uint32_t> pool_used { 0 };
+
+        static_assert(pool_slots <= 32, "pool_used has one bit per slot");
+        constexpr uint32_t pool_full = pool_slots == 32 ? ~0u : (1u << pool_slots) - 1;
+    }
+
+    void* Error::operator new(size_t size) {
+        if (size <= Error::max_size) {
+            auto used = pool_used.load(std::memory_order_relaxed);
+            while (used != pool_full) {
+                auto const slot = std::countr_one(used);
+                if (pool_used.compare_exchange_weak(used, used | (1u << slot), std::memory_order_acquire)) {
+                    return pool[slot];
+                }
+            }
+        }
+
+        // Too many errors alive at once. The heap still works, but with CONFIG_SEDS_STATIC_MEMORY
+        // this aborts in flight, which is what we want: it means errors are being leaked.
+        return ::operator new(size);
+    }
+
+    void Error::operator delete(void* ptr, size_t size) {
+        auto const address = reinterpret_cast<uintptr_t>(ptr);
+        auto const start = reinterpret_cast<uintptr_t>(&pool[0][0]);
+
+        if (address >= start && address < start + sizeof(pool)) {
+            auto const slot = (address - start) / Error::max_size;
+            pool_used.fetch_and(~(1u << slot), std::memory_order_release);
+            return;
+        }
+
+        ::operator delete(ptr, size);
+    }
+}
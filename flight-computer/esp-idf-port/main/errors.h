@@ -1,9 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <exception>
 #include <expected>
-#include <print>
 #include <memory>
 #include <iostream>
+#include <variant>
 #include "esp_err.h"
 #include "esp_log.h"
 
@@ -37,14 +39,40 @@ namespace seds::errors {
     template<typename T>
     using Expected = std::expected<T, std::unique_ptr<std::exception>>;
 
+    /// Base class for errors in this project.
+    ///
+    /// Unlike std::runtime_error, the message is never copied (so it must be a string literal or
+    /// otherwise outlive the error), and errors are allocated from a small fixed pool instead of
+    /// the heap (see errors.cpp). That way a sensor that fails every loop in flight doesn't hit
+    /// the allocator every loop.
+    class Error : public std::exception {
+    public:
+        explicit Error(const char* message) : message(message) {}
+
+        const char* what() const noexcept override {
+            return this->message;
+        }
+
+        static void* operator new(size_t size);
+        static void operator delete(void* ptr, size_t size);
+
+        /// Largest error type that fits in the pool. Bigger ones fall back to the heap.
+        static constexpr size_t max_size = 32;
+
+    private:
+        const char* message;
+    };
+
     /// An error sourced from ESP-IDF.
-    class EspError final : public std::runtime_error {
+    class EspError final : public Error {
     public:
-        explicit EspError(const esp_err_t error) : runtime_error(esp_err_to_name(error)) {}
+        explicit EspError(const esp_err_t error) : Error(esp_err_to_name(error)), code(error) {}
+
+        esp_err_t code;
     };
 
     /// An error from an SD card operation
-    class SDError final : public std::runtime_error {
+    class SDError final : public Error {
     public:
         enum Value : uint8_t {
             NoMemory,
@@ -59,12 +87,12 @@ namespace seds::errors {
             Other,
         };
 
-        constexpr SDError(Value code) : runtime_error(SDError::msg(code)), value(code) {}
+        SDError(Value code) : Error(SDError::msg(code)), value(code) {}
 
-        constexpr SDError(int err) :  runtime_error(SDError::msg(Value::Other)), value(Other), error_code(err) {}
+        SDError(int err) :  Error(SDError::msg(Value::Other)), value(Other), error_code(err) {}
 
-        constexpr bool operator==(SDError other) const { return this->value == other.value && this->error_code == other.error_code; }
-        constexpr bool operator!=(SDError other) const { return this->value != other.value && this->error_code == other.error_code; }
+        bool operator==(SDError other) const { return this->value == other.value && this->error_code == other.error_code; }
+        bool operator!=(SDError other) const { return this->value != other.value && this->error_code == other.error_code; }
         
 
 
@@ -83,6 +111,9 @@ namespace seds::errors {
         int error_code = 0;
     };
 
+    static_assert(sizeof(EspError) <= Error::max_size);
+    static_assert(sizeof(SDError) <= Error::max_size);
+
     /// Checks if the given value is an error, and if it is, terminates.
     ///
     /// This function should be used to prevent further execution in the event of an
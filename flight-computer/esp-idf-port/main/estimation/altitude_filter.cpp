@@ -0,0 +1,174 @@
+#include "altitude_filter.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include "baro_voter.h"
+
+namespace seds::estimation {
+
+namespace {
+    constexpr size_t ALTITUDE = 0;
+    constexpr size_t VELOCITY = 1;
+    constexpr size_t BIAS = 2;
+
+    /// Starting uncertainty of the velocity (m/s) and bias (m/s²), 1σ. The computer starts at
+    /// rest on the pad, so the velocity is known well.
+    constexpr float INITIAL_VELOCITY_SD = 0.5f;
+    constexpr float INITIAL_BIAS_SD = 1.0f;
+
+    float square(float value) {
+        return value * value;
+    }
+}
+
+AltitudeFilter::AltitudeFilter(FilterConfig const& config) : config(config) {
+    this->reset();
+}
+
+void AltitudeFilter::reset() {
+    this->reference_pressure = 0;
+    this->barometric_altitude = AltitudeAboveGround();
+    this->initialized = false;
+    this->state = Vector<3>::zero();
+    this->covariance = Matrix<3, 3>::zero();
+    this->output = Estimate {};
+}
+
+void AltitudeFilter::set_ground_pressure(float pressure) {
+    this->reference_pressure = pressure;
+    this->barometric_altitude = AltitudeAboveGround(pressure);
+}
+
+float AltitudeFilter::high_g_weight(int16_t imu_counts) const {
+    auto const fraction = std::abs(static_cast<float>(imu_counts))
+        / -static_cast<float>(std::numeric_limits<int16_t>::min());
+    auto const weight = (fraction - this->config.blend_start)
+        / (this->config.blend_end - this->config.blend_start);
+    return std::clamp(weight, 0.0f, 1.0f);
+}
+
+Estimate const& AltitudeFilter::update(RawSensorSample const& sample, CalibratedScales const& scales,
+    BaroVote const& baro)
+{
+    bool const has_imu = sample.valid & VALID_IMU;
+    bool const has_high_g = sample.valid & VALID_HIGH_G;
+
+    if (this->reference_pressure == 0) {
+        if (baro.count == 0) {
+            // Nothing to measure altitude against yet
+            return this->output;
+        }
+        this->set_ground_pressure(baro.pressure);
+    }
+
+    if (!this->initialized) {
+        if (baro.count == 0) {
+            return this->output;
+        }
+        this->initialize(sample.time_ms, this->barometric_altitude(baro.pressure));
+    }
+
+    // Blend the accelerometers by how close the BMI323 is to clipping. A clipped reading is
+    // wrong by an unknown amount, so the ADXL375 takes over well before that.
+    float weight = 0;
+    if (has_imu && has_high_g) {
+        weight = this->high_g_weight(sample.imu.az);
+    } else if (has_high_g) {
+        weight = 1;
+    }
+
+    float accel;
+    float accel_variance;
+    if (has_imu || has_high_g) {
+        // One multiply-add each, with the calibration folded in
+        auto const& imu_z = scales.coefficients.imu[2];
+        auto const& high_g_z = scales.coefficients.high_g[2];
+        auto const imu_accel = (sample.imu.az * imu_z.gain + imu_z.offset - 1.0f) * GRAVITY;
+        auto const high_g_accel =
+            (sample.high_g.z * high_g_z.gain + high_g_z.offset - 1.0f) * GRAVITY;
+        accel = (1.0f - weight) * imu_accel + weight * high_g_accel;
+        accel_variance = square((1.0f - weight) * this->config.imu_accel_noise)
+            + square(weight * this->config.high_g_accel_noise);
+    } else {
+        // Coast on the last acceleration, and trust the barometers more while we do
+        accel = this->output.acceleration + this->state[BIAS];
+        accel_variance = square(this->config.lost_accel_noise);
+    }
+
+    auto const dt = (sample.time_ms - this->output.time_ms) / 1000.0f;
+    if (dt > 0) {
+        this->predict(dt, accel, accel_variance);
+    }
+
+    if (baro.count > 0) {
+        // The vote averages independent barometers, which cuts the noise
+        auto const noise_scale = baro.transonic ? this->config.transonic_baro_noise_scale : 1.0f;
+        auto const baro_variance = square(this->config.baro_noise * noise_scale) / baro.count;
+        this->update_altitude(this->barometric_altitude(baro.pressure), baro_variance);
+    }
+
+    this->output = Estimate {
+        .time_ms = std::max(sample.time_ms, this->output.time_ms),
+        .altitude = this->state[ALTITUDE],
+        .velocity = this->state[VELOCITY],
+        .acceleration = accel - this->state[BIAS],
+        .accel_bias = this->state[BIAS],
+        .high_g_weight = weight,
+        .altitude_variance = this->covariance(ALTITUDE, ALTITUDE),
+    };
+    return this->output;
+}
+
+void AltitudeFilter::initialize(int64_t time_ms, float altitude) {
+    this->state = Vector<3> { { altitude, 0, 0 } };
+    this->covariance = Matrix<3, 3>::diagonal({
+        square(this->config.baro_noise),
+        square(INITIAL_VELOCITY_SD),
+        square(INITIAL_BIAS_SD),
+    });
+    this->output.time_ms = time_ms;
+    this->initialized = true;
+}
+
+void AltitudeFilter::predict(float dt, float accel, float accel_variance) {
+    auto const half_dt2 = 0.5f * dt * dt;
+
+    // The true acceleration is the measured one minus the bias
+    auto transition = Matrix<3, 3>::identity();
+    transition(ALTITUDE, VELOCITY) = dt;
+    transition(ALTITUDE, BIAS) = -half_dt2;
+    transition(VELOCITY, BIAS) = -dt;
+
+    auto const input = Vector<3> { { half_dt2, dt, 0 } };
+
+    this->state = transition * this->state + input * accel;
+
+    // Accelerometer noise enters through the same path as the acceleration itself
+    auto process_noise = input * input.transposed() * accel_variance;
+    process_noise(BIAS, BIAS) += square(this->config.bias_drift) * dt;
+
+    this->covariance = transition * this->covariance * transition.transposed() + process_noise;
+}
+
+void AltitudeFilter::update_altitude(float altitude, float variance) {
+    // The measurement is the first state, so the gain only needs the first column of P
+    auto const innovation_variance = this->covariance(ALTITUDE, ALTITUDE) + variance;
+    Vector<3> gain;
+    for (size_t i = 0; i < 3; i++) {
+        gain[i] = this->covariance(i, ALTITUDE) / innovation_variance;
+    }
+
+    auto const innovation = altitude - this->state[ALTITUDE];
+    this->state += gain * innovation;
+
+    // P -= K H P, where H P is P's first row
+    Matrix<1, 3> first_row;
+    for (size_t i = 0; i < 3; i++) {
+        first_row(0, i) = this->covariance(ALTITUDE, i);
+    }
+    this->covariance -= gain * first_row;
+    symmetrize(this->covariance);
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+#include "computer/log_format.h"
+#include "estimation/estimate.h"
+#include "estimation/matrix.h"
+#include "estimation/pressure_altitude.h"
+
+namespace seds::estimation {
+    /// Noise levels and thresholds for AltitudeFilter. The defaults suit the sensors we fly.
+    struct FilterConfig {
+        /// Noise of the BMI323's vertical acceleration, m/s² (1σ), including vibration.
+        float imu_accel_noise = 0.3f;
+        /// Noise of the ADXL375's vertical acceleration, m/s² (1σ). Its 49 mg counts are coarse.
+        float high_g_accel_noise = 1.5f;
+        /// Stand-in acceleration noise when neither accelerometer read, m/s² (1σ).
+        float lost_accel_noise = 20.0f;
+        /// How fast the accelerometer bias may wander, m/s² per √s.
+        float bias_drift = 0.05f;
+        /// Noise of one barometer's altitude, m (1σ).
+        float baro_noise = 1.0f;
+        /// How much noisier the barometers get near Mach 1.
+        float transonic_baro_noise_scale = 10.0f;
+        /// Fraction of the BMI323's full scale at which the ADXL375 starts to take over, and at
+        /// which it has taken over completely. In between, the two are blended linearly.
+        float blend_start = 0.80f;
+        float blend_end = 0.95f;
+    };
+
+    struct BaroVote;
+
+    /// Fuses the voted barometer pressure (see baro_voter.h) with the vertical acceleration from
+    /// the BMI323 and ADXL375 into altitude, vertical velocity and accelerometer bias.
+    ///
+    /// This is a three-state Kalman filter. Acceleration drives the prediction as a control
+    /// input, and the barometers are applied as one scalar altitude measurement, so no matrix is
+    /// ever inverted. Every update costs the same fixed handful of 3×3 products and
+    /// nothing is allocated.
+    ///
+    /// The z axes of both accelerometers are taken to point up the rocket, and flight is taken to
+    /// be close enough to vertical that z is up. Whatever the tilt adds on the pad shows up as
+    /// accelerometer bias.
+    class AltitudeFilter {
+    public:
+        AltitudeFilter() : AltitudeFilter(FilterConfig {}) {}
+        explicit AltitudeFilter(FilterConfig const& config);
+
+        /// Forget everything, including the ground reference pressure.
+        void reset();
+
+        /// Measure altitude from this pressure, in Pa. Without this, the first voted pressure
+        /// becomes the reference, which is what we want when the computer starts on the pad.
+        void set_ground_pressure(float pressure);
+
+        /// The ground reference pressure in Pa, or 0 before it is known.
+        [[nodiscard]]
+        float ground_pressure() const {
+            return this->reference_pressure;
+        }
+
+        /// Advance the filter to the time of `sample`, folding in the accelerometers that read and
+        /// the barometers' vote. The accelerometers are converted with the calibration in
+        /// `scales`, if there is one yet.
+        Estimate const& update(RawSensorSample const& sample, CalibratedScales const& scales,
+            BaroVote const& baro);
+
+        /// The output of the last update.
+        [[nodiscard]]
+        Estimate const& estimate() const {
+            return this->output;
+        }
+
+        /// How much to weight the ADXL375 given the BMI323's reading on the same axis.
+        [[nodiscard]]
+        float high_g_weight(int16_t imu_counts) const;
+
+    private:
+        void initialize(int64_t time_ms, float altitude);
+        void predict(float dt, float accel, float accel_variance);
+        void update_altitude(float altitude, float variance);
+
+        FilterConfig config;
+        float reference_pressure = 0;
+        AltitudeAboveGround barometric_altitude;
+        bool initialized = false;
+
+        /// Altitude, velocity and accelerometer bias.
+        Vector<3> state;
+        Matrix<3, 3> covariance;
+        Estimate output;
+    };
+}
@@ -0,0 +1,210 @@
+#include "baro_voter.h"
+
+#include <cmath>
+
+namespace seds::estimation {
+
+char const* to_string(BaroStatus status) {
+    switch (status) {
+        case BaroStatus::Ok: return "ok";
+        case BaroStatus::Diverged: return "diverged";
+        case BaroStatus::Stuck: return "stuck";
+        case BaroStatus::Dead: return "dead";
+    }
+    return "unknown";
+}
+
+namespace {
+    /// Isothermal scale height of the lower atmosphere, m. Over one sample, pressure changes by
+    /// about -p v dt / H, which is all the gating needs.
+    constexpr float SCALE_HEIGHT = 8434.0f;
+
+    /// Weight of each new sample in the tracking error average.
+    constexpr float TRACKING_RATE = 0.1f;
+}
+
+BaroVoter::BaroVoter(VoterConfig const& config) : config(config) {}
+
+bool BaroVoter::check(Channel& channel, bool read, int32_t counts, float pressure, int64_t time_ms,
+    Estimate const& estimate, bool transonic)
+{
+    auto const& config = this->config;
+
+    if (!read) {
+        // Not reading a dead barometer isn't another failure
+        if (channel.status != BaroStatus::Dead && ++channel.failures >= config.dead_after) {
+            channel.status = BaroStatus::Dead;
+        }
+        return false;
+    }
+
+    // It answered, so it isn't dead (any more)
+    channel.failures = 0;
+    if (channel.status == BaroStatus::Dead) {
+        channel.status = BaroStatus::Ok;
+        channel.time_ms = -1;
+    }
+
+    channel.repeats = counts == channel.last_counts ? channel.repeats + 1 : 0;
+    channel.last_counts = counts;
+    if (channel.repeats >= config.stuck_after) {
+        channel.status = BaroStatus::Stuck;
+        return false;
+    }
+    if (channel.status == BaroStatus::Stuck) {
+        channel.status = BaroStatus::Ok;
+    }
+
+    if (!(pressure >= config.min_pressure && pressure <= config.max_pressure)) {
+        channel.spikes++;
+        return false;
+    }
+
+    if (channel.time_ms >= 0) {
+        auto const dt = (time_ms - channel.time_ms) / 1000.0f;
+        auto const expected_change = channel.pressure
+            * std::expm1(-estimate.velocity * dt / SCALE_HEIGHT);
+        auto const surprise = std::abs(pressure - channel.pressure - expected_change);
+
+        if (surprise > config.spike_pa + std::abs(expected_change) * config.spike_fraction
+            && (transonic || ++channel.rejects < config.reanchor_after)) {
+            channel.spikes++;
+            return false;
+        }
+
+        channel.tracking_error += TRACKING_RATE * (surprise - channel.tracking_error);
+    }
+
+    channel.rejects = 0;
+    channel.pressure = pressure;
+    channel.time_ms = time_ms;
+    return true;
+}
+
+size_t BaroVoter::culprit(float const (&pressures)[BAROMETERS]) const {
+    if (!this->reference.valid) {
+        // They've disagreed since startup. The one with the rougher changes is the better guess.
+        return this->channels[0].tracking_error > this->channels[1].tracking_error ? 0 : 1;
+    }
+
+    auto const expected = std::exp(-this->reference.climb / SCALE_HEIGHT);
+    float errors[BAROMETERS];
+    for (size_t i = 0; i < BAROMETERS; i++) {
+        errors[i] = std::abs(pressures[i] - this->reference.pressures[i] * expected);
+    }
+    return errors[0] > errors[1] ? 0 : 1;
+}
+
+void BaroVoter::clear_divergence() {
+    this->diverged_since_ms = -1;
+    for (auto& channel : this->channels) {
+        if (channel.status == BaroStatus::Diverged) {
+            channel.status = BaroStatus::Ok;
+        }
+    }
+}
+
+BaroVote const& BaroVoter::update(RawSensorSample const& sample, SensorScales const& scales,
+    Estimate const& estimate)
+{
+    auto const& config = this->config;
+    int32_t const counts[BAROMETERS] = { sample.baro1.pressure, sample.baro2.pressure };
+    uint8_t const bits[BAROMETERS] = { VALID_BARO1, VALID_BARO2 };
+
+    auto const speed = std::abs(estimate.velocity);
+    bool const transonic = speed >= config.transonic_low && speed <= config.transonic_high;
+
+    bool accepted[BAROMETERS];
+    float pressures[BAROMETERS];
+    for (size_t i = 0; i < BAROMETERS; i++) {
+        pressures[i] = counts[i] * scales.baro.pa_per_lsb;
+        accepted[i] = this->check(this->channels[i], sample.valid & bits[i], counts[i],
+            pressures[i], sample.time_ms, estimate, transonic);
+    }
+
+    // Dead-reckon the climb since the barometers last agreed
+    auto& reference = this->reference;
+    if (reference.valid) {
+        auto const dt = (sample.time_ms - this->reference_time_ms) / 1000.0f;
+        reference.climb += reference.velocity * dt + 0.5f * estimate.acceleration * dt * dt;
+        reference.velocity += estimate.acceleration * dt;
+        this->reference_time_ms = sample.time_ms;
+    }
+
+    if (accepted[0] && accepted[1]) {
+        // Restart the reference while they're as close as they usually are. Waiting for them to
+        // fall within the divergence threshold instead would let a slow drift leak into the
+        // estimated velocity the reference starts from.
+        auto const difference = pressures[1] - pressures[0];
+        if (!this->has_offset) {
+            this->offset = difference;
+            this->has_offset = true;
+        }
+        auto const deviation = difference - this->offset;
+        if (std::abs(deviation) < config.agree_pa) {
+            this->offset += config.offset_rate * deviation;
+            reference = Reference {
+                .valid = true,
+                .pressures = { pressures[0], pressures[1] },
+                .velocity = estimate.velocity,
+                .climb = 0,
+            };
+            this->reference_time_ms = sample.time_ms;
+        }
+
+        auto const apart = std::abs(deviation);
+        bool const blamed = this->channels[0].status == BaroStatus::Diverged
+            || this->channels[1].status == BaroStatus::Diverged;
+        if (apart > config.divergence_pa) {
+            if (this->diverged_since_ms < 0) {
+                this->diverged_since_ms = sample.time_ms;
+            }
+            // Once one is blamed it stays blamed until they agree again. Until then, the likelier
+            // culprit is left out of the vote but not flagged, since it may just be noise.
+            if (!blamed) {
+                auto const suspect = this->culprit(pressures);
+                if (sample.time_ms - this->diverged_since_ms >= config.divergence_hold_ms) {
+                    this->channels[suspect].status = BaroStatus::Diverged;
+                } else {
+                    accepted[suspect] = false;
+                }
+            }
+        } else if (apart < config.divergence_pa / 2) {
+            this->clear_divergence();
+        }
+    } else {
+        // If the barometer we trust dropped out, a suspect one beats none
+        bool trusted = false;
+        for (size_t i = 0; i < BAROMETERS; i++) {
+            trusted |= accepted[i] && this->channels[i].status == BaroStatus::Ok;
+        }
+        if (!trusted) {
+            this->clear_divergence();
+        }
+    }
+
+    BaroVote vote {};
+    float sum = 0;
+    float health = 0;
+    for (size_t i = 0; i < BAROMETERS; i++) {
+        auto& channel = this->channels[i];
+        bool const used = accepted[i] && channel.status == BaroStatus::Ok;
+        channel.health += config.health_rate * ((used ? 1.0f : 0.0f) - channel.health);
+
+        if (used) {
+            sum += pressures[i];
+            health += channel.health;
+            vote.count++;
+            vote.used |= bits[i];
+        }
+    }
+
+    vote.transonic = transonic;
+    vote.pressure = vote.count > 0 ? sum / vote.count : 0;
+    vote.health = health / BAROMETERS * (vote.transonic ? 0.5f : 1.0f);
+
+    this->last_vote = vote;
+    return this->last_vote;
+}
+
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "computer/log_format.h"
+#include "estimation/altitude_filter.h"
+
+namespace seds::estimation {
+    /// What the voter thinks of one barometer.
+    enum class BaroStatus : uint8_t {
+        /// Readings are being used.
+        Ok,
+        /// Disagrees with the other barometer and is the one that doesn't match the motion.
+        Diverged,
+        /// Returned exactly the same counts for too long. A live BMP581 at 1/64 Pa resolution
+        /// never does that.
+        Stuck,
+        /// Failed to read too many times in a row. It is only read now and then to see if it's
+        /// back.
+        Dead,
+    };
+
+    char const* to_string(BaroStatus status);
+
+    /// Thresholds for BaroVoter.
+    struct VoterConfig {
+        /// Pressures outside this range (Pa) can't be real.
+        float min_pressure = 1'000.0f;
+        float max_pressure = 120'000.0f;
+        /// Failed reads in a row before a barometer is dead.
+        uint32_t dead_after = 10;
+        /// Identical readings in a row before a barometer is stuck.
+        uint32_t stuck_after = 10;
+        /// How far a reading may land from where the last one and the current velocity say it
+        /// should be before it's a spike: this many Pa, plus `spike_fraction` of the expected
+        /// change to allow for the velocity being off.
+        float spike_pa = 150.0f;
+        float spike_fraction = 0.1f;
+        /// Spikes in a row after which the barometer has probably really moved, and is trusted
+        /// again from its new reading. Not while transonic, where jumps are expected.
+        uint32_t reanchor_after = 10;
+        /// Two BMP581s can read up to 60 Pa apart, so how far apart they usually are is learned,
+        /// following at `offset_rate` per sample while they agree. Within `agree_pa` of that
+        /// they agree, and the dead-reckoned climb that settles disagreements restarts.
+        float agree_pa = 50.0f;
+        float offset_rate = 0.01f;
+        /// How far from their usual difference they may stray (Pa) for how long before one is
+        /// blamed.
+        float divergence_pa = 100.0f;
+        uint32_t divergence_hold_ms = 500;
+        /// Speeds (m/s) around Mach 1 where shock waves passing the static ports make both
+        /// barometers unreliable.
+        float transonic_low = 250.0f;
+        float transonic_high = 450.0f;
+        /// How fast the health scores follow the pass/fail record, per sample.
+        float health_rate = 0.05f;
+    };
+
+    /// The voter's output for one sample.
+    struct BaroVote {
+        /// Mean of the barometers in use, Pa. Only meaningful if `count` isn't 0.
+        float pressure = 0;
+        /// How many barometers went into `pressure`.
+        uint8_t count = 0;
+        /// VALID_BARO1 and/or VALID_BARO2 for the barometers in use.
+        uint8_t used = 0;
+        /// Near Mach 1. Trust `pressure` much less.
+        bool transonic = false;
+        /// 1 with both barometers healthy, 0.5 with one, 0 with none, and halved while
+        /// transonic.
+        float health = 0;
+    };
+
+    /// Cross-checks the two BMP581s every sample and votes one pressure out of them.
+    ///
+    /// Each barometer is checked on its own for failed reads, stuck output, implausible values
+    /// and spikes against where its last reading and the estimated velocity say it should be.
+    /// Then the two are checked against each other. With only two, a disagreement can't be
+    /// settled by majority, so the accelerometers break the tie: the climb since the barometers
+    /// last agreed is dead-reckoned from the estimated acceleration, and the barometer that
+    /// strays further from it is left out until they agree again. The filter's own velocity
+    /// can't be used for this, since by then it has been fed the bad barometer too. A bad
+    /// barometer is dropped from the vote rather than averaged in, so it can't drag the altitude
+    /// estimate with it.
+    class BaroVoter {
+    public:
+        static constexpr size_t BAROMETERS = 2;
+
+        BaroVoter() : BaroVoter(VoterConfig {}) {}
+        explicit BaroVoter(VoterConfig const& config);
+
+        /// Vote on the barometers in `sample`, given the estimate from before it.
+        BaroVote const& update(RawSensorSample const& sample, SensorScales const& scales,
+            Estimate const& estimate);
+
+        [[nodiscard]]
+        BaroVote const& vote() const {
+            return this->last_vote;
+        }
+
+        [[nodiscard]]
+        BaroStatus status(size_t barometer) const {
+            return this->channels[barometer].status;
+        }
+
+        /// 0 to 1, how often the barometer's readings have been used lately.
+        [[nodiscard]]
+        float health(size_t barometer) const {
+            return this->channels[barometer].health;
+        }
+
+        /// Readings thrown out as spikes so far.
+        [[nodiscard]]
+        uint32_t spikes(size_t barometer) const {
+            return this->channels[barometer].spikes;
+        }
+
+    private:
+        struct Channel {
+            BaroStatus status = BaroStatus::Ok;
+            float health = 1;
+            uint32_t failures = 0;
+            int32_t last_counts = 0;
+            uint32_t repeats = 0;
+            /// Last reading that was accepted, and when.
+            float pressure = 0;
+            int64_t time_ms = -1;
+            uint32_t rejects = 0;
+            uint32_t spikes = 0;
+            /// Running average of how far this barometer's changes are from the expected ones.
+            float tracking_error = 0;
+        };
+
+        /// Where the barometers last agreed, and the climb since then from the accelerometers
+        /// alone.
+        struct Reference {
+            bool valid = false;
+            std::array<float, BAROMETERS> pressures {};
+            float velocity = 0;
+            float climb = 0;
+        };
+
+        /// Checks one barometer on its own. Returns true if its reading can be used.
+        bool check(Channel& channel, bool read, int32_t counts, float pressure, int64_t time_ms,
+            Estimate const& estimate, bool transonic);
+
+        /// Which barometer to leave out now that they disagree.
+        size_t culprit(float const (&pressures)[BAROMETERS]) const;
+
+        void clear_divergence();
+
+        VoterConfig config;
+        std::array<Channel, BAROMETERS> channels;
+        Reference reference;
+        int64_t reference_time_ms = -1;
+        /// Usual difference between the barometers (second minus first), Pa.
+        float offset = 0;
+        bool has_offset = false;
+        int64_t diverged_since_ms = -1;
+        BaroVote last_vote;
+    };
+}
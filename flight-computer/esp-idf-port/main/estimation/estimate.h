@@ -0,0 +1,29 @@
+#pragma once
+
+// The estimator's output on its own, without the filter, so code that only consumes estimates
+// (the air brake controller, which is also built into the trajectory engine) needn't pull in
+// the sensor and log types.
+
+#include <cstdint>
+
+namespace seds::estimation {
+    /// Standard gravity, m/s².
+    constexpr float GRAVITY = 9.80665f;
+
+    /// The filter's output for one sample.
+    struct Estimate {
+        int64_t time_ms = 0;
+        /// Height above the ground reference pressure, m.
+        float altitude = 0;
+        /// Vertical velocity, m/s, positive up.
+        float velocity = 0;
+        /// Vertical acceleration with gravity and the estimated bias removed, m/s².
+        float acceleration = 0;
+        /// Estimated bias of the accelerometer in use, m/s².
+        float accel_bias = 0;
+        /// How much of the acceleration came from the ADXL375: 0 is all BMI323, 1 all ADXL375.
+        float high_g_weight = 0;
+        /// Variance of `altitude`, m².
+        float altitude_variance = 0;
+    };
+}
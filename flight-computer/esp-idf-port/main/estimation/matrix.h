@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace seds::estimation {
+    /// A dense row-major matrix with its size fixed at compile time.
+    ///
+    /// Just enough linear algebra for small filters: everything is stored inline, so matrices
+    /// can live on the stack or in a static without touching the heap, and the compiler sees the
+    /// loop bounds and can unroll them.
+    template<size_t Rows, size_t Cols>
+    struct Matrix {
+        std::array<float, Rows * Cols> values {};
+
+        static constexpr size_t rows = Rows;
+        static constexpr size_t cols = Cols;
+
+        [[nodiscard]]
+        static constexpr Matrix zero() {
+            return Matrix {};
+        }
+
+        [[nodiscard]]
+        static constexpr Matrix identity() requires (Rows == Cols) {
+            Matrix result {};
+            for (size_t i = 0; i < Rows; i++) {
+                result(i, i) = 1.0f;
+            }
+            return result;
+        }
+
+        /// A diagonal matrix with `diagonal` along the diagonal.
+        [[nodiscard]]
+        static constexpr Matrix diagonal(std::array<float, Rows> const& diagonal)
+            requires (Rows == Cols)
+        {
+            Matrix result {};
+            for (size_t i = 0; i < Rows; i++) {
+                result(i, i) = diagonal[i];
+            }
+            return result;
+        }
+
+        constexpr float& operator()(size_t row, size_t col) {
+            return this->values[row * Cols + col];
+        }
+
+        constexpr float operator()(size_t row, size_t col) const {
+            return this->values[row * Cols + col];
+        }
+
+        /// Element of a column vector.
+        constexpr float& operator[](size_t row) requires (Cols == 1) {
+            return this->values[row];
+        }
+
+        constexpr float operator[](size_t row) const requires (Cols == 1) {
+            return this->values[row];
+        }
+
+        [[nodiscard]]
+        constexpr Matrix<Cols, Rows> transposed() const {
+            Matrix<Cols, Rows> result {};
+            for (size_t r = 0; r < Rows; r++) {
+                for (size_t c = 0; c < Cols; c++) {
+                    result(c, r) = (*this)(r, c);
+                }
+            }
+            return result;
+        }
+
+        constexpr Matrix& operator+=(Matrix const& other) {
+            for (size_t i = 0; i < Rows * Cols; i++) {
+                this->values[i] += other.values[i];
+            }
+            return *this;
+        }
+
+        constexpr Matrix& operator-=(Matrix const& other) {
+            for (size_t i = 0; i < Rows * Cols; i++) {
+                this->values[i] -= other.values[i];
+            }
+            return *this;
+        }
+
+        constexpr Matrix& operator*=(float scale) {
+            for (auto& value : this->values) {
+                value *= scale;
+            }
+            return *this;
+        }
+
+        friend constexpr Matrix operator+(Matrix lhs, Matrix const& rhs) {
+            return lhs += rhs;
+        }
+
+        friend constexpr Matrix operator-(Matrix lhs, Matrix const& rhs) {
+            return lhs -= rhs;
+        }
+
+        friend constexpr Matrix operator*(Matrix lhs, float scale) {
+            return lhs *= scale;
+        }
+
+        friend constexpr Matrix operator*(float scale, Matrix rhs) {
+            return rhs *= scale;
+        }
+
+        bool operator==(Matrix const&) const = default;
+    };
+
+    template<size_t Rows>
+    using Vector = Matrix<Rows, 1>;
+
+    template<size_t Rows, size_t Inner, size_t Cols>
+    constexpr Matrix<Rows, Cols> operator*(Matrix<Rows, Inner> const& lhs, Matrix<Inner, Cols> const& rhs) {
+        Matrix<Rows, Cols> result {};
+        for (size_t r = 0; r < Rows; r++) {
+            for (size_t k = 0; k < Inner; k++) {
+                auto const scale = lhs(r, k);
+                for (size_t c = 0; c < Cols; c++) {
+                    result(r, c) += scale * rhs(k, c);
+                }
+            }
+        }
+        return result;
+    }
+
+    /// Averages a square matrix with its transpose, removing the asymmetry that rounding slowly
+    /// introduces into covariance matrices.
+    template<size_t N>
+    constexpr void symmetrize(Matrix<N, N>& matrix) {
+        for (size_t r = 0; r < N; r++) {
+            for (size_t c = r + 1; c < N; c++) {
+                auto const mean = 0.5f * (matrix(r, c) + matrix(c, r));
+                matrix(r, c) = mean;
+                matrix(c, r) = mean;
+            }
+        }
+    }
+
+    static_assert(Matrix<2, 2>::identity() * Matrix<2, 2>::diagonal({2, 3}) == Matrix<2, 2>::diagonal({2, 3}));
+    static_assert((Matrix<2, 3> { {1, 2, 3, 4, 5, 6} }.transposed())(2, 1) == 6);
+}
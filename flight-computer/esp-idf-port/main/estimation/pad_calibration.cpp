@@ -0,0 +1,75 @@
+#include "pad_calibration.h"
+
+#include <cmath>
+
+namespace seds::estimation {
+
+namespace {
+    // Where each axis is in the window
+    constexpr size_t ACCEL = 0;
+    constexpr size_t GYRO = 3;
+    constexpr size_t HIGH_G = 6;
+}
+
+PadCalibrator::PadCalibrator(CalibrationConfig const& config) : config(config) {}
+
+bool PadCalibrator::update(RawSensorSample const& sample, SensorScales const& scales) {
+    // Both accelerometers have to be in every sample of a window, or they can't be lined up
+    if ((sample.valid & (VALID_IMU | VALID_HIGH_G)) != (VALID_IMU | VALID_HIGH_G)) {
+        return false;
+    }
+
+    auto const imu = scales.imu.convert(sample.imu);
+    auto const high_g = scales.high_g.convert(sample.high_g);
+    this->window.add({
+        imu.ax, imu.ay, imu.az,
+        imu.gx, imu.gy, imu.gz,
+        high_g.h_ax, high_g.h_ay, high_g.h_az,
+    });
+    if (this->window.count() < this->config.samples) {
+        return false;
+    }
+
+    auto const calibration = this->solve();
+    this->window.reset();
+    if (!calibration.has_value()) {
+        this->rejected_windows++;
+        return false;
+    }
+
+    this->result = calibration;
+    return true;
+}
+
+std::optional<SensorCalibration> PadCalibrator::solve() const {
+    auto const& mean = this->window.mean();
+    for (size_t i = 0; i < 3; i++) {
+        if (this->window.variance(ACCEL + i) > this->config.max_accel_sd * this->config.max_accel_sd
+            || this->window.variance(GYRO + i) > this->config.max_gyro_sd * this->config.max_gyro_sd
+            || this->window.variance(HIGH_G + i)
+                > this->config.max_high_g_sd * this->config.max_high_g_sd) {
+            return std::nullopt;
+        }
+    }
+
+    auto const gravity = std::sqrt(mean[ACCEL] * mean[ACCEL] + mean[ACCEL + 1] * mean[ACCEL + 1]
+        + mean[ACCEL + 2] * mean[ACCEL + 2]);
+    if (std::abs(gravity - 1.0f) > this->config.max_gravity_error) {
+        return std::nullopt;
+    }
+
+    SensorCalibration calibration;
+    auto const accel_gain = 1.0f / gravity;
+    for (size_t i = 0; i < 3; i++) {
+        calibration.imu[i] = AxisCorrection { .gain = accel_gain, .offset = 0 };
+        calibration.imu[3 + i] = AxisCorrection { .gain = 1, .offset = -mean[GYRO + i] };
+        // Read the same gravity as the BMI323 once that is corrected
+        calibration.high_g[i] = AxisCorrection {
+            .gain = 1,
+            .offset = mean[ACCEL + i] * accel_gain - mean[HIGH_G + i],
+        };
+    }
+    return calibration;
+}
+
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "computer/log_format.h"
+
+namespace seds::estimation {
+    /// Running mean and variance of `N` channels by Welford's method: constant memory, one pass,
+    /// and none of the cancellation that summing squares suffers over thousands of samples.
+    template<size_t N>
+    class Welford {
+    public:
+        void add(std::array<float, N> const& values) {
+            this->n++;
+            for (size_t i = 0; i < N; i++) {
+                auto const delta = values[i] - this->means[i];
+                this->means[i] += delta / static_cast<float>(this->n);
+                this->m2[i] += delta * (values[i] - this->means[i]);
+            }
+        }
+
+        void reset() {
+            *this = Welford();
+        }
+
+        [[nodiscard]]
+        uint32_t count() const {
+            return this->n;
+        }
+
+        [[nodiscard]]
+        std::array<float, N> const& mean() const {
+            return this->means;
+        }
+
+        /// Sample variance of channel `i`, or 0 with fewer than two samples.
+        [[nodiscard]]
+        float variance(size_t i) const {
+            return this->n > 1 ? this->m2[i] / static_cast<float>(this->n - 1) : 0.0f;
+        }
+
+    private:
+        uint32_t n = 0;
+        std::array<float, N> means {};
+        /// Sums of squared differences from the mean.
+        std::array<float, N> m2 {};
+    };
+
+    /// Settings for PadCalibrator. The defaults suit the BMI323 and ADXL375 on a rail.
+    struct CalibrationConfig {
+        /// Samples in each calibration, about 10 s at the pad's sampling rate.
+        uint32_t samples = 100;
+        /// Noise above which the rocket isn't still enough to calibrate against, 1σ: BMI323 g,
+        /// gyro dps and ADXL375 g. Wind rocking the rail is fine; someone loading it isn't.
+        float max_accel_sd = 0.05f;
+        float max_gyro_sd = 2.0f;
+        float max_high_g_sd = 0.2f;
+        /// How far from 1 g the BMI323 may read and still be trusted to be sitting in gravity
+        /// alone, g.
+        float max_gravity_error = 0.1f;
+    };
+
+    /// Calibrates the BMI323 and ADXL375 while the rocket sits still on the pad.
+    ///
+    /// Each window of `samples` samples in which both accelerometers read is summed up with
+    /// Welford statistics. If the rocket was still throughout, the window gives:
+    ///
+    /// - gyro bias, per axis, which is simply the mean rate.
+    /// - accelerometer scale against 1 g: one gain for all three BMI323 axes that makes it read
+    ///   exactly 1 g. Sitting in one attitude can't tell a per-axis bias from the tilt of the rail,
+    ///   so the altitude filter goes on estimating the bias that matters in flight.
+    /// - how the ADXL375 lines up with the BMI323, as the per-axis offset that makes it read
+    ///   the same gravity vector as the calibrated BMI323. At 1 g the small misalignment between
+    ///   the two boards shows up as exactly such an offset.
+    ///
+    /// Windows run back to back for as long as the rocket is on the pad, and each still one
+    /// replaces the calibration, so it reflects the rocket as it was last set up. One with
+    /// movement in it is thrown away.
+    class PadCalibrator {
+    public:
+        PadCalibrator() : PadCalibrator(CalibrationConfig {}) {}
+        explicit PadCalibrator(CalibrationConfig const& config);
+
+        /// Add a sample taken on the pad, converted with the uncalibrated `scales`. Returns true
+        /// when it completes a calibration, which is then in `calibration()`.
+        bool update(RawSensorSample const& sample, SensorScales const& scales);
+
+        /// The latest calibration, if a window has finished still.
+        [[nodiscard]]
+        std::optional<SensorCalibration> const& calibration() const {
+            return this->result;
+        }
+
+        /// Windows thrown away because the rocket moved.
+        [[nodiscard]]
+        uint32_t rejected() const {
+            return this->rejected_windows;
+        }
+
+    private:
+        /// Works out the calibration from a full window, if it was still.
+        std::optional<SensorCalibration> solve() const;
+
+        CalibrationConfig config;
+        /// BMI323 accel x y z (g), gyro x y z (dps), then ADXL375 x y z (g).
+        Welford<9> window;
+        std::optional<SensorCalibration> result;
+        uint32_t rejected_windows = 0;
+    };
+}
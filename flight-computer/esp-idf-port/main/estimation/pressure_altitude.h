@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace seds::estimation {
+    /// Converts barometer pressure to altitude without a `powf` per reading.
+    ///
+    /// The standard atmosphere gives the altitude above sea level at pressure p as
+    ///
+    ///     h(p) = H (1 - (p / P0)^k)
+    ///
+    /// Over `MIN_PRESSURE`..`MAX_PRESSURE` (about -700 m to 13.6 km), h(p) is stored as a table
+    /// of cubic segments built at compile time, so a conversion is a multiply, a truncation and
+    /// three multiply-adds. Outside that range it falls back to the formula.
+    ///
+    /// Altitude above a ground pressure g needs no extra transcendental per reading either:
+    /// H (1 - (p / g)^k) = (h(p) - h(g)) / (g / P0)^k, and the divisor only changes with g.
+    namespace pressure_altitude {
+        /// International standard atmosphere troposphere constants: sea level pressure (Pa),
+        /// height scale (m) and exponent.
+        constexpr double SEA_LEVEL_PRESSURE = 101325.0;
+        constexpr double HEIGHT_SCALE = 44330.77;
+        constexpr double EXPONENT = 0.190263;
+
+        /// The table's range, in Pa.
+        constexpr float MIN_PRESSURE = 15000.0f;
+        constexpr float MAX_PRESSURE = 110000.0f;
+        constexpr size_t SEGMENTS = 64;
+
+        /// Largest error of the table against the exact formula anywhere in its range, m. This
+        /// is checked when the table is built.
+        constexpr double MAX_ERROR = 0.01;
+
+        namespace detail {
+            // Just enough of <cmath> to build the table at compile time, in double precision
+
+            constexpr double ln(double x) {
+                // x = m 2^e with m near 1, then ln m = 2 atanh((m - 1) / (m + 1))
+                int e = 0;
+                while (x > 1.5) { x /= 2; e++; }
+                while (x < 0.75) { x *= 2; e--; }
+                double const z = (x - 1) / (x + 1);
+                double const z2 = z * z;
+                double term = z;
+                double sum = 0;
+                for (int n = 1; n < 60; n += 2) {
+                    sum += term / n;
+                    term *= z2;
+                }
+                return 2 * sum + e * 0.69314718055994530942;
+            }
+
+            constexpr double exp(double x) {
+                // x = n ln 2 + r with |r| <= ln 2 / 2, then a Taylor series for e^r
+                int const n = static_cast<int>(x / 0.69314718055994530942 + (x < 0 ? -0.5 : 0.5));
+                double const r = x - n * 0.69314718055994530942;
+                double term = 1;
+                double sum = 1;
+                for (int i = 1; i < 30; i++) {
+                    term *= r / i;
+                    sum += term;
+                }
+                for (int i = 0; i < n; i++) { sum *= 2; }
+                for (int i = 0; i > n; i--) { sum /= 2; }
+                return sum;
+            }
+
+            constexpr double altitude(double pressure) {
+                return HEIGHT_SCALE * (1 - exp(EXPONENT * ln(pressure / SEA_LEVEL_PRESSURE)));
+            }
+
+            constexpr double altitude_slope(double pressure) {
+                return -HEIGHT_SCALE * EXPONENT / pressure
+                    * exp(EXPONENT * ln(pressure / SEA_LEVEL_PRESSURE));
+            }
+
+            /// a + t (b + t (c + t d)) for t in [0, 1) across one segment.
+            struct Segment {
+                float a;
+                float b;
+                float c;
+                float d;
+
+                constexpr float operator()(float t) const {
+                    // std::fma isn't constexpr until C++26, and the compiler fuses these anyway
+                    return this->a + t * (this->b + t * (this->c + t * this->d));
+                }
+            };
+
+            constexpr double SEGMENT_WIDTH = (double(MAX_PRESSURE) - MIN_PRESSURE) / SEGMENTS;
+
+            /// Cubic Hermite segments: each matches h and dh/dp at both of its ends, so the
+            /// curve and its slope are continuous across segments.
+            constexpr std::array<Segment, SEGMENTS> build_table() {
+                std::array<Segment, SEGMENTS> table {};
+                for (size_t i = 0; i < SEGMENTS; i++) {
+                    double const p0 = MIN_PRESSURE + i * SEGMENT_WIDTH;
+                    double const p1 = p0 + SEGMENT_WIDTH;
+                    double const h0 = altitude(p0);
+                    double const h1 = altitude(p1);
+                    // Slopes per unit t rather than per Pa
+                    double const m0 = altitude_slope(p0) * SEGMENT_WIDTH;
+                    double const m1 = altitude_slope(p1) * SEGMENT_WIDTH;
+
+                    table[i] = Segment {
+                        .a = static_cast<float>(h0),
+                        .b = static_cast<float>(m0),
+                        .c = static_cast<float>(3 * (h1 - h0) - 2 * m0 - m1),
+                        .d = static_cast<float>(2 * (h0 - h1) + m0 + m1),
+                    };
+                }
+                return table;
+            }
+
+            inline constexpr std::array<Segment, SEGMENTS> TABLE = build_table();
+
+            constexpr float SEGMENTS_PER_PA = static_cast<float>(1 / SEGMENT_WIDTH);
+
+            /// The largest error of the table's float arithmetic against the exact formula over
+            /// `points` evenly spaced points in each segment, m.
+            constexpr double max_table_error(size_t points) {
+                double worst = 0;
+                for (size_t i = 0; i < SEGMENTS; i++) {
+                    for (size_t j = 0; j <= points; j++) {
+                        double const t = double(j) / points;
+                        double const pressure = MIN_PRESSURE + (i + t) * SEGMENT_WIDTH;
+                        double const error = TABLE[i](static_cast<float>(t)) - altitude(pressure);
+                        worst = error > worst ? error : (-error > worst ? -error : worst);
+                    }
+                }
+                return worst;
+            }
+
+            static_assert(max_table_error(16) < MAX_ERROR, "the altitude table is not accurate enough");
+            static_assert(
+                (altitude(SEA_LEVEL_PRESSURE) < 1e-9 && altitude(SEA_LEVEL_PRESSURE) > -1e-9),
+                "sea level must be at 0 m"
+            );
+        }
+
+        /// Altitude above sea level of the standard atmosphere at `pressure` (Pa), from the
+        /// formula with a `powf`. Reference for `standard_altitude`.
+        inline float exact_standard_altitude(float pressure) {
+            return static_cast<float>(HEIGHT_SCALE)
+                * (1.0f - std::pow(pressure / static_cast<float>(SEA_LEVEL_PRESSURE),
+                    static_cast<float>(EXPONENT)));
+        }
+
+        /// Altitude above sea level of the standard atmosphere at `pressure` (Pa), within
+        /// `MAX_ERROR` of the formula.
+        inline float standard_altitude(float pressure) {
+            auto const position = (pressure - MIN_PRESSURE) * detail::SEGMENTS_PER_PA;
+            // Written so that NaN also takes the slow path
+            if (!(position >= 0.0f && position < static_cast<float>(SEGMENTS))) {
+                return exact_standard_altitude(pressure);
+            }
+
+            auto const segment = static_cast<size_t>(position);
+            return detail::TABLE[segment](position - static_cast<float>(segment));
+        }
+    }
+
+    /// Altitude above a fixed ground pressure, using the table in `pressure_altitude`.
+    class AltitudeAboveGround {
+    public:
+        /// A converter for pressures measured against `ground_pressure` (Pa). This is the only
+        /// place the formula is evaluated.
+        explicit AltitudeAboveGround(float ground_pressure)
+            : ground_altitude(pressure_altitude::standard_altitude(ground_pressure))
+            , scale(std::pow(
+                static_cast<float>(pressure_altitude::SEA_LEVEL_PRESSURE) / ground_pressure,
+                static_cast<float>(pressure_altitude::EXPONENT)))
+        {}
+
+        AltitudeAboveGround() : AltitudeAboveGround(static_cast<float>(pressure_altitude::SEA_LEVEL_PRESSURE)) {}
+
+        /// Altitude above the ground pressure of the standard atmosphere at `pressure` (Pa), m.
+        float operator()(float pressure) const {
+            return (pressure_altitude::standard_altitude(pressure) - this->ground_altitude) * this->scale;
+        }
+
+    private:
+        float ground_altitude;
+        /// 1 / (ground pressure / P0)^k
+        float scale;
+    };
+}
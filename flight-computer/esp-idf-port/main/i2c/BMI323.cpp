@@ -28,19 +28,33 @@ namespace seds {
         CMD = 0x7E,
     };
 
-    // Both of these are exactly the values given, scaled up by 1000 for LSB/g
-    // However, the actual values are probably powers of two, so we could guess what they are and get slightly better precision
-    // For now, I'll use what I've found in the data sheet 
+    BMI323::BMI323(I2CDevice&& device) : device(std::move(device)) {}
 
-    const std::array<float, 4> accel_divisors {16380.0, 8190.0, 4010.0, 2050.0}; // LSB/g for ranges 2g, 4g, 8g, 16g
-    const std::array<float, 5> gyro_divisors {262.144, 131.072, 65.536, 32.768, 16.4}; // LSB/°/s for ranges 125, 250, 500, 1000, 2000 dps
+    namespace {
+        constexpr uint16_t NORMAL_MODE = 0x4;
+        constexpr uint16_t FATAL_ERROR = 0x1;
 
-    BMI323::BMI323(I2CDevice&& device) : device(std::move(device)) {}
+        uint16_t sensor_config(uint16_t range, BMI323::SensorHz hz) {
+            return ((NORMAL_MODE << 12) | (range << 4) | static_cast<uint16_t>(hz)) & 0x707F;
+        }
+    }
+
+    void BMI323::update_scale() {
+        auto accel_range = static_cast<size_t>(this->accel_range);
+        auto gyro_range = static_cast<size_t>(this->gyro_range);
+
+        // Precompute the reciprocals so conversion is a multiply instead of a divide
+        this->current_scale = IMUScale {
+            .g_per_lsb = 1.0f / accel_lsb_per_g[accel_range],
+            .dps_per_lsb = 1.0f / gyro_lsb_per_dps[gyro_range],
+            .accel_range = static_cast<uint8_t>(this->accel_range),
+            .gyro_range = static_cast<uint8_t>(this->gyro_range),
+            .sensor_hz = static_cast<uint8_t>(this->sensor_hz),
+        };
+    }
 
     Expected<std::monostate> BMI323::write_accel_config(AccelRange range, SensorHz hz) {
-        uint16_t acc_mode = 0x4; // normal mode
-        uint16_t acc_cfg = (acc_mode << 12) | (static_cast<uint16_t>(range) << 4) | static_cast<uint16_t>(hz);
-        acc_cfg &= 0x707F;
+        uint16_t acc_cfg = sensor_config(static_cast<uint16_t>(range), hz);
 
         TRY(
             this->device.write_le_register<uint16_t>(
@@ -53,9 +67,7 @@ namespace seds {
     }
 
     Expected<std::monostate> BMI323::write_gyro_config(GyroRange range, SensorHz hz) {
-        uint16_t gyr_mode = 0x4; // normal mode
-        uint16_t gyr_cfg = (gyr_mode << 12) | (static_cast<uint16_t>(range) << 4) | static_cast<uint16_t>(hz);
-        gyr_cfg &= 0x707F;
+        uint16_t gyr_cfg = sensor_config(static_cast<uint16_t>(range), hz);
 
         TRY(
             this->device.write_le_register<uint16_t>(
@@ -84,14 +96,44 @@ namespace seds {
         uint16_t acc_cfg = TRY(imu.device.read_le_register<uint32_t>(BMI323Register::ACC_CFG)) >> 16;
         ESP_LOGI("BMI323", "acc cfg: %x", acc_cfg);
 
-        TRY(imu.write_accel_config(imu.accel_range, imu.sensor_hz));
-        TRY(imu.write_gyro_config(imu.gyro_range, imu.sensor_hz));
+        TRY(imu.write_config());
+        imu.update_scale();
         
         ESP_LOGI("BMI323", "IMU created");
 
         return imu;
     }
 
+    Expected<std::monostate> BMI323::write_config() {
+        TRY(this->write_accel_config(this->accel_range, this->sensor_hz));
+        TRY(this->write_gyro_config(this->gyro_range, this->sensor_hz));
+
+        return std::monostate {};
+    }
+
+    Expected<ProbeResult> BMI323::probe() {
+        uint16_t const acc_cfg = TRY(this->device.read_le_register<uint32_t>(BMI323Register::ACC_CFG)) >> 16;
+        if (acc_cfg != sensor_config(static_cast<uint16_t>(this->accel_range), this->sensor_hz)) {
+            return ProbeResult::Reset;
+        }
+
+        uint16_t const err = TRY(this->device.read_le_register<uint32_t>(BMI323Register::ERR_REG)) >> 16;
+        this->faulted = err & FATAL_ERROR;
+        return this->faulted ? ProbeResult::Faulted : ProbeResult::Ok;
+    }
+
+    Expected<std::monostate> BMI323::reinit() {
+        // Only a soft reset clears a fatal error. It takes a couple of milliseconds, so leave the
+        // configuration for the next probe to find missing rather than waiting here.
+        if (this->faulted) {
+            TRY(this->device.write_le_register<uint16_t>(BMI323Register::CMD, 0xDEAF));
+            this->faulted = false;
+            return std::monostate {};
+        }
+
+        return this->write_config();
+    }
+
     bool BMI323::is_connected() {
         constexpr uint16_t dev_id = 0x0043;
         auto result = this->device.read_le_register<uint32_t>(BMI323Register::CHIP_ID);
@@ -132,6 +174,7 @@ namespace seds {
         TRY(this->write_accel_config(range, this->sensor_hz));
 
         this->accel_range = range;
+        this->update_scale();
 
         return std::monostate {};
     }
@@ -140,6 +183,7 @@ namespace seds {
         TRY(this->write_gyro_config(range, this->sensor_hz));
 
         this->gyro_range = range;
+        this->update_scale();
 
         return std::monostate {};
     }
@@ -149,36 +193,36 @@ namespace seds {
         TRY(this->write_gyro_config(this->gyro_range, hz));
 
         this->sensor_hz = hz;
+        this->update_scale();
 
         return std::monostate {};
     }
 
     Expected<IMUData> BMI323::read_imu() {
-        // The device sends 32-bit LE numbers, but the upper 16 bits are always zeroed out
-        // according to page 208 of the datasheet.
-
-        // Read accelerometer data
-        int16_t ax_raw = TRY((this->device.read_le_register<uint32_t>(BMI323Register::ACC_DATA_X))) >> 16;
-        int16_t ay_raw = TRY((this->device.read_le_register<uint32_t>(BMI323Register::ACC_DATA_Y))) >> 16;
-        int16_t az_raw = TRY((this->device.read_le_register<uint32_t>(BMI323Register::ACC_DATA_Z))) >> 16;
-
-        // Read gyroscope data
-        int16_t gx_raw = TRY((this->device.read_le_register<uint32_t>(BMI323Register::GYR_DATA_X))) >> 16;
-        int16_t gy_raw = TRY((this->device.read_le_register<uint32_t>(BMI323Register::GYR_DATA_Y))) >> 16;
-        int16_t gz_raw = TRY((this->device.read_le_register<uint32_t>(BMI323Register::GYR_DATA_Z))) >> 16;
-
-        auto accel_range = static_cast<size_t>(this->accel_range);
-        auto gyro_range = static_cast<size_t>(this->gyro_range);
+        return this->current_scale.convert(TRY(this->read_raw()));
+    }
 
-        IMUData data = {
-            .ax = static_cast<float>(ax_raw) / accel_divisors[accel_range],
-            .ay = static_cast<float>(ay_raw) / accel_divisors[accel_range],
-            .az = static_cast<float>(az_raw) / accel_divisors[accel_range],
-            .gx = static_cast<float>(gx_raw) / gyro_divisors[gyro_range],
-            .gy = static_cast<float>(gy_raw) / gyro_divisors[gyro_range],
-            .gz = static_cast<float>(gz_raw) / gyro_divisors[gyro_range],
+    Expected<IMURaw> BMI323::read_raw() {
+        // ACC_DATA_X through GYR_DATA_Z in one read: the register pointer moves on after each
+        // 16-bit register, so the two dummy bytes come only once, before the first. Six reads of
+        // one register each would hold the bus two and a half times as long.
+        constexpr auto first = static_cast<uint8_t>(BMI323Register::ACC_DATA_X);
+        constexpr auto last = static_cast<uint8_t>(BMI323Register::GYR_DATA_Z);
+        constexpr size_t len = 2 + 2 * (last - first + 1);
+        auto const data = TRY(this->device.write_read<len>(std::array { first }));
+
+        auto const word = [&](BMI323Register reg) {
+            auto const i = 2 + 2 * (static_cast<uint8_t>(reg) - first);
+            return static_cast<int16_t>(data[i] | (data[i + 1] << 8));
         };
 
-        return data;
+        return IMURaw {
+            .ax = word(BMI323Register::ACC_DATA_X),
+            .ay = word(BMI323Register::ACC_DATA_Y),
+            .az = word(BMI323Register::ACC_DATA_Z),
+            .gx = word(BMI323Register::GYR_DATA_X),
+            .gy = word(BMI323Register::GYR_DATA_Y),
+            .gz = word(BMI323Register::GYR_DATA_Z),
+        };
     }
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
+#include <array>
+
 #include "I2C.h"
+#include "sensor.h"
 
 namespace seds {
     using namespace seds::errors;
@@ -13,6 +16,38 @@ namespace seds {
         float gz;
     };  
 
+    /// IMU readings as raw signed counts, straight from the data registers.
+    struct IMURaw {
+        int16_t ax;
+        int16_t ay;
+        int16_t az;
+        int16_t gx;
+        int16_t gy;
+        int16_t gz;
+    };
+
+    /// What an IMURaw count means under the IMU's current configuration.
+    struct IMUScale {
+        float g_per_lsb;
+        float dps_per_lsb;
+        uint8_t accel_range;
+        uint8_t gyro_range;
+        uint8_t sensor_hz;
+
+        bool operator==(IMUScale const&) const = default;
+
+        IMUData convert(IMURaw const& raw) const {
+            return IMUData {
+                .ax = raw.ax * this->g_per_lsb,
+                .ay = raw.ay * this->g_per_lsb,
+                .az = raw.az * this->g_per_lsb,
+                .gx = raw.gx * this->dps_per_lsb,
+                .gy = raw.gy * this->dps_per_lsb,
+                .gz = raw.gz * this->dps_per_lsb,
+            };
+        }
+    };
+
     class BMI323 {
     public:
         // Is this an understandable way to do this?
@@ -50,6 +85,103 @@ namespace seds {
 
         static constexpr int16_t default_address = 0x68;
 
+        // How the IMU is logged (see sensor.h)
+        using Raw = IMURaw;
+        using Data = IMUData;
+        using Scale = IMUScale;
+
+        static constexpr std::array<LogField, 6> fields {{
+            {"accel x", "g", 2, true},
+            {"accel y", "g", 2, true},
+            {"accel z", "g", 2, true},
+            {"gyro x", "dps", 2, true},
+            {"gyro y", "dps", 2, true},
+            {"gyro z", "dps", 2, true},
+        }};
+
+        /// The fastest it can be set to. The current rate is in `scale()`.
+        static constexpr uint32_t rate_hz = 6400;
+
+        static constexpr std::array<int32_t, 6> counts(IMURaw const& raw) {
+            return { raw.ax, raw.ay, raw.az, raw.gx, raw.gy, raw.gz };
+        }
+
+        static constexpr IMURaw from_counts(std::array<int32_t, 6> const& counts) {
+            return IMURaw {
+                .ax = static_cast<int16_t>(counts[0]),
+                .ay = static_cast<int16_t>(counts[1]),
+                .az = static_cast<int16_t>(counts[2]),
+                .gx = static_cast<int16_t>(counts[3]),
+                .gy = static_cast<int16_t>(counts[4]),
+                .gz = static_cast<int16_t>(counts[5]),
+            };
+        }
+
+        static constexpr std::array<float, 6> values(IMUData const& data) {
+            return { data.ax, data.ay, data.az, data.gx, data.gy, data.gz };
+        }
+
+        static constexpr IMUData from_values(std::array<float, 6> const& values) {
+            return IMUData {
+                .ax = values[0], .ay = values[1], .az = values[2],
+                .gx = values[3], .gy = values[4], .gz = values[5],
+            };
+        }
+
+        static constexpr std::array<ConfigField, 3> config_fields {{
+            {"accel range", "g"},
+            {"gyro range", "dps"},
+            {"rate", "Hz"},
+        }};
+
+        static constexpr std::array<float, 6> per_count(IMUScale const& scale) {
+            auto const g = scale.g_per_lsb;
+            auto const dps = scale.dps_per_lsb;
+            return { g, g, g, dps, dps, dps };
+        }
+
+        static constexpr std::array<float, 3> config(IMUScale const& scale) {
+            return {
+                accel_range_g[scale.accel_range],
+                gyro_range_dps[scale.gyro_range],
+                rate_of(static_cast<SensorHz>(scale.sensor_hz)),
+            };
+        }
+
+        static constexpr IMUScale scale_from(std::array<float, 6> const& per_count,
+            std::array<float, 3> const& config)
+        {
+            uint8_t sensor_hz = static_cast<uint8_t>(SensorHz::__78125);
+            for (auto hz = sensor_hz; hz <= static_cast<uint8_t>(SensorHz::_6400); hz++) {
+                if (rate_of(static_cast<SensorHz>(hz)) <= config[2]) {
+                    sensor_hz = hz;
+                }
+            }
+
+            return IMUScale {
+                .g_per_lsb = per_count[0],
+                .dps_per_lsb = per_count[3],
+                .accel_range = index_of(accel_range_g, config[0]),
+                .gyro_range = index_of(gyro_range_dps, config[1]),
+                .sensor_hz = sensor_hz,
+            };
+        }
+
+        /// Full-scale ranges, indexed by AccelRange and GyroRange.
+        static constexpr std::array<float, 4> accel_range_g {2, 4, 8, 16};
+        static constexpr std::array<float, 5> gyro_range_dps {125, 250, 500, 1000, 2000};
+
+        /// Output data rate, halving from 6400 Hz with each step down.
+        static constexpr float rate_of(SensorHz hz) {
+            return 6400.0f / (1 << (static_cast<uint8_t>(SensorHz::_6400) - static_cast<uint8_t>(hz)));
+        }
+
+        // Sensitivities from the data sheet, indexed by AccelRange and GyroRange.
+        // However, the actual values are probably powers of two, so we could guess what they are
+        // and get slightly better precision.
+        static constexpr std::array<float, 4> accel_lsb_per_g {16380.0, 8190.0, 4100.0, 2050.0};
+        static constexpr std::array<float, 5> gyro_lsb_per_dps {262.144, 131.072, 65.536, 32.768, 16.4};
+
         [[nodiscard]]
         static Expected<BMI323> create(I2CDevice&& device);
 
@@ -60,6 +192,16 @@ namespace seds {
 
         bool is_connected();
 
+        /// Check that the IMU is still measuring as configured, with one or two register reads.
+        /// It comes back from a brownout in suspend, where every axis reads -32768.
+        [[nodiscard]]
+        Expected<ProbeResult> probe();
+
+        /// Put back the current ranges and rate after `probe` found the IMU reset, or soft reset
+        /// it if it found an error, without waiting. Probe again afterwards to finish the job.
+        [[nodiscard]]
+        Expected<std::monostate> reinit();
+
         [[nodiscard]]
         Expected<std::monostate> set_accel_range(AccelRange range);
 
@@ -69,8 +211,19 @@ namespace seds {
         [[nodiscard]]
         Expected<std::monostate> set_sensor_hz(SensorHz hz);
 
+        /// Read acceleration in g and rotation rates in °/s.
         [[nodiscard]]
         Expected<IMUData> read_imu();
+
+        /// Read acceleration and rotation rates as raw counts. Use `scale()` to interpret them.
+        [[nodiscard]]
+        Expected<IMURaw> read_raw();
+
+        /// How to convert raw counts under the current range settings.
+        [[nodiscard]]
+        IMUScale scale() const {
+            return this->current_scale;
+        }
         
     private:
         explicit BMI323(I2CDevice&& device);
@@ -81,9 +234,27 @@ namespace seds {
         [[nodiscard]]
         Expected<std::monostate> write_gyro_config(GyroRange range, SensorHz hz);
 
+        [[nodiscard]]
+        Expected<std::monostate> write_config();
+
+        void update_scale();
+
+        /// The index of the first entry of `table` at least `value`, or the last one.
+        template<size_t N>
+        static constexpr uint8_t index_of(std::array<float, N> const& table, float value) {
+            uint8_t i = 0;
+            while (size_t { i } + 1 < N && table[i] < value) {
+                i++;
+            }
+            return i;
+        }
+
         I2CDevice device;
         AccelRange accel_range; 
         GyroRange gyro_range;    
         SensorHz sensor_hz;
+        IMUScale current_scale;
+        /// The last probe found the error register set, so `reinit` has to soft reset.
+        bool faulted = false;
     };
 }
\ No newline at end of file
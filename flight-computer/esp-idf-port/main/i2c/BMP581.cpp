@@ -3,9 +3,6 @@
 #include "driver/i2c_master.h"
 #include "esp_log.h"
 
-const float temp_scale = 1.0f / 65536.0f; // 2^16
-const float press_scale = 1.0f / 64.0f; // 2^6
-
 static const char *TAG = "BMP581";
 
 namespace seds {
@@ -19,6 +16,9 @@ namespace seds {
         ODR_CONFIG = 0x37,
     };
 
+    // Normal mode at the fastest output rate, with deep standby left enabled
+    constexpr uint8_t ODR_CONFIG_NORMAL = 0x01;
+
     BMP581::BMP581(I2CDevice&& device) :
         device(std::move(device)) {
     }
@@ -27,24 +27,38 @@ namespace seds {
         BMP581 bmp581(std::move(device));
         if (!bmp581.is_connected()) {
             return std::unexpected(
-                std::make_unique<std::runtime_error>("BMP581 not connected or not responding")
+                std::make_unique<Error>("BMP581 not connected or not responding")
             );
         }
 
+        TRY(bmp581.write_config());
+
+        return bmp581;
+    }
+
+    Expected<std::monostate> BMP581::write_config() {
         // enter normal mode
-        TRY(bmp581.device.write_be_register<uint8_t>(
+        TRY(this->device.write_be_register<uint8_t>(
             BMP581Register::ODR_CONFIG,
-            0x01 // normal mode
+            ODR_CONFIG_NORMAL
         ));
 
         // try to set config for reading pressure 
-        TRY(bmp581.device.write_be_register<uint8_t>(
+        TRY(this->device.write_be_register<uint8_t>(
             BMP581Register::OSR_CONFIG,
             0b01010000 // temp oversampling x1, pressure oversampling x4 (standard resolution), pressure reading on 
         ));
-        
 
-        return bmp581;
+        return std::monostate {};
+    }
+
+    Expected<ProbeResult> BMP581::probe() {
+        auto const odr_config = TRY(this->device.read_be_register<uint8_t>(BMP581Register::ODR_CONFIG));
+        return odr_config == ODR_CONFIG_NORMAL ? ProbeResult::Ok : ProbeResult::Reset;
+    }
+
+    Expected<std::monostate> BMP581::reinit() {
+        return this->write_config();
     }
 
     bool BMP581::is_connected() {
@@ -64,15 +78,19 @@ namespace seds {
     }
 
     Expected<BarometerData> BMP581::read_data() {
+        return scale().convert(TRY(this->read_raw()));
+    }
+
+    Expected<BarometerRaw> BMP581::read_raw() {
         uint64_t raw_data = TRY(this->device.read_le_register<uint64_t>(BMP581Register::TMP_DATA));
-        int32_t raw_temp = raw_data & 0xFFFFFF; //TRY(this->device.read_le_register<uint32_t>(BMP581Register::TMP_DATA)) & 0xFFFFFF;
+        // Temperature is a signed 24-bit number, so shift it to the top and back to sign extend it
+        int32_t raw_temp = static_cast<int32_t>(static_cast<uint32_t>(raw_data) << 8) >> 8;
         int32_t raw_press = (raw_data >> 24) & 0xFFFFFF;//TRY(this->device.read_le_register<uint32_t>(BMP581Register::PRESS_DATA)) & 0xFFFFFF;
 
-        BarometerData data;
-        data.baro_temp = static_cast<float>(raw_temp) * temp_scale;
-        data.pressure = static_cast<float>(raw_press) * press_scale;
-
-        return data;
+        return BarometerRaw {
+            .temp = raw_temp,
+            .pressure = raw_press,
+        };
     }
 
 }
\ No newline at end of file
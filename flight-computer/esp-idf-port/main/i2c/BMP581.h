@@ -1,6 +1,7 @@
 #pragma once
 
 #include "I2C.h"
+#include "sensor.h"
 
 namespace seds {
     using namespace seds::errors;
@@ -10,12 +11,80 @@ namespace seds {
         float pressure;
     };
 
+    /// Barometer readings as raw 24-bit counts.
+    struct BarometerRaw {
+        int32_t temp;
+        int32_t pressure;
+    };
+
+    /// What a BarometerRaw count means. These are fixed by the data sheet.
+    struct BarometerScale {
+        float c_per_lsb = 1.0f / 65536.0f; // 2^16
+        float pa_per_lsb = 1.0f / 64.0f; // 2^6
+
+        bool operator==(BarometerScale const&) const = default;
+
+        BarometerData convert(BarometerRaw const& raw) const {
+            return BarometerData {
+                .baro_temp = raw.temp * this->c_per_lsb,
+                .pressure = raw.pressure * this->pa_per_lsb,
+            };
+        }
+    };
+
     class BMP581 : std::enable_shared_from_this<BMP581> {
     public:
         // No default address since there are two, so we should specify each
         static constexpr int16_t address_1 = 0x46;
         static constexpr int16_t address_2 = 0x47;
 
+        // How a barometer is logged (see sensor.h)
+        using Raw = BarometerRaw;
+        using Data = BarometerData;
+        using Scale = BarometerScale;
+
+        static constexpr std::array<LogField, 2> fields {{
+            {"temp", "C", 3, true},
+            {"pressure", "Pa", 3, false},
+        }};
+
+        /// In the normal mode `create` sets.
+        static constexpr uint32_t rate_hz = 240;
+
+        static constexpr std::array<int32_t, 2> counts(BarometerRaw const& raw) {
+            return { raw.temp, raw.pressure };
+        }
+
+        static constexpr BarometerRaw from_counts(std::array<int32_t, 2> const& counts) {
+            return BarometerRaw { .temp = counts[0], .pressure = counts[1] };
+        }
+
+        static constexpr std::array<float, 2> values(BarometerData const& data) {
+            return { data.baro_temp, data.pressure };
+        }
+
+        static constexpr BarometerData from_values(std::array<float, 2> const& values) {
+            return BarometerData { .baro_temp = values[0], .pressure = values[1] };
+        }
+
+        static constexpr std::array<ConfigField, 1> config_fields {{
+            {"rate", "Hz"},
+        }};
+
+        static constexpr std::array<float, 2> per_count(BarometerScale const& scale) {
+            return { scale.c_per_lsb, scale.pa_per_lsb };
+        }
+
+        static constexpr std::array<float, 1> config(BarometerScale const&) {
+            return { rate_hz };
+        }
+
+        static constexpr BarometerScale scale_from(std::array<float, 2> const& per_count,
+            std::array<float, 1> const&)
+        {
+            return BarometerScale { .c_per_lsb = per_count[0], .pa_per_lsb = per_count[1] };
+        }
+
         [[nodiscard]]
         static Expected<BMP581> create(I2CDevice&& device);
 
@@ -28,13 +97,34 @@ namespace seds {
         /// Check whether the device is a working BMP581 barometer.
         bool is_connected();
 
+        /// Check that the barometer is still measuring, with one register read. It comes back
+        /// from a brownout in standby, where its readings stop changing.
+        [[nodiscard]]
+        Expected<ProbeResult> probe();
+
+        /// Put the configuration from `create` back after `probe` found the barometer reset.
+        [[nodiscard]]
+        Expected<std::monostate> reinit();
+
         /// Read the last temperature and pressure measurement from the sensor.
         [[nodiscard]]
         Expected<BarometerData> read_data();
 
+        /// Read the last temperature and pressure measurement as raw counts.
+        [[nodiscard]]
+        Expected<BarometerRaw> read_raw();
+
+        [[nodiscard]]
+        static constexpr BarometerScale scale() {
+            return BarometerScale {};
+        }
+
     private:
         explicit BMP581(I2CDevice&& device);
 
+        [[nodiscard]]
+        Expected<std::monostate> write_config();
+
         I2CDevice device;
     };
 }
\ No newline at end of file
@@ -1,13 +1,15 @@
 #include "I2C.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <expected>
 
 #include "driver/i2c_master.h"
+#include "esp_timer.h"
 
 namespace seds {
-    constexpr uint32_t i2c_baudrate = 100'000;
+    static const char* TAG = "i2c";
 
     I2C::I2C(Private) {
         // These values are mostly pulled from the ESP IDF example for I2C.
@@ -30,16 +32,59 @@ namespace seds {
         ESP_ERROR_CHECK(i2c_del_master_bus(this->handle()));
     }
 
+    void I2C::recover() {
+        this->reset_count++;
+        auto const result = i2c_master_bus_reset(this->handle());
+        if (result != ESP_OK) {
+            ESP_LOGE(TAG, "bus reset failed: %s", esp_err_to_name(result));
+        }
+    }
+
+    bool I2C::backed_off() const {
+        return esp_timer_get_time() < this->retry_at_us;
+    }
+
+    void I2C::timed_out() {
+        // Timing out again with nothing getting through since the last reset means the bus is
+        // still held, and every device would wait out its own timeout on it
+        if (this->stuck) {
+            auto const backoff = std::min<std::chrono::microseconds>(
+                I2CDevice::FIRST_BACKOFF * (1 << this->backoffs), I2CDevice::MAX_BACKOFF);
+            ESP_LOGW(TAG, "bus still held after a reset, backing off for %lld ms",
+                static_cast<long long>(backoff.count() / 1000));
+
+            this->retry_at_us = esp_timer_get_time() + backoff.count();
+            this->backoffs = std::min<uint8_t>(this->backoffs + 1, 16);
+        }
+        this->stuck = true;
+        this->recover();
+    }
+
+    void I2C::answered() {
+        if (this->backoffs > 0) {
+            ESP_LOGI(TAG, "bus is free again");
+        }
+        this->stuck = false;
+        this->backoffs = 0;
+        this->retry_at_us = 0;
+    }
+
     Expected<I2CDevice> I2C::get_device(uint16_t address) {
-        auto [_, did_insert] = this->used_addresses.insert(address);
+        // Devices are added with 7-bit addresses
+        if (address >= this->used_addresses.size()) {
+            return std::unexpected(
+                std::make_unique<Error>("Address out of range")
+            );
+        }
 
         // Don't allow duplicate devices to prevent two subsystems writing to the same place
         // and causing interference.
-        if (!did_insert) {
+        if (this->used_addresses.test(address)) {
             return std::unexpected(
-                std::make_unique<std::runtime_error>("Address in use")
+                std::make_unique<Error>("Address in use")
             );
         }
+        this->used_addresses.set(address);
 
         ESP_LOGI("i2c", "Making I2CDevice");
 
@@ -52,7 +97,8 @@ namespace seds {
         i2c_device_config_t dev_config = {
             .dev_addr_length = I2C_ADDR_BIT_LEN_7,
             .device_address = address,
-            .scl_speed_hz = i2c_baudrate,
+            .scl_speed_hz = BAUDRATE,
+            .scl_wait_us = SCL_WAIT_US,
         };
 
         ESP_ERROR_CHECK(
@@ -65,7 +111,57 @@ namespace seds {
         // (In that case, there's no need to free anything.)
         if (this->bus) {
             ESP_ERROR_CHECK(i2c_master_bus_rm_device(this->handle()));
-            this->bus->used_addresses.erase(this->address);
+            this->bus->used_addresses.reset(this->address);
+        }
+    }
+
+    bool I2CDevice::backed_off() const {
+        return esp_timer_get_time() < this->retry_at_us;
+    }
+
+    Expected<std::monostate> I2CDevice::check_backoff() const {
+        if (this->bus->backed_off()) {
+            return std::unexpected(
+                std::make_unique<Error>("I2C bus backed off after timing out repeatedly")
+            );
+        }
+        if (this->backed_off()) {
+            return std::unexpected(
+                std::make_unique<Error>("I2C device backed off after failing repeatedly")
+            );
+        }
+        return std::monostate {};
+    }
+
+    esp_err_t I2CDevice::record(esp_err_t result) {
+        // A timeout rather than a NACK means something is holding the bus, which would fail
+        // every other device's transactions too
+        if (result == ESP_ERR_TIMEOUT) {
+            this->bus->timed_out();
+        } else {
+            this->bus->answered();
+        }
+
+        if (result == ESP_OK) {
+            if (this->backoffs > 0) {
+                ESP_LOGI(TAG, "device %x is answering again", this->address);
+            }
+            this->failures = 0;
+            this->backoffs = 0;
+            return result;
+        }
+
+        if (++this->failures >= FAILURES_BEFORE_BACKOFF) {
+            auto const backoff = std::min<std::chrono::microseconds>(
+                FIRST_BACKOFF * (1 << this->backoffs), MAX_BACKOFF);
+            ESP_LOGW(TAG, "device %x failed %d times, backing off for %lld ms", this->address,
+                this->failures, static_cast<long long>(backoff.count() / 1000));
+
+            this->retry_at_us = esp_timer_get_time() + backoff.count();
+            this->backoffs = std::min<uint8_t>(this->backoffs + 1, 16);
+            // One more failure when it's next tried backs it off again, for longer
+            this->failures = FAILURES_BEFORE_BACKOFF - 1;
         }
+        return result;
     }
 }
@@ -1,7 +1,7 @@
 #pragma once
 #include <expected>
 #include <memory>
-#include <set>
+#include <bitset>
 #include <chrono>
 #include <algorithm>
 #include <string>
@@ -22,6 +22,17 @@ namespace seds {
 
     class I2CDevice;
 
+    /// What a driver's health probe found. A device that doesn't answer at all is an error
+    /// instead.
+    enum class ProbeResult : uint8_t {
+        /// Running as the driver configured it.
+        Ok,
+        /// Back in its power-on configuration, most likely after a brownout. `reinit()` fixes it.
+        Reset,
+        /// Reporting an internal error. `reinit()` may fix it.
+        Faulted,
+    };
+
     /// An I2C bus.
     class I2C : public std::enable_shared_from_this<I2C> {
         // Used to prevent construction except by create().
@@ -68,18 +79,81 @@ namespace seds {
             return this->bus_handle;
         }
 
+        /// Clock SCL until whatever device is holding SDA low lets go, then send a stop. A device
+        /// left mid-byte by a glitch or a brownout holds the bus until this happens, and every
+        /// transaction to every device times out until then.
+        void recover();
+
+        /// How many times the bus has been reset by `recover()`.
+        [[nodiscard]]
+        uint32_t resets() const {
+            return this->reset_count;
+        }
+
+        /// Whether every device's transactions are failing without being attempted, because the
+        /// bus is still held after a reset.
+        [[nodiscard]]
+        bool backed_off() const;
+
     private:
         friend class I2CDevice;
 
+        /// Track a transaction that timed out: reset the bus, and back it off if the last reset
+        /// didn't free it.
+        void timed_out();
+
+        /// Track a transaction that didn't time out, which shows the bus is free.
+        void answered();
+
         i2c_master_bus_handle_t bus_handle { nullptr };
-        std::set<uint16_t> used_addresses;
+        uint32_t reset_count = 0;
+        /// Whether a transaction has timed out since the last one that didn't.
+        bool stuck = false;
+        /// Backoffs in a row, and when the bus is next tried. Devices back off the same way.
+        uint8_t backoffs = 0;
+        int64_t retry_at_us = 0;
+        /// Indexed by 7-bit address. (A set would allocate a node per device.)
+        std::bitset<128> used_addresses;
     };
 
     /// A unique I2C device. It is a type invariant that there is no other I2C device
     /// with this address on the same bus.
+    ///
+    /// A device that fails `FAILURES_BEFORE_BACKOFF` transactions in a row is backed off: its
+    /// transactions fail straight away without touching the bus, and it is tried again after
+    /// `FIRST_BACKOFF`, doubling up to `MAX_BACKOFF` for as long as it keeps failing. That way an
+    /// unplugged sensor costs the other sensors on the bus nothing most of the time.
+    ///
+    /// A held bus times out every device, so the bus backs off as a whole once a reset hasn't
+    /// freed it, on the same schedule. With `SCL_WAIT_US` bounding each timeout, a jammed bus
+    /// costs a sample no more than two timeouts and two resets.
     class I2CDevice {
     public:
-        static constexpr auto timeout = 1000ms;
+        /// SCL frequency of every device: fast mode, which every sensor on the bus supports. At
+        /// 100 kHz one round of sensor reads takes longer than the boost phase's sampling period.
+        static constexpr uint32_t BAUDRATE = 400'000;
+
+        /// How long a device may hold SCL low before the controller gives up on the transaction.
+        /// None of the sensors stretch the clock, so a device holding it longer is hung, and
+        /// waiting for the millisecond `timeout_ms` would hold up the whole loop.
+        static constexpr uint32_t SCL_WAIT_US = 100;
+
+        static constexpr uint8_t FAILURES_BEFORE_BACKOFF = 3;
+        static constexpr auto FIRST_BACKOFF = 10ms;
+        static constexpr auto MAX_BACKOFF = 1000ms;
+
+        /// Deadline for a transaction that writes `write_bytes` and then reads `read_bytes`: twice
+        /// its time on the wire, rounded up to the milliseconds the ESP-IDF driver counts in. A
+        /// healthy device never gets close, so a miss means the device or bus is stuck. A device
+        /// holding SCL hits `SCL_WAIT_US` long before this.
+        static constexpr int timeout_ms(size_t write_bytes, size_t read_bytes) {
+            // Nine clocks per byte with its ACK. Reads send the address again after a repeated
+            // start, and each start or stop takes about a clock.
+            auto const bytes = 1 + write_bytes + (read_bytes > 0 ? 1 + read_bytes : 0);
+            auto const clocks = bytes * 9 + (read_bytes > 0 ? 3 : 2);
+            auto const wire_us = clocks * 1'000'000 / BAUDRATE;
+            return static_cast<int>((2 * wire_us + 999) / 1000);
+        }
 
         // Disallow accidentally making duplicates
         I2CDevice(I2CDevice const&) = delete;
@@ -97,17 +171,16 @@ namespace seds {
         ) {
             std::array<uint8_t, ReadN> read_buf;
 
+            TRY(this->check_backoff());
             ESP_TRY(
-                i2c_master_transmit_receive(
+                this->record(i2c_master_transmit_receive(
                     this->handle(),
                     write_buf.data(),
                     write_buf.size(),
                     read_buf.data(),
                     read_buf.size(),
-                    // I'm not totally sure why we need to divide by the tick period here, but it
-                    // was in the I2C example.
-                    timeout.count() / portTICK_PERIOD_MS
-                )
+                    timeout_ms(WriteN, ReadN)
+                ))
             );
 
             return read_buf;
@@ -119,15 +192,14 @@ namespace seds {
         Expected<std::monostate> write(
             std::array<uint8_t, WriteN> const& write_buf
         ) {
+            TRY(this->check_backoff());
             ESP_TRY(
-                i2c_master_transmit(
+                this->record(i2c_master_transmit(
                     this->handle(),
                     write_buf.data(),
                     write_buf.size(),
-                    // I'm not totally sure why we need to divide by the tick period here, but it
-                    // was in the I2C example.
-                    timeout.count() / portTICK_PERIOD_MS
-                )
+                    timeout_ms(WriteN, 0)
+                ))
             );
 
             return std::monostate {};
@@ -215,13 +287,32 @@ namespace seds {
             return this->dev_handle;
         }
 
+        /// Whether transactions are currently failing without being attempted.
+        [[nodiscard]]
+        bool backed_off() const;
+
     private:
         // This constructor is called from I2C::get_device, which has some extra checks.
         friend class I2C;
         I2CDevice(std::shared_ptr<I2C> bus, uint16_t address);
 
+        /// Returns an error if the device or the bus is backed off.
+        Expected<std::monostate> check_backoff() const;
+
+        /// Track the result of a transaction for the backoff, and recover the bus if it timed
+        /// out. Returns `result`.
+        esp_err_t record(esp_err_t result);
+
         std::shared_ptr<I2C> bus;
         uint16_t address;
         i2c_master_dev_handle_t dev_handle { nullptr };
+        uint8_t failures = 0;
+        /// How many backoffs in a row, which sets how long the next one lasts.
+        uint8_t backoffs = 0;
+        int64_t retry_at_us = 0;
     };
+
+    // A 16-bit register read, and the longest burst any driver does (the BMI323's fourteen bytes)
+    static_assert(I2CDevice::timeout_ms(1, 2) == 1);
+    static_assert(I2CDevice::timeout_ms(1, 14) == 1);
 }
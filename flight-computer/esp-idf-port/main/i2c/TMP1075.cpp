@@ -32,6 +32,10 @@ namespace seds {
     }
 
     Expected<float> TMP1075::read_temperature() {
+        return TRY(this->read_raw()) * c_per_lsb;
+    }
+
+    Expected<int16_t> TMP1075::read_raw() {
         // https://www.ti.com/lit/an/sbaa588a/sbaa588a.pdf?ts=1760629136511
 
         // Bits 15-4 contain signed big-endian temperature, 3-0 are unused
@@ -40,8 +44,7 @@ namespace seds {
         // Move the entire int down into the first few bytes. (Sign extension is automatic.)
         temp_raw >>= 4;
 
-        // Apply resolution scaling factor specified in data sheet
-        return static_cast<float>(temp_raw) * 0.0625f;
+        return temp_raw;
     }
 
     constexpr uint8_t ONESHOT_OFFSET = 15;
@@ -58,6 +61,19 @@ namespace seds {
         return this->device.write_be_register(TMP1075Register::CFGR, config_data);
     }
 
+    Expected<ProbeResult> TMP1075::probe() {
+        auto const config = TRY(this->read_config());
+        if (config.rate != this->current_config.rate
+            || config.is_shutdown != this->current_config.is_shutdown) {
+            return ProbeResult::Reset;
+        }
+        return ProbeResult::Ok;
+    }
+
+    Expected<std::monostate> TMP1075::reinit() {
+        return this->write_config(this->current_config, false);
+    }
+
     Expected<TMP1075::Config> TMP1075::read_config() {
         auto const reg = TRY(this->device.read_be_register<uint16_t>(TMP1075Register::CFGR));
 
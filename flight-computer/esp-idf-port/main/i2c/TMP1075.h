@@ -1,16 +1,74 @@
 #pragma once
-#include <functional>
+#include <concepts>
 
 #include "I2C.h"
+#include "sensor.h"
 
 namespace seds {
     using namespace seds::errors;
 
+    /// What a TMP1075 count means. Fixed by the data sheet.
+    struct TemperatureScale {
+        float c_per_lsb = 0.0625f;
+
+        bool operator==(TemperatureScale const&) const = default;
+
+        float convert(int16_t raw) const {
+            return raw * this->c_per_lsb;
+        }
+    };
+
     /// TMP1075 Temperature sensor.
     class TMP1075 {
     public:
         static constexpr int16_t default_address = 0x48;
 
+        // How the sensor is logged (see sensor.h)
+        using Raw = int16_t;
+        using Data = float;
+        using Scale = TemperatureScale;
+
+        static constexpr std::array<LogField, 1> fields {{
+            {"", "C", 2, true},
+        }};
+
+        /// At the default conversion period of 27.5 ms.
+        static constexpr uint32_t rate_hz = 36;
+
+        static constexpr std::array<int32_t, 1> counts(int16_t raw) {
+            return { raw };
+        }
+
+        static constexpr int16_t from_counts(std::array<int32_t, 1> const& counts) {
+            return static_cast<int16_t>(counts[0]);
+        }
+
+        static constexpr std::array<float, 1> values(float data) {
+            return { data };
+        }
+
+        static constexpr float from_values(std::array<float, 1> const& values) {
+            return values[0];
+        }
+
+        static constexpr std::array<ConfigField, 1> config_fields {{
+            {"rate", "Hz"},
+        }};
+
+        static constexpr std::array<float, 1> per_count(TemperatureScale const& scale) {
+            return { scale.c_per_lsb };
+        }
+
+        static constexpr std::array<float, 1> config(TemperatureScale const&) {
+            return { rate_hz };
+        }
+
+        static constexpr TemperatureScale scale_from(std::array<float, 1> const& per_count,
+            std::array<float, 1> const&)
+        {
+            return TemperatureScale { .c_per_lsb = per_count[0] };
+        }
+
         explicit TMP1075(I2CDevice&& device);
 
         // No copies allowed since we hold unique state
@@ -43,15 +101,36 @@ namespace seds {
         /// Check whether the device is a working TMP1075 temperature sensor.
         bool is_connected();
 
+        /// Check that the sensor still has the configuration last written to it, with one read.
+        [[nodiscard]]
+        Expected<ProbeResult> probe();
+
+        /// Write the configuration back after `probe` found the sensor reset.
+        [[nodiscard]]
+        Expected<std::monostate> reinit();
+
         /// Read the last temperature measurement from the sensor in degrees Celsius.
         [[nodiscard]]
         Expected<float> read_temperature();
 
+        /// Read the last temperature measurement as a raw 12-bit signed count.
+        [[nodiscard]]
+        Expected<int16_t> read_raw();
+
+        /// Degrees Celsius per raw count, as specified in the data sheet.
+        static constexpr float c_per_lsb = TemperatureScale {}.c_per_lsb;
+
+        [[nodiscard]]
+        static constexpr TemperatureScale scale() {
+            return TemperatureScale {};
+        }
+
         /// Run a closure which can read the device's current configuration and update it
         /// as desired.
         ///
         /// Any updates are propagated to the device after the closure finishes running.
-        Expected<std::monostate> update_config(std::function<void(Config &)> const& updater) {
+        template<std::invocable<Config&> Updater>
+        Expected<std::monostate> update_config(Updater&& updater) {
             this->current_config = TRY(this->read_config());
             updater(this->current_config);
             return this->write_config(this->current_config, false);
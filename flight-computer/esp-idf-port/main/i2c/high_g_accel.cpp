@@ -14,32 +14,57 @@ namespace seds {
         DATAZ0 = 0x36,
     };
 
-    constexpr float accel_sense = 20.5; 
+    constexpr uint8_t DATA_FORMAT_RIGHT_JUSTIFIED = 0x08;
+    constexpr uint8_t POWER_CTL_MEASURE = 0x08;
 
     HighGAccel::HighGAccel(I2CDevice&& device) : device(std::move(device)) {}
 
     Expected<HighGAccel> HighGAccel::create(I2CDevice&& device)  {
         auto accel = HighGAccel(std::move(device));
 
+        TRY(accel.write_config());
+
+        ESP_LOGI("HighGAccel", "High-g accelerometer created");
+
+        return accel;
+    }
+
+    Expected<std::monostate> HighGAccel::write_config() {
         /// Initialize the accelerometer: Full resolution, ±200g
         TRY(
-            accel.device.write_be_register<uint8_t>(
+            this->device.write_be_register<uint8_t>(
                 ADXL375Register::DATA_FORMAT,
-                0x08 // right justified
+                DATA_FORMAT_RIGHT_JUSTIFIED
             )
         );
 
         /// Set measure bit to start measurements
         TRY(
-            accel.device.write_be_register<uint8_t>(
+            this->device.write_be_register<uint8_t>(
                 ADXL375Register::POWER_CTL,
-                0x08
+                POWER_CTL_MEASURE
             )
         );
 
-        ESP_LOGI("HighGAccel", "High-g accelerometer created");
+        return std::monostate {};
+    }
 
-        return accel;
+    Expected<ProbeResult> HighGAccel::probe() {
+        // POWER_CTL through DATA_FORMAT in one read
+        constexpr auto first = static_cast<uint8_t>(ADXL375Register::POWER_CTL);
+        constexpr auto last = static_cast<uint8_t>(ADXL375Register::DATA_FORMAT);
+        auto const regs = TRY(this->device.write_read<last - first + 1>(std::array { first }));
+        auto const power_ctl = regs[0];
+        auto const data_format = regs[last - first];
+
+        if (power_ctl != POWER_CTL_MEASURE || data_format != DATA_FORMAT_RIGHT_JUSTIFIED) {
+            return ProbeResult::Reset;
+        }
+        return ProbeResult::Ok;
+    }
+
+    Expected<std::monostate> HighGAccel::reinit() {
+        return this->write_config();
     }
 
     bool HighGAccel::is_connected() {
@@ -51,18 +76,17 @@ namespace seds {
 
     
     Expected<HighGAccelData> HighGAccel::read_acceleration() {
+        return scale().convert(TRY(this->read_raw()));
+    }
+
+    Expected<HighGAccelRaw> HighGAccel::read_raw() {
         // FIXME: read all sensors at once
         auto raw_data = TRY(this->device.read_le_register<uint64_t>(ADXL375Register::DATAX0)) & 0xFFFFFFFFFFFF;
 
-        auto x = (int16_t)raw_data;
-        auto y = (int16_t)(raw_data >> 16);
-        auto z = (int16_t)(raw_data >> 32);
-
-        HighGAccelData data;
-        data.h_ax = static_cast<float>(x) / accel_sense;
-        data.h_ay = static_cast<float>(y) / accel_sense;
-        data.h_az = static_cast<float>(z) / accel_sense;
-
-        return data;
+        return HighGAccelRaw {
+            .x = (int16_t)raw_data,
+            .y = (int16_t)(raw_data >> 16),
+            .z = (int16_t)(raw_data >> 32),
+        };
     }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "I2C.h"
+#include "sensor.h"
 
 namespace seds {
     using namespace seds::errors;
@@ -10,23 +11,121 @@ namespace seds {
         float h_az;
     };
 
+    /// High-g readings as raw signed counts.
+    struct HighGAccelRaw {
+        int16_t x;
+        int16_t y;
+        int16_t z;
+    };
+
+    /// What a HighGAccelRaw count means. The ADXL375 has a single fixed range.
+    struct HighGAccelScale {
+        float g_per_lsb = 1.0f / 20.5f;
+
+        bool operator==(HighGAccelScale const&) const = default;
+
+        HighGAccelData convert(HighGAccelRaw const& raw) const {
+            return HighGAccelData {
+                .h_ax = raw.x * this->g_per_lsb,
+                .h_ay = raw.y * this->g_per_lsb,
+                .h_az = raw.z * this->g_per_lsb,
+            };
+        }
+    };
+
     /// ADXL375BCCZ high-g accelerometer
     class HighGAccel {
     public:
         static constexpr int16_t default_address = 0x53;
 
+        // How the accelerometer is logged (see sensor.h)
+        using Raw = HighGAccelRaw;
+        using Data = HighGAccelData;
+        using Scale = HighGAccelScale;
+
+        static constexpr std::array<LogField, 3> fields {{
+            {"accel x", "g", 2, true},
+            {"accel y", "g", 2, true},
+            {"accel z", "g", 2, true},
+        }};
+
+        /// The power-on rate, which `create` leaves alone.
+        static constexpr uint32_t rate_hz = 100;
+
+        static constexpr std::array<int32_t, 3> counts(HighGAccelRaw const& raw) {
+            return { raw.x, raw.y, raw.z };
+        }
+
+        static constexpr HighGAccelRaw from_counts(std::array<int32_t, 3> const& counts) {
+            return HighGAccelRaw {
+                .x = static_cast<int16_t>(counts[0]),
+                .y = static_cast<int16_t>(counts[1]),
+                .z = static_cast<int16_t>(counts[2]),
+            };
+        }
+
+        static constexpr std::array<float, 3> values(HighGAccelData const& data) {
+            return { data.h_ax, data.h_ay, data.h_az };
+        }
+
+        static constexpr HighGAccelData from_values(std::array<float, 3> const& values) {
+            return HighGAccelData { .h_ax = values[0], .h_ay = values[1], .h_az = values[2] };
+        }
+
+        /// The ADXL375's range is fixed at ±200 g.
+        static constexpr float range_g = 200;
+
+        static constexpr std::array<ConfigField, 2> config_fields {{
+            {"range", "g"},
+            {"rate", "Hz"},
+        }};
+
+        static constexpr std::array<float, 3> per_count(HighGAccelScale const& scale) {
+            return { scale.g_per_lsb, scale.g_per_lsb, scale.g_per_lsb };
+        }
+
+        static constexpr std::array<float, 2> config(HighGAccelScale const&) {
+            return { range_g, rate_hz };
+        }
+
+        static constexpr HighGAccelScale scale_from(std::array<float, 3> const& per_count,
+            std::array<float, 2> const&)
+        {
+            return HighGAccelScale { .g_per_lsb = per_count[0] };
+        }
+
         /// Should this function initialize reading?
         [[nodiscard]]
         static Expected<HighGAccel> create(I2CDevice&& device);
 
         bool is_connected();
 
+        /// Check that the accelerometer is still measuring, with one read. It comes back from a
+        /// brownout in standby, where its readings stop changing.
+        [[nodiscard]]
+        Expected<ProbeResult> probe();
+
+        /// Put the configuration from `create` back after `probe` found the accelerometer reset.
+        [[nodiscard]]
+        Expected<std::monostate> reinit();
+
         [[nodiscard]]
         Expected<HighGAccelData> read_acceleration();
 
+        [[nodiscard]]
+        Expected<HighGAccelRaw> read_raw();
+
+        [[nodiscard]]
+        static constexpr HighGAccelScale scale() {
+            return HighGAccelScale {};
+        }
+
     private:
         explicit HighGAccel(I2CDevice&& device);
 
+        [[nodiscard]]
+        Expected<std::monostate> write_config();
+
         I2CDevice device;
     };
 }
\ No newline at end of file
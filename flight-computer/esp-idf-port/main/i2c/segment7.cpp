@@ -1,5 +1,7 @@
 #include "segment7.h"
 
+#include <algorithm>
+
 #include "driver/i2c_master.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -40,8 +42,12 @@ namespace seds {
     }
 
 
-    Expected<std::monostate> SegmentDisplay::set_msg(const std::string msg) {
-        this->msg = std::vector<uint8_t>(msg.begin(), msg.end());
+    Expected<std::monostate> SegmentDisplay::set_msg(std::string_view msg) {
+        if (msg.size() > max_msg_len) {
+            ESP_LOGW("7segment", "message cut off at %zu characters", max_msg_len);
+        }
+        this->msg_len = std::min(msg.size(), max_msg_len);
+        std::copy_n(msg.begin(), this->msg_len, this->msg.begin());
         this->msg_offset = 0;
         if (auto ret = this->start_timer(false); !ret.has_value()) {
             ESP_LOGE("7segment", "timer start: %s", ret.error()->what());
@@ -52,7 +58,7 @@ namespace seds {
     Expected<std::monostate> SegmentDisplay::clear_msg() {
         ESP_TRY(esp_timer_stop(this->scroll_timer));
         ESP_TRY(esp_timer_delete(this->scroll_timer));
-        this->msg.clear();
+        this->msg_len = 0;
         this->msg_offset = 0;
         // Clear both displays
         TRY(this->left_display.set_segments(0x00));
@@ -61,7 +67,7 @@ namespace seds {
     }
 
     Expected<std::monostate> SegmentDisplay::scroll_msg() {
-        if (this->msg.empty()) {
+        if (this->msg_len == 0) {
             // Nothing to do
             return std::monostate {};
         }
@@ -69,18 +75,18 @@ namespace seds {
         // Display two characters starting from msg_offset
         uint8_t left_char = this->msg[this->msg_offset];
         uint8_t right_char = ' ';
-        if (this->msg_offset + 1 < this->msg.size()) {
+        if (this->msg_offset + 1 < this->msg_len) {
             right_char = this->msg[this->msg_offset + 1];
         }
 
         TRY(this->left_display.set_segments(left_char));
         TRY(this->right_display.set_segments(right_char));
 
-        if (this->msg_offset + 1 >= this->msg.size()) {
+        if (this->msg_offset + 1 >= this->msg_len) {
             // don't overshoot the beginning of the message
             this->msg_offset = 0;
         } else {
-            this->msg_offset = (this->msg_offset + 2) % this->msg.size();
+            this->msg_offset = (this->msg_offset + 2) % this->msg_len;
         }
 
         return std::monostate {};
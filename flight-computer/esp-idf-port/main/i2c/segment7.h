@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <string_view>
+
 #include "esp_timer.h"
 #include "I2C.h"
 
@@ -90,8 +93,11 @@ namespace seds {
         SegmentDisplay(SegmentDisplay const&) = delete;
         SegmentDisplay& operator=(SegmentDisplay const&) = delete;
 
+        /// Longest message that can be displayed. Longer messages are cut off.
+        static constexpr size_t max_msg_len = 64;
+
         [[nodiscard]]
-        Expected<std::monostate> set_msg(const std::string msg);
+        Expected<std::monostate> set_msg(std::string_view msg);
 
         [[nodiscard]]
         Expected<std::monostate> clear_msg();
@@ -112,7 +118,8 @@ namespace seds {
         TCA6507 left_display;
         TCA6507 right_display;
 
-        std::vector<uint8_t> msg; // using vector, but this isn't hot code so it shouldn't matter
+        std::array<uint8_t, max_msg_len> msg;
+        size_t msg_len = 0;
         uint32_t msg_offset;
         esp_timer_handle_t scroll_timer;
         uint64_t scroll_interval_us = 500000; // default to 0.5s
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <variant>
+
+#include "I2C.h"
+
+namespace seds {
+    /// One value a sensor contributes to each logged sample.
+    struct LogField {
+        /// Column name, without the sensor's name in front. Empty for sensors with one value.
+        char const* name;
+        /// Unit once converted by the sensor's scale. Raw logs store the counts instead.
+        char const* unit;
+        /// Bytes the count takes in a raw sample record, and whether it is signed.
+        uint8_t bytes;
+        bool is_signed;
+    };
+
+    /// A setting that decides what a sensor's counts mean, such as its range or output rate.
+    /// Raw logs record it alongside the scale factors, in `unit`.
+    struct ConfigField {
+        char const* name;
+        char const* unit;
+    };
+
+    /// A driver the flight computer can read and log without knowing anything else about it
+    /// (see computer/sensor_registry.h).
+    ///
+    /// One reading is a `Raw` of counts, and the `Scale` from `scale()` converts it into a `Data`
+    /// in engineering units. `fields` describes the values of a reading in log order, and
+    /// `counts`/`values` flatten a `Raw`/`Data` into that order (`from_counts`/`from_values`
+    /// undo it). `rate_hz` is how often the sensor has a new reading as `create` sets it up, or
+    /// the most it can be set to if that changes in flight.
+    ///
+    /// For raw logs to describe themselves, `per_count` gives what one count of each field is
+    /// worth under a `Scale` and `config` the settings named by `config_fields` that it was read
+    /// back from. `scale_from` rebuilds the `Scale` from those two.
+    template<typename T>
+    concept Sensor = requires(T& sensor, typename T::Raw const& raw, typename T::Data const& data,
+        typename T::Scale const& scale)
+    {
+        { T::fields } -> std::convertible_to<std::array<LogField, T::fields.size()>>;
+        { T::rate_hz } -> std::convertible_to<uint32_t>;
+        { T::counts(raw) } -> std::same_as<std::array<int32_t, T::fields.size()>>;
+        { T::from_counts(T::counts(raw)) } -> std::same_as<typename T::Raw>;
+        { T::values(data) } -> std::same_as<std::array<float, T::fields.size()>>;
+        { T::from_values(T::values(data)) } -> std::same_as<typename T::Data>;
+        { T::config_fields } -> std::convertible_to<std::array<ConfigField, T::config_fields.size()>>;
+        { T::per_count(scale) } -> std::same_as<std::array<float, T::fields.size()>>;
+        { T::config(scale) } -> std::same_as<std::array<float, T::config_fields.size()>>;
+        { T::scale_from(T::per_count(scale), T::config(scale)) } -> std::same_as<typename T::Scale>;
+        { scale.convert(raw) } -> std::same_as<typename T::Data>;
+        { sensor.scale() } -> std::same_as<typename T::Scale>;
+        { sensor.read_raw() } -> std::same_as<Expected<typename T::Raw>>;
+        { sensor.probe() } -> std::same_as<Expected<ProbeResult>>;
+        { sensor.reinit() } -> std::same_as<Expected<std::monostate>>;
+    };
+}
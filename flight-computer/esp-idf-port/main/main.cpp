@@ -1,3 +1,4 @@
+#include <cinttypes>
 #include <cstdio>
 #include "sdkconfig.h"
 #include "freertos/FreeRTOS.h"
@@ -14,16 +15,55 @@
 #include "i2c/TMP1075.h"
 #include "errors.h"
 #include "sd.h"
+#if CONFIG_SEDS_AIRBRAKE_TIMING
+#include <algorithm>
+#include "esp_timer.h"
+#include "airbrake/apogee_predictor.h"
+#endif
 
 
 static const char *TAG = "main";
 
 using namespace seds::errors;
 
+#if CONFIG_SEDS_AIRBRAKE_TIMING
+/// Runs the apogee predictor from every coast state on a grid and logs the slowest prediction.
+static void time_apogee_predictor()
+{
+    static seds::airbrake::ApogeePredictor const predictor;
+    int64_t slowest_us = 0;
+    int64_t total_us = 0;
+    int predictions = 0;
+    float checksum = 0;
+    for (float velocity = 10; velocity <= 310; velocity += 20) {
+        for (float altitude = 0; altitude <= 4000; altitude += 500) {
+            for (float deployment = 0; deployment <= 1; deployment += 0.25f) {
+                auto const start = esp_timer_get_time();
+                checksum += predictor.predict(altitude, velocity, deployment);
+                auto const elapsed = esp_timer_get_time() - start;
+                slowest_us = std::max(slowest_us, elapsed);
+                total_us += elapsed;
+                predictions++;
+            }
+        }
+    }
+
+    ESP_LOGI(TAG, "apogee predictor: %d predictions, mean %" PRId64 " us, slowest %" PRId64
+        " us (checksum %f)", predictions, total_us / predictions, slowest_us, checksum);
+    if (slowest_us >= 1000) {
+        ESP_LOGE(TAG, "apogee predictor is over its 1 ms budget");
+    }
+}
+#endif
+
 extern "C" void app_main()
 {
     ESP_LOGI(TAG, "Hello!");
 
+#if CONFIG_SEDS_AIRBRAKE_TIMING
+    time_apogee_predictor();
+#endif
+
     auto i2c = seds::I2C::create();
     ESP_LOGI(TAG, "I2C initialized successfully");
 
@@ -85,7 +125,8 @@ extern "C" void app_main()
     
     seds::SDCard sd = unwrap(seds::SDCard::create());
 
-    auto fc = seds::FlightComputer {
+    // Static because the flight tasks keep using it after app_main returns
+    static auto fc = seds::FlightComputer {
         .baro1 = std::move(baro_sensor_1),
         .baro2 = std::move(baro_sensor_2),
         .imu = std::move(imu),
@@ -95,6 +136,16 @@ extern "C" void app_main()
         .sd = std::move(sd)
     };
 
-    auto init_res = fc.init();
-    fc.process(10, true);
+    unwrap(fc.init());
+    unwrap(fc.start());
+
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(5000));
+
+        auto stats = fc.stats();
+        ESP_LOGI(TAG, "phase: %s, samples: %" PRIu32 ", missed periods: %" PRIu32
+            ", queue overruns: %" PRIu32 ", max queue depth: %" PRIu32,
+            seds::to_string(fc.phase()), stats.samples_read, stats.missed_periods,
+            stats.queue_overruns, stats.max_queue_depth);
+    }
 }
@@ -0,0 +1,40 @@
+#include "memory.h"
+
+#include <cstdlib>
+
+#include "sdkconfig.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+
+namespace seds::memory {
+    namespace {
+        // FreeRTOS tasks each get their own copy, as threads do on the host
+        thread_local bool armed = false;
+    }
+
+    void arm() {
+        armed = true;
+    }
+
+    void disarm() {
+        armed = false;
+    }
+
+    bool is_armed() {
+        return armed;
+    }
+}
+
+#if CONFIG_SEDS_STATIC_MEMORY
+// Called by ESP-IDF on every successful heap allocation (CONFIG_HEAP_USE_HOOKS). This can run
+// inside the allocator with interrupts disabled, so it has to live in IRAM and can't use the
+// normal logging. It runs on the allocating task, so it sees that task's flag.
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook(void*, size_t size, uint32_t caps) {
+    if (seds::memory::armed) {
+        esp_rom_printf("heap allocation of %u bytes (caps 0x%x) after arming\n",
+            static_cast<unsigned>(size), static_cast<unsigned>(caps));
+        abort();
+    }
+}
+#endif
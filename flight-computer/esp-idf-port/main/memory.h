@@ -0,0 +1,22 @@
+#pragma once
+
+// Everything the flight loop uses is allocated statically or during init, so once the loop is
+// running, a heap allocation is a bug: it means unbounded memory use or an allocator stall
+// mid-flight. FlightComputer::process arms this check while it runs, and each flight task arms
+// it for itself. With CONFIG_SEDS_STATIC_MEMORY set, an allocation while armed prints its size
+// and aborts; without it, arming does nothing.
+//
+// Arming is per task. The rest of the firmware (logging, the esp_timer task, the SD card's
+// driver, IDF services) still allocates as it likes, even while the flight tasks run.
+
+namespace seds::memory {
+    /// Forbid heap allocation on the calling task from now on.
+    void arm();
+
+    /// Allow heap allocation on the calling task again.
+    void disarm();
+
+    /// Whether the calling task is armed.
+    [[nodiscard]]
+    bool is_armed();
+}
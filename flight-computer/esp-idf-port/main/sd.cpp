@@ -52,25 +52,25 @@ Expected<std::monostate> SDCard::create_file(const char* path, const uint8_t* da
         // save error
         auto error = errno;
         if (error == ENOMEM) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("failed to allocate memory for file")));
+            return std::unexpected(std::make_unique<Error>("failed to allocate memory for file"));
         }
         if (error == EDQUOT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EINVAL) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file basename was invalid")));
+            return std::unexpected(std::make_unique<Error>("file basename was invalid"));
         }
         if (error == EISDIR) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file points to directory")));
+            return std::unexpected(std::make_unique<Error>("file points to directory"));
         }
         if (error == ENAMETOOLONG) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("path was too long")));
+            return std::unexpected(std::make_unique<Error>("path was too long"));
         }
         if (error == ENOENT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("a directory in the path did not exist")));
+            return std::unexpected(std::make_unique<Error>("a directory in the path did not exist"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -84,18 +84,18 @@ Expected<std::monostate> SDCard::create_file(const char* path, const uint8_t* da
         // attempt to close file
         fclose(f);
         if (error == EDQUOT || error == ENOSPC) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
     if (written < length) {
         // TODO: Make these error enums so we can handle this case differently
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("wrote fewer bytes than expected")));
+        return std::unexpected(std::make_unique<Error>("wrote fewer bytes than expected"));
     }
 
     if (fclose(f) != 0) {
@@ -103,13 +103,13 @@ Expected<std::monostate> SDCard::create_file(const char* path, const uint8_t* da
         auto error = errno;
         clearerr(f);
         if (error == EDQUOT || error == ENOSPC) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -123,25 +123,25 @@ Expected<std::monostate> SDCard::append_file(const char *path, const uint8_t *da
         // save error
         auto error = errno;
         if (error == ENOMEM) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("failed to allocate memory for file")));
+            return std::unexpected(std::make_unique<Error>("failed to allocate memory for file"));
         }
         if (error == EDQUOT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EINVAL) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file basename was invalid")));
+            return std::unexpected(std::make_unique<Error>("file basename was invalid"));
         }
         if (error == EISDIR) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file points to directory")));
+            return std::unexpected(std::make_unique<Error>("file points to directory"));
         }
         if (error == ENAMETOOLONG) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("path was too long")));
+            return std::unexpected(std::make_unique<Error>("path was too long"));
         }
         if (error == ENOENT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("a directory in the path did not exist")));
+            return std::unexpected(std::make_unique<Error>("a directory in the path did not exist"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -153,18 +153,18 @@ Expected<std::monostate> SDCard::append_file(const char *path, const uint8_t *da
         // attempt to close file
         fclose(f);
         if (error == EDQUOT || error == ENOSPC) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
     if (written < length) {
         // TODO: Make these error enums so we can handle this case differently
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("wrote fewer bytes than expected")));
+        return std::unexpected(std::make_unique<Error>("wrote fewer bytes than expected"));
     }
 
     if (fclose(f) != 0) {
@@ -172,13 +172,13 @@ Expected<std::monostate> SDCard::append_file(const char *path, const uint8_t *da
         auto error = errno;
         clearerr(f);
         if (error == EDQUOT || error == ENOSPC) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -192,19 +192,19 @@ Expected<std::monostate> SDCard::read_file(const char *path, uint8_t* buffer, si
         // save error
         auto error = errno;
         if (error == ENOMEM) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("failed to allocate memory for file")));
+            return std::unexpected(std::make_unique<Error>("failed to allocate memory for file"));
         }
         if (error == EINVAL) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file basename was invalid")));
+            return std::unexpected(std::make_unique<Error>("file basename was invalid"));
         }
         if (error == ENAMETOOLONG) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("path was too long")));
+            return std::unexpected(std::make_unique<Error>("path was too long"));
         }
         if (error == ENOENT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file does not exist")));
+            return std::unexpected(std::make_unique<Error>("file does not exist"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -216,28 +216,28 @@ Expected<std::monostate> SDCard::read_file(const char *path, uint8_t* buffer, si
         // attempt to close file
         fclose(f);
         if (error == EISDIR) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file points to directory")));
+            return std::unexpected(std::make_unique<Error>("file points to directory"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
     if (read < length) {
         // TODO: Make these error enums so we can handle this case differently
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("read fewer bytes than expected")));
+        return std::unexpected(std::make_unique<Error>("read fewer bytes than expected"));
     }
     if (fclose(f) == EOF) {
         // save error
         auto error = errno;
         clearerr(f);
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            //return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(errno)));
+            //return std::unexpected(std::make_unique<Error>(errno));
         }
     };
 
@@ -251,25 +251,25 @@ Expected<std::monostate> SDCard::flush_file(const char *path) {
         // save error
         auto error = errno;
         if (error == ENOMEM) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("failed to allocate memory for file")));
+            return std::unexpected(std::make_unique<Error>("failed to allocate memory for file"));
         }
         if (error == EDQUOT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EINVAL) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file basename was invalid")));
+            return std::unexpected(std::make_unique<Error>("file basename was invalid"));
         }
         if (error == EISDIR) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file points to directory")));
+            return std::unexpected(std::make_unique<Error>("file points to directory"));
         }
         if (error == ENAMETOOLONG) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("path was too long")));
+            return std::unexpected(std::make_unique<Error>("path was too long"));
         }
         if (error == ENOENT) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("a directory in the path did not exist")));
+            return std::unexpected(std::make_unique<Error>("a directory in the path did not exist"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -281,13 +281,13 @@ Expected<std::monostate> SDCard::flush_file(const char *path) {
         // attempt to close file
         fclose(f);
         if (error == EDQUOT || error == ENOSPC) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -296,13 +296,13 @@ Expected<std::monostate> SDCard::flush_file(const char *path) {
         auto error = errno;
         clearerr(f);
         if (error == EDQUOT || error == ENOSPC) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("no space on card for file")));
+            return std::unexpected(std::make_unique<Error>("no space on card for file"));
         }
         if (error == EIO) {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("an io error occured")));
+            return std::unexpected(std::make_unique<Error>("an io error occured"));
         }
         else {
-            return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error(strerror(error))));
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
         }
     }
 
@@ -313,15 +313,15 @@ Expected<std::monostate> SDCard::rename_file(const char* old_name, const char* n
     // Check if destination file exists before renaming
     struct stat st;
     if (stat(old_name, &st) != 0) {
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("old file does not exist")));
+        return std::unexpected(std::make_unique<Error>("old file does not exist"));
     }
 
     if (stat(new_name, &st) == 0) {
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("new file already exists")));
+        return std::unexpected(std::make_unique<Error>("new file already exists"));
     }
 
     if (rename(old_name, new_name) != 0) {
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("Renaming file failed")));
+        return std::unexpected(std::make_unique<Error>("Renaming file failed"));
     }
 
     return {};
@@ -335,10 +335,109 @@ Expected<std::monostate> SDCard::format_fatfs() {
 Expected<struct stat> SDCard::stat_file(const char* path) {
     struct stat st;
     if (stat(path, &st) != 0) {
-        return std::unexpected(std::make_unique<std::runtime_error>(std::runtime_error("file does not exist")));
+        return std::unexpected(std::make_unique<Error>("file does not exist"));
     }
 
     return st;
 }
 
+Expected<AppendFile> SDCard::open_append(const char *path) {
+    errno = 0;
+    FILE *f = fopen(path, "r+");
+    if (f == NULL) {
+        auto error = errno;
+        if (error == ENOMEM) {
+            return std::unexpected(std::make_unique<Error>("failed to allocate memory for file"));
+        }
+        if (error == ENOENT) {
+            return std::unexpected(std::make_unique<Error>("file does not exist"));
+        }
+        else {
+            return std::unexpected(std::make_unique<Error>(strerror(error)));
+        }
+    }
+
+    // The caller batches writes, so a stdio buffer would only add a copy (and an allocation)
+    setvbuf(f, NULL, _IONBF, 0);
+    fseek(f, 0, SEEK_END);
+
+    return AppendFile(f);
+}
+
+/// Turns errno after a failed write or sync into an error.
+static std::unique_ptr<std::exception> write_error(int error) {
+    if (error == EDQUOT || error == ENOSPC) {
+        return std::make_unique<Error>("no space on card for file");
+    }
+    if (error == EIO) {
+        return std::make_unique<Error>("an io error occured");
+    }
+    return std::make_unique<Error>(strerror(error));
+}
+
+AppendFile::~AppendFile() {
+    if (this->file != NULL) {
+        fclose(this->file);
+    }
+}
+
+AppendFile& AppendFile::operator=(AppendFile&& other) {
+    if (this != &other) {
+        if (this->file != NULL) {
+            fclose(this->file);
+        }
+        this->file = std::exchange(other.file, nullptr);
+    }
+    return *this;
+}
+
+Expected<std::monostate> AppendFile::write(const uint8_t* data, size_t length) {
+    if (this->file == NULL) {
+        return std::unexpected(std::make_unique<Error>("file is not open"));
+    }
+
+    errno = 0;
+    size_t written = fwrite(data, 1, length, this->file);
+    if (written < length) {
+        auto error = errno;
+        clearerr(this->file);
+        if (error == 0) {
+            return std::unexpected(std::make_unique<Error>("wrote fewer bytes than expected"));
+        }
+        return std::unexpected(write_error(error));
+    }
+
+    return {};
+}
+
+Expected<std::monostate> AppendFile::sync() {
+    if (this->file == NULL) {
+        return std::unexpected(std::make_unique<Error>("file is not open"));
+    }
+
+    // fflush hands the data to the filesystem, and fsync makes the filesystem write it and the
+    // FAT entries out to the card
+    if (fflush(this->file) != 0 || fsync(fileno(this->file)) != 0) {
+        auto error = errno;
+        clearerr(this->file);
+        return std::unexpected(write_error(error));
+    }
+
+    return {};
+}
+
+Expected<std::monostate> AppendFile::close() {
+    if (this->file == NULL) {
+        return std::unexpected(std::make_unique<Error>("file is not open"));
+    }
+
+    // The file is gone whatever fclose says, so don't try to close it twice
+    auto* file = std::exchange(this->file, nullptr);
+    if (fclose(file) != 0) {
+        return std::unexpected(write_error(errno));
+    }
+
+    return {};
+}
+
 }
@@ -3,6 +3,7 @@
 #include <expected>
 #include <sys/unistd.h>
 #include <sys/stat.h>
+#include <utility>
 #include <variant>
 
 #include "errors.h"
@@ -27,7 +28,10 @@ const gpio_num_t PIN_NUM_CS = (gpio_num_t)5;
 // This requires either a fixed length buffer (bad for potential writing into uninitialized memory)
 // Or malloc (bad for performance)
 // Here, the user just writes MOUNT_POINT/path
+// (Host builds override this so logs land in a local directory.)
+#ifndef MOUNT_POINT
 #define MOUNT_POINT "/sdcard"
+#endif
 #define MOUNT_POINT_LEN (sizeof(MOUNT_POINT))
 
 // Example reference:
@@ -36,6 +40,41 @@ const gpio_num_t PIN_NUM_CS = (gpio_num_t)5;
 namespace seds {
     using namespace seds::errors;
 
+    /// A file kept open for appending. Opening a file allocates, and closing it is the slow part
+    /// of a write, so code that writes often should hold one of these instead of calling
+    /// `SDCard::append_file` each time.
+    class AppendFile {
+    public:
+        /// A file that isn't open. Writes to it fail.
+        AppendFile() = default;
+        ~AppendFile();
+
+        AppendFile(AppendFile&& other) : file(std::exchange(other.file, nullptr)) {}
+        AppendFile& operator=(AppendFile&& other);
+        AppendFile(AppendFile const&) = delete;
+        AppendFile& operator=(AppendFile const&) = delete;
+
+        bool is_open() const {
+            return this->file != nullptr;
+        }
+
+        /// Writes straight through to the filesystem. The file is unbuffered, so batch writes
+        /// yourself.
+        Expected<std::monostate> write(const uint8_t* data, size_t length);
+
+        /// Commits everything written so far to the card, like closing the file would.
+        Expected<std::monostate> sync();
+
+        /// Commits everything and closes the file. Later writes fail.
+        Expected<std::monostate> close();
+
+    private:
+        friend class SDCard;
+        explicit AppendFile(FILE* file) : file(file) {}
+
+        FILE* file = nullptr;
+    };
+
     class SDCard {
     public:
         ~SDCard() {
@@ -53,6 +92,9 @@ namespace seds {
 
         Expected<std::monostate> append_file(const char *path, const uint8_t* data, size_t length);
 
+        /// Opens a file to append to and keeps it open. The file must already exist.
+        Expected<AppendFile> open_append(const char *path);
+
         Expected<std::monostate> flush_file(const char *path);
 
         /// If the old file doesn't exist, or the new file does, this function errors
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+namespace seds {
+    /// A fixed-size ring buffer connecting exactly one producer task to exactly one consumer task
+    /// without locks.
+    ///
+    /// Every operation finishes in a bounded number of steps regardless of what the other side is
+    /// doing (wait-free), and nothing is allocated. The producer can write straight into the next
+    /// slot with `claim` and `commit`, and the consumer can read straight out of it with `front`
+    /// or `readable` and `release`, so records don't have to be copied through the ring. Blocking
+    /// is left to the caller: pair the ring with a task notification if the consumer should sleep
+    /// while it is empty.
+    ///
+    /// Producer-side and consumer-side state live on separate cache lines so the two cores don't
+    /// keep stealing the same line from each other.
+    template<typename T, size_t Capacity>
+    class SpscRing {
+        static_assert(std::is_trivially_copyable_v<T>, "records are copied in and out as bytes");
+        static_assert(std::has_single_bit(Capacity), "capacity must be a power of two");
+
+        /// Big enough for the ESP32's PSRAM cache and for host CPUs.
+        static constexpr size_t cache_line = 64;
+
+    public:
+        SpscRing() = default;
+
+        // The producer and consumer hold on to the ring's address
+        SpscRing(SpscRing const&) = delete;
+        SpscRing& operator=(SpscRing const&) = delete;
+
+        static constexpr size_t capacity() {
+            return Capacity;
+        }
+
+        // Producer side
+
+        /// Returns the next free slot to fill in place, or nullptr if the ring is full. The slot
+        /// isn't visible to the consumer until `commit`. Claiming again before committing returns
+        /// the same slot.
+        T* claim() {
+            auto const head = this->head.load(std::memory_order_relaxed);
+            if (head - this->cached_tail == Capacity) {
+                this->cached_tail = this->tail.load(std::memory_order_acquire);
+                if (head - this->cached_tail == Capacity) {
+                    return nullptr;
+                }
+            }
+
+            return &this->slots[head & mask];
+        }
+
+        /// Publishes the slot returned by the last `claim`.
+        void commit() {
+            auto const head = this->head.load(std::memory_order_relaxed);
+            this->head.store(head + 1, std::memory_order_release);
+        }
+
+        /// Copies a record in. Returns false if the ring is full.
+        bool push(T const& record) {
+            T* slot = this->claim();
+            if (slot == nullptr) {
+                return false;
+            }
+
+            *slot = record;
+            this->commit();
+            return true;
+        }
+
+        /// Copies in as many records as fit, publishing them all at once. Returns how many were
+        /// pushed.
+        size_t push(std::span<T const> records) {
+            auto const head = this->head.load(std::memory_order_relaxed);
+            if (head - this->cached_tail + records.size() > Capacity) {
+                this->cached_tail = this->tail.load(std::memory_order_acquire);
+            }
+
+            auto const count = std::min(records.size(), Capacity - (head - this->cached_tail));
+            for (size_t i = 0; i < count; i++) {
+                this->slots[(head + i) & mask] = records[i];
+            }
+
+            this->head.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        // Consumer side
+
+        /// Returns the oldest record without removing it, or nullptr if the ring is empty.
+        T const* front() {
+            auto const tail = this->tail.load(std::memory_order_relaxed);
+            if (tail == this->cached_head) {
+                this->cached_head = this->head.load(std::memory_order_acquire);
+                if (tail == this->cached_head) {
+                    return nullptr;
+                }
+            }
+
+            return &this->slots[tail & mask];
+        }
+
+        /// Returns the oldest records that are contiguous in memory, without removing them. There
+        /// may be more after these if the records wrap around the end of the ring.
+        std::span<T const> readable() {
+            auto const tail = this->tail.load(std::memory_order_relaxed);
+            this->cached_head = this->head.load(std::memory_order_acquire);
+
+            auto const start = tail & mask;
+            auto const count = std::min<size_t>(this->cached_head - tail, Capacity - start);
+            return std::span<T const>(&this->slots[start], count);
+        }
+
+        /// Removes the `count` oldest records, which must have been returned by `front` or
+        /// `readable`.
+        void release(size_t count = 1) {
+            auto const tail = this->tail.load(std::memory_order_relaxed);
+            this->tail.store(tail + count, std::memory_order_release);
+        }
+
+        /// Copies out and removes the oldest record. Returns false if the ring is empty.
+        bool pop(T& record) {
+            T const* slot = this->front();
+            if (slot == nullptr) {
+                return false;
+            }
+
+            record = *slot;
+            this->release();
+            return true;
+        }
+
+        /// Copies out and removes as many records as are available, up to `records.size()`.
+        /// Returns how many were popped.
+        size_t pop(std::span<T> records) {
+            auto const tail = this->tail.load(std::memory_order_relaxed);
+            if (this->cached_head - tail < records.size()) {
+                this->cached_head = this->head.load(std::memory_order_acquire);
+            }
+
+            auto const count = std::min<size_t>(records.size(), this->cached_head - tail);
+            for (size_t i = 0; i < count; i++) {
+                records[i] = this->slots[(tail + i) & mask];
+            }
+
+            this->tail.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        // Either side
+
+        /// Records waiting to be consumed. Only a snapshot if the other side is running.
+        [[nodiscard]]
+        size_t size() const {
+            auto const head = this->head.load(std::memory_order_acquire);
+            auto const tail = this->tail.load(std::memory_order_acquire);
+            return head - tail;
+        }
+
+        /// Empties the ring. Only call this while neither side is using it.
+        void clear() {
+            this->head.store(0, std::memory_order_relaxed);
+            this->tail.store(0, std::memory_order_relaxed);
+            this->cached_head = 0;
+            this->cached_tail = 0;
+        }
+
+    private:
+        static constexpr size_t mask = Capacity - 1;
+
+        // Indices count up forever and are masked on access, so a full ring (head - tail ==
+        // Capacity) can be told apart from an empty one (head == tail).
+
+        /// Next slot to write. Written by the producer.
+        alignas(cache_line) std::atomic<size_t> head { 0 };
+        /// The producer's last view of `tail`, so it only touches the consumer's line when the
+        /// ring looks full.
+        size_t cached_tail = 0;
+
+        /// Next slot to read. Written by the consumer.
+        alignas(cache_line) std::atomic<size_t> tail { 0 };
+        /// The consumer's last view of `head`.
+        size_t cached_head = 0;
+
+        alignas(cache_line) T slots[Capacity];
+    };
+}
@@ -0,0 +1,162 @@
+#include "downlink.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace seds::telemetry {
+
+namespace {
+    /// The groups other than State, in the order they get the budget.
+    constexpr Group PRIORITY[] = { GROUP_HEALTH, GROUP_GPS, GROUP_ESTIMATOR };
+
+    constexpr size_t index_of(Group group) {
+        return std::countr_zero(static_cast<unsigned>(group));
+    }
+}
+
+Scheduler::Scheduler(DownlinkConfig const& config) {
+    if (config.budget == 0) {
+        return;
+    }
+    this->frame_period_us = static_cast<int64_t>(FRAME_LEN) * 1'000'000 / config.budget;
+
+    // Every frame has this much room after State, and the groups share it out in priority order
+    auto const frame_rate = this->frame_rate();
+    auto spare = frame_rate * static_cast<float>(FRAME_PAYLOAD_LEN - GROUP_LEN[0]);
+    for (auto group : PRIORITY) {
+        auto const requested = group == GROUP_HEALTH ? config.health_hz
+            : group == GROUP_GPS ? config.gps_hz
+            : config.estimator_hz;
+        auto const len = static_cast<float>(GROUP_LEN[index_of(group)]);
+        auto const granted = std::min({ requested, spare / len, frame_rate });
+        if (granted > 0) {
+            this->slots[index_of(group)].period_ms = std::lround(1000 / granted);
+            spare -= granted * len;
+        }
+    }
+}
+
+float Scheduler::rate(Group group) const {
+    if (group == GROUP_STATE) {
+        return this->frame_rate();
+    }
+    auto const period_ms = this->slots[index_of(group)].period_ms;
+    return period_ms > 0 ? 1000.0f / static_cast<float>(period_ms) : 0;
+}
+
+bool Scheduler::due(int64_t time_ms) {
+    auto const now_us = time_ms * 1000;
+    if (this->frame_period_us == 0 || now_us < this->next_frame_us) {
+        return false;
+    }
+
+    // Keep to the budget's cadence, but don't save it up through a gap in the samples: after
+    // one, the next frame is a whole period after this one
+    this->next_frame_us = std::max(this->next_frame_us, now_us) + this->frame_period_us;
+    return true;
+}
+
+uint8_t Scheduler::pick(int64_t time_ms, uint8_t available, uint8_t urgent) {
+    struct Candidate {
+        Group group;
+        /// Periods since it was last sent. Urgent and never-sent groups are infinitely late.
+        float lateness;
+        size_t priority;
+    };
+    Candidate candidates[std::size(PRIORITY)];
+    size_t count = 0;
+    for (size_t priority = 0; priority < std::size(PRIORITY); priority++) {
+        auto const group = PRIORITY[priority];
+        if (!(available & group)) {
+            continue;
+        }
+        auto const& slot = this->slots[index_of(group)];
+        auto lateness = std::numeric_limits<float>::infinity();
+        if (slot.sent && !(urgent & group)) {
+            // Groups the budget has no room for only ever fill leftover space
+            lateness = slot.period_ms > 0
+                ? static_cast<float>(time_ms - slot.last_ms) / static_cast<float>(slot.period_ms)
+                : 0;
+        }
+        candidates[count++] = { group, lateness, priority };
+    }
+    // Latest first, ties in priority order. With at most three, an insertion sort: std::sort
+    // trips GCC's -Warray-bounds on an array this small, and std::stable_sort would allocate.
+    auto const before = [](Candidate const& a, Candidate const& b) {
+        return a.lateness != b.lateness ? a.lateness > b.lateness : a.priority < b.priority;
+    };
+    for (size_t i = 1; i < count; i++) {
+        for (size_t j = i; j > 0 && before(candidates[j], candidates[j - 1]); j--) {
+            std::swap(candidates[j], candidates[j - 1]);
+        }
+    }
+
+    uint8_t contents = GROUP_STATE;
+    auto room = FRAME_PAYLOAD_LEN - GROUP_LEN[0];
+    // Everything due first, then anything that fits in what's left
+    for (bool const only_due : { true, false }) {
+        for (size_t i = 0; i < count; i++) {
+            auto const [group, lateness, priority] = candidates[i];
+            auto const len = GROUP_LEN[index_of(group)];
+            if ((contents & group) || len > room || (only_due && lateness < 1)) {
+                continue;
+            }
+            contents |= group;
+            room -= len;
+            auto& slot = this->slots[index_of(group)];
+            slot.last_ms = time_ms;
+            slot.sent = true;
+        }
+    }
+    return contents;
+}
+
+void Downlink::encode(uint8_t* dest, estimation::Estimate const& estimate, FlightPhase phase,
+    Health const& health) {
+    uint8_t available = GROUP_HEALTH | GROUP_ESTIMATOR;
+    uint8_t urgent = 0;
+    if (this->gps_fresh) {
+        available |= GROUP_GPS;
+    }
+    if (!this->health_sent || health.valid != this->sent_valid || health.dead != this->sent_dead) {
+        urgent |= GROUP_HEALTH;
+    }
+
+    auto const contents = this->scheduler.pick(estimate.time_ms, available, urgent);
+    begin_frame(dest, static_cast<uint16_t>(this->sequence),
+        static_cast<uint32_t>(estimate.time_ms), contents);
+    this->sequence++;
+
+    // Groups go in bit order
+    auto* out = &dest[FRAME_HEADER_LEN];
+    out += encode_state(out, estimate.altitude, estimate.velocity, estimate.acceleration, phase);
+    if (contents & GROUP_HEALTH) {
+        out += encode_health(out, health);
+        this->sent_valid = health.valid;
+        this->sent_dead = health.dead;
+        this->health_sent = true;
+    }
+    if (contents & GROUP_ESTIMATOR) {
+        out += encode_estimator(out, {
+            .altitude_sigma = std::sqrt(std::max(estimate.altitude_variance, 0.0f)),
+            .high_g_weight = estimate.high_g_weight,
+            .accel_bias = estimate.accel_bias,
+        });
+    }
+    if (contents & GROUP_GPS) {
+        out += encode_gps(out, this->gps);
+        this->gps_fresh = false;
+    }
+    finish_frame(dest, out - &dest[FRAME_HEADER_LEN]);
+}
+
+void Downlink::update_gps(GpsFix const& fix) {
+    this->gps = fix;
+    this->gps_fresh = true;
+}
+
+}
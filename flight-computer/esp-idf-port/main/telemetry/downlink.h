@@ -0,0 +1,121 @@
+#pragma once
+
+// The flight computer's side of the telemetry radio: decides which groups of flight data go in
+// each frame so the link carries the most useful data it can, and encodes the frames.
+
+#include <cstdint>
+
+#include "estimation/estimate.h"
+#include "sdkconfig.h"
+#include "telemetry/frame.h"
+
+namespace seds::telemetry {
+    /// Settings for Downlink.
+    struct DownlinkConfig {
+        /// Bytes per second the radio can carry. One frame goes out every FRAME_LEN of these. 0
+        /// sends nothing.
+        uint32_t budget = CONFIG_SEDS_TELEMETRY_BUDGET;
+        /// How often the ground should hear each group other than State, which is in every
+        /// frame, Hz. If the budget can't carry all of them, they get what's left in this order:
+        /// health, then GPS, then the estimator.
+        float health_hz = 2;
+        float gps_hz = 1;
+        float estimator_hz = 5;
+    };
+
+    /// Spends the link budget on frames, and the frames on groups.
+    ///
+    /// Frames go out no faster than the budget allows, on the first sample after each is due;
+    /// after a gap in the samples the budget isn't saved up for a burst. Every frame carries
+    /// State. The rest of each frame goes to the groups that have waited longest relative to
+    /// their rates, then whatever fits in the room left over, so no frame carries padding that a
+    /// group could have used. A group whose contents change in a way the ground should know
+    /// about (a sensor dying, say) goes in the next frame.
+    class Scheduler {
+    public:
+        Scheduler() : Scheduler(DownlinkConfig {}) {}
+        explicit Scheduler(DownlinkConfig const& config);
+
+        /// Whether a frame should go out with the sample taken at `time_ms`. Counts it against
+        /// the budget if so.
+        bool due(int64_t time_ms);
+
+        /// The groups for the frame going out at `time_ms`, as Group bits. Only groups in
+        /// `available` have something to send, and those in `urgent` go first.
+        uint8_t pick(int64_t time_ms, uint8_t available, uint8_t urgent);
+
+        /// Frames per second the budget allows.
+        [[nodiscard]]
+        float frame_rate() const {
+            if (this->frame_period_us == 0) {
+                return 0;
+            }
+            return 1e6f / static_cast<float>(this->frame_period_us);
+        }
+
+        /// The rate `group` is guaranteed within the budget, Hz. Zero if the budget has no room
+        /// for it.
+        [[nodiscard]]
+        float rate(Group group) const;
+
+    private:
+        struct Slot {
+            /// Zero if the group never gets a guaranteed place.
+            int64_t period_ms = 0;
+            int64_t last_ms = 0;
+            bool sent = false;
+        };
+
+        /// Zero if the budget is.
+        int64_t frame_period_us = 0;
+        int64_t next_frame_us = 0;
+        Slot slots[GROUP_COUNT];
+    };
+
+    /// Encodes telemetry frames from the flight computer's state as it is, without collecting
+    /// it anywhere first.
+    ///
+    /// Ask `due` with every sample; only when it says yes does `encode` read the estimate and
+    /// health, quantize them and write the frame, straight into wherever it will be sent from.
+    /// Samples between frames cost a comparison.
+    class Downlink {
+    public:
+        Downlink() : Downlink(DownlinkConfig {}) {}
+        explicit Downlink(DownlinkConfig const& config) : scheduler(config) {}
+
+        /// Whether a frame should go out with the sample taken at `time_ms` (see Scheduler::due).
+        bool due(int64_t time_ms) {
+            return this->scheduler.due(time_ms);
+        }
+
+        /// Encodes the next frame into `dest`, which must hold FRAME_LEN bytes.
+        void encode(uint8_t* dest, estimation::Estimate const& estimate, FlightPhase phase,
+            Health const& health);
+
+        /// Hands over the latest position from a GPS receiver. It goes down in the next frames
+        /// that have room for it. The flight computer has no GPS yet, so nothing calls this on
+        /// the board.
+        void update_gps(GpsFix const& fix);
+
+        /// Frames encoded so far.
+        [[nodiscard]]
+        uint32_t frames() const {
+            return this->sequence;
+        }
+
+        [[nodiscard]]
+        Scheduler const& schedule() const {
+            return this->scheduler;
+        }
+
+    private:
+        Scheduler scheduler;
+        uint32_t sequence = 0;
+        /// What the ground last heard of the sensors, to notice when that changes.
+        uint8_t sent_valid = 0;
+        uint8_t sent_dead = 0;
+        bool health_sent = false;
+        GpsFix gps;
+        bool gps_fresh = false;
+    };
+}
@@ -0,0 +1,248 @@
+#include "frame.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "utils.h"
+
+namespace seds::telemetry {
+
+char const* to_string(Group group) {
+    switch (group) {
+        case GROUP_STATE: return "state";
+        case GROUP_HEALTH: return "health";
+        case GROUP_ESTIMATOR: return "estimator";
+        case GROUP_GPS: return "gps";
+    }
+    return "unknown";
+}
+
+namespace {
+    constexpr auto CRC_TABLE = [] {
+        std::array<uint16_t, 256> table {};
+        for (size_t i = 0; i < table.size(); i++) {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = crc & 0x8000 ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : crc << 1;
+            }
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+    /// `value / resolution` rounded to the nearest T, saturating at T's range. NaN is zero.
+    template<typename T>
+    T quantize(float value, float resolution) {
+        constexpr auto low = static_cast<float>(std::numeric_limits<T>::min());
+        constexpr auto high = static_cast<float>(std::numeric_limits<T>::max());
+        auto const steps = std::nearbyint(value / resolution);
+        if (std::isnan(steps)) {
+            return 0;
+        }
+        return static_cast<T>(std::clamp(steps, low, high));
+    }
+
+    template<typename T>
+    T saturate(uint32_t value) {
+        return static_cast<T>(std::min<uint32_t>(value, std::numeric_limits<T>::max()));
+    }
+
+    /// Appends little-endian values to a byte buffer.
+    class Writer {
+    public:
+        explicit Writer(uint8_t* dest) : dest(dest), start(dest) {}
+
+        template<typename T>
+        void put(T value) {
+            auto bytes = num::to_le_bytes(value);
+            memcpy(this->dest, bytes.data(), bytes.size());
+            this->dest += bytes.size();
+        }
+
+        size_t written() const {
+            return this->dest - this->start;
+        }
+
+    private:
+        uint8_t* dest;
+        uint8_t* start;
+    };
+
+    /// Reads little-endian values out of a byte buffer.
+    class Reader {
+    public:
+        explicit Reader(uint8_t const* src) : src(src) {}
+
+        template<typename T>
+        T get() {
+            std::array<uint8_t, sizeof(T)> bytes;
+            memcpy(bytes.data(), this->src, bytes.size());
+            this->src += bytes.size();
+            return num::from_le_bytes<T>(bytes);
+        }
+
+    private:
+        uint8_t const* src;
+    };
+}
+
+uint16_t crc16(uint8_t const* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc = static_cast<uint16_t>((crc << 8) ^ CRC_TABLE[(crc >> 8) ^ data[i]]);
+    }
+    return crc;
+}
+
+size_t encode_state(uint8_t* dest, float altitude, float velocity, float acceleration,
+    FlightPhase phase) {
+    Writer out(dest);
+    out.put(quantize<int16_t>(altitude, 0.5f));
+    out.put(quantize<int16_t>(velocity, 0.05f));
+    out.put(quantize<int16_t>(acceleration, 0.02f));
+    out.put(static_cast<uint8_t>(phase));
+    return out.written();
+}
+
+size_t encode_health(uint8_t* dest, Health const& health) {
+    Writer out(dest);
+    out.put(health.valid);
+    out.put(health.dead);
+    out.put(saturate<uint16_t>(health.queue_overruns));
+    out.put(saturate<uint16_t>(health.missed_periods));
+    out.put(saturate<uint8_t>(health.max_queue_depth));
+    return out.written();
+}
+
+size_t encode_estimator(uint8_t* dest, EstimatorQuality const& quality) {
+    Writer out(dest);
+    out.put(quantize<uint8_t>(quality.altitude_sigma, 0.1f));
+    out.put(quantize<uint8_t>(quality.high_g_weight, 1.0f / 255));
+    out.put(quantize<int8_t>(quality.accel_bias, 0.01f));
+    return out.written();
+}
+
+size_t encode_gps(uint8_t* dest, GpsFix const& fix) {
+    Writer out(dest);
+    out.put(fix.latitude_e7);
+    out.put(fix.longitude_e7);
+    out.put(quantize<int16_t>(fix.altitude, 1));
+    out.put(fix.satellites);
+    out.put(static_cast<uint8_t>(fix.fix));
+    return out.written();
+}
+
+void begin_frame(uint8_t* dest, uint16_t sequence, uint32_t time_ms, uint8_t contents) {
+    Writer out(dest);
+    out.put(FRAME_SYNC[0]);
+    out.put(FRAME_SYNC[1]);
+    out.put(sequence);
+    out.put(time_ms);
+    out.put(contents);
+}
+
+void finish_frame(uint8_t* dest, size_t payload_len) {
+    auto const end = FRAME_HEADER_LEN + payload_len;
+    memset(&dest[end], 0, FRAME_LEN - FRAME_CRC_LEN - end);
+    Writer(&dest[FRAME_LEN - FRAME_CRC_LEN]).put(crc16(dest, FRAME_LEN - FRAME_CRC_LEN));
+}
+
+std::optional<Frame> decode_frame(uint8_t const* src) {
+    if (src[0] != FRAME_SYNC[0] || src[1] != FRAME_SYNC[1]) {
+        return std::nullopt;
+    }
+    auto const crc = Reader(&src[FRAME_LEN - FRAME_CRC_LEN]).get<uint16_t>();
+    if (crc != crc16(src, FRAME_LEN - FRAME_CRC_LEN)) {
+        return std::nullopt;
+    }
+
+    Reader in(&src[2]);
+    Frame frame;
+    frame.sequence = in.get<uint16_t>();
+    frame.time_ms = in.get<uint32_t>();
+    frame.contents = in.get<uint8_t>();
+
+    size_t payload = 0;
+    for (size_t i = 0; i < GROUP_COUNT; i++) {
+        if (frame.contents & (1 << i)) {
+            payload += GROUP_LEN[i];
+        }
+    }
+    if (!(frame.contents & GROUP_STATE) || frame.contents >> GROUP_COUNT
+        || payload > FRAME_PAYLOAD_LEN) {
+        return std::nullopt;
+    }
+
+    frame.state.altitude = in.get<int16_t>() * 0.5f;
+    frame.state.velocity = in.get<int16_t>() * 0.05f;
+    frame.state.acceleration = in.get<int16_t>() * 0.02f;
+    auto const phase = in.get<uint8_t>();
+    if (phase >= FLIGHT_PHASE_COUNT) {
+        return std::nullopt;
+    }
+    frame.state.phase = static_cast<FlightPhase>(phase);
+    if (frame.contents & GROUP_HEALTH) {
+        frame.health.valid = in.get<uint8_t>();
+        frame.health.dead = in.get<uint8_t>();
+        frame.health.queue_overruns = in.get<uint16_t>();
+        frame.health.missed_periods = in.get<uint16_t>();
+        frame.health.max_queue_depth = in.get<uint8_t>();
+    }
+    if (frame.contents & GROUP_ESTIMATOR) {
+        frame.estimator.altitude_sigma = in.get<uint8_t>() * 0.1f;
+        frame.estimator.high_g_weight = in.get<uint8_t>() / 255.0f;
+        frame.estimator.accel_bias = in.get<int8_t>() * 0.01f;
+    }
+    if (frame.contents & GROUP_GPS) {
+        frame.gps.latitude_e7 = in.get<int32_t>();
+        frame.gps.longitude_e7 = in.get<int32_t>();
+        frame.gps.altitude = in.get<int16_t>();
+        frame.gps.satellites = in.get<uint8_t>();
+        frame.gps.fix = static_cast<GpsFixType>(in.get<uint8_t>());
+    }
+    return frame;
+}
+
+std::optional<Frame> Deframer::push(uint8_t byte) {
+    // Don't start a frame on a byte that can't be the start of the sync
+    if (this->len == 0 && byte != FRAME_SYNC[0]) {
+        this->dropped++;
+        return std::nullopt;
+    }
+    this->buffer[this->len++] = byte;
+    if (this->len == 2 && byte != FRAME_SYNC[1]) {
+        this->resync();
+        return std::nullopt;
+    }
+    if (this->len < FRAME_LEN) {
+        return std::nullopt;
+    }
+
+    auto frame = decode_frame(this->buffer.data());
+    if (frame.has_value()) {
+        this->good++;
+        this->len = 0;
+        return frame;
+    }
+
+    // The frame that seemed to start here was damaged, or this was never a frame. Either way a
+    // good one may start somewhere in the bytes already buffered.
+    this->bad++;
+    this->resync();
+    return std::nullopt;
+}
+
+void Deframer::resync() {
+    size_t start = 1;
+    while (start < this->len && !(this->buffer[start] == FRAME_SYNC[0]
+        && (start + 1 == this->len || this->buffer[start + 1] == FRAME_SYNC[1]))) {
+        start++;
+    }
+    this->dropped += start;
+    std::copy(&this->buffer[start], &this->buffer[this->len], this->buffer.begin());
+    this->len -= start;
+}
+
+}
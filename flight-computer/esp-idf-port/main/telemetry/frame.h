@@ -0,0 +1,241 @@
+#pragma once
+
+// The telemetry downlink's frame format: fixed-size frames of quantized flight data, each
+// checked by its own CRC, so a receiver that misses bytes or hears noise finds the next frame
+// by itself.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "computer/phase.h"
+
+namespace seds::telemetry {
+    // Frames
+    //
+    // Every frame is FRAME_LEN bytes. All numbers are little-endian.
+    //
+    //   sync      2 bytes, FRAME_SYNC
+    //   sequence  u16, one more than the last frame's, wrapping
+    //   time      u32, ms since boot of the newest data in the frame
+    //   contents  u8, which groups follow (Group bits), always including State
+    //   payload   the groups named in `contents`, in bit order, then zeros to fill the frame
+    //   crc       u16, CRC-16/CCITT-FALSE of everything before it
+    //
+    // A group is a few fields that are always sent together, quantized to the resolution the
+    // ground needs and saturating at the ends of their range:
+    //
+    //   State (7 bytes, every frame)
+    //     altitude      i16, 0.5 m        above the pad, -16384 to 16383 m
+    //     velocity      i16, 0.05 m/s     vertical, positive up, ±1638 m/s
+    //     acceleration  i16, 0.02 m/s²    vertical, gravity removed, ±655 m/s²
+    //     phase         u8                FlightPhase
+    //   Health (7 bytes)
+    //     valid         u8                SensorValid bits of the newest sample
+    //     dead          u8                SensorValid bits of sensors given up on
+    //     overruns      u16               samples dropped between the flight tasks, saturating
+    //     missed        u16               sampling periods missed, saturating
+    //     queue depth   u8                most samples ever waiting between the flight tasks
+    //   Estimator (3 bytes)
+    //     altitude σ    u8, 0.1 m         standard deviation of the altitude, to 25.5 m
+    //     high g weight u8, 1/255         share of the acceleration from the ADXL375
+    //     accel bias    i8, 0.01 m/s²     estimated accelerometer bias, ±1.27 m/s²
+    //   Gps (12 bytes)
+    //     latitude      i32, 1e-7 °
+    //     longitude     i32, 1e-7 °
+    //     altitude      i16, 1 m          above mean sea level
+    //     satellites    u8
+    //     fix           u8                GpsFixType
+    //
+    // Which groups go in each frame is up to the Downlink's scheduler (see downlink.h).
+
+    constexpr size_t FRAME_LEN = 32;
+    constexpr uint8_t FRAME_SYNC[2] = { 0x5E, 0xD5 };
+    /// Sync, sequence, time and contents.
+    constexpr size_t FRAME_HEADER_LEN = 2 + 2 + 4 + 1;
+    constexpr size_t FRAME_CRC_LEN = 2;
+    /// Room for groups in each frame.
+    constexpr size_t FRAME_PAYLOAD_LEN = FRAME_LEN - FRAME_HEADER_LEN - FRAME_CRC_LEN;
+
+    using FrameBytes = std::array<uint8_t, FRAME_LEN>;
+
+    /// The groups of fields a frame can carry, as bits of its `contents` byte.
+    enum Group : uint8_t {
+        GROUP_STATE = 1 << 0,
+        GROUP_HEALTH = 1 << 1,
+        GROUP_ESTIMATOR = 1 << 2,
+        GROUP_GPS = 1 << 3,
+    };
+
+    constexpr size_t GROUP_COUNT = 4;
+
+    /// Encoded length of each group, in Group bit order.
+    constexpr size_t GROUP_LEN[GROUP_COUNT] = { 7, 7, 3, 12 };
+
+    static_assert(GROUP_LEN[0] + GROUP_LEN[1] + GROUP_LEN[2] <= FRAME_PAYLOAD_LEN);
+    static_assert(GROUP_LEN[0] + GROUP_LEN[3] <= FRAME_PAYLOAD_LEN);
+
+    char const* to_string(Group group);
+
+    struct State {
+        float altitude = 0;
+        float velocity = 0;
+        float acceleration = 0;
+        FlightPhase phase = FlightPhase::Pad;
+
+        bool operator==(State const&) const = default;
+    };
+
+    struct Health {
+        uint8_t valid = 0;
+        uint8_t dead = 0;
+        uint32_t queue_overruns = 0;
+        uint32_t missed_periods = 0;
+        uint32_t max_queue_depth = 0;
+
+        bool operator==(Health const&) const = default;
+    };
+
+    struct EstimatorQuality {
+        float altitude_sigma = 0;
+        float high_g_weight = 0;
+        float accel_bias = 0;
+
+        bool operator==(EstimatorQuality const&) const = default;
+    };
+
+    enum class GpsFixType : uint8_t {
+        None,
+        Fix2D,
+        Fix3D,
+    };
+
+    /// A position from a GPS receiver.
+    struct GpsFix {
+        int32_t latitude_e7 = 0;
+        int32_t longitude_e7 = 0;
+        /// Above mean sea level, m.
+        float altitude = 0;
+        uint8_t satellites = 0;
+        GpsFixType fix = GpsFixType::None;
+
+        bool operator==(GpsFix const&) const = default;
+    };
+
+    /// Everything a frame can carry, as decoded on the ground. Only the groups named in
+    /// `contents` hold anything.
+    struct Frame {
+        uint16_t sequence = 0;
+        uint32_t time_ms = 0;
+        uint8_t contents = 0;
+        State state;
+        Health health;
+        EstimatorQuality estimator;
+        GpsFix gps;
+
+        bool operator==(Frame const&) const = default;
+    };
+
+    /// CRC-16/CCITT-FALSE (polynomial 0x1021, starting from 0xFFFF), table-driven.
+    uint16_t crc16(uint8_t const* data, size_t len);
+
+    // Group encoders. Each writes GROUP_LEN of its group to `dest` and returns that length.
+
+    size_t encode_state(uint8_t* dest, float altitude, float velocity, float acceleration,
+        FlightPhase phase);
+    size_t encode_health(uint8_t* dest, Health const& health);
+    size_t encode_estimator(uint8_t* dest, EstimatorQuality const& quality);
+    size_t encode_gps(uint8_t* dest, GpsFix const& fix);
+
+    /// Writes the header of a frame carrying `contents` into `dest`, which must hold FRAME_LEN
+    /// bytes. Its groups go after it, starting at `dest + FRAME_HEADER_LEN`.
+    void begin_frame(uint8_t* dest, uint16_t sequence, uint32_t time_ms, uint8_t contents);
+
+    /// Zeroes the rest of the payload after the `payload_len` bytes of groups written, and
+    /// appends the CRC.
+    void finish_frame(uint8_t* dest, size_t payload_len);
+
+    /// Decodes one frame. Empty if it doesn't start with FRAME_SYNC, its CRC doesn't match, or
+    /// its contents don't fit.
+    std::optional<Frame> decode_frame(uint8_t const* src);
+
+    /// Finds frames in a stream of bytes from the radio, however the stream was split up. After
+    /// lost or corrupted bytes it slides along to the next sync that starts a good frame.
+    class Deframer {
+    public:
+        /// Takes the next byte of the stream, and returns the frame it completes, if any.
+        std::optional<Frame> push(uint8_t byte);
+
+        /// Takes the next `len` bytes of the stream and calls `on_frame` with each frame they
+        /// complete, in order. Finds the same frames as pushing the bytes one by one, but frames
+        /// that lie whole in `data` are decoded where they are, and runs of noise are skipped
+        /// with memchr, so a recorded stream goes through at memory speed.
+        template<typename F>
+        void feed(uint8_t const* data, size_t len, F&& on_frame) {
+            size_t i = 0;
+            while (i < len) {
+                if (this->len > 0 || len - i < FRAME_LEN) {
+                    auto frame = this->push(data[i++]);
+                    if (frame.has_value()) {
+                        on_frame(*frame);
+                    }
+                    continue;
+                }
+
+                if (data[i] != FRAME_SYNC[0]) {
+                    auto const* sync = static_cast<uint8_t const*>(
+                        memchr(&data[i + 1], FRAME_SYNC[0], len - i - 1));
+                    auto const skip = sync == nullptr
+                        ? len - i
+                        : static_cast<size_t>(sync - &data[i]);
+                    this->dropped += skip;
+                    i += skip;
+                    continue;
+                }
+                if (data[i + 1] == FRAME_SYNC[1]) {
+                    auto frame = decode_frame(&data[i]);
+                    if (frame.has_value()) {
+                        this->good++;
+                        i += FRAME_LEN;
+                        on_frame(*frame);
+                        continue;
+                    }
+                    this->bad++;
+                }
+                // No frame starts here
+                this->dropped++;
+                i++;
+            }
+        }
+
+        /// Frames decoded.
+        [[nodiscard]]
+        uint32_t frames() const {
+            return this->good;
+        }
+
+        /// Frames that started with the sync but failed their CRC.
+        [[nodiscard]]
+        uint32_t corrupted() const {
+            return this->bad;
+        }
+
+        /// Bytes thrown away looking for a frame.
+        [[nodiscard]]
+        uint32_t skipped() const {
+            return this->dropped;
+        }
+
+    private:
+        /// Drops the first byte, and any after it that can't start a frame.
+        void resync();
+
+        FrameBytes buffer = {};
+        size_t len = 0;
+        uint32_t good = 0;
+        uint32_t bad = 0;
+        uint32_t dropped = 0;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <ranges>
 #include <type_traits>
 #include <cstdint>
@@ -0,0 +1,520 @@
+// The ground station's ingest: how fast it deframes and stores a telemetry stream compared to the
+// radio link, whether its snapshot and store can be read while frames pour in, and whether it
+// finds the right frames in streams damaged every way a radio can damage them.
+//
+// Each one checks what it measures and fails with an error instead of reporting a time if a
+// frame goes missing, a damaged frame is accepted, or a reader sees a half-written value.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "station/ingest.h"
+
+namespace seds::station {
+    using namespace seds::telemetry;
+
+    namespace {
+        /// The flight computer's default telemetry budget, bytes/s, to compare speeds with.
+        constexpr double LINK_RATE = 640;
+
+        /// Frame `n` of a made-up flight, with the groups in a mix like the Downlink's.
+        FrameBytes make_frame(uint16_t sequence, uint32_t n) {
+            uint8_t contents = GROUP_STATE;
+            if (n % 20 == 19) {
+                contents |= GROUP_GPS;
+            } else {
+                contents |= n % 10 == 0 ? GROUP_HEALTH : 0;
+                contents |= n % 4 == 0 ? GROUP_ESTIMATOR : 0;
+            }
+
+            FrameBytes frame;
+            auto const time_ms = 50 * n;
+            begin_frame(frame.data(), sequence, time_ms, contents);
+            auto* out = &frame[FRAME_HEADER_LEN];
+            auto const t = static_cast<float>(time_ms) / 1000;
+            out += encode_state(out, std::fmod(9.8f * t * t, 5000), std::fmod(9.8f * t, 300),
+                -9.8f, static_cast<FlightPhase>(n / 1000 % FLIGHT_PHASE_COUNT));
+            if (contents & GROUP_HEALTH) {
+                out += encode_health(out, { .valid = 0x3f, .dead = 0, .queue_overruns = n / 100 });
+            }
+            if (contents & GROUP_ESTIMATOR) {
+                out += encode_estimator(out, { .altitude_sigma = 1.5f, .high_g_weight = 0.2f });
+            }
+            if (contents & GROUP_GPS) {
+                out += encode_gps(out, {
+                    .latitude_e7 = 329'906'120 + static_cast<int32_t>(n),
+                    .longitude_e7 = -1'069'746'430,
+                    .altitude = 1401,
+                    .satellites = 9,
+                    .fix = GpsFixType::Fix3D,
+                });
+            }
+            finish_frame(frame.data(), out - &frame[FRAME_HEADER_LEN]);
+            return frame;
+        }
+
+        std::vector<uint8_t> make_stream(size_t frames) {
+            std::vector<uint8_t> stream;
+            stream.reserve(frames * FRAME_LEN);
+            for (size_t n = 0; n < frames; n++) {
+                auto const frame = make_frame(static_cast<uint16_t>(n), static_cast<uint32_t>(n));
+                stream.insert(stream.end(), frame.begin(), frame.end());
+            }
+            return stream;
+        }
+
+        /// Flips or drops each byte with a probability of `rate` in 10,000.
+        std::vector<uint8_t> damage(std::vector<uint8_t> const& stream, double rate,
+            uint32_t seed) {
+            std::mt19937 rng(seed);
+            std::bernoulli_distribution damaged(rate / 10'000);
+            std::bernoulli_distribution dropped(0.5);
+            std::uniform_int_distribution<int> flip(1, 255);
+            std::vector<uint8_t> out;
+            out.reserve(stream.size());
+            for (auto byte : stream) {
+                if (damaged(rng)) {
+                    if (dropped(rng)) {
+                        continue;
+                    }
+                    byte ^= static_cast<uint8_t>(flip(rng));
+                }
+                out.push_back(byte);
+            }
+            return out;
+        }
+
+        std::filesystem::path temp_path(char const* name) {
+            return std::filesystem::temp_directory_path()
+                / (std::string("station_bench_") + std::to_string(getpid()) + "_" + name);
+        }
+    }
+
+    /// The Deframer over 64k frames damaged at `range(1)` bytes in 10,000, a byte at a time
+    /// (`range(0)` = 0) or in 4 kB reads with Deframer::feed (1), as the ingest thread does.
+    /// Fails if the two ways find different frames. `links` is how many radio links' worth of
+    /// bytes the deframer keeps up with.
+    static void BM_Station_Deframe(benchmark::State& state) {
+        bool const bulk = state.range(0) != 0;
+        auto const stream = damage(make_stream(1 << 16), static_cast<double>(state.range(1)), 3);
+
+        auto const run = [&](Deframer& deframer, std::vector<Frame>* frames) {
+            auto const keep = [&](Frame const& frame) {
+                if (frames != nullptr) {
+                    frames->push_back(frame);
+                }
+                benchmark::DoNotOptimize(frame);
+            };
+            if (bulk) {
+                for (size_t offset = 0; offset < stream.size(); offset += Ingest::CHUNK_LEN) {
+                    deframer.feed(&stream[offset],
+                        std::min(Ingest::CHUNK_LEN, stream.size() - offset), keep);
+                }
+            } else {
+                for (auto byte : stream) {
+                    if (auto const frame = deframer.push(byte)) {
+                        keep(*frame);
+                    }
+                }
+            }
+        };
+
+        for (auto _ : state) {
+            Deframer deframer;
+            run(deframer, nullptr);
+        }
+
+        Deframer deframer;
+        std::vector<Frame> frames;
+        run(deframer, &frames);
+        Deframer reference;
+        std::vector<Frame> expected;
+        for (auto byte : stream) {
+            if (auto const frame = reference.push(byte)) {
+                expected.push_back(*frame);
+            }
+        }
+        if (frames != expected || deframer.corrupted() != reference.corrupted()
+            || deframer.skipped() != reference.skipped()) {
+            state.SkipWithError("feeding found different frames from pushing");
+            return;
+        }
+
+        auto const bytes = state.iterations() * static_cast<int64_t>(stream.size());
+        state.SetBytesProcessed(bytes);
+        state.counters["links"] = benchmark::Counter(static_cast<double>(bytes) / LINK_RATE,
+            benchmark::Counter::kIsRate);
+    }
+    BENCHMARK(BM_Station_Deframe)->ArgsProduct({ { 0, 1 }, { 0, 10 } });
+
+    /// The whole ground station replaying a recorded stream of 256k frames (8 MB, almost four
+    /// hours of the link at 640 bytes/s) from a file: reading, recording it again, deframing,
+    /// storing and publishing snapshots, while another thread reads the store's newest rows.
+    /// Fails if a frame is missing from the store or the snapshot, the recording differs from
+    /// the stream, or the reader finds a row that isn't what was sent. `links` is how many
+    /// radio links' worth of bytes it keeps up with.
+    static void BM_Station_Ingest(benchmark::State& state) {
+        constexpr size_t frame_count = 1 << 18;
+        auto const stream = make_stream(frame_count);
+        auto const input = temp_path("input.bin");
+        auto const recording = temp_path("recording.bin");
+        {
+            FILE* file = std::fopen(input.c_str(), "wb");
+            if (file == nullptr
+                || std::fwrite(stream.data(), 1, stream.size(), file) != stream.size()) {
+                state.SkipWithError("can't write the stream to a temporary file");
+                return;
+            }
+            std::fclose(file);
+        }
+
+        uint64_t rows_checked = 0;
+        bool bad_row = false;
+        bool ok = true;
+        for (auto _ : state) {
+            auto source = open_file(input);
+            if (!source.has_value()) {
+                state.SkipWithError(source.error().c_str());
+                break;
+            }
+            Ingest ingest(std::move(*source));
+            std::atomic<bool> reading = true;
+            std::thread reader([&] {
+                // The newest row is whole as soon as the table counts it
+                while (reading.load(std::memory_order_relaxed)) {
+                    auto const& table = ingest.store().state();
+                    auto const rows = table.rows();
+                    if (rows > 0) {
+                        auto const row = rows - 1;
+                        auto const expected = decode_frame(make_frame(static_cast<uint16_t>(row),
+                            static_cast<uint32_t>(row)).data());
+                        bad_row |= table.sequence[row] != expected->sequence
+                            || table.time_ms[row] != expected->time_ms
+                            || table.altitude[row] != expected->state.altitude;
+                        rows_checked++;
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+
+            if (!ingest.start({ .record = recording }).has_value()) {
+                state.SkipWithError("can't start the ingest");
+                reading = false;
+                reader.join();
+                break;
+            }
+            while (!ingest.done()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+            auto const stopped = ingest.stop();
+            reading = false;
+            reader.join();
+
+            auto const snapshot = ingest.snapshot();
+            auto const& store = ingest.store();
+            ok = stopped.has_value() && snapshot.stats.frames == frame_count
+                && snapshot.stats.lost == 0 && snapshot.stats.corrupted == 0
+                && snapshot.stats.bytes == stream.size()
+                && snapshot.sequence == static_cast<uint16_t>(frame_count - 1)
+                && snapshot.heard == (GROUP_STATE | GROUP_HEALTH | GROUP_ESTIMATOR | GROUP_GPS)
+                && store.state().rows() == frame_count
+                && store.gps().rows() == frame_count / 20
+                && std::filesystem::file_size(recording) == stream.size();
+            if (!ok) {
+                break;
+            }
+        }
+
+        // The recording, byte for byte
+        if (ok && !bad_row) {
+            FILE* file = std::fopen(recording.c_str(), "rb");
+            std::vector<uint8_t> recorded(stream.size());
+            ok = file != nullptr
+                && std::fread(recorded.data(), 1, recorded.size(), file) == recorded.size()
+                && recorded == stream;
+            if (file != nullptr) {
+                std::fclose(file);
+            }
+        }
+        std::filesystem::remove(input);
+        std::filesystem::remove(recording);
+        if (!ok) {
+            state.SkipWithError("a frame is missing or the recording differs");
+            return;
+        }
+        if (bad_row) {
+            state.SkipWithError("a reader saw a stored row that wasn't what was sent");
+            return;
+        }
+
+        auto const bytes = state.iterations() * static_cast<int64_t>(stream.size());
+        state.SetBytesProcessed(bytes);
+        state.counters["links"] = benchmark::Counter(static_cast<double>(bytes) / LINK_RATE,
+            benchmark::Counter::kIsRate);
+        state.counters["rows_checked"] = static_cast<double>(rows_checked);
+    }
+    BENCHMARK(BM_Station_Ingest)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+    /// Reading the snapshot while another thread publishes a new one as fast as it can. Every
+    /// field of each snapshot published comes from the same counter; fails if a read ever mixes
+    /// two. `writes` is how many snapshots were published while reading.
+    static void BM_Station_Snapshot(benchmark::State& state) {
+        SnapshotCell<Snapshot> cell;
+        std::atomic<bool> writing = true;
+        std::thread writer([&] {
+            Snapshot snapshot;
+            for (uint32_t n = 1; writing.load(std::memory_order_relaxed); n++) {
+                snapshot.stats = { n, n, n, n, n, n, n };
+                snapshot.sequence = static_cast<uint16_t>(n);
+                snapshot.time_ms = n;
+                snapshot.state.altitude = static_cast<float>(n % 65536);
+                snapshot.gps.latitude_e7 = static_cast<int32_t>(n);
+                snapshot.received_ns = n;
+                cell.store(snapshot);
+            }
+        });
+
+        bool torn = false;
+        for (auto _ : state) {
+            auto const snapshot = cell.load();
+            auto const n = snapshot.time_ms;
+            torn |= snapshot.stats.bytes != n || snapshot.stats.unstored != n
+                || snapshot.sequence != static_cast<uint16_t>(n)
+                || snapshot.state.altitude != static_cast<float>(n % 65536)
+                || snapshot.gps.latitude_e7 != static_cast<int32_t>(n)
+                || snapshot.received_ns != n;
+        }
+        writing = false;
+        writer.join();
+
+        if (torn) {
+            state.SkipWithError("a read mixed two snapshots");
+            return;
+        }
+        state.counters["writes"] = static_cast<double>(cell.version());
+    }
+    BENCHMARK(BM_Station_Snapshot);
+
+    namespace {
+        /// A stream with something wrong with it, and which frames made it through untouched.
+        struct Mangled {
+            std::vector<uint8_t> bytes;
+            /// Where each frame whose bytes are all in `bytes`, together and unchanged, starts.
+            std::vector<size_t> intact;
+        };
+
+        /// `frames`, one after another, put through a radio that flips, drops and adds bytes,
+        /// cuts frames short, sends noise that looks like a sync, repeats frames and wipes out
+        /// bursts of bytes, each at a rate picked at random for the case.
+        Mangled mangle(std::mt19937& rng, std::vector<FrameBytes> const& frames) {
+            constexpr double rates[] = { 0, 2, 20, 200, 1000 };
+            auto const pick_rate = [&] {
+                return rates[std::uniform_int_distribution<size_t>(0, std::size(rates) - 1)(rng)]
+                    / 10'000;
+            };
+            std::bernoulli_distribution flip(pick_rate());
+            std::bernoulli_distribution drop(pick_rate());
+            std::bernoulli_distribution insert(pick_rate());
+            std::bernoulli_distribution truncate(pick_rate() * FRAME_LEN);
+            std::bernoulli_distribution noise(pick_rate() * FRAME_LEN);
+            std::bernoulli_distribution repeat(pick_rate() * FRAME_LEN);
+            std::bernoulli_distribution burst(pick_rate() * FRAME_LEN);
+            std::uniform_int_distribution<int> any_byte(0, 255);
+            std::uniform_int_distribution<int> any_nonzero(1, 255);
+            std::uniform_int_distribution<size_t> noise_len(0, 2 * FRAME_LEN);
+            std::uniform_int_distribution<size_t> burst_len(1, 2 * FRAME_LEN);
+            std::uniform_int_distribution<size_t> cut(1, FRAME_LEN - 1);
+
+            struct Copy {
+                uint16_t sequence;
+                size_t begin;
+                bool touched;
+            };
+            std::vector<Copy> copies;
+            Mangled out;
+            auto const emit = [&](FrameBytes const& frame, uint16_t sequence) {
+                auto const begin = out.bytes.size();
+                auto const len = truncate(rng) ? cut(rng) : FRAME_LEN;
+                bool touched = len != FRAME_LEN;
+                for (size_t i = 0; i < len; i++) {
+                    if (drop(rng)) {
+                        touched = true;
+                        continue;
+                    }
+                    auto byte = frame[i];
+                    if (flip(rng)) {
+                        byte ^= static_cast<uint8_t>(any_nonzero(rng));
+                        touched = true;
+                    }
+                    out.bytes.push_back(byte);
+                    if (insert(rng)) {
+                        out.bytes.push_back(static_cast<uint8_t>(any_byte(rng)));
+                        touched = true;
+                    }
+                }
+                copies.push_back({ sequence, begin, touched });
+            };
+
+            for (size_t i = 0; i < frames.size(); i++) {
+                if (noise(rng)) {
+                    // Half the time, noise that starts like a frame
+                    if (any_byte(rng) & 1) {
+                        out.bytes.insert(out.bytes.end(), FRAME_SYNC, FRAME_SYNC + 2);
+                    }
+                    for (auto n = noise_len(rng); n > 0; n--) {
+                        out.bytes.push_back(static_cast<uint8_t>(any_byte(rng)));
+                    }
+                }
+                auto const sequence = static_cast<uint16_t>(frames[i][2] | frames[i][3] << 8);
+                emit(frames[i], sequence);
+                if (i > 0 && repeat(rng)) {
+                    emit(frames[i - 1], static_cast<uint16_t>(sequence - 1));
+                }
+            }
+
+            // Bursts wipe out whatever they land on, across frame boundaries
+            auto const bursts = static_cast<size_t>(burst.p() * static_cast<double>(frames.size()));
+            for (size_t b = 0; b < bursts && !out.bytes.empty(); b++) {
+                auto const begin = std::uniform_int_distribution<size_t>(0,
+                    out.bytes.size() - 1)(rng);
+                auto const end = std::min(out.bytes.size(), begin + burst_len(rng));
+                for (auto i = begin; i < end; i++) {
+                    out.bytes[i] = static_cast<uint8_t>(any_byte(rng));
+                }
+                for (auto& copy : copies) {
+                    copy.touched |= copy.begin < end && begin < copy.begin + FRAME_LEN;
+                }
+            }
+
+            for (auto const& copy : copies) {
+                if (!copy.touched) {
+                    out.intact.push_back(copy.begin);
+                }
+            }
+            return out;
+        }
+    }
+
+    /// A fuzzer for the ingest's deframing, deterministic so that a failure can be replayed: each
+    /// iteration is a new case of 500 frames, numbered from a random sequence so some wrap,
+    /// put through mangle() and split into reads of random sizes. Fails if feeding the reads
+    /// finds different frames, or counts differently, from pushing the stream a byte at a time;
+    /// if a frame that came through intact isn't found, unless another frame was accepted
+    /// across it; or if more damaged frames pass their CRC than a 16-bit CRC lets through (one in
+    /// 65,536, with a wide margin). A frame that is accepted but isn't byte for byte one that
+    /// was sent is a `false_accept`.
+    static void BM_Station_Fuzz(benchmark::State& state) {
+        constexpr size_t frame_count = 500;
+        uint32_t seed = 0;
+        uint64_t sent = 0;
+        uint64_t found = 0;
+        uint64_t corrupted = 0;
+        uint64_t false_accepts = 0;
+        uint64_t intact = 0;
+        uint64_t missed = 0;
+        bool mismatch = false;
+        bool unexplained_miss = false;
+
+        for (auto _ : state) {
+            std::mt19937 rng(seed++);
+            auto const first = static_cast<uint16_t>(rng());
+            std::vector<FrameBytes> frames;
+            for (size_t i = 0; i < frame_count; i++) {
+                frames.push_back(make_frame(static_cast<uint16_t>(first + i),
+                    static_cast<uint32_t>(i)));
+            }
+            auto const mangled = mangle(rng, frames);
+
+            // A frame is only right if its bytes are the ones sent. Damage that happens to keep
+            // the CRC can leave the fields as they were, changing only the padding.
+            Deframer by_byte;
+            std::vector<Frame> pushed;
+            uint64_t case_false_accepts = 0;
+            std::set<uint16_t> accepted;
+            /// Where each frame accepted started, right or not.
+            std::vector<size_t> starts;
+            for (size_t i = 0; i < mangled.bytes.size(); i++) {
+                auto const frame = by_byte.push(mangled.bytes[i]);
+                if (!frame.has_value()) {
+                    continue;
+                }
+                pushed.push_back(*frame);
+                starts.push_back(i + 1 - FRAME_LEN);
+                auto const index = static_cast<uint16_t>(frame->sequence - first);
+                if (index >= frame_count || !std::equal(frames[index].begin(),
+                    frames[index].end(), &mangled.bytes[i + 1 - FRAME_LEN])) {
+                    case_false_accepts++;
+                    continue;
+                }
+                accepted.insert(frame->sequence);
+            }
+
+            Deframer bulk;
+            std::vector<Frame> fed;
+            std::uniform_int_distribution<size_t> read_len(1, 3 * FRAME_LEN);
+            for (size_t offset = 0; offset < mangled.bytes.size();) {
+                // Reads of every size, from a byte to several frames
+                auto const len = std::min(rng() % 4 == 0 ? Ingest::CHUNK_LEN : read_len(rng),
+                    mangled.bytes.size() - offset);
+                bulk.feed(&mangled.bytes[offset], len, [&](Frame const& frame) {
+                    fed.push_back(frame);
+                });
+                offset += len;
+            }
+            mismatch |= fed != pushed || bulk.frames() != by_byte.frames()
+                || bulk.corrupted() != by_byte.corrupted() || bulk.skipped() != by_byte.skipped();
+
+            // The only thing that can hide an intact frame is a frame accepted across its start,
+            // which may even be a damaged one that lost a byte the intact one starts with
+            uint64_t case_missed = 0;
+            for (auto begin : mangled.intact) {
+                auto const after = std::lower_bound(starts.begin(), starts.end(), begin);
+                bool const found = after != starts.end() && *after == begin;
+                bool const hidden = (after != starts.end() && *after < begin + FRAME_LEN)
+                    || (after != starts.begin() && *(after - 1) + FRAME_LEN > begin);
+                case_missed += !found;
+                unexplained_miss |= !found && !hidden;
+            }
+
+            sent += frame_count;
+            found += accepted.size();
+            corrupted += by_byte.corrupted();
+            false_accepts += case_false_accepts;
+            intact += mangled.intact.size();
+            missed += case_missed;
+        }
+
+        if (mismatch) {
+            state.SkipWithError("feeding found different frames from pushing");
+            return;
+        }
+        if (unexplained_miss) {
+            state.SkipWithError("an intact frame was missed");
+            return;
+        }
+        if (false_accepts > 1 + corrupted / 4096) {
+            state.SkipWithError("damaged frames passed their CRC too often");
+            return;
+        }
+
+        state.counters["cases"] = static_cast<double>(seed);
+        state.counters["recovered"] = static_cast<double>(found) / static_cast<double>(sent);
+        state.counters["intact_found"] = static_cast<double>(intact - missed)
+            / static_cast<double>(std::max<uint64_t>(intact, 1));
+        state.counters["corrupted"] = static_cast<double>(corrupted);
+        state.counters["false_accepts"] = static_cast<double>(false_accepts);
+    }
+    BENCHMARK(BM_Station_Fuzz)->Iterations(2000)->Unit(benchmark::kMicrosecond);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <expected>
+#include <string>
+
+// Exceptionless error handling for the ground station, in the same shape as the trajectory
+// engine's. It only ever runs on a laptop, so an error owns its message and can name the device
+// or file that failed.
+
+/// Returns std::unexpected if the given std::expected value is an error.
+#define TRY(x) ({                                                                                   \
+    auto result = (x);                                                                              \
+    if (!result.has_value()) {                                                                      \
+        return std::unexpected(std::move(result).error());                                          \
+    }                                                                                               \
+    std::move(result).value();                                                                      \
+})
+
+namespace seds::station {
+    /// Contains either a value or a message saying what went wrong.
+    template<typename T>
+    using Expected = std::expected<T, std::string>;
+}
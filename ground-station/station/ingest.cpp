@@ -0,0 +1,208 @@
+#include "station/ingest.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace seds::station {
+
+using namespace seds::telemetry;
+
+Ingest::~Ingest() {
+    (void) this->stop();
+}
+
+Expected<void> Ingest::start(IngestConfig const& config) {
+    if (!config.record.empty()) {
+        this->recording = open(config.record.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+            0644);
+        if (this->recording < 0) {
+            return std::unexpected(config.record.string() + ": " + strerror(errno));
+        }
+        this->recording_name = config.record.string();
+    }
+
+    this->reading.store(true, std::memory_order_relaxed);
+    this->reader = std::thread([this] { this->read_loop(); });
+    this->ingester = std::thread([this] { this->ingest_loop(); });
+    return {};
+}
+
+Expected<void> Ingest::stop() {
+    if (!this->reader.joinable()) {
+        return {};
+    }
+
+    this->stopping.store(true, std::memory_order_relaxed);
+    this->reader_wake.fetch_add(1, std::memory_order_release);
+    this->reader_wake.notify_one();
+    this->reader.join();
+    this->ingester.join();
+
+    std::optional<std::string> error = this->read_error;
+    if (this->recording >= 0) {
+        if (close(this->recording) != 0 && this->record_error == 0) {
+            this->record_error = errno;
+        }
+        if (this->record_error != 0 && !error.has_value()) {
+            error = this->recording_name + ": " + strerror(this->record_error);
+        }
+        this->recording = -1;
+    }
+    if (error.has_value()) {
+        return std::unexpected(*error);
+    }
+    return {};
+}
+
+void Ingest::read_loop() {
+    auto& ring = *this->ring;
+    while (!this->stopping.load(std::memory_order_relaxed)) {
+        // Read the wakeup count first, so a chunk freed after the ring looks full still wakes us
+        auto const seen = this->reader_wake.load(std::memory_order_acquire);
+        auto* chunk = ring.claim();
+        if (chunk == nullptr) {
+            this->stalls.fetch_add(1, std::memory_order_relaxed);
+            this->reader_wake.wait(seen, std::memory_order_acquire);
+            continue;
+        }
+
+        auto const count = this->source->read(std::span(chunk->bytes));
+        if (!count.has_value()) {
+            this->read_error = count.error();
+            break;
+        }
+        if (*count == 0) {
+            if (this->source->ended()) {
+                break;
+            }
+            continue;
+        }
+        chunk->len = static_cast<uint32_t>(*count);
+        ring.commit();
+        this->ingest_wake.fetch_add(1, std::memory_order_release);
+        this->ingest_wake.notify_one();
+    }
+
+    this->reading.store(false, std::memory_order_release);
+    this->ingest_wake.fetch_add(1, std::memory_order_release);
+    this->ingest_wake.notify_one();
+}
+
+void Ingest::ingest_loop() {
+    auto& ring = *this->ring;
+    while (true) {
+        auto const seen = this->ingest_wake.load(std::memory_order_acquire);
+        auto const chunks = ring.readable();
+        if (chunks.empty()) {
+            if (!this->reading.load(std::memory_order_acquire)) {
+                // The reader's last chunk may have gone in just before it stopped
+                if (ring.readable().empty()) {
+                    break;
+                }
+                continue;
+            }
+            this->ingest_wake.wait(seen, std::memory_order_acquire);
+            continue;
+        }
+
+        this->record(chunks);
+        for (auto const& chunk : chunks) {
+            this->ingest(chunk);
+        }
+        ring.release(chunks.size());
+        this->reader_wake.fetch_add(1, std::memory_order_release);
+        this->reader_wake.notify_one();
+
+        auto& stats = this->next.stats;
+        if (this->deframer.frames() != stats.frames) {
+            this->next.received_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+        stats.frames = this->deframer.frames();
+        stats.corrupted = this->deframer.corrupted();
+        stats.skipped = this->deframer.skipped();
+        stats.stalls = this->stalls.load(std::memory_order_relaxed);
+        this->latest.store(this->next);
+    }
+
+    this->next.stats.stalls = this->stalls.load(std::memory_order_relaxed);
+    this->latest.store(this->next);
+    this->finished.store(true, std::memory_order_release);
+}
+
+void Ingest::record(std::span<Chunk const> chunks) {
+    if (this->recording < 0 || this->record_error != 0) {
+        return;
+    }
+
+    iovec pieces[RING_CHUNKS];
+    size_t count = 0;
+    for (auto const& chunk : chunks) {
+        pieces[count++] = { .iov_base = const_cast<uint8_t*>(chunk.bytes), .iov_len = chunk.len };
+    }
+    // The disk may take less than everything at once
+    auto* piece = pieces;
+    while (count > 0) {
+        auto written = writev(this->recording, piece, static_cast<int>(count));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            this->record_error = errno;
+            return;
+        }
+        while (count > 0 && static_cast<size_t>(written) >= piece->iov_len) {
+            written -= static_cast<ssize_t>(piece->iov_len);
+            piece++;
+            count--;
+        }
+        if (count > 0) {
+            piece->iov_base = static_cast<uint8_t*>(piece->iov_base) + written;
+            piece->iov_len -= static_cast<size_t>(written);
+        }
+    }
+}
+
+void Ingest::ingest(Chunk const& chunk) {
+    this->next.stats.bytes += chunk.len;
+    this->deframer.feed(chunk.bytes, chunk.len, [this](Frame const& frame) {
+        this->take(frame);
+    });
+}
+
+void Ingest::take(Frame const& frame) {
+    auto& next = this->next;
+    if (this->last_sequence.has_value()) {
+        // A jump back, from the flight computer restarting or a replay starting over, isn't loss
+        auto const gap = static_cast<uint16_t>(frame.sequence - *this->last_sequence - 1);
+        next.stats.lost += gap < 0x8000 ? gap : 0;
+    }
+    this->last_sequence = frame.sequence;
+    if (!this->frames.append(frame)) {
+        next.stats.unstored++;
+    }
+
+    next.heard |= frame.contents;
+    next.sequence = frame.sequence;
+    next.time_ms = frame.time_ms;
+    next.state = frame.state;
+    if (frame.contents & GROUP_HEALTH) {
+        next.health = frame.health;
+        next.health_ms = frame.time_ms;
+    }
+    if (frame.contents & GROUP_ESTIMATOR) {
+        next.estimator = frame.estimator;
+        next.estimator_ms = frame.time_ms;
+    }
+    if (frame.contents & GROUP_GPS) {
+        next.gps = frame.gps;
+        next.gps_ms = frame.time_ms;
+    }
+}
+
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+// The ground station's pipeline: bytes from a source, recorded as they came, deframed, decoded
+// into the store and summed up in a snapshot.
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "spsc_ring.h"
+#include "station/errors.h"
+#include "station/snapshot.h"
+#include "station/source.h"
+#include "station/store.h"
+#include "telemetry/frame.h"
+
+namespace seds::station {
+    /// Settings for Ingest.
+    struct IngestConfig {
+        /// Where to record the raw stream, byte for byte as it came in. Empty records nothing.
+        std::filesystem::path record;
+    };
+
+    /// Takes in everything a source sends, on two threads of its own.
+    ///
+    /// The reader thread only reads: it fills chunks of a lock-free ring straight from the
+    /// source, so a serial port or socket is drained as soon as bytes arrive. The ingest thread
+    /// takes whole runs of chunks at a time, writes them to the recording straight from the ring
+    /// in one system call, deframes them in place
+    /// (see Deframer::feed), appends each frame to the store and publishes a snapshot once per
+    /// run rather than per frame. Neither thread locks anything; each sleeps on the other only
+    /// when there is nothing to do. A recorded stream is read as fast as the disk gives it, far
+    /// faster than any radio link, and if the ingest ever falls behind the reader waits for it
+    /// (counted in IngestStats::stalls) rather than dropping bytes.
+    class Ingest {
+    public:
+        /// Bytes read at once.
+        static constexpr size_t CHUNK_LEN = 4096;
+        /// Chunks that can wait between the threads: a megabyte of burst.
+        static constexpr size_t RING_CHUNKS = 256;
+
+        explicit Ingest(std::unique_ptr<Source> source) : source(std::move(source)) {}
+        ~Ingest();
+
+        Ingest(Ingest const&) = delete;
+        Ingest& operator=(Ingest const&) = delete;
+
+        /// Opens the recording, if any, and starts reading.
+        Expected<void> start(IngestConfig const& config = {});
+
+        /// Stops reading, ingests everything already read and closes the recording. Returns the
+        /// first error reading the source or writing the recording, if there was one.
+        Expected<void> stop();
+
+        /// Whether everything the source will ever send has been ingested: a recorded stream has
+        /// been read to its end, or reading failed.
+        [[nodiscard]]
+        bool done() const {
+            return this->finished.load(std::memory_order_acquire);
+        }
+
+        /// The latest state, from any thread.
+        [[nodiscard]]
+        Snapshot snapshot() const {
+            return this->latest.load();
+        }
+
+        /// Snapshots published so far, to tell whether there is a new one.
+        [[nodiscard]]
+        uint64_t version() const {
+            return this->latest.version();
+        }
+
+        /// Every frame so far, from any thread (see Store).
+        [[nodiscard]]
+        Store const& store() const {
+            return this->frames;
+        }
+
+        [[nodiscard]]
+        Source const& input() const {
+            return *this->source;
+        }
+
+    private:
+        struct Chunk {
+            uint32_t len;
+            uint8_t bytes[CHUNK_LEN];
+        };
+
+        void read_loop();
+        void ingest_loop();
+        void record(std::span<Chunk const> chunks);
+        void ingest(Chunk const& chunk);
+        void take(telemetry::Frame const& frame);
+
+        std::unique_ptr<Source> source;
+        std::unique_ptr<SpscRing<Chunk, RING_CHUNKS>> ring
+            = std::make_unique<SpscRing<Chunk, RING_CHUNKS>>();
+        std::thread reader;
+        std::thread ingester;
+
+        std::atomic<bool> stopping = false;
+        /// Cleared by the reader when it won't commit any more chunks.
+        std::atomic<bool> reading = false;
+        std::atomic<bool> finished = false;
+        /// Bumped to wake the reader when a chunk is freed, or to stop it.
+        std::atomic<uint32_t> reader_wake = 0;
+        /// Bumped to wake the ingest thread when a chunk is committed, or reading ends.
+        std::atomic<uint32_t> ingest_wake = 0;
+        std::atomic<uint64_t> stalls = 0;
+        /// Written by the reader before it clears `reading`.
+        std::optional<std::string> read_error;
+
+        // Only the ingest thread touches these while it runs
+
+        /// -1 if not recording.
+        int recording = -1;
+        std::string recording_name;
+        /// errno of the first failed write to the recording.
+        int record_error = 0;
+        telemetry::Deframer deframer;
+        std::optional<uint16_t> last_sequence;
+        Snapshot next;
+        Store frames;
+        SnapshotCell<Snapshot> latest;
+    };
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+// The latest state heard from the rocket, shared from the ingest thread with any number of
+// readers without locks.
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "telemetry/frame.h"
+
+namespace seds::station {
+    /// Counts of what has come in so far.
+    struct IngestStats {
+        /// Bytes read from the source.
+        uint64_t bytes = 0;
+        /// Frames decoded.
+        uint64_t frames = 0;
+        /// Frames missing between those decoded, by their sequence numbers.
+        uint64_t lost = 0;
+        /// Frames that started with the sync but failed their CRC.
+        uint64_t corrupted = 0;
+        /// Bytes thrown away looking for a frame.
+        uint64_t skipped = 0;
+        /// Times the reader found the ingest behind and had to wait for it.
+        uint64_t stalls = 0;
+        /// Frames decoded after the store filled up, which are in the snapshot but not stored.
+        uint64_t unstored = 0;
+    };
+
+    /// Everything the ground knows of the rocket at one moment. Each group is as of the last
+    /// frame that carried it; `heard` says which have ever come down.
+    struct Snapshot {
+        IngestStats stats;
+        /// Group bits.
+        uint8_t heard = 0;
+        uint16_t sequence = 0;
+        /// Flight computer time of the newest frame, ms.
+        uint32_t time_ms = 0;
+        telemetry::State state;
+        uint32_t health_ms = 0;
+        telemetry::Health health;
+        uint32_t estimator_ms = 0;
+        telemetry::EstimatorQuality estimator;
+        uint32_t gps_ms = 0;
+        telemetry::GpsFix gps;
+        /// When the newest frame arrived, by the ground's steady clock, ns.
+        int64_t received_ns = 0;
+    };
+
+    /// One value written by a single thread and read by any number of others, as a seqlock.
+    ///
+    /// The writer never waits: it marks the value as changing, writes it, and marks it done.
+    /// Readers never block the writer or each other; a reader that overlaps a write sees the
+    /// mark change and reads again. The value is kept in atomic words so that a read racing a
+    /// write is only ever a retry, never undefined behaviour.
+    template<typename T>
+    class SnapshotCell {
+        static_assert(std::is_trivially_copyable_v<T>, "values are copied in and out as words");
+
+        static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    public:
+        /// Replaces the value. Only one thread may write.
+        void store(T const& value) {
+            uint64_t words[WORDS] = {};
+            std::memcpy(words, &value, sizeof(T));
+
+            auto const sequence = this->sequence.load(std::memory_order_relaxed);
+            this->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (size_t i = 0; i < WORDS; i++) {
+                this->words[i].store(words[i], std::memory_order_relaxed);
+            }
+            this->sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        /// The value as of the last finished store.
+        T load() const {
+            uint64_t words[WORDS];
+            while (true) {
+                auto const before = this->sequence.load(std::memory_order_acquire);
+                if (before & 1) {
+                    // The writer may be waiting for this core
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t i = 0; i < WORDS; i++) {
+                    words[i] = this->words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (this->sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+
+            T value;
+            std::memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+        /// How many stores have finished.
+        [[nodiscard]]
+        uint64_t version() const {
+            return this->sequence.load(std::memory_order_acquire) / 2;
+        }
+
+    private:
+        /// Odd while a store is in progress.
+        std::atomic<uint64_t> sequence { 0 };
+        std::atomic<uint64_t> words[WORDS] = {};
+    };
+}
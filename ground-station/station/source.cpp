@@ -0,0 +1,163 @@
+#include "station/source.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace seds::station {
+
+namespace {
+    std::string describe(std::string const& what) {
+        return what + ": " + strerror(errno);
+    }
+
+    /// Raw mode: every byte as it comes, nothing echoed or translated.
+    bool make_raw(int fd, speed_t speed) {
+        termios settings;
+        if (tcgetattr(fd, &settings) != 0) {
+            return false;
+        }
+        cfmakeraw(&settings);
+        settings.c_cflag |= CLOCAL | CREAD;
+        settings.c_cc[VMIN] = 0;
+        settings.c_cc[VTIME] = 0;
+        if (speed != 0 && (cfsetispeed(&settings, speed) != 0
+            || cfsetospeed(&settings, speed) != 0)) {
+            return false;
+        }
+        return tcsetattr(fd, TCSANOW, &settings) == 0;
+    }
+
+    speed_t speed_of(uint32_t baud) {
+        switch (baud) {
+        case 9600: return B9600;
+        case 19200: return B19200;
+        case 38400: return B38400;
+        case 57600: return B57600;
+        case 115200: return B115200;
+        case 230400: return B230400;
+        case 460800: return B460800;
+        case 921600: return B921600;
+        default: return 0;
+        }
+    }
+}
+
+Source::~Source() {
+    close(this->fd);
+    if (this->peer >= 0) {
+        close(this->peer);
+    }
+}
+
+Expected<size_t> Source::read(std::span<uint8_t> dest) {
+    if (this->at_end) {
+        return 0;
+    }
+    if (!this->recorded) {
+        pollfd wait = { .fd = this->fd, .events = POLLIN, .revents = 0 };
+        auto const ready = poll(&wait, 1, POLL_MS);
+        if (ready < 0 && errno != EINTR) {
+            return std::unexpected(describe(this->label));
+        }
+        if (ready <= 0) {
+            return 0;
+        }
+    }
+
+    auto const count = ::read(this->fd, dest.data(), dest.size());
+    if (count < 0) {
+        if (errno == EINTR || errno == EAGAIN) {
+            return 0;
+        }
+        return std::unexpected(describe(this->label));
+    }
+    if (count == 0 && this->recorded) {
+        this->at_end = true;
+    }
+    return static_cast<size_t>(count);
+}
+
+Expected<std::unique_ptr<Source>> open_file(std::filesystem::path const& path) {
+    auto const fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(describe(path.string()));
+    }
+    // Read front to back, once
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return std::unique_ptr<Source>(new Source(fd, path.string(), true));
+}
+
+Expected<std::unique_ptr<Source>> open_serial(std::filesystem::path const& device,
+    uint32_t baud) {
+    auto const speed = speed_of(baud);
+    if (speed == 0) {
+        return std::unexpected(std::to_string(baud) + " isn't a baud rate the port can be set to");
+    }
+    auto const fd = open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(describe(device.string()));
+    }
+    if (!make_raw(fd, speed)) {
+        auto error = describe(device.string());
+        close(fd);
+        return std::unexpected(error);
+    }
+    return std::unique_ptr<Source>(new Source(fd, device.string(), false));
+}
+
+Expected<std::unique_ptr<Source>> open_pty() {
+    auto const fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        auto error = describe("pty");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return std::unexpected(error);
+    }
+    std::string const path = ptsname(fd);
+
+    // Without anything holding the other end open, the pty hangs up whenever a writer closes it,
+    // and polling it spins
+    auto const peer = open(path.c_str(), O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (peer < 0 || !make_raw(peer, 0)) {
+        auto error = describe(path);
+        close(fd);
+        if (peer >= 0) {
+            close(peer);
+        }
+        return std::unexpected(error);
+    }
+    return std::unique_ptr<Source>(new Source(fd, path, false, peer));
+}
+
+Expected<std::unique_ptr<Source>> open_udp(uint16_t port) {
+    auto const fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(describe("udp"));
+    }
+    // Room for a burst to wait while the ingest catches up
+    int const buffer = 4 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) {
+        auto error = describe("udp port " + std::to_string(port));
+        close(fd);
+        return std::unexpected(error);
+    }
+    return std::unique_ptr<Source>(new Source(fd, "udp port " + std::to_string(port), false));
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// Where the ground station's bytes come from: the receiver on a serial port, a pty or UDP socket
+// standing in for it, or a stream recorded earlier.
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "station/errors.h"
+
+namespace seds::station {
+    /// A stream of bytes from the radio, read in whatever pieces they arrive in.
+    ///
+    /// Reads wait at most `POLL_MS` for bytes, so whoever is reading can notice it has been
+    /// asked to stop.
+    class Source {
+    public:
+        static constexpr int POLL_MS = 100;
+
+        ~Source();
+
+        Source(Source const&) = delete;
+        Source& operator=(Source const&) = delete;
+
+        /// Reads up to `dest.size()` bytes. Returns how many, which is zero if none came within
+        /// POLL_MS or the stream has ended.
+        Expected<size_t> read(std::span<uint8_t> dest);
+
+        /// Whether a recorded stream has been read to its end. Live sources never end.
+        [[nodiscard]]
+        bool ended() const {
+            return this->at_end;
+        }
+
+        /// What the source is, for messages: a path, or a port.
+        [[nodiscard]]
+        std::string const& name() const {
+            return this->label;
+        }
+
+    private:
+        friend Expected<std::unique_ptr<Source>> open_file(std::filesystem::path const& path);
+        friend Expected<std::unique_ptr<Source>> open_serial(std::filesystem::path const& device,
+            uint32_t baud);
+        friend Expected<std::unique_ptr<Source>> open_pty();
+        friend Expected<std::unique_ptr<Source>> open_udp(uint16_t port);
+
+        Source(int fd, std::string label, bool recorded, int peer = -1)
+            : fd(fd), peer(peer), label(std::move(label)), recorded(recorded) {}
+
+        int fd;
+        /// The pty's other end, held open so the source doesn't hang up between writers.
+        int peer;
+        std::string label;
+        /// Read to its end instead of polled.
+        bool recorded;
+        bool at_end = false;
+    };
+
+    /// A stream recorded earlier, read as fast as it can be.
+    Expected<std::unique_ptr<Source>> open_file(std::filesystem::path const& path);
+
+    /// The receiver on a serial port, in raw mode at `baud`.
+    Expected<std::unique_ptr<Source>> open_serial(std::filesystem::path const& device,
+        uint32_t baud);
+
+    /// A new pseudo-terminal, for a simulated receiver to write to as if it were a serial port.
+    /// Its name() is the path of the end to write to.
+    Expected<std::unique_ptr<Source>> open_pty();
+
+    /// Datagrams sent to `port` on any local address, each a piece of the stream in order.
+    Expected<std::unique_ptr<Source>> open_udp(uint16_t port);
+}
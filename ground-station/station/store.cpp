@@ -0,0 +1,152 @@
+#include "station/store.h"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace seds::station {
+
+using namespace seds::telemetry;
+
+namespace {
+    /// A file that closes itself.
+    struct File {
+        explicit File(std::filesystem::path const& path) : handle(std::fopen(path.c_str(), "w")) {
+            if (this->handle != nullptr) {
+                // Tables run to millions of rows
+                std::setvbuf(this->handle, nullptr, _IOFBF, 1 << 20);
+            }
+        }
+
+        ~File() {
+            if (this->handle != nullptr) {
+                std::fclose(this->handle);
+            }
+        }
+
+        File(File const&) = delete;
+        File& operator=(File const&) = delete;
+
+        FILE* handle;
+    };
+
+    Expected<void> write_table(std::filesystem::path const& path, char const* header, size_t rows,
+        auto&& write_row) {
+        File file(path);
+        if (file.handle == nullptr) {
+            return std::unexpected(path.string() + ": " + strerror(errno));
+        }
+        std::fprintf(file.handle, "%s\n", header);
+        for (size_t row = 0; row < rows; row++) {
+            write_row(file.handle, row);
+        }
+        if (std::fflush(file.handle) != 0 || std::ferror(file.handle)) {
+            return std::unexpected(path.string() + ": " + strerror(errno));
+        }
+        return {};
+    }
+}
+
+void StateTable::append(Frame const& frame) {
+    auto const row = this->next();
+    this->time_ms.set(row, frame.time_ms);
+    this->sequence.set(row, frame.sequence);
+    this->altitude.set(row, frame.state.altitude);
+    this->velocity.set(row, frame.state.velocity);
+    this->acceleration.set(row, frame.state.acceleration);
+    this->phase.set(row, frame.state.phase);
+    this->publish();
+}
+
+void HealthTable::append(Frame const& frame) {
+    auto const row = this->next();
+    this->time_ms.set(row, frame.time_ms);
+    this->valid.set(row, frame.health.valid);
+    this->dead.set(row, frame.health.dead);
+    this->queue_overruns.set(row, frame.health.queue_overruns);
+    this->missed_periods.set(row, frame.health.missed_periods);
+    this->max_queue_depth.set(row, frame.health.max_queue_depth);
+    this->publish();
+}
+
+void EstimatorTable::append(Frame const& frame) {
+    auto const row = this->next();
+    this->time_ms.set(row, frame.time_ms);
+    this->altitude_sigma.set(row, frame.estimator.altitude_sigma);
+    this->high_g_weight.set(row, frame.estimator.high_g_weight);
+    this->accel_bias.set(row, frame.estimator.accel_bias);
+    this->publish();
+}
+
+void GpsTable::append(Frame const& frame) {
+    auto const row = this->next();
+    this->time_ms.set(row, frame.time_ms);
+    this->latitude_e7.set(row, frame.gps.latitude_e7);
+    this->longitude_e7.set(row, frame.gps.longitude_e7);
+    this->altitude.set(row, frame.gps.altitude);
+    this->satellites.set(row, frame.gps.satellites);
+    this->fix.set(row, frame.gps.fix);
+    this->publish();
+}
+
+bool Store::append(Frame const& frame) {
+    // Every frame has State, so that table fills first
+    if (this->state_table.rows() == CAPACITY) {
+        return false;
+    }
+    this->state_table.append(frame);
+    if (frame.contents & GROUP_HEALTH) {
+        this->health_table.append(frame);
+    }
+    if (frame.contents & GROUP_ESTIMATOR) {
+        this->estimator_table.append(frame);
+    }
+    if (frame.contents & GROUP_GPS) {
+        this->gps_table.append(frame);
+    }
+    return true;
+}
+
+Expected<void> Store::write_csv(std::filesystem::path const& dir) const {
+    std::error_code error;
+    std::filesystem::create_directories(dir, error);
+    if (error) {
+        return std::unexpected(dir.string() + ": " + error.message());
+    }
+
+    auto const& state = this->state_table;
+    TRY(write_table(dir / "state.csv", "sequence,time (ms),phase,altitude (m),velocity (m/s),"
+        "acceleration (m/s^2)", state.rows(), [&](FILE* file, size_t row) {
+        std::fprintf(file, "%u,%" PRIu32 ",%s,%.1f,%.2f,%.2f\n", state.sequence[row],
+            state.time_ms[row], to_string(state.phase[row]), state.altitude[row],
+            state.velocity[row], state.acceleration[row]);
+    }));
+
+    auto const& health = this->health_table;
+    TRY(write_table(dir / "health.csv", "time (ms),valid,dead,queue overruns,missed periods,"
+        "max queue depth", health.rows(), [&](FILE* file, size_t row) {
+        std::fprintf(file, "%" PRIu32 ",0x%02x,0x%02x,%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\n",
+            health.time_ms[row], health.valid[row], health.dead[row], health.queue_overruns[row],
+            health.missed_periods[row], health.max_queue_depth[row]);
+    }));
+
+    auto const& estimator = this->estimator_table;
+    TRY(write_table(dir / "estimator.csv", "time (ms),altitude sigma (m),high g weight,"
+        "accel bias (m/s^2)", estimator.rows(), [&](FILE* file, size_t row) {
+        std::fprintf(file, "%" PRIu32 ",%.1f,%.3f,%.2f\n", estimator.time_ms[row],
+            estimator.altitude_sigma[row], estimator.high_g_weight[row],
+            estimator.accel_bias[row]);
+    }));
+
+    auto const& gps = this->gps_table;
+    TRY(write_table(dir / "gps.csv", "time (ms),latitude (deg),longitude (deg),altitude (m),"
+        "satellites,fix", gps.rows(), [&](FILE* file, size_t row) {
+        std::fprintf(file, "%" PRIu32 ",%.7f,%.7f,%.0f,%u,%u\n", gps.time_ms[row],
+            gps.latitude_e7[row] * 1e-7, gps.longitude_e7[row] * 1e-7, gps.altitude[row],
+            gps.satellites[row], static_cast<unsigned>(gps.fix[row]));
+    }));
+    return {};
+}
+
+}
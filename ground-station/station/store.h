@@ -0,0 +1,175 @@
+#pragma once
+
+// Every frame the ground station has decoded, kept in memory a column per field so a plot or an
+// export reads only the fields it needs.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+#include "station/errors.h"
+#include "telemetry/frame.h"
+
+namespace seds::station {
+    /// One field of a table, appended to by one thread while others read the rows already there.
+    ///
+    /// Rows are kept in fixed-size chunks that never move once allocated, so appending never
+    /// copies what is already stored and a reader's references stay good. Which rows exist is up
+    /// to the table (see Table).
+    template<typename T>
+    class Column {
+    public:
+        static constexpr size_t CHUNK_ROWS = 4096;
+        static constexpr size_t MAX_CHUNKS = 4096;
+        static constexpr size_t CAPACITY = CHUNK_ROWS * MAX_CHUNKS;
+
+        Column() : chunks(std::make_unique<std::unique_ptr<T[]>[]>(MAX_CHUNKS)) {}
+
+        /// Writes `row`, the one after the last written. `row` must be below CAPACITY.
+        void set(size_t row, T value) {
+            auto& chunk = this->chunks[row / CHUNK_ROWS];
+            if (chunk == nullptr) {
+                chunk = std::make_unique_for_overwrite<T[]>(CHUNK_ROWS);
+            }
+            chunk[row % CHUNK_ROWS] = value;
+        }
+
+        T operator[](size_t row) const {
+            return this->chunks[row / CHUNK_ROWS][row % CHUNK_ROWS];
+        }
+
+        /// Calls `visit` with rows [begin, end) as contiguous spans, in order.
+        template<typename F>
+        void scan(size_t begin, size_t end, F&& visit) const {
+            while (begin < end) {
+                auto const offset = begin % CHUNK_ROWS;
+                auto const count = std::min(end - begin, CHUNK_ROWS - offset);
+                visit(std::span<T const>(&this->chunks[begin / CHUNK_ROWS][offset], count));
+                begin += count;
+            }
+        }
+
+    private:
+        std::unique_ptr<std::unique_ptr<T[]>[]> chunks;
+    };
+
+    /// The row count of a table's columns. Rows below it are whole and will never change.
+    class Table {
+    public:
+        [[nodiscard]]
+        size_t rows() const {
+            return this->count.load(std::memory_order_acquire);
+        }
+
+    protected:
+        /// Makes the row just written to every column visible to readers.
+        void publish() {
+            this->count.store(this->count.load(std::memory_order_relaxed) + 1,
+                std::memory_order_release);
+        }
+
+        /// The row being written.
+        [[nodiscard]]
+        size_t next() const {
+            return this->count.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<size_t> count { 0 };
+    };
+
+    /// A row from every frame.
+    class StateTable : public Table {
+    public:
+        void append(telemetry::Frame const& frame);
+
+        Column<uint32_t> time_ms;
+        Column<uint16_t> sequence;
+        Column<float> altitude;
+        Column<float> velocity;
+        Column<float> acceleration;
+        Column<FlightPhase> phase;
+    };
+
+    /// A row from every frame with the health group.
+    class HealthTable : public Table {
+    public:
+        void append(telemetry::Frame const& frame);
+
+        Column<uint32_t> time_ms;
+        Column<uint8_t> valid;
+        Column<uint8_t> dead;
+        Column<uint32_t> queue_overruns;
+        Column<uint32_t> missed_periods;
+        Column<uint32_t> max_queue_depth;
+    };
+
+    /// A row from every frame with the estimator group.
+    class EstimatorTable : public Table {
+    public:
+        void append(telemetry::Frame const& frame);
+
+        Column<uint32_t> time_ms;
+        Column<float> altitude_sigma;
+        Column<float> high_g_weight;
+        Column<float> accel_bias;
+    };
+
+    /// A row from every frame with the GPS group.
+    class GpsTable : public Table {
+    public:
+        void append(telemetry::Frame const& frame);
+
+        Column<uint32_t> time_ms;
+        Column<int32_t> latitude_e7;
+        Column<int32_t> longitude_e7;
+        Column<float> altitude;
+        Column<uint8_t> satellites;
+        Column<telemetry::GpsFixType> fix;
+    };
+
+    /// A table per group, each with the flight computer's time of its rows.
+    ///
+    /// One thread appends; any number of others can read at the same time, up to each table's
+    /// rows(), without locks.
+    class Store {
+    public:
+        static constexpr size_t CAPACITY = Column<uint8_t>::CAPACITY;
+
+        /// Adds a row to the table of each group `frame` carries. Returns false, adding nothing,
+        /// once the store is full.
+        bool append(telemetry::Frame const& frame);
+
+        /// Writes each table to `dir` as CSV: state.csv, health.csv, estimator.csv and gps.csv.
+        Expected<void> write_csv(std::filesystem::path const& dir) const;
+
+        [[nodiscard]]
+        StateTable const& state() const {
+            return this->state_table;
+        }
+
+        [[nodiscard]]
+        HealthTable const& health() const {
+            return this->health_table;
+        }
+
+        [[nodiscard]]
+        EstimatorTable const& estimator() const {
+            return this->estimator_table;
+        }
+
+        [[nodiscard]]
+        GpsTable const& gps() const {
+            return this->gps_table;
+        }
+
+    private:
+        StateTable state_table;
+        HealthTable health_table;
+        EstimatorTable estimator_table;
+        GpsTable gps_table;
+    };
+}
@@ -0,0 +1,210 @@
+// Listens to the telemetry radio and shows the rocket's latest state once a second, keeping every
+// frame until it's stopped with Ctrl-C.
+//
+// The receiver can be on a serial port, or be stood in for by radio_sim through a pty or UDP.
+// A stream recorded earlier (by --record here, or by `sil --telemetry`) is replayed as fast as
+// it can be read, and what it took is printed at the end.
+//
+//     ground_station (--serial <device> [--baud <rate>] | --pty | --udp <port> | --file <stream>)
+//                    [--record <file>] [--out <dir>] [--link <bytes/s>]
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#include "station/ingest.h"
+
+using namespace seds;
+using namespace seds::station;
+using namespace std::chrono;
+
+namespace {
+    struct Options {
+        enum class Kind { None, Serial, Pty, Udp, File };
+
+        Kind kind = Kind::None;
+        char const* path = nullptr;
+        uint32_t baud = 115200;
+        uint16_t port = 0;
+        IngestConfig ingest;
+        char const* out_dir = nullptr;
+        /// To compare a replay's speed with, bytes/s.
+        double link = 640;
+    };
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: ground_station (--serial <device> [--baud <rate>] | --pty | --udp <port>\n"
+            "                       | --file <stream>)\n"
+            "                      [--record <file>] [--out <dir>] [--link <bytes/s>]\n"
+            "\n"
+            "  --serial  the receiver's serial port\n"
+            "  --baud    its baud rate (default: 115200)\n"
+            "  --pty     make a pty for radio_sim to write to, and print its path\n"
+            "  --udp     take datagrams sent to this port, as radio_sim sends them\n"
+            "  --file    replay a recorded stream as fast as it can be read\n"
+            "  --record  save the stream to this file byte for byte as it came in\n"
+            "  --out     write the frames to this directory as CSV at the end, a file per group\n"
+            "  --link    the radio's rate to compare a replay's speed with, bytes/s\n"
+            "            (default: 640, the flight computer's default budget)\n");
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--pty") {
+                options.kind = Options::Kind::Pty;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            i++;
+            auto const number = std::atol(argv[i]);
+            if (arg == "--serial") {
+                options.kind = Options::Kind::Serial;
+                options.path = argv[i];
+            } else if (arg == "--baud" && number > 0) {
+                options.baud = static_cast<uint32_t>(number);
+            } else if (arg == "--udp" && number > 0 && number < 65536) {
+                options.kind = Options::Kind::Udp;
+                options.port = static_cast<uint16_t>(number);
+            } else if (arg == "--file") {
+                options.kind = Options::Kind::File;
+                options.path = argv[i];
+            } else if (arg == "--record") {
+                options.ingest.record = argv[i];
+            } else if (arg == "--out") {
+                options.out_dir = argv[i];
+            } else if (arg == "--link" && std::atof(argv[i]) > 0) {
+                options.link = std::atof(argv[i]);
+            } else {
+                return std::nullopt;
+            }
+        }
+        if (options.kind == Options::Kind::None) {
+            return std::nullopt;
+        }
+        return options;
+    }
+
+    Expected<std::unique_ptr<Source>> open_source(Options const& options) {
+        switch (options.kind) {
+        case Options::Kind::Serial:
+            return open_serial(options.path, options.baud);
+        case Options::Kind::Pty:
+            return open_pty();
+        case Options::Kind::Udp:
+            return open_udp(options.port);
+        case Options::Kind::File:
+        case Options::Kind::None:
+            break;
+        }
+        return open_file(options.path);
+    }
+
+    std::atomic<bool> interrupted = false;
+
+    void print_status(Snapshot const& snapshot, double bytes_per_s) {
+        auto const& stats = snapshot.stats;
+        if (stats.frames == 0) {
+            std::printf("no frames yet, %llu bytes\n",
+                static_cast<unsigned long long>(stats.bytes));
+            return;
+        }
+        std::printf("%9.2f s  %-14s %8.1f m %8.2f m/s %8.2f m/s^2  %llu frames, %llu lost, "
+            "%llu corrupted, %.0f bytes/s\n", snapshot.time_ms / 1000.0,
+            to_string(snapshot.state.phase), snapshot.state.altitude, snapshot.state.velocity,
+            snapshot.state.acceleration, static_cast<unsigned long long>(stats.frames),
+            static_cast<unsigned long long>(stats.lost),
+            static_cast<unsigned long long>(stats.corrupted), bytes_per_s);
+        if (snapshot.heard & telemetry::GROUP_HEALTH) {
+            std::printf("           sensors valid 0x%02x, dead 0x%02x\n", snapshot.health.valid,
+                snapshot.health.dead);
+        }
+        if (snapshot.heard & telemetry::GROUP_GPS) {
+            std::printf("           gps %.7f, %.7f, %.0f m, %u satellites\n",
+                snapshot.gps.latitude_e7 * 1e-7, snapshot.gps.longitude_e7 * 1e-7,
+                snapshot.gps.altitude, snapshot.gps.satellites);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto source = open_source(*options);
+    if (!source.has_value()) {
+        std::fprintf(stderr, "%s\n", source.error().c_str());
+        return 1;
+    }
+    bool const live = options->kind != Options::Kind::File;
+    // Status lines as they happen, even into a pipe
+    std::setvbuf(stdout, nullptr, _IOLBF, 0);
+    if (live) {
+        std::printf("listening on %s\n", (*source)->name().c_str());
+    }
+
+    Ingest ingest(std::move(*source));
+    auto const start = steady_clock::now();
+    if (auto started = ingest.start(options->ingest); !started.has_value()) {
+        std::fprintf(stderr, "%s\n", started.error().c_str());
+        return 1;
+    }
+    std::signal(SIGINT, [](int) { interrupted.store(true); });
+
+    auto last_print = start;
+    uint64_t last_bytes = 0;
+    while (!interrupted.load() && !ingest.done()) {
+        // A replay is over in moments
+        std::this_thread::sleep_for(live ? milliseconds(50) : milliseconds(1));
+        auto const now = steady_clock::now();
+        if (!live || now - last_print < seconds(1)) {
+            continue;
+        }
+        auto const snapshot = ingest.snapshot();
+        auto const elapsed = duration<double>(now - last_print).count();
+        print_status(snapshot, static_cast<double>(snapshot.stats.bytes - last_bytes) / elapsed);
+        last_print = now;
+        last_bytes = snapshot.stats.bytes;
+    }
+
+    auto const stopped = ingest.stop();
+    auto const elapsed = duration<double>(steady_clock::now() - start).count();
+    if (!stopped.has_value()) {
+        std::fprintf(stderr, "%s\n", stopped.error().c_str());
+    }
+
+    auto const snapshot = ingest.snapshot();
+    auto const& stats = snapshot.stats;
+    print_status(snapshot, static_cast<double>(stats.bytes) / elapsed);
+    std::printf("%llu bytes in %.3f s, %.1f MB/s, %.0f times the link; %llu bytes skipped, "
+        "%llu stalls\n", static_cast<unsigned long long>(stats.bytes), elapsed,
+        static_cast<double>(stats.bytes) / elapsed / 1e6,
+        static_cast<double>(stats.bytes) / elapsed / options->link,
+        static_cast<unsigned long long>(stats.skipped),
+        static_cast<unsigned long long>(stats.stalls));
+    if (stats.unstored > 0) {
+        std::printf("the store filled up; %llu frames weren't kept\n",
+            static_cast<unsigned long long>(stats.unstored));
+    }
+
+    if (options->out_dir != nullptr) {
+        auto const written = ingest.store().write_csv(options->out_dir);
+        if (!written.has_value()) {
+            std::fprintf(stderr, "%s\n", written.error().c_str());
+            return 1;
+        }
+    }
+    return stopped.has_value() ? 0 : 1;
+}
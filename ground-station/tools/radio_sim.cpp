@@ -0,0 +1,203 @@
+// Plays a recorded telemetry stream to the ground station as the radio would: a little at a
+// time, at the link's rate, optionally damaging it on the way.
+//
+// The stream goes to a UDP port or to a file such as the pty `ground_station --pty` prints, so
+// the whole ground station can be run without a receiver.
+//
+//     radio_sim <stream> (--udp <port> [--host <address>] | --write <path>) [--rate <bytes/s>]
+//               [--corrupt <n>] [--seed <n>] [--loop]
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <random>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std::chrono;
+
+namespace {
+    struct Options {
+        char const* stream = nullptr;
+        char const* write_path = nullptr;
+        char const* host = "127.0.0.1";
+        uint16_t port = 0;
+        /// Bytes per second. Zero sends as fast as possible.
+        double rate = 640;
+        /// Bytes damaged or lost in 10,000.
+        double corrupt = 0;
+        uint32_t seed = 1;
+        bool loop = false;
+    };
+
+    /// The most sent at once, well within a datagram.
+    constexpr size_t MAX_PIECE = 1024;
+
+    void usage() {
+        std::fprintf(stderr,
+            "usage: radio_sim <stream> (--udp <port> [--host <address>] | --write <path>)\n"
+            "                 [--rate <bytes/s>] [--corrupt <n>] [--seed <n>] [--loop]\n"
+            "\n"
+            "  --udp      send datagrams to this port\n"
+            "  --host     ... on this IPv4 address (default: 127.0.0.1)\n"
+            "  --write    write to this file, such as the pty ground_station --pty made\n"
+            "  --rate     bytes per second, or 0 for as fast as possible (default: 640)\n"
+            "  --corrupt  bytes in 10,000 to flip or drop (default: 0)\n"
+            "  --seed     for the damage (default: 1)\n"
+            "  --loop     start the stream over at its end, until stopped\n");
+    }
+
+    std::optional<Options> parse_args(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--loop") {
+                options.loop = true;
+                continue;
+            }
+            if (!arg.starts_with("--")) {
+                if (options.stream != nullptr) {
+                    return std::nullopt;
+                }
+                options.stream = argv[i];
+                continue;
+            }
+            if (i + 1 >= argc) {
+                return std::nullopt;
+            }
+            i++;
+            auto const number = std::atof(argv[i]);
+            if (arg == "--udp" && number > 0 && number < 65536) {
+                options.port = static_cast<uint16_t>(number);
+            } else if (arg == "--host") {
+                options.host = argv[i];
+            } else if (arg == "--write") {
+                options.write_path = argv[i];
+            } else if (arg == "--rate" && number >= 0) {
+                options.rate = number;
+            } else if (arg == "--corrupt" && number >= 0 && number <= 10'000) {
+                options.corrupt = number;
+            } else if (arg == "--seed") {
+                options.seed = static_cast<uint32_t>(std::atol(argv[i]));
+            } else {
+                return std::nullopt;
+            }
+        }
+        if (options.stream == nullptr || (options.port == 0) == (options.write_path == nullptr)) {
+            return std::nullopt;
+        }
+        return options;
+    }
+
+    std::optional<std::vector<uint8_t>> read_stream(char const* path) {
+        FILE* file = std::fopen(path, "rb");
+        if (file == nullptr) {
+            return std::nullopt;
+        }
+        std::vector<uint8_t> bytes;
+        uint8_t chunk[1 << 16];
+        size_t len;
+        while ((len = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            bytes.insert(bytes.end(), chunk, chunk + len);
+        }
+        std::fclose(file);
+        return bytes;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto const options = parse_args(argc, argv);
+    if (!options.has_value()) {
+        usage();
+        return 2;
+    }
+
+    auto const stream = read_stream(options->stream);
+    if (!stream.has_value()) {
+        std::fprintf(stderr, "%s: %s\n", options->stream, strerror(errno));
+        return 1;
+    }
+    if (stream->empty()) {
+        std::fprintf(stderr, "%s: empty\n", options->stream);
+        return 1;
+    }
+
+    int fd;
+    sockaddr_in address = {};
+    if (options->write_path != nullptr) {
+        fd = open(options->write_path, O_WRONLY | O_NOCTTY);
+        if (fd < 0) {
+            std::fprintf(stderr, "%s: %s\n", options->write_path, strerror(errno));
+            return 1;
+        }
+    } else {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options->port);
+        if (fd < 0 || inet_pton(AF_INET, options->host, &address.sin_addr) != 1) {
+            std::fprintf(stderr, "can't send to %s:%u\n", options->host, options->port);
+            return 1;
+        }
+    }
+
+    // A piece every 20 ms at the link's rate, in as few writes as it takes at full speed
+    auto const piece_len = options->rate == 0
+        ? MAX_PIECE
+        : std::clamp<size_t>(static_cast<size_t>(options->rate / 50), 1, MAX_PIECE);
+
+    std::mt19937 rng(options->seed);
+    std::bernoulli_distribution damaged(options->corrupt / 10'000);
+    std::bernoulli_distribution dropped(0.5);
+    std::uniform_int_distribution<int> flip(1, 255);
+
+    uint64_t sent = 0;
+    auto const start = steady_clock::now();
+    std::vector<uint8_t> piece;
+    do {
+        for (size_t offset = 0; offset < stream->size(); offset += piece_len) {
+            auto const end = std::min(offset + piece_len, stream->size());
+            piece.clear();
+            for (size_t i = offset; i < end; i++) {
+                auto byte = (*stream)[i];
+                if (damaged(rng)) {
+                    if (dropped(rng)) {
+                        continue;
+                    }
+                    byte ^= static_cast<uint8_t>(flip(rng));
+                }
+                piece.push_back(byte);
+            }
+
+            if (options->rate > 0) {
+                std::this_thread::sleep_until(start + duration_cast<nanoseconds>(
+                    duration<double>(static_cast<double>(sent) / options->rate)));
+            }
+            auto const written = options->write_path != nullptr
+                ? write(fd, piece.data(), piece.size())
+                : sendto(fd, piece.data(), piece.size(), 0,
+                    reinterpret_cast<sockaddr const*>(&address), sizeof(address));
+            if (written < 0) {
+                std::fprintf(stderr, "send: %s\n", strerror(errno));
+                close(fd);
+                return 1;
+            }
+            sent += end - offset;
+        }
+    } while (options->loop);
+
+    close(fd);
+    auto const elapsed = duration<double>(steady_clock::now() - start).count();
+    std::printf("%llu bytes in %.3f s\n", static_cast<unsigned long long>(sent), elapsed);
+    return 0;
+}